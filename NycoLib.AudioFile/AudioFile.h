@@ -0,0 +1,871 @@
+#ifndef NYCOLIB_AUDIO_FILE_H
+#define NYCOLIB_AUDIO_FILE_H
+
+/*
+	Module: AudioFile (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		AudioFile contains the AudioFile class, a reader of WAV, RF64 and AIFF/AIFC files
+		that memory maps the file instead of reading it.
+
+		when the samples in the file are already in the layout of the requested type
+		(float32 for AudioStream<float>, 16 bit PCM for AudioStream<int16_t>, in the byte
+		order of the machine), stream<T>() returns an AudioStream over the mapped data
+		itself. nothing is read or copied, the pages are loaded by the OS as they are touched,
+		and the mapping stays alive for as long as any stream over it does.
+
+		any other encoding (24 bit PCM, big endian AIFF, 8 bit WAV...) is decoded lazily
+		through samples<T>(), only the samples that are accessed are converted. little
+		endian PCM and float files are decoded to float by the vector kernels of
+		SampleConversion.
+
+		the mapping is private and copy-on-write, so a stream over it can be modified in
+		place like any other stream, without ever writing to the file.
+		samples are interleaved, sample i of frame f is at f * channels() + i.
+
+*/
+
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <assert.h>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../NycoLib/AudioStream.h"
+#include "../NycoLib/AudioStreamView.h"
+#include "../NycoLib/SampleConversion.h"
+
+
+#pragma region nyco - AudioFile - Declarations
+
+namespace nyco {
+
+/*
+* thrown when a file can not be opened, mapped, or is not a supported audio file
+*/
+class AudioFileError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+/*
+* the layout of the samples in an audio file
+*/
+struct AudioFormat {
+	enum Container {
+		WAV,
+		RF64,
+		AIFF,
+		AIFC
+	};
+
+	enum Encoding {
+		// integer samples, signed except 8 bit WAV which is unsigned
+		PCM,
+		// IEEE float samples of 32 or 64 bits
+		FLOAT
+	};
+
+	Container container = WAV;
+
+	Encoding encoding = PCM;
+
+	size_t channels = 0;
+
+	double sampleRate = 0;
+
+	size_t bitsPerSample = 0;
+
+	bool bigEndian = false;
+
+	/*
+	* returns the number of bytes of a single sample
+	*/
+	size_t bytesPerSample() const;
+
+	/*
+	* returns true if the samples are unsigned integers (8 bit WAV)
+	*/
+	bool isUnsigned() const;
+};
+
+/*
+* a read-only file mapped into memory with private copy-on-write pages
+*/
+class MappedFile {
+
+#pragma region Constructors
+public:
+
+	/*
+	* maps the whole file at path, throws AudioFileError if it can not be opened or mapped
+	*/
+	explicit MappedFile(std::string const& path);
+
+	MappedFile(MappedFile const&) = delete;
+
+	~MappedFile();
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the first byte of the mapping
+	*/
+	unsigned char* data() const;
+
+	/*
+	* returns the size of the file in bytes
+	*/
+	size_t size() const;
+
+#pragma endregion
+
+	MappedFile& operator=(MappedFile const&) = delete;
+
+#pragma region Private Methods
+private:
+
+	/*
+	* unmaps the file and closes every handle that was opened
+	*/
+	void close();
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	unsigned char* m_pData;
+
+	size_t m_nSize;
+
+#if defined(_WIN32)
+	HANDLE m_hFile;
+
+	HANDLE m_hMapping;
+#endif
+
+#pragma endregion
+
+};
+
+/*
+* the samples of an audio file as BufferType, decoded from the mapping when they are accessed
+* floating point samples are normalized to [-1, 1), integer samples are scaled to the full range of BufferType
+*/
+template <typename BufferType>
+class AudioFileSamples {
+
+#pragma region Constructors
+public:
+
+	explicit AudioFileSamples(std::shared_ptr<MappedFile> file, unsigned char const* data, size_t length, AudioFormat const& format);
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the number of samples (of all channels)
+	*/
+	size_t size() const;
+
+	/*
+	* decodes into.size() samples starting at sample first into into
+	*/
+	void read(size_t first, AudioStreamView<BufferType> into) const;
+
+	/*
+	* decodes count samples starting at sample first into a new AudioStream
+	*/
+	AudioStream<BufferType> read(size_t first, size_t count) const;
+
+#pragma endregion
+
+#pragma region Operator Overloading
+public:
+
+	/*
+	* decodes and returns sample i
+	*/
+	BufferType operator[](size_t i) const;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	std::shared_ptr<MappedFile> m_pFile;
+
+	unsigned char const* m_pData;
+
+	size_t m_nLength;
+
+	AudioFormat m_format;
+
+#pragma endregion
+
+};
+
+class AudioFile {
+
+#pragma region Constructors
+public:
+
+	/*
+	* maps the audio file at path and reads its header
+	* throws AudioFileError if the file can not be mapped or is not a supported WAV, RF64 or AIFF file
+	*/
+	explicit AudioFile(std::string const& path);
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the layout of the samples in the file
+	*/
+	AudioFormat const& format() const;
+
+	/*
+	* returns the number of channels
+	*/
+	size_t channels() const;
+
+	/*
+	* returns the sample rate in Hz
+	*/
+	double sampleRate() const;
+
+	/*
+	* returns the number of frames, a frame is a single sample of every channel
+	*/
+	size_t frames() const;
+
+	/*
+	* returns the number of samples of all channels, frames() * channels()
+	*/
+	size_t size() const;
+
+	/*
+	* returns true if the samples in the file can be used as BufferType without decoding them,
+	* meaning stream<BufferType>() does not copy
+	*/
+	template <typename BufferType>
+	bool isNative() const;
+
+	/*
+	* returns the samples of the file as an AudioStream
+	* if isNative<BufferType>() the stream is over the mapping and nothing is copied,
+	* otherwise every sample is decoded into a newly allocated stream
+	*/
+	template <typename BufferType>
+	AudioStream<BufferType> stream() const;
+
+	/*
+	* returns the samples of the file, decoded as BufferType when they are accessed
+	*/
+	template <typename BufferType>
+	AudioFileSamples<BufferType> samples() const;
+
+#pragma endregion
+
+#pragma region Private Methods
+private:
+
+	void parseWav();
+
+	void parseAiff();
+
+	/*
+	* returns a pointer to the size bytes at offset in the file, or throws if they are past its end
+	*/
+	unsigned char const* at(size_t offset, size_t size) const;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	std::shared_ptr<MappedFile> m_pFile;
+
+	unsigned char const* m_pData;
+
+	size_t m_nFrames;
+
+	AudioFormat m_format;
+
+#pragma endregion
+
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - AudioFile - Definitions
+
+namespace nyco {
+
+namespace detail {
+inline uint16_t readLE16(unsigned char const* p)
+{
+	return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t readLE32(unsigned char const* p)
+{
+	return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t readLE64(unsigned char const* p)
+{
+	return static_cast<uint64_t>(readLE32(p)) | (static_cast<uint64_t>(readLE32(p + 4)) << 32);
+}
+
+inline uint16_t readBE16(unsigned char const* p)
+{
+	return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t readBE32(unsigned char const* p)
+{
+	return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t readBE64(unsigned char const* p)
+{
+	return (static_cast<uint64_t>(readBE32(p)) << 32) | static_cast<uint64_t>(readBE32(p + 4));
+}
+
+/*
+* reads the 80 bit IEEE extended float AIFF stores the sample rate in
+*/
+inline double readExtended(unsigned char const* p)
+{
+	int const exponent = ((p[0] & 0x7F) << 8) | p[1];
+	uint64_t const mantissa = readBE64(p + 2);
+	if (exponent == 0 && mantissa == 0) {
+		return 0;
+	}
+	double const value = std::ldexp(static_cast<double>(mantissa), exponent - 16383 - 63);
+	return (p[0] & 0x80) ? -value : value;
+}
+
+inline bool matches(unsigned char const* p, char const* id)
+{
+	return std::memcmp(p, id, 4) == 0;
+}
+
+/*
+* converts a sample normalized to [-1, 1) to BufferType, scaling and clamping it to the range of integer types
+*/
+template <typename BufferType>
+BufferType fromNormalized(double x)
+{
+	if constexpr (std::is_floating_point_v<BufferType>) {
+		return static_cast<BufferType>(x);
+	}
+	else {
+		constexpr double scale = static_cast<double>(uint64_t{ 1 } << (sizeof(BufferType) * 8 - 1));
+		double const scaled = std::round(x * scale);
+		if (scaled >= scale) {
+			return static_cast<BufferType>(scale - 1);
+		}
+		if (scaled < -scale) {
+			return static_cast<BufferType>(-scale);
+		}
+		return static_cast<BufferType>(scaled);
+	}
+}
+
+/*
+* decodes count little endian 16/24/32 bit PCM or 32/64 bit float samples at src into dst with the
+* vector kernels of SampleConversion, returns false for any other format or when src is not aligned
+* to the type of its samples
+*/
+inline bool decodeVectorized(unsigned char const* src, AudioFormat const& format, float* dst, size_t count)
+{
+	if (std::endian::native != std::endian::little || format.bigEndian) {
+		return false;
+	}
+	auto aligned = [src](size_t alignment) { return reinterpret_cast<uintptr_t>(src) % alignment == 0; };
+	if (format.encoding == AudioFormat::FLOAT) {
+		if (format.bitsPerSample == 32) {
+			std::memcpy(dst, src, count * sizeof(float));
+			return true;
+		}
+		if (format.bitsPerSample == 64 && aligned(alignof(double))) {
+			conversion::convert(dst, reinterpret_cast<double const*>(src), count);
+			return true;
+		}
+		return false;
+	}
+	switch (format.bitsPerSample) {
+	case 16:
+		if (aligned(alignof(int16_t))) {
+			conversion::convert(dst, reinterpret_cast<int16_t const*>(src), count);
+			return true;
+		}
+		break;
+	case 24:
+		conversion::convert(dst, reinterpret_cast<conversion::Int24 const*>(src), count);
+		return true;
+	case 32:
+		if (aligned(alignof(int32_t))) {
+			conversion::convert(dst, reinterpret_cast<int32_t const*>(src), count);
+			return true;
+		}
+		break;
+	default:
+		break;
+	}
+	return false;
+}
+
+/*
+* decodes count samples of the given format at src into dst
+* the format is resolved once and the loop runs over a single encoding
+*/
+template <typename BufferType>
+void decode(unsigned char const* src, AudioFormat const& format, BufferType* dst, size_t count)
+{
+	if constexpr (std::is_same_v<BufferType, float>) {
+		if (count != 0 && decodeVectorized(src, format, dst, count)) {
+			return;
+		}
+	}
+	bool const big = format.bigEndian;
+	auto loop = [&](size_t step, auto&& sample) {
+		for (size_t i = 0; i < count; ++i, src += step) {
+			dst[i] = fromNormalized<BufferType>(sample(src));
+		}
+	};
+	if (format.encoding == AudioFormat::FLOAT) {
+		if (format.bitsPerSample == 32) {
+			loop(4, [big](unsigned char const* p) { return static_cast<double>(std::bit_cast<float>(big ? readBE32(p) : readLE32(p))); });
+		}
+		else {
+			loop(8, [big](unsigned char const* p) { return std::bit_cast<double>(big ? readBE64(p) : readLE64(p)); });
+		}
+		return;
+	}
+	switch (format.bitsPerSample) {
+	case 8:
+		if (format.isUnsigned()) {
+			loop(1, [](unsigned char const* p) { return (static_cast<int>(p[0]) - 128) / 128.0; });
+		}
+		else {
+			loop(1, [](unsigned char const* p) { return static_cast<int8_t>(p[0]) / 128.0; });
+		}
+		break;
+	case 16:
+		loop(2, [big](unsigned char const* p) { return static_cast<int16_t>(big ? readBE16(p) : readLE16(p)) / 32768.0; });
+		break;
+	case 24:
+		loop(3, [big](unsigned char const* p) {
+			uint32_t const bits = big ? (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8)
+				: (static_cast<uint32_t>(p[2]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[0]) << 8);
+			return static_cast<int32_t>(bits) / 2147483648.0;
+		});
+		break;
+	case 32:
+		loop(4, [big](unsigned char const* p) { return static_cast<int32_t>(big ? readBE32(p) : readLE32(p)) / 2147483648.0; });
+		break;
+	default:
+		assert(false && "unsupported sample size, AudioFile only accepts 8, 16, 24 and 32 bit PCM");
+	}
+}
+}
+
+#pragma region AudioFormat
+
+inline size_t AudioFormat::bytesPerSample() const
+{
+	return (bitsPerSample + 7) / 8;
+}
+
+inline bool AudioFormat::isUnsigned() const
+{
+	return encoding == PCM && bitsPerSample == 8 && (container == WAV || container == RF64);
+}
+
+#pragma endregion
+
+#pragma region MappedFile
+
+#if defined(_WIN32)
+
+inline MappedFile::MappedFile(std::string const& path)
+	: m_pData{ nullptr }
+	, m_nSize{ 0 }
+	, m_hFile{ INVALID_HANDLE_VALUE }
+	, m_hMapping{ nullptr }
+{
+	m_hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	LARGE_INTEGER size{};
+	if (m_hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_hFile, &size) || size.QuadPart == 0) {
+		close();
+		throw AudioFileError("can not open " + path);
+	}
+	m_nSize = static_cast<size_t>(size.QuadPart);
+	m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	m_pData = m_hMapping != nullptr ? static_cast<unsigned char*>(MapViewOfFile(m_hMapping, FILE_MAP_COPY, 0, 0, 0)) : nullptr;
+	if (m_pData == nullptr) {
+		close();
+		throw AudioFileError("can not map " + path);
+	}
+}
+
+inline MappedFile::~MappedFile()
+{
+	close();
+}
+
+inline void MappedFile::close()
+{
+	if (m_pData != nullptr) {
+		UnmapViewOfFile(m_pData);
+		m_pData = nullptr;
+	}
+	if (m_hMapping != nullptr) {
+		CloseHandle(m_hMapping);
+		m_hMapping = nullptr;
+	}
+	if (m_hFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+}
+
+#else
+
+inline MappedFile::MappedFile(std::string const& path)
+	: m_pData{ nullptr }
+	, m_nSize{ 0 }
+{
+	int const fd = ::open(path.c_str(), O_RDONLY);
+	struct stat info {};
+	if (fd < 0 || ::fstat(fd, &info) != 0 || info.st_size == 0) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+		throw AudioFileError("can not open " + path);
+	}
+	m_nSize = static_cast<size_t>(info.st_size);
+	// the mapping outlives the descriptor
+	void* const data = ::mmap(nullptr, m_nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		throw AudioFileError("can not map " + path);
+	}
+	m_pData = static_cast<unsigned char*>(data);
+	::madvise(data, m_nSize, MADV_SEQUENTIAL);
+}
+
+inline MappedFile::~MappedFile()
+{
+	close();
+}
+
+inline void MappedFile::close()
+{
+	if (m_pData != nullptr) {
+		::munmap(m_pData, m_nSize);
+		m_pData = nullptr;
+	}
+}
+
+#endif
+
+inline unsigned char* MappedFile::data() const
+{
+	return m_pData;
+}
+
+inline size_t MappedFile::size() const
+{
+	return m_nSize;
+}
+
+#pragma endregion
+
+#pragma region AudioFileSamples<BufferType>
+
+template <typename BufferType>
+AudioFileSamples<BufferType>::AudioFileSamples(std::shared_ptr<MappedFile> file, unsigned char const* data, size_t length, AudioFormat const& format)
+	: m_pFile{ std::move(file) }
+	, m_pData{ data }
+	, m_nLength{ length }
+	, m_format{ format }
+{
+}
+
+template <typename BufferType>
+size_t AudioFileSamples<BufferType>::size() const
+{
+	return m_nLength;
+}
+
+template <typename BufferType>
+void AudioFileSamples<BufferType>::read(size_t first, AudioStreamView<BufferType> into) const
+{
+	assert(first + into.size() <= m_nLength);
+	detail::decode(m_pData + first * m_format.bytesPerSample(), m_format, into.data(), into.size());
+}
+
+template <typename BufferType>
+AudioStream<BufferType> AudioFileSamples<BufferType>::read(size_t first, size_t count) const
+{
+	AudioStream<BufferType> stream(count);
+	read(first, stream.view());
+	return stream;
+}
+
+template <typename BufferType>
+BufferType AudioFileSamples<BufferType>::operator[](size_t i) const
+{
+	assert(i < m_nLength);
+	BufferType sample;
+	detail::decode(m_pData + i * m_format.bytesPerSample(), m_format, &sample, 1);
+	return sample;
+}
+
+#pragma endregion
+
+#pragma region AudioFile - Constructors
+
+inline AudioFile::AudioFile(std::string const& path)
+	: m_pFile{ std::make_shared<MappedFile>(path) }
+	, m_pData{ nullptr }
+	, m_nFrames{ 0 }
+	, m_format{}
+{
+	unsigned char const* header = at(0, 12);
+	if ((detail::matches(header, "RIFF") || detail::matches(header, "RF64")) && detail::matches(header + 8, "WAVE")) {
+		parseWav();
+	}
+	else if (detail::matches(header, "FORM") && (detail::matches(header + 8, "AIFF") || detail::matches(header + 8, "AIFC"))) {
+		parseAiff();
+	}
+	else {
+		throw AudioFileError(path + " is not a WAV, RF64 or AIFF file");
+	}
+	if (m_format.channels == 0 || m_pData == nullptr) {
+		throw AudioFileError(path + " has no audio data");
+	}
+	size_t const bits = m_format.bitsPerSample;
+	bool const supported = m_format.encoding == AudioFormat::FLOAT ? (bits == 32 || bits == 64) : (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+	if (!supported) {
+		throw AudioFileError(path + " has unsupported " + std::to_string(bits) + " bit samples");
+	}
+}
+
+#pragma endregion
+
+#pragma region AudioFile - Methods
+
+inline AudioFormat const& AudioFile::format() const
+{
+	return m_format;
+}
+
+inline size_t AudioFile::channels() const
+{
+	return m_format.channels;
+}
+
+inline double AudioFile::sampleRate() const
+{
+	return m_format.sampleRate;
+}
+
+inline size_t AudioFile::frames() const
+{
+	return m_nFrames;
+}
+
+inline size_t AudioFile::size() const
+{
+	return m_nFrames * m_format.channels;
+}
+
+template <typename BufferType>
+bool AudioFile::isNative() const
+{
+	bool const nativeOrder = m_format.bigEndian == (std::endian::native == std::endian::big) || sizeof(BufferType) == 1;
+	bool const aligned = reinterpret_cast<std::uintptr_t>(m_pData) % alignof(BufferType) == 0;
+	bool const sameWidth = m_format.bitsPerSample == sizeof(BufferType) * 8;
+	bool sameEncoding = false;
+	if constexpr (std::is_floating_point_v<BufferType>) {
+		sameEncoding = m_format.encoding == AudioFormat::FLOAT;
+	}
+	else if constexpr (std::is_integral_v<BufferType> && std::is_signed_v<BufferType>) {
+		sameEncoding = m_format.encoding == AudioFormat::PCM && !m_format.isUnsigned();
+	}
+	return nativeOrder && aligned && sameWidth && sameEncoding;
+}
+
+template <typename BufferType>
+AudioStream<BufferType> AudioFile::stream() const
+{
+	if (isNative<BufferType>()) {
+		// the stream shares ownership of the mapping, and points into it
+		std::shared_ptr<BufferType> samples(m_pFile, reinterpret_cast<BufferType*>(const_cast<unsigned char*>(m_pData)));
+		return AudioStream<BufferType>(std::move(samples), size(), ownership::NO_OWNERSHIP);
+	}
+	return samples<BufferType>().read(0, size());
+}
+
+template <typename BufferType>
+AudioFileSamples<BufferType> AudioFile::samples() const
+{
+	return AudioFileSamples<BufferType>(m_pFile, m_pData, size(), m_format);
+}
+
+#pragma endregion
+
+#pragma region AudioFile - Private Methods
+
+inline void AudioFile::parseWav()
+{
+	bool const rf64 = detail::matches(at(0, 4), "RF64");
+	m_format.container = rf64 ? AudioFormat::RF64 : AudioFormat::WAV;
+	m_format.bigEndian = false;
+	uint64_t dataSize64 = 0;
+	size_t offset = 12;
+	while (offset + 8 <= m_pFile->size()) {
+		unsigned char const* chunk = at(offset, 8);
+		uint64_t size = detail::readLE32(chunk + 4);
+		if (detail::matches(chunk, "ds64")) {
+			// RF64 keeps the 64 bit sizes here, the 32 bit fields are 0xFFFFFFFF
+			dataSize64 = detail::readLE64(at(offset + 8 + 8, 8));
+		}
+		else if (detail::matches(chunk, "fmt ")) {
+			unsigned char const* fmt = at(offset + 8, 16);
+			uint16_t tag = detail::readLE16(fmt);
+			m_format.channels = detail::readLE16(fmt + 2);
+			m_format.sampleRate = detail::readLE32(fmt + 4);
+			m_format.bitsPerSample = detail::readLE16(fmt + 14);
+			if (tag == 0xFFFE) {
+				// WAVE_FORMAT_EXTENSIBLE, the format tag is the start of the sub format GUID
+				tag = detail::readLE16(at(offset + 8 + 24, 2));
+			}
+			if (tag == 1) {
+				m_format.encoding = AudioFormat::PCM;
+			}
+			else if (tag == 3) {
+				m_format.encoding = AudioFormat::FLOAT;
+			}
+			else {
+				throw AudioFileError("unsupported WAV format tag " + std::to_string(tag));
+			}
+		}
+		else if (detail::matches(chunk, "data")) {
+			if (rf64 && size == 0xFFFFFFFF) {
+				size = dataSize64;
+			}
+			// a file that is still being recorded may be shorter than its header says
+			size = std::min<uint64_t>(size, m_pFile->size() - (offset + 8));
+			m_pData = m_pFile->data() + offset + 8;
+			size_t const frameSize = m_format.bytesPerSample() * m_format.channels;
+			m_nFrames = frameSize != 0 ? static_cast<size_t>(size) / frameSize : 0;
+			return;
+		}
+		offset += 8 + static_cast<size_t>(size) + (size & 1);
+	}
+}
+
+inline void AudioFile::parseAiff()
+{
+	bool const aifc = detail::matches(at(8, 4), "AIFC");
+	m_format.container = aifc ? AudioFormat::AIFC : AudioFormat::AIFF;
+	m_format.encoding = AudioFormat::PCM;
+	m_format.bigEndian = true;
+	unsigned char const* data = nullptr;
+	uint64_t dataSize = 0;
+	size_t offset = 12;
+	while (offset + 8 <= m_pFile->size()) {
+		unsigned char const* chunk = at(offset, 8);
+		uint64_t const size = detail::readBE32(chunk + 4);
+		if (detail::matches(chunk, "COMM")) {
+			unsigned char const* comm = at(offset + 8, 18);
+			m_format.channels = detail::readBE16(comm);
+			m_nFrames = detail::readBE32(comm + 2);
+			m_format.bitsPerSample = detail::readBE16(comm + 6);
+			m_format.sampleRate = detail::readExtended(comm + 8);
+			if (aifc) {
+				unsigned char const* compression = at(offset + 8 + 18, 4);
+				if (detail::matches(compression, "sowt")) {
+					m_format.bigEndian = false;
+				}
+				else if (detail::matches(compression, "fl32") || detail::matches(compression, "FL32")) {
+					m_format.encoding = AudioFormat::FLOAT;
+					m_format.bitsPerSample = 32;
+				}
+				else if (detail::matches(compression, "fl64") || detail::matches(compression, "FL64")) {
+					m_format.encoding = AudioFormat::FLOAT;
+					m_format.bitsPerSample = 64;
+				}
+				else if (!detail::matches(compression, "NONE") && !detail::matches(compression, "twos")) {
+					throw AudioFileError("unsupported AIFC compression " + std::string(reinterpret_cast<char const*>(compression), 4));
+				}
+			}
+		}
+		else if (detail::matches(chunk, "SSND")) {
+			// the samples start after the offset and block size fields, and offset bytes of padding
+			size_t const skip = 8 + detail::readBE32(at(offset + 8, 4));
+			size_t const start = offset + 8 + skip;
+			dataSize = std::min<uint64_t>(size > skip ? size - skip : 0, m_pFile->size() > start ? m_pFile->size() - start : 0);
+			data = m_pFile->data() + start;
+		}
+		offset += 8 + static_cast<size_t>(size) + (size & 1);
+	}
+	if (data != nullptr) {
+		m_pData = data;
+		size_t const frameSize = m_format.bytesPerSample() * m_format.channels;
+		m_nFrames = frameSize != 0 ? std::min<size_t>(m_nFrames, static_cast<size_t>(dataSize) / frameSize) : 0;
+	}
+}
+
+inline unsigned char const* AudioFile::at(size_t offset, size_t size) const
+{
+	if (offset > m_pFile->size() || size > m_pFile->size() - offset) {
+		throw AudioFileError("the audio file is truncated");
+	}
+	return m_pFile->data() + offset;
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_AUDIO_FILE_H
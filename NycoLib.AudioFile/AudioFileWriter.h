@@ -0,0 +1,751 @@
+#ifndef NYCOLIB_AUDIO_FILE_WRITER_H
+#define NYCOLIB_AUDIO_FILE_WRITER_H
+
+/*
+	Module: AudioFileWriter (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		AudioFileWriter contains the AudioFileWriter class, a streaming WAV/RF64 writer
+		for bouncing renders of any length with constant memory.
+
+		write() only copies the block into a lock-free AudioRingBuffer, so the producer
+		(a render or audio thread) never locks, allocates or waits for the disk. two
+		background threads do the rest:
+			- the converter drains the ring, converts the samples to the format of the
+			  file and serializes them into one of two aligned staging buffers.
+			- the disk thread writes a full staging buffer with a single large sequential
+			  write (optionally O_DIRECT), while the converter fills the other one.
+
+		the header is written with room for an RF64 ds64 chunk, and patched at close():
+		files over 4 GB become RF64, smaller ones stay plain WAV.
+
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <assert.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "AudioFile.h"
+#include "../NycoLib/AudioRingBuffer.h"
+
+
+#pragma region nyco - AudioFileWriter - Declarations
+
+namespace nyco {
+
+template <typename BufferType>
+class AudioFileWriter {
+
+#pragma region Types
+public:
+
+	struct Options {
+		// the samples the ring between the producer and the converter holds
+		size_t ringSamples = 1 << 20;
+
+		// the bytes of each of the two staging buffers, rounded up to a multiple of ALIGNMENT
+		size_t stagingBytes = 1 << 22;
+
+		// bypasses the page cache (O_DIRECT, FILE_FLAG_NO_BUFFERING) where the system supports it
+		bool directIO = false;
+
+		// adds TPDF dither when float samples are narrowed to 16 or 24 bit PCM
+		bool dither = false;
+	};
+
+	// the alignment of the staging buffers and of every write, as O_DIRECT needs
+	static constexpr size_t ALIGNMENT = 4096;
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* creates the file at path and starts the background threads
+	* format.container is WAV (promoted to RF64 at close if it grows over 4 GB) or RF64
+	* format.encoding and bitsPerSample are the layout of the samples in the file (PCM 16/24/32 or FLOAT 32/64)
+	* throws AudioFileError if the file can not be created
+	*/
+	explicit AudioFileWriter(std::string const& path, AudioFormat const& format, Options const& options = Options());
+
+	AudioFileWriter(AudioFileWriter const&) = delete;
+
+	/*
+	* closes the file, see close()
+	*/
+	~AudioFileWriter();
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* queues the interleaved samples of block to be written, and returns how many were queued
+	* never blocks: if the disk fell so far behind that the ring is full, the rest is dropped and counted
+	*/
+	size_t write(AudioStreamView<BufferType const> block);
+
+	/*
+	* queues the interleaved samples of stream to be written, see write(view)
+	*/
+	size_t write(AudioStreamBase<BufferType> const& stream);
+
+	/*
+	* returns the number of samples write() can queue right now
+	*/
+	size_t writeAvailable() const;
+
+	/*
+	* returns the number of samples dropped because the ring was full
+	*/
+	size_t dropped() const;
+
+	/*
+	* writes every queued sample, patches the header, stops the threads and closes the file
+	* throws AudioFileError if any write failed. does nothing if already closed
+	*/
+	void close();
+
+#pragma endregion
+
+	AudioFileWriter& operator=(AudioFileWriter const&) = delete;
+
+#pragma region Private Methods
+private:
+
+	/*
+	* the loop of the converter thread
+	*/
+	void convert();
+
+	/*
+	* the loop of the disk thread
+	*/
+	void flush();
+
+	/*
+	* hands the staging buffer index, holding length bytes, to the disk thread and waits for the other one to be free
+	*/
+	void submit(size_t index, size_t length);
+
+	/*
+	* writes length bytes of data at offset of the file, returns false on failure
+	*/
+	bool writeAt(unsigned char const* data, size_t length, uint64_t offset);
+
+	/*
+	* turns off direct I/O, for the writes that are not a multiple of ALIGNMENT
+	*/
+	void disableDirectIO();
+
+	/*
+	* writes the final header for dataBytes bytes of samples over the one written at the start
+	*/
+	bool patchHeader(uint64_t dataBytes);
+
+	/*
+	* returns the header of the file, with the sizes of dataBytes bytes of samples
+	*/
+	static size_t header(AudioFormat const& format, uint64_t dataBytes, bool rf64, unsigned char* out);
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	// the bytes header() writes: RIFF, JUNK or ds64, fmt and data chunk headers
+	static constexpr size_t HEADER_SIZE = 12 + 8 + 28 + 8 + 16 + 8;
+
+	struct Staging {
+		unsigned char* data = nullptr;
+
+		size_t length = 0;
+
+		bool full = false;
+	};
+
+	AudioFormat m_format;
+
+	AudioRingBuffer<BufferType> m_ring;
+
+	Staging m_staging[2];
+
+	size_t m_nStagingSize;
+
+	std::mutex m_lock;
+
+	std::condition_variable m_changed;
+
+	std::atomic<bool> m_bClosing;
+
+	bool m_bConverted;
+
+	std::atomic<bool> m_bFailed;
+
+	std::atomic<size_t> m_nDropped;
+
+	uint64_t m_nDataBytes;
+
+	bool m_bDirect;
+
+	bool m_bDither;
+
+	bool m_bClosed;
+
+#if defined(_WIN32)
+	HANDLE m_hFile;
+#else
+	int m_fd;
+#endif
+
+	std::thread m_converter;
+
+	std::thread m_disk;
+
+#pragma endregion
+
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - AudioFileWriter - Definitions
+
+namespace nyco {
+
+namespace detail {
+inline void writeLE16(unsigned char* p, uint16_t v)
+{
+	p[0] = static_cast<unsigned char>(v);
+	p[1] = static_cast<unsigned char>(v >> 8);
+}
+
+inline void writeLE32(unsigned char* p, uint32_t v)
+{
+	writeLE16(p, static_cast<uint16_t>(v));
+	writeLE16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+inline void writeLE64(unsigned char* p, uint64_t v)
+{
+	writeLE32(p, static_cast<uint32_t>(v));
+	writeLE32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+/*
+* returns a sample of BufferType normalized to [-1, 1), the inverse of fromNormalized
+*/
+template <typename BufferType>
+double toNormalized(BufferType x)
+{
+	if constexpr (std::is_floating_point_v<BufferType>) {
+		return static_cast<double>(x);
+	}
+	else {
+		constexpr double scale = static_cast<double>(uint64_t{ 1 } << (sizeof(BufferType) * 8 - 1));
+		return static_cast<double>(x) / scale;
+	}
+}
+
+/*
+* encodes count float samples at src into the little endian format of the file at dst with the vector
+* kernels of SampleConversion, returns false on a big endian machine or when dst is not aligned to the
+* type of the samples
+*/
+inline bool encodeVectorized(float const* src, AudioFormat const& format, unsigned char* dst, size_t count, conversion::TpdfDither* dither)
+{
+	if (std::endian::native != std::endian::little) {
+		return false;
+	}
+	auto aligned = [dst](size_t alignment) { return reinterpret_cast<uintptr_t>(dst) % alignment == 0; };
+	if (format.encoding == AudioFormat::FLOAT) {
+		if (format.bitsPerSample == 32) {
+			std::memcpy(dst, src, count * sizeof(float));
+			return true;
+		}
+		if (aligned(alignof(double))) {
+			conversion::convert(reinterpret_cast<double*>(dst), src, count);
+			return true;
+		}
+		return false;
+	}
+	switch (format.bitsPerSample) {
+	case 16:
+		if (aligned(alignof(int16_t))) {
+			conversion::convert(reinterpret_cast<int16_t*>(dst), src, count, dither);
+			return true;
+		}
+		break;
+	case 24:
+		conversion::convert(reinterpret_cast<conversion::Int24*>(dst), src, count, dither);
+		return true;
+	case 32:
+		if (aligned(alignof(int32_t))) {
+			conversion::convert(reinterpret_cast<int32_t*>(dst), src, count, dither);
+			return true;
+		}
+		break;
+	default:
+		break;
+	}
+	return false;
+}
+
+/*
+* encodes count samples at src into the little endian format of the file at dst
+* dither is only used by float samples narrowed to PCM, and may be nullptr
+*/
+template <typename BufferType>
+void encode(BufferType const* src, AudioFormat const& format, unsigned char* dst, size_t count, conversion::TpdfDither* dither)
+{
+	if constexpr (std::is_same_v<BufferType, float>) {
+		if (count != 0 && encodeVectorized(src, format, dst, count, dither)) {
+			return;
+		}
+	}
+	auto loop = [&](size_t step, auto&& store) {
+		for (size_t i = 0; i < count; ++i, dst += step) {
+			store(dst, toNormalized(src[i]));
+		}
+	};
+	auto pcm = [](double x, double scale) {
+		double const scaled = std::round(x * scale);
+		return static_cast<int64_t>(std::clamp(scaled, -scale, scale - 1));
+	};
+	if (format.encoding == AudioFormat::FLOAT) {
+		if (format.bitsPerSample == 32) {
+			loop(4, [](unsigned char* p, double x) { writeLE32(p, std::bit_cast<uint32_t>(static_cast<float>(x))); });
+		}
+		else {
+			loop(8, [](unsigned char* p, double x) { writeLE64(p, std::bit_cast<uint64_t>(x)); });
+		}
+		return;
+	}
+	switch (format.bitsPerSample) {
+	case 16:
+		loop(2, [&](unsigned char* p, double x) { writeLE16(p, static_cast<uint16_t>(pcm(x, 32768.0))); });
+		break;
+	case 24:
+		loop(3, [&](unsigned char* p, double x) {
+			uint32_t const v = static_cast<uint32_t>(pcm(x, 8388608.0));
+			p[0] = static_cast<unsigned char>(v);
+			p[1] = static_cast<unsigned char>(v >> 8);
+			p[2] = static_cast<unsigned char>(v >> 16);
+		});
+		break;
+	case 32:
+		loop(4, [&](unsigned char* p, double x) { writeLE32(p, static_cast<uint32_t>(pcm(x, 2147483648.0))); });
+		break;
+	default:
+		assert(false && "unsupported sample size, AudioFileWriter only writes 16, 24 and 32 bit PCM");
+	}
+}
+}
+
+#pragma region AudioFileWriter<BufferType> - Constructors
+
+template <typename BufferType>
+AudioFileWriter<BufferType>::AudioFileWriter(std::string const& path, AudioFormat const& format, Options const& options)
+	: m_format{ format }
+	, m_ring(options.ringSamples)
+	, m_staging{}
+	, m_nStagingSize{ (std::max(options.stagingBytes, HEADER_SIZE) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT }
+	, m_lock{}
+	, m_changed{}
+	, m_bClosing{ false }
+	, m_bConverted{ false }
+	, m_bFailed{ false }
+	, m_nDropped{ 0 }
+	, m_nDataBytes{ 0 }
+	, m_bDirect{ false }
+	, m_bDither{ options.dither }
+	, m_bClosed{ false }
+{
+	bool const supported = format.encoding == AudioFormat::FLOAT ? (format.bitsPerSample == 32 || format.bitsPerSample == 64)
+		: (format.bitsPerSample == 16 || format.bitsPerSample == 24 || format.bitsPerSample == 32);
+	if (!supported || format.channels == 0 || (format.container != AudioFormat::WAV && format.container != AudioFormat::RF64)) {
+		throw AudioFileError("AudioFileWriter writes WAV or RF64 files of 16/24/32 bit PCM or 32/64 bit float samples");
+	}
+	m_format.bigEndian = false;
+
+#if defined(_WIN32)
+	DWORD const flags = options.directIO ? FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH : FILE_FLAG_SEQUENTIAL_SCAN;
+	m_hFile = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, flags, nullptr);
+	if (m_hFile == INVALID_HANDLE_VALUE) {
+		throw AudioFileError("can not create " + path);
+	}
+	m_bDirect = options.directIO;
+#else
+	int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+	if (options.directIO) {
+		flags |= O_DIRECT;
+		m_bDirect = true;
+	}
+#endif
+	m_fd = ::open(path.c_str(), flags, 0644);
+	if (m_fd < 0 && m_bDirect) {
+		// the file system does not support direct I/O
+		m_bDirect = false;
+		m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	if (m_fd < 0) {
+		throw AudioFileError("can not create " + path);
+	}
+#endif
+
+	for (Staging& staging : m_staging) {
+		staging.data = static_cast<unsigned char*>(::operator new(m_nStagingSize, std::align_val_t{ ALIGNMENT }));
+	}
+	// the header is the first bytes of the stream, its sizes are patched at close
+	m_staging[0].length = header(m_format, 0, m_format.container == AudioFormat::RF64, m_staging[0].data);
+
+	m_disk = std::thread([this]() { flush(); });
+	m_converter = std::thread([this]() { convert(); });
+}
+
+template <typename BufferType>
+AudioFileWriter<BufferType>::~AudioFileWriter()
+{
+	try {
+		close();
+	}
+	catch (AudioFileError const&) {
+		// a destructor can not report the failure, call close() to see it
+	}
+	for (Staging& staging : m_staging) {
+		::operator delete(staging.data, std::align_val_t{ ALIGNMENT });
+	}
+}
+
+#pragma endregion
+
+#pragma region AudioFileWriter<BufferType> - Methods
+
+template <typename BufferType>
+size_t AudioFileWriter<BufferType>::write(AudioStreamView<BufferType const> block)
+{
+	size_t const queued = m_ring.push(block);
+	if (queued < block.size()) {
+		m_nDropped.fetch_add(block.size() - queued, std::memory_order_relaxed);
+	}
+	return queued;
+}
+
+template <typename BufferType>
+size_t AudioFileWriter<BufferType>::write(AudioStreamBase<BufferType> const& stream)
+{
+	// a rotated stream is queued in logical order from its two segments, it is not normalized
+	auto const segments = stream.segments();
+	size_t const queued = write(segments[0]);
+	if (queued < segments[0].size()) {
+		m_nDropped.fetch_add(segments[1].size(), std::memory_order_relaxed);
+		return queued;
+	}
+	return queued + write(segments[1]);
+}
+
+template <typename BufferType>
+size_t AudioFileWriter<BufferType>::writeAvailable() const
+{
+	return m_ring.writeAvailable();
+}
+
+template <typename BufferType>
+size_t AudioFileWriter<BufferType>::dropped() const
+{
+	return m_nDropped.load(std::memory_order_relaxed);
+}
+
+template <typename BufferType>
+void AudioFileWriter<BufferType>::close()
+{
+	if (m_bClosed) {
+		return;
+	}
+	m_bClosed = true;
+	m_bClosing.store(true, std::memory_order_release);
+	m_converter.join();
+	m_disk.join();
+
+	// the data chunk is padded to an even size, a direct write already padded it with zeros
+	if ((m_nDataBytes & 1) != 0 && !m_bDirect) {
+		unsigned char const pad = 0;
+		disableDirectIO();
+		if (!writeAt(&pad, 1, HEADER_SIZE + m_nDataBytes)) {
+			m_bFailed = true;
+		}
+	}
+	if (!patchHeader(m_nDataBytes)) {
+		m_bFailed = true;
+	}
+
+#if defined(_WIN32)
+	LARGE_INTEGER end{};
+	end.QuadPart = static_cast<LONGLONG>(HEADER_SIZE + m_nDataBytes + (m_nDataBytes & 1));
+	if (!SetFilePointerEx(m_hFile, end, nullptr, FILE_BEGIN) || !SetEndOfFile(m_hFile)) {
+		m_bFailed = true;
+	}
+	CloseHandle(m_hFile);
+#else
+	// the last direct write was padded to ALIGNMENT, the file ends where the samples do
+	if (::ftruncate(m_fd, static_cast<off_t>(HEADER_SIZE + m_nDataBytes + (m_nDataBytes & 1))) != 0) {
+		m_bFailed = true;
+	}
+	::close(m_fd);
+#endif
+
+	if (m_bFailed) {
+		throw AudioFileError("writing the audio file failed");
+	}
+}
+
+#pragma endregion
+
+#pragma region AudioFileWriter<BufferType> - Private Methods
+
+template <typename BufferType>
+void AudioFileWriter<BufferType>::convert()
+{
+	size_t const sampleSize = m_format.bytesPerSample();
+	size_t current = 0;
+	conversion::TpdfDither state;
+	conversion::TpdfDither* const dither = m_bDither ? &state : nullptr;
+	while (true) {
+		// the closing flag is read before draining, so every sample pushed before close() is written
+		bool const closing = m_bClosing.load(std::memory_order_acquire);
+		auto ready = m_ring.peek(m_ring.capacity());
+		if (ready.size() == 0) {
+			if (closing) {
+				break;
+			}
+			// the producer never signals, so it never makes a system call; the converter polls instead
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+		for (AudioStreamView<BufferType const> region : { ready.first, ready.second }) {
+			size_t done = 0;
+			while (done < region.size()) {
+				Staging& staging = m_staging[current];
+				size_t const room = m_nStagingSize - staging.length;
+				size_t const whole = std::min(room / sampleSize, region.size() - done);
+				detail::encode(region.data() + done, m_format, staging.data + staging.length, whole, dither);
+				staging.length += whole * sampleSize;
+				done += whole;
+				if (done < region.size() && staging.length + sampleSize > m_nStagingSize) {
+					// a sample that straddles two staging buffers is encoded aside and split
+					unsigned char sample[8];
+					detail::encode(region.data() + done, m_format, sample, 1, dither);
+					size_t const head = m_nStagingSize - staging.length;
+					std::memcpy(staging.data + staging.length, sample, head);
+					staging.length = m_nStagingSize;
+					submit(current, m_nStagingSize);
+					current ^= 1;
+					std::memcpy(m_staging[current].data, sample + head, sampleSize - head);
+					m_staging[current].length = sampleSize - head;
+					++done;
+				}
+				else if (staging.length == m_nStagingSize) {
+					submit(current, m_nStagingSize);
+					current ^= 1;
+				}
+			}
+		}
+		m_nDataBytes += ready.size() * sampleSize;
+		m_ring.consume(ready.size());
+	}
+	if (m_staging[current].length != 0) {
+		submit(current, m_staging[current].length);
+	}
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_bConverted = true;
+	}
+	m_changed.notify_all();
+}
+
+template <typename BufferType>
+void AudioFileWriter<BufferType>::submit(size_t index, size_t length)
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_staging[index].length = length;
+	m_staging[index].full = true;
+	m_changed.notify_all();
+	m_changed.wait(lock, [&]() { return !m_staging[index ^ 1].full; });
+	m_staging[index ^ 1].length = 0;
+}
+
+template <typename BufferType>
+void AudioFileWriter<BufferType>::flush()
+{
+	size_t current = 0;
+	uint64_t offset = 0;
+	while (true) {
+		size_t length = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+			m_changed.wait(lock, [&]() { return m_staging[current].full || m_bConverted; });
+			if (!m_staging[current].full) {
+				return;
+			}
+			length = m_staging[current].length;
+		}
+		size_t written = length;
+		if (m_bDirect && length % ALIGNMENT != 0) {
+			// the last buffer is padded to ALIGNMENT, close() truncates the file to its real size
+			written = (length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+			std::memset(m_staging[current].data + length, 0, written - length);
+		}
+		if (!writeAt(m_staging[current].data, written, offset)) {
+			m_bFailed = true;
+		}
+		offset += length;
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_staging[current].full = false;
+		}
+		m_changed.notify_all();
+		current ^= 1;
+	}
+}
+
+template <typename BufferType>
+bool AudioFileWriter<BufferType>::writeAt(unsigned char const* data, size_t length, uint64_t offset)
+{
+#if defined(_WIN32)
+	while (length != 0) {
+		OVERLAPPED position{};
+		position.Offset = static_cast<DWORD>(offset);
+		position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		DWORD const chunk = static_cast<DWORD>(std::min<size_t>(length, 1u << 30));
+		DWORD done = 0;
+		if (!WriteFile(m_hFile, data, chunk, &done, &position) || done == 0) {
+			return false;
+		}
+		data += done;
+		length -= done;
+		offset += done;
+	}
+#else
+	while (length != 0) {
+		ssize_t const done = ::pwrite(m_fd, data, length, static_cast<off_t>(offset));
+		if (done <= 0) {
+			return false;
+		}
+		data += done;
+		length -= static_cast<size_t>(done);
+		offset += static_cast<uint64_t>(done);
+	}
+#endif
+	return true;
+}
+
+template <typename BufferType>
+void AudioFileWriter<BufferType>::disableDirectIO()
+{
+	if (!m_bDirect) {
+		return;
+	}
+#if defined(_WIN32)
+	// FILE_FLAG_NO_BUFFERING can not be turned off on a handle, the small writes are padded instead
+#else
+#ifdef O_DIRECT
+	::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+#endif
+	m_bDirect = false;
+#endif
+}
+
+template <typename BufferType>
+bool AudioFileWriter<BufferType>::patchHeader(uint64_t dataBytes)
+{
+	bool const rf64 = m_format.container == AudioFormat::RF64 || HEADER_SIZE + dataBytes + (dataBytes & 1) > 0xFFFFFFFFull;
+#if defined(_WIN32)
+	if (m_bDirect) {
+		// rewrites the whole first sector, which holds the header and the first samples
+		unsigned char* sector = static_cast<unsigned char*>(::operator new(ALIGNMENT, std::align_val_t{ ALIGNMENT }));
+		std::memset(sector, 0, ALIGNMENT);
+		OVERLAPPED position{};
+		DWORD done = 0;
+		HANDLE reader = ReOpenFile(m_hFile, GENERIC_READ, FILE_SHARE_WRITE, 0);
+		bool ok = reader != INVALID_HANDLE_VALUE && ReadFile(reader, sector, ALIGNMENT, &done, &position);
+		if (reader != INVALID_HANDLE_VALUE) {
+			CloseHandle(reader);
+		}
+		header(m_format, dataBytes, rf64, sector);
+		ok = ok && writeAt(sector, ALIGNMENT, 0);
+		::operator delete(sector, std::align_val_t{ ALIGNMENT });
+		return ok;
+	}
+#endif
+	disableDirectIO();
+	unsigned char bytes[HEADER_SIZE];
+	header(m_format, dataBytes, rf64, bytes);
+	return writeAt(bytes, HEADER_SIZE, 0);
+}
+
+template <typename BufferType>
+size_t AudioFileWriter<BufferType>::header(AudioFormat const& format, uint64_t dataBytes, bool rf64, unsigned char* out)
+{
+	uint64_t const riffBytes = HEADER_SIZE - 8 + dataBytes + (dataBytes & 1);
+	size_t const blockAlign = format.bytesPerSample() * format.channels;
+	unsigned char* p = out;
+	std::memcpy(p, rf64 ? "RF64" : "RIFF", 4);
+	detail::writeLE32(p + 4, rf64 ? 0xFFFFFFFF : static_cast<uint32_t>(riffBytes));
+	std::memcpy(p + 8, "WAVE", 4);
+	p += 12;
+	// a WAV keeps the room of the ds64 chunk as a JUNK chunk, so it can become an RF64 in place
+	std::memcpy(p, rf64 ? "ds64" : "JUNK", 4);
+	detail::writeLE32(p + 4, 28);
+	std::memset(p + 8, 0, 28);
+	if (rf64) {
+		detail::writeLE64(p + 8, riffBytes);
+		detail::writeLE64(p + 16, dataBytes);
+		detail::writeLE64(p + 24, blockAlign != 0 ? dataBytes / blockAlign : 0);
+	}
+	p += 8 + 28;
+	std::memcpy(p, "fmt ", 4);
+	detail::writeLE32(p + 4, 16);
+	detail::writeLE16(p + 8, format.encoding == AudioFormat::FLOAT ? 3 : 1);
+	detail::writeLE16(p + 10, static_cast<uint16_t>(format.channels));
+	detail::writeLE32(p + 12, static_cast<uint32_t>(format.sampleRate));
+	detail::writeLE32(p + 16, static_cast<uint32_t>(format.sampleRate * blockAlign));
+	detail::writeLE16(p + 20, static_cast<uint16_t>(blockAlign));
+	detail::writeLE16(p + 22, static_cast<uint16_t>(format.bitsPerSample));
+	p += 8 + 16;
+	std::memcpy(p, "data", 4);
+	detail::writeLE32(p + 4, rf64 ? 0xFFFFFFFF : static_cast<uint32_t>(dataBytes));
+	p += 8;
+	return static_cast<size_t>(p - out);
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_AUDIO_FILE_WRITER_H
@@ -0,0 +1,454 @@
+#ifndef NYCOLIB_AUDIO_ALLOCATOR_H
+#define NYCOLIB_AUDIO_ALLOCATOR_H
+
+/*
+	Module: AudioAllocator (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		AudioAllocator contains the allocators the buffers of AudioStream and
+		MultiChannelAudioStream come from. every buffer is aligned to a 64 byte cache line,
+		so vector loads never split a line.
+
+		by default buffers come from a PoolAllocator, which keeps freed buffers in free
+		lists by size class. a stream that is cloned or evaluated every block reuses the
+		buffer the previous block freed, instead of calling malloc.
+		any class deriving from AudioAllocator can be used instead, for a single stream
+		or for the whole library with setDefaultAllocator.
+
+*/
+
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <assert.h>
+
+
+#pragma region nyco - AudioAllocator - Declarations
+
+namespace nyco {
+
+/*
+* the interface every allocator of sample buffers implements
+* allocate must return memory aligned to AudioAllocator::ALIGNMENT
+*/
+class AudioAllocator {
+
+#pragma region Constants
+public:
+
+	// alignment in bytes of every buffer returned by allocate
+	static constexpr size_t ALIGNMENT = 64;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	virtual ~AudioAllocator() = default;
+
+	/*
+	* returns an uninitialized buffer of at least bytes bytes, aligned to ALIGNMENT
+	*/
+	virtual void* allocate(size_t bytes) = 0;
+
+	/*
+	* returns a buffer to the allocator. bytes is the same value it was allocated with
+	*/
+	virtual void deallocate(void* p, size_t bytes) = 0;
+
+#pragma endregion
+
+};
+
+/*
+* allocates every buffer from the global heap with aligned operator new
+*/
+class AlignedAllocator : public AudioAllocator {
+
+#pragma region Methods
+public:
+
+	void* allocate(size_t bytes) override;
+
+	void deallocate(void* p, size_t bytes) override;
+
+#pragma endregion
+
+};
+
+/*
+* keeps freed buffers in free lists by size class (powers of two from 64 bytes) and
+* hands them out again before asking the upstream allocator for memory.
+* every size class has its own lock, so threads working with different sizes do not contend
+*/
+class PoolAllocator : public AudioAllocator {
+
+#pragma region Constants
+public:
+
+	// size in bytes of the smallest size class
+	static constexpr size_t MIN_BLOCK_SIZE = ALIGNMENT;
+
+	// number of size classes, buffers larger than the last one always go to the upstream allocator
+	static constexpr size_t SIZE_CLASSES = 20;
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new PoolAllocator that keeps at most maxCachedBlocks free buffers of each size class
+	* and gets its memory from upstream
+	*/
+	explicit PoolAllocator(size_t maxCachedBlocks = 16, AudioAllocator* upstream = nullptr);
+
+	PoolAllocator(PoolAllocator const&) = delete;
+
+	~PoolAllocator() override;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	void* allocate(size_t bytes) override;
+
+	void deallocate(void* p, size_t bytes) override;
+
+	/*
+	* returns every cached buffer to the upstream allocator
+	*/
+	void release();
+
+	/*
+	* returns the size class of a buffer of bytes bytes, or SIZE_CLASSES if it is not pooled
+	*/
+	static size_t sizeClass(size_t bytes);
+
+	/*
+	* returns the size in bytes of the buffers in the given size class
+	*/
+	static size_t blockSize(size_t sizeClass);
+
+#pragma endregion
+
+	PoolAllocator& operator=(PoolAllocator const&) = delete;
+
+#pragma region Private Members
+private:
+
+	// a free buffer, the link to the next one is stored in the buffer itself
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	struct FreeList {
+		std::mutex lock;
+		FreeBlock* head = nullptr;
+		size_t count = 0;
+	};
+
+	std::array<FreeList, SIZE_CLASSES> m_freeLists;
+
+	size_t m_nMaxCachedBlocks;
+
+	AudioAllocator* m_pUpstream;
+
+#pragma endregion
+
+};
+
+/*
+* deleter for a buffer of T that was allocated from an AudioAllocator
+*/
+template <typename T>
+struct allocator_delete
+{
+	allocator_delete() /* noexcept */
+		: m_pAllocator{ nullptr }
+		, m_nLength{ 0 }
+	{
+	}
+
+	allocator_delete(AudioAllocator& allocator, size_t length) /* noexcept */
+		: m_pAllocator{ &allocator }
+		, m_nLength{ length }
+	{
+	}
+
+	void operator()(T* const p) const /* noexcept */
+	{
+		if (p != nullptr) {
+			m_pAllocator->deallocate(p, m_nLength * sizeof(T));
+		}
+	}
+
+	AudioAllocator& allocator() const
+	{
+		return *m_pAllocator;
+	}
+
+	AudioAllocator* m_pAllocator;
+
+	size_t m_nLength;
+};
+
+/*
+* std compatible allocator over an AudioAllocator, used for the control block of a std::shared_ptr
+*/
+template <typename T>
+class AllocatorAdapter {
+public:
+	using value_type = T;
+
+	explicit AllocatorAdapter(AudioAllocator& allocator);
+
+	template <typename U>
+	AllocatorAdapter(AllocatorAdapter<U> const& other);
+
+	T* allocate(size_t n);
+
+	void deallocate(T* p, size_t n);
+
+	AudioAllocator& allocator() const;
+
+	template <typename U>
+	bool operator==(AllocatorAdapter<U> const& other) const;
+
+private:
+	AudioAllocator* m_pAllocator;
+};
+
+/*
+* returns the allocator used for new buffers when no allocator is given
+* inside a RealTimeScope this is the pool of the scope
+*/
+AudioAllocator& defaultAllocator();
+
+/*
+* returns the allocator a new buffer is taken from when requested is asked for
+* inside a RealTimeScope this is always the pool of the scope, otherwise it is requested
+*/
+AudioAllocator& resolveAllocator(AudioAllocator& requested);
+
+/*
+* sets the allocator used for new buffers when no allocator is given
+* allocator must outlive every buffer allocated from it
+*/
+void setDefaultAllocator(AudioAllocator& allocator);
+
+/*
+* returns the global AlignedAllocator
+*/
+AudioAllocator& alignedAllocator();
+
+}
+
+#pragma endregion
+
+#pragma region nyco - AudioAllocator - Definitions
+
+namespace nyco {
+
+#pragma region AlignedAllocator
+
+inline void* AlignedAllocator::allocate(size_t bytes)
+{
+	return ::operator new(bytes, std::align_val_t{ ALIGNMENT });
+}
+
+inline void AlignedAllocator::deallocate(void* p, size_t)
+{
+	::operator delete(p, std::align_val_t{ ALIGNMENT });
+}
+
+#pragma endregion
+
+#pragma region PoolAllocator
+
+inline PoolAllocator::PoolAllocator(size_t maxCachedBlocks, AudioAllocator* upstream)
+	: m_freeLists{}
+	, m_nMaxCachedBlocks{ maxCachedBlocks }
+	, m_pUpstream{ upstream != nullptr ? upstream : &alignedAllocator() }
+{
+}
+
+inline PoolAllocator::~PoolAllocator()
+{
+	release();
+}
+
+inline void* PoolAllocator::allocate(size_t bytes)
+{
+	size_t const c = sizeClass(bytes);
+	if (c == SIZE_CLASSES) {
+		return m_pUpstream->allocate(bytes);
+	}
+	FreeList& list = m_freeLists[c];
+	{
+		std::lock_guard<std::mutex> guard(list.lock);
+		if (FreeBlock* block = list.head) {
+			list.head = block->next;
+			--list.count;
+			return block;
+		}
+	}
+	return m_pUpstream->allocate(blockSize(c));
+}
+
+inline void PoolAllocator::deallocate(void* p, size_t bytes)
+{
+	size_t const c = sizeClass(bytes);
+	if (c == SIZE_CLASSES) {
+		m_pUpstream->deallocate(p, bytes);
+		return;
+	}
+	FreeList& list = m_freeLists[c];
+	{
+		std::lock_guard<std::mutex> guard(list.lock);
+		if (list.count < m_nMaxCachedBlocks) {
+			list.head = ::new (p) FreeBlock{ list.head };
+			++list.count;
+			return;
+		}
+	}
+	m_pUpstream->deallocate(p, blockSize(c));
+}
+
+inline void PoolAllocator::release()
+{
+	for (size_t c = 0; c < SIZE_CLASSES; ++c) {
+		FreeList& list = m_freeLists[c];
+		FreeBlock* block = nullptr;
+		{
+			std::lock_guard<std::mutex> guard(list.lock);
+			block = list.head;
+			list.head = nullptr;
+			list.count = 0;
+		}
+		while (block != nullptr) {
+			FreeBlock* next = block->next;
+			m_pUpstream->deallocate(block, blockSize(c));
+			block = next;
+		}
+	}
+}
+
+inline size_t PoolAllocator::sizeClass(size_t bytes)
+{
+	size_t c = 0;
+	while (c < SIZE_CLASSES && blockSize(c) < bytes) {
+		++c;
+	}
+	return c;
+}
+
+inline size_t PoolAllocator::blockSize(size_t sizeClass)
+{
+	return MIN_BLOCK_SIZE << sizeClass;
+}
+
+#pragma endregion
+
+#pragma region AllocatorAdapter<T>
+
+template <typename T>
+AllocatorAdapter<T>::AllocatorAdapter(AudioAllocator& allocator)
+	: m_pAllocator{ &allocator }
+{
+}
+
+template <typename T>
+template <typename U>
+AllocatorAdapter<T>::AllocatorAdapter(AllocatorAdapter<U> const& other)
+	: m_pAllocator{ &other.allocator() }
+{
+}
+
+template <typename T>
+T* AllocatorAdapter<T>::allocate(size_t n)
+{
+	return static_cast<T*>(m_pAllocator->allocate(n * sizeof(T)));
+}
+
+template <typename T>
+void AllocatorAdapter<T>::deallocate(T* p, size_t n)
+{
+	m_pAllocator->deallocate(p, n * sizeof(T));
+}
+
+template <typename T>
+AudioAllocator& AllocatorAdapter<T>::allocator() const
+{
+	return *m_pAllocator;
+}
+
+template <typename T>
+template <typename U>
+bool AllocatorAdapter<T>::operator==(AllocatorAdapter<U> const& other) const
+{
+	return m_pAllocator == &other.allocator();
+}
+
+#pragma endregion
+
+#pragma region Default Allocator
+
+namespace detail {
+inline std::atomic<AudioAllocator*>& defaultAllocatorSlot()
+{
+	// the pool is never destroyed, so buffers of static streams can still be freed into it at exit
+	static PoolAllocator* pool = new PoolAllocator();
+	static std::atomic<AudioAllocator*> slot{ pool };
+	return slot;
+}
+
+// the allocator of the innermost RealTimeScope of this thread
+inline AudioAllocator*& scopeAllocatorSlot()
+{
+	static thread_local AudioAllocator* allocator = nullptr;
+	return allocator;
+}
+}
+
+inline AudioAllocator& defaultAllocator()
+{
+	if (AudioAllocator* scoped = detail::scopeAllocatorSlot()) {
+		return *scoped;
+	}
+	return *detail::defaultAllocatorSlot().load(std::memory_order_acquire);
+}
+
+inline AudioAllocator& resolveAllocator(AudioAllocator& requested)
+{
+	if (AudioAllocator* scoped = detail::scopeAllocatorSlot()) {
+		return *scoped;
+	}
+	return requested;
+}
+
+inline void setDefaultAllocator(AudioAllocator& allocator)
+{
+	detail::defaultAllocatorSlot().store(&allocator, std::memory_order_release);
+}
+
+inline AudioAllocator& alignedAllocator()
+{
+	// never destroyed, it is the upstream of the default pool
+	static AlignedAllocator* allocator = new AlignedAllocator();
+	return *allocator;
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_AUDIO_ALLOCATOR_H
@@ -0,0 +1,478 @@
+#ifndef NYCOLIB_AUDIO_BUFFER_H
+#define NYCOLIB_AUDIO_BUFFER_H
+
+/*
+	Module: AudioBuffer (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		AudioBuffer contains the buffer handles an AudioStream keeps its samples in,
+		one for every ownership policy in ownership.h:
+
+			ownership::shared         SharedBuffer    a std::shared_ptr, the buffer can be shared between streams
+			ownership::unique         UniqueBuffer    a bare pointer, freed to its allocator with the stream
+			ownership::borrowed       BorrowedBuffer  a bare pointer to samples that belong to someone else
+			ownership::copy_on_write  SharedBuffer    a std::shared_ptr, shared by clone until one of the streams is written
+
+		the policy is a template parameter of AudioStream, so the handle is picked at compile time.
+		a unique or borrowed stream has no reference count and no type-erased deleter,
+		moving one copies a pointer and destroying one is at most a call to its allocator.
+		a unique handle does not keep the length of its buffer, the stream returns the buffer
+		with its own length, so a unique stream is no larger than a shared one.
+		a buffer from a RealTimePool is owned by a unique stream whose allocator is the pool.
+
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <assert.h>
+
+#include "ownership.h"
+#include "AudioAllocator.h"
+
+
+#pragma region nyco - AudioBuffer - Declarations
+
+namespace nyco {
+
+/*
+* a reference counted buffer. the handle of ownership::shared and ownership::copy_on_write
+*/
+template <typename T>
+class SharedBuffer {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs an empty handle
+	*/
+	SharedBuffer() = default;
+
+	/*
+	* constructs a handle over a buffer that is already reference counted
+	*/
+	explicit SharedBuffer(std::shared_ptr<T> buffer);
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns a pointer to the first sample of the buffer
+	*/
+	T* get() const;
+
+	/*
+	* returns true if this handle is the only owner of the buffer,
+	* a buffer that is not owned (constructed with an empty_delete) is never unique
+	*/
+	bool unique() const;
+
+	/*
+	* returns the allocator the buffer came from, or the default allocator if it was not allocated by the library
+	*/
+	AudioAllocator& allocator() const;
+
+	/*
+	* moves the reference counted buffer out of this handle
+	*/
+	std::shared_ptr<T> release();
+
+	explicit operator bool() const;
+
+#pragma endregion
+
+#pragma region Static Methods
+public:
+
+	/*
+	* returns a handle over an uninitialized, 64 byte aligned buffer of length samples from allocator.
+	* the shared_ptr control block comes from the same allocator
+	*/
+	static SharedBuffer<T> allocate(size_t length, AudioAllocator& allocator);
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	std::shared_ptr<T> m_pBuffer;
+
+#pragma endregion
+
+};
+
+/*
+* a buffer with a single owner and the allocator it came from. the handle of ownership::unique,
+* the stream that owns it keeps the length and returns it with deallocate before the handle is destroyed
+*/
+template <typename T>
+class UniqueBuffer {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs an empty handle
+	*/
+	UniqueBuffer() = default;
+
+	// Copy Constructor
+	UniqueBuffer(UniqueBuffer<T> const&) = delete;
+
+	// Move Constructor
+	UniqueBuffer(UniqueBuffer<T>&& other) noexcept;
+
+	// asserts the buffer was returned with deallocate
+	~UniqueBuffer();
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns a pointer to the first sample of the buffer
+	*/
+	T* get() const;
+
+	/*
+	* returns true if this handle holds a buffer, which it is always the only owner of
+	*/
+	bool unique() const;
+
+	/*
+	* returns the allocator the buffer came from
+	*/
+	AudioAllocator& allocator() const;
+
+	/*
+	* returns the buffer to its allocator and empties the handle, length must be the length it was allocated with
+	*/
+	void deallocate(size_t length);
+
+	explicit operator bool() const;
+
+#pragma endregion
+
+#pragma region Static Methods
+public:
+
+	/*
+	* returns a handle over an uninitialized, 64 byte aligned buffer of length samples from allocator
+	*/
+	static UniqueBuffer<T> allocate(size_t length, AudioAllocator& allocator);
+
+#pragma endregion
+
+#pragma region Operator Overloading
+public:
+
+	UniqueBuffer<T>& operator=(UniqueBuffer<T> const&) = delete;
+
+	// a handle that holds a buffer cannot return it without its length, so it is never assigned over
+	UniqueBuffer<T>& operator=(UniqueBuffer<T>&&) = delete;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	T* m_pData = nullptr;
+
+	AudioAllocator* m_pAllocator = nullptr;
+
+#pragma endregion
+
+};
+
+/*
+* a pointer to samples owned by someone else, never freed. the handle of ownership::borrowed
+*/
+template <typename T>
+class BorrowedBuffer {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs an empty handle
+	*/
+	BorrowedBuffer() = default;
+
+	/*
+	* constructs a handle over data
+	*/
+	explicit BorrowedBuffer(T* data);
+
+	// Move Constructor
+	BorrowedBuffer(BorrowedBuffer<T>&& other) noexcept;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns a pointer to the first sample of the buffer
+	*/
+	T* get() const;
+
+	/*
+	* returns false, the samples always belong to someone else
+	*/
+	bool unique() const;
+
+	/*
+	* returns the default allocator, the samples were not allocated by the library
+	*/
+	AudioAllocator& allocator() const;
+
+	explicit operator bool() const;
+
+#pragma endregion
+
+#pragma region Operator Overloading
+public:
+
+	BorrowedBuffer<T>& operator=(BorrowedBuffer<T>&& other) noexcept;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	T* m_pData = nullptr;
+
+#pragma endregion
+
+};
+
+namespace ownership {
+namespace detail {
+template <typename Policy, typename T>
+struct Buffer;
+
+template <typename T>
+struct Buffer<shared, T> {
+	using type = SharedBuffer<T>;
+};
+
+template <typename T>
+struct Buffer<unique, T> {
+	using type = UniqueBuffer<T>;
+};
+
+template <typename T>
+struct Buffer<borrowed, T> {
+	using type = BorrowedBuffer<T>;
+};
+
+template <typename T>
+struct Buffer<copy_on_write, T> {
+	using type = SharedBuffer<T>;
+};
+
+template <typename Policy>
+struct Owning {
+	using type = Policy;
+};
+
+template <>
+struct Owning<borrowed> {
+	using type = unique;
+};
+}
+
+/*
+* the buffer handle of a stream of T with the given ownership policy
+*/
+template <typename Policy, typename T>
+using buffer_t = typename detail::Buffer<Policy, T>::type;
+
+/*
+* the policy of a new stream made from a stream with the given policy (a clone, a concat, a shifted copy).
+* a copy of borrowed samples is owned by a unique stream, the other policies keep their own
+*/
+template <typename Policy>
+using owning_t = typename detail::Owning<Policy>::type;
+}
+}
+
+#pragma endregion
+
+#pragma region nyco - AudioBuffer - Definitions
+
+namespace nyco {
+
+#pragma region SharedBuffer<T>
+
+template <typename T>
+SharedBuffer<T>::SharedBuffer(std::shared_ptr<T> buffer)
+	: m_pBuffer{ std::move(buffer) }
+{
+}
+
+template <typename T>
+T* SharedBuffer<T>::get() const
+{
+	return m_pBuffer.get();
+}
+
+template <typename T>
+bool SharedBuffer<T>::unique() const
+{
+	// a stream constructed with ownership::NO_OWNERSHIP never owns its buffer, even if nothing else points to it
+	return m_pBuffer.use_count() == 1 && std::get_deleter<empty_delete<T>>(m_pBuffer) == nullptr;
+}
+
+template <typename T>
+AudioAllocator& SharedBuffer<T>::allocator() const
+{
+	if (allocator_delete<T> const* deleter = std::get_deleter<allocator_delete<T>>(m_pBuffer)) {
+		return deleter->allocator();
+	}
+	return defaultAllocator();
+}
+
+template <typename T>
+std::shared_ptr<T> SharedBuffer<T>::release()
+{
+	return std::move(m_pBuffer);
+}
+
+template <typename T>
+SharedBuffer<T>::operator bool() const
+{
+	return static_cast<bool>(m_pBuffer);
+}
+
+template <typename T>
+SharedBuffer<T> SharedBuffer<T>::allocate(size_t length, AudioAllocator& allocator)
+{
+	AudioAllocator& source = resolveAllocator(allocator);
+	T* buffer = static_cast<T*>(source.allocate(length * sizeof(T)));
+	assert(reinterpret_cast<std::uintptr_t>(buffer) % AudioAllocator::ALIGNMENT == 0);
+	return SharedBuffer<T>(std::shared_ptr<T>(buffer, allocator_delete<T>(source, length), AllocatorAdapter<T>(source)));
+}
+
+#pragma endregion
+
+#pragma region UniqueBuffer<T>
+
+template <typename T>
+UniqueBuffer<T>::UniqueBuffer(UniqueBuffer<T>&& other) noexcept
+	: m_pData{ std::exchange(other.m_pData, nullptr) }
+	, m_pAllocator{ other.m_pAllocator }
+{
+}
+
+template <typename T>
+UniqueBuffer<T>::~UniqueBuffer()
+{
+	assert(m_pData == nullptr && "a unique buffer must be returned with deallocate by the stream that owns it");
+}
+
+template <typename T>
+T* UniqueBuffer<T>::get() const
+{
+	return m_pData;
+}
+
+template <typename T>
+bool UniqueBuffer<T>::unique() const
+{
+	return m_pData != nullptr;
+}
+
+template <typename T>
+AudioAllocator& UniqueBuffer<T>::allocator() const
+{
+	return m_pAllocator != nullptr ? *m_pAllocator : defaultAllocator();
+}
+
+template <typename T>
+void UniqueBuffer<T>::deallocate(size_t length)
+{
+	if (m_pData != nullptr) {
+		m_pAllocator->deallocate(std::exchange(m_pData, nullptr), length * sizeof(T));
+	}
+}
+
+template <typename T>
+UniqueBuffer<T>::operator bool() const
+{
+	return m_pData != nullptr;
+}
+
+template <typename T>
+UniqueBuffer<T> UniqueBuffer<T>::allocate(size_t length, AudioAllocator& allocator)
+{
+	UniqueBuffer<T> buffer;
+	buffer.m_pAllocator = &resolveAllocator(allocator);
+	buffer.m_pData = static_cast<T*>(buffer.m_pAllocator->allocate(length * sizeof(T)));
+	assert(reinterpret_cast<std::uintptr_t>(buffer.m_pData) % AudioAllocator::ALIGNMENT == 0);
+	return buffer;
+}
+
+#pragma endregion
+
+#pragma region BorrowedBuffer<T>
+
+template <typename T>
+BorrowedBuffer<T>::BorrowedBuffer(T* data)
+	: m_pData{ data }
+{
+}
+
+template <typename T>
+BorrowedBuffer<T>::BorrowedBuffer(BorrowedBuffer<T>&& other) noexcept
+	: m_pData{ std::exchange(other.m_pData, nullptr) }
+{
+}
+
+template <typename T>
+T* BorrowedBuffer<T>::get() const
+{
+	return m_pData;
+}
+
+template <typename T>
+bool BorrowedBuffer<T>::unique() const
+{
+	return false;
+}
+
+template <typename T>
+AudioAllocator& BorrowedBuffer<T>::allocator() const
+{
+	return defaultAllocator();
+}
+
+template <typename T>
+BorrowedBuffer<T>::operator bool() const
+{
+	return m_pData != nullptr;
+}
+
+template <typename T>
+BorrowedBuffer<T>& BorrowedBuffer<T>::operator=(BorrowedBuffer<T>&& other) noexcept
+{
+	m_pData = std::exchange(other.m_pData, nullptr);
+	return *this;
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_AUDIO_BUFFER_H
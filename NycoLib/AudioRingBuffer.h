@@ -0,0 +1,337 @@
+#ifndef NYCOLIB_AUDIO_RING_BUFFER_H
+#define NYCOLIB_AUDIO_RING_BUFFER_H
+
+/*
+	Module: AudioRingBuffer (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		AudioRingBuffer contains the AudioRingBuffer class, a wait-free single producer,
+		single consumer queue of samples for passing audio between the real-time thread
+		and worker threads (disk, analysis) without locks.
+
+		the capacity is a power of two, so positions wrap with a mask. the write and read
+		positions live on separate cache lines, and every push or pop is at most two memcpys.
+		peek and prepare hand out the readable or writable part of the buffer as (up to)
+		two views, so samples can be produced or consumed in place without a copy.
+
+		exactly one thread may call the producer methods (push, prepare, commit,
+		writeAvailable) and exactly one thread the consumer methods (pop, peek, consume,
+		readAvailable) at the same time.
+
+*/
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <assert.h>
+
+#include "AudioStream.h"
+#include "AudioStreamView.h"
+
+
+#pragma region nyco - AudioRingBuffer - Declarations
+
+namespace nyco {
+
+template <typename BufferType>
+class AudioRingBuffer {
+
+#pragma region Types
+public:
+
+	/*
+	* a part of the ring buffer that may wrap around its end, as two consecutive views
+	*/
+	template <typename T>
+	struct Regions {
+		AudioStreamView<T> first;
+
+		AudioStreamView<T> second;
+
+		/*
+		* returns the number of samples in both views
+		*/
+		size_t size() const;
+	};
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new AudioRingBuffer that holds at least capacity samples (rounded up to a power of two)
+	*/
+	explicit AudioRingBuffer(size_t capacity, AudioAllocator& allocator = defaultAllocator());
+
+	// Copy Constructor
+	AudioRingBuffer(AudioRingBuffer<BufferType> const& ring) = delete;
+
+#pragma endregion
+
+#pragma region Producer Methods
+public:
+
+	/*
+	* copies as many samples of samples as there is room for, and returns how many were copied
+	*/
+	size_t push(AudioStreamView<BufferType const> samples);
+
+	/*
+	* returns the free part of the buffer, up to length samples, to be written in place
+	* the samples become readable after commit
+	*/
+	Regions<BufferType> prepare(size_t length);
+
+	/*
+	* makes length samples written into the regions returned by prepare readable
+	*/
+	void commit(size_t length);
+
+	/*
+	* returns the number of samples that can be pushed
+	*/
+	size_t writeAvailable() const;
+
+#pragma endregion
+
+#pragma region Consumer Methods
+public:
+
+	/*
+	* copies as many samples into into as are available, and returns how many were copied
+	*/
+	size_t pop(AudioStreamView<BufferType> into);
+
+	/*
+	* returns the readable part of the buffer, up to length samples, without copying or consuming it
+	*/
+	Regions<BufferType const> peek(size_t length) const;
+
+	/*
+	* drops length samples, usually after reading them through peek
+	*/
+	void consume(size_t length);
+
+	/*
+	* returns the number of samples that can be popped
+	*/
+	size_t readAvailable() const;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the number of samples the buffer holds
+	*/
+	size_t capacity() const;
+
+	/*
+	* returns the smallest power of two that is at least length
+	*/
+	static size_t capacityFor(size_t length);
+
+#pragma endregion
+
+	// Deleting the operator= so you can't assign a ring buffer by reference
+	AudioRingBuffer<BufferType>& operator=(AudioRingBuffer<BufferType> const& rhs) = delete;
+
+#pragma region Private Methods
+private:
+
+	/*
+	* returns the part of the buffer of length samples starting at the position
+	*/
+	template <typename T>
+	Regions<T> regions(size_t position, size_t length) const;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	AudioStream<BufferType> m_storage;
+
+	BufferType* m_pData;
+
+	size_t m_nMask;
+
+	// positions only ever grow, the index in the buffer is position & m_nMask
+	// the producer owns m_nWrite and a cached copy of the last m_nRead it saw, the consumer the opposite
+
+	alignas(AudioAllocator::ALIGNMENT) std::atomic<size_t> m_nWrite;
+
+	size_t m_nCachedRead;
+
+	alignas(AudioAllocator::ALIGNMENT) std::atomic<size_t> m_nRead;
+
+	mutable size_t m_nCachedWrite;
+
+#pragma endregion
+
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - AudioRingBuffer - Definitions
+
+namespace nyco {
+
+#pragma region AudioRingBuffer<BufferType> - Regions
+
+template <typename BufferType>
+template <typename T>
+size_t AudioRingBuffer<BufferType>::Regions<T>::size() const
+{
+	return first.size() + second.size();
+}
+
+#pragma endregion
+
+#pragma region AudioRingBuffer<BufferType> - Constructors
+
+template <typename BufferType>
+AudioRingBuffer<BufferType>::AudioRingBuffer(size_t capacity, AudioAllocator& allocator)
+	: m_storage(capacityFor(capacity), allocator)
+	, m_pData{ m_storage.begin() }
+	, m_nMask{ capacityFor(capacity) - 1 }
+	, m_nWrite{ 0 }
+	, m_nCachedRead{ 0 }
+	, m_nRead{ 0 }
+	, m_nCachedWrite{ 0 }
+{
+}
+
+#pragma endregion
+
+#pragma region AudioRingBuffer<BufferType> - Producer Methods
+
+template <typename BufferType>
+size_t AudioRingBuffer<BufferType>::push(AudioStreamView<BufferType const> samples)
+{
+	Regions<BufferType> free = prepare(samples.size());
+	size_t const length = free.size();
+	if (length == 0) {
+		return 0;
+	}
+	std::memcpy(free.first.data(), samples.data(), free.first.size() * sizeof(BufferType));
+	std::memcpy(free.second.data(), samples.data() + free.first.size(), free.second.size() * sizeof(BufferType));
+	commit(length);
+	return length;
+}
+
+template <typename BufferType>
+typename AudioRingBuffer<BufferType>::template Regions<BufferType> AudioRingBuffer<BufferType>::prepare(size_t length)
+{
+	size_t const write = m_nWrite.load(std::memory_order_relaxed);
+	if (capacity() - (write - m_nCachedRead) < length) {
+		m_nCachedRead = m_nRead.load(std::memory_order_acquire);
+	}
+	size_t const free = capacity() - (write - m_nCachedRead);
+	return regions<BufferType>(write, length < free ? length : free);
+}
+
+template <typename BufferType>
+void AudioRingBuffer<BufferType>::commit(size_t length)
+{
+	size_t const write = m_nWrite.load(std::memory_order_relaxed);
+	assert(length <= capacity() - (write - m_nRead.load(std::memory_order_relaxed)));
+	m_nWrite.store(write + length, std::memory_order_release);
+}
+
+template <typename BufferType>
+size_t AudioRingBuffer<BufferType>::writeAvailable() const
+{
+	return capacity() - (m_nWrite.load(std::memory_order_relaxed) - m_nRead.load(std::memory_order_acquire));
+}
+
+#pragma endregion
+
+#pragma region AudioRingBuffer<BufferType> - Consumer Methods
+
+template <typename BufferType>
+size_t AudioRingBuffer<BufferType>::pop(AudioStreamView<BufferType> into)
+{
+	Regions<BufferType const> ready = peek(into.size());
+	size_t const length = ready.size();
+	if (length == 0) {
+		return 0;
+	}
+	std::memcpy(into.data(), ready.first.data(), ready.first.size() * sizeof(BufferType));
+	std::memcpy(into.data() + ready.first.size(), ready.second.data(), ready.second.size() * sizeof(BufferType));
+	consume(length);
+	return length;
+}
+
+template <typename BufferType>
+typename AudioRingBuffer<BufferType>::template Regions<BufferType const> AudioRingBuffer<BufferType>::peek(size_t length) const
+{
+	size_t const read = m_nRead.load(std::memory_order_relaxed);
+	if (m_nCachedWrite - read < length) {
+		m_nCachedWrite = m_nWrite.load(std::memory_order_acquire);
+	}
+	size_t const ready = m_nCachedWrite - read;
+	return regions<BufferType const>(read, length < ready ? length : ready);
+}
+
+template <typename BufferType>
+void AudioRingBuffer<BufferType>::consume(size_t length)
+{
+	size_t const read = m_nRead.load(std::memory_order_relaxed);
+	assert(length <= m_nWrite.load(std::memory_order_relaxed) - read);
+	m_nRead.store(read + length, std::memory_order_release);
+}
+
+template <typename BufferType>
+size_t AudioRingBuffer<BufferType>::readAvailable() const
+{
+	return m_nWrite.load(std::memory_order_acquire) - m_nRead.load(std::memory_order_relaxed);
+}
+
+#pragma endregion
+
+#pragma region AudioRingBuffer<BufferType> - Methods
+
+template <typename BufferType>
+size_t AudioRingBuffer<BufferType>::capacity() const
+{
+	return m_nMask + 1;
+}
+
+template <typename BufferType>
+size_t AudioRingBuffer<BufferType>::capacityFor(size_t length)
+{
+	size_t capacity = 1;
+	while (capacity < length) {
+		capacity <<= 1;
+	}
+	return capacity;
+}
+
+#pragma endregion
+
+#pragma region AudioRingBuffer<BufferType> - Private Methods
+
+template <typename BufferType>
+template <typename T>
+typename AudioRingBuffer<BufferType>::template Regions<T> AudioRingBuffer<BufferType>::regions(size_t position, size_t length) const
+{
+	size_t const index = position & m_nMask;
+	size_t const head = length < capacity() - index ? length : capacity() - index;
+	return Regions<T>{ AudioStreamView<T>(m_pData + index, head), AudioStreamView<T>(m_pData, length - head) };
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_AUDIO_RING_BUFFER_H
@@ -10,14 +10,54 @@
 		AudioStream contains the AudioStream class that defines common methods for working
 		with streams of any type.
 
+		a stream can know that all of its samples hold the same value (silence is the constant 0).
+		the flag is set by a zeroed constructor, by fill and markConstant, by detectConstant,
+		and by assigning an expression that folds to a constant (silence * gain, constant + constant),
+		in which case the value is computed once and nothing is written if the samples already hold it.
+		it is cleared whenever a mutable pointer, reference or view to the samples is handed out.
+		the flag is only trusted while the stream is the only owner of its buffer (a copy_on_write stream
+		always is, its clones detach before they write), so a buffer shared with another stream, or given
+		with ownership::NO_OWNERSHIP, is never taken as constant without scanning it.
+		fill, markConstant and detectConstant invalidate the mutable pointers, references and views handed
+		out before them: a write through one of those is not seen, take a new one or call markVarying.
+
+		a stream with the ownership::copy_on_write policy shares its buffer with its clones.
+		every method that writes the samples, or hands out a mutable pointer, reference or view to them
+		(transform, fill, the compound operators, assigning an expression, operator[], begin, end, view),
+		first copies them into a buffer of its own if the buffer is shared, so a clone that is only read costs nothing.
+		normalizing a rotated stream that shares its buffer copies it too, since the other owners keep their own offset.
+		whether the buffer is shared is read from the reference count without synchronization,
+		so a stream must not be written while one of its clones is destroyed on another thread.
+
+		rotating a stream only moves its logical start. indexing, expressions, clone and segments read
+		a rotated stream through that offset, and only the non-const methods that hand out a contiguous
+		pointer or view (begin, end, view) move the samples back in place, as normalize does.
+		a const stream is never modified, so it has no contiguous view: its begin and end are iterators
+		that wrap around the end of the buffer, and segments returns its samples as two views.
+
 */
 
 
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <optional>
 #include <iostream>
 #include <assert.h>
 
 #include "ownership.h"
+#include "AudioAllocator.h"
+#include "AudioBuffer.h"
+#include "RealTimePool.h"
+#include "ExecutionPolicy.h"
+#include "AudioStreamExpression.h"
+#include "AudioStreamView.h"
+#include "MultiChannelAudioStream.h"
 
 
 #pragma region nyco - AudioStream - Declarations
@@ -25,80 +65,127 @@
 namespace nyco {
 using byte = unsigned char;
 
-// forward declaration of AudioStreamBase
-template <typename T>
+// forward declaration of AudioStreamBase, the ownership policy defaults to a shared buffer
+template <typename T, typename Ownership = ownership::shared>
 class AudioStreamBase;
 
-#pragma region AudioStreamBase<BufferType> friend functions forward declarations
+// forward declaration of ChunkedAudioStream
+template <typename T>
+class ChunkedAudioStream;
 
-// forward declarations for the AudioStream friend operators where AudioStream is the right operand
+#pragma region AudioStreamBase<BufferType, Ownership> friend functions forward declarations
 
-// BufferType + AudioStreamBase<BufferType>
 /*
-* return a copy of b, where all values in it's buffer are shifted up by the value of a.
+* outputs a string representation of the audio stream to s.
 */
-template <typename BufferType>
-AudioStreamBase<BufferType> operator+(BufferType const& a, AudioStreamBase<BufferType> const& b);
+template <typename BufferType, typename Ownership>
+std::ostream& operator<<(std::ostream& s, AudioStreamBase<BufferType, Ownership> const& stream);
 
-// BufferType - AudioStreamBase<BufferType>
-/*
-* return a copy of b, where all values in it's buffer are shifted down by the value of a.
-*/
-template <typename BufferType>
-AudioStreamBase<BufferType> operator-(BufferType const& a, AudioStreamBase<BufferType> const& b);
+#pragma endregion
 
-// BufferType * AudioStreamBase<BufferType>
 /*
-* return a copy of b, where all values in it's buffer are scaled by the value of a.
+* a read-only random access iterator over the samples of a stream in logical order,
+* it wraps around the end of the buffer of a rotated stream
 */
-template <typename BufferType>
-AudioStreamBase<BufferType> operator*(BufferType const& a, AudioStreamBase<BufferType> const& b);
+template <typename T>
+class AudioStreamIterator {
 
-// BufferType / AudioStreamBase<BufferType>
-/*
-* return a copy of b, where all values in it's buffer are scaled inversly by the value of a
-*/
-template <typename BufferType>
-AudioStreamBase<BufferType> operator/(BufferType const& a, AudioStreamBase<BufferType> const& b);
+#pragma region Types
+public:
 
-// BufferType % AudioStreamBase<BufferType>
-/*
-* return a copy of b, where all values in it's buffer are the remainder of a divided by that value
-*/
-template <typename BufferType>
-AudioStreamBase<BufferType> operator%(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	using iterator_concept = std::random_access_iterator_tag;
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = std::remove_const_t<T>;
+	using difference_type = std::ptrdiff_t;
+	using pointer = T*;
+	using reference = T&;
 
-// BufferType ^ AudioStreamBase<BufferType>
-/*
-* return a copy of b, where all values in it's buffer are the result of a XOR with a
-*/
-template <typename BufferType>
-AudioStreamBase<BufferType> operator^(BufferType const& a, AudioStreamBase<BufferType> const& b);
+#pragma endregion
 
-// BufferType & AudioStreamBase<BufferType>
-/*
-* return a copy of b, where all values in it's buffer are the result of a AND with a
-*/
-template <typename BufferType>
-AudioStreamBase<BufferType> operator&(BufferType const& a, AudioStreamBase<BufferType> const& b);
+#pragma region Constructors
+public:
 
-// BufferType | AudioStreamBase<BufferType>
-/*
-* return a copy of b, where all values in it's buffer are the result of a OR with a
-*/
-template <typename BufferType>
-AudioStreamBase<BufferType> operator|(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	/*
+	* constructs an iterator that points nowhere
+	*/
+	AudioStreamIterator() = default;
 
-/*
-* outputs a string representation of the audio stream to s.
-*/
-template <typename BufferType>
-std::ostream& operator<<(std::ostream& s, AudioStreamBase<BufferType> const& stream);
+	/*
+	* constructs an iterator to the logical element index of the length elements at data, which start at offset
+	*/
+	AudioStreamIterator(T* data, size_t length, size_t offset, size_t index);
+
+#pragma endregion
+
+#pragma region Operator Overloading
+public:
+
+	reference operator*() const;
+
+	pointer operator->() const;
+
+	reference operator[](difference_type n) const;
+
+	AudioStreamIterator<T>& operator++();
+
+	AudioStreamIterator<T> operator++(int);
+
+	AudioStreamIterator<T>& operator--();
+
+	AudioStreamIterator<T> operator--(int);
+
+	AudioStreamIterator<T>& operator+=(difference_type n);
+
+	AudioStreamIterator<T>& operator-=(difference_type n);
+
+	AudioStreamIterator<T> operator+(difference_type n) const;
+
+	AudioStreamIterator<T> operator-(difference_type n) const;
+
+	difference_type operator-(AudioStreamIterator<T> const& other) const;
+
+	bool operator==(AudioStreamIterator<T> const& other) const;
+
+	std::strong_ordering operator<=>(AudioStreamIterator<T> const& other) const;
+
+	friend AudioStreamIterator<T> operator+(difference_type n, AudioStreamIterator<T> const& it) { return it + n; }
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	T* m_pData = nullptr;
+
+	size_t m_nLength = 0;
+
+	// the position in the buffer of the first logical element
+	size_t m_nOffset = 0;
+
+	// the logical index this iterator points to
+	size_t m_nIndex = 0;
 
 #pragma endregion
 
-template <typename BufferType>
+};
+
+template <typename BufferType, typename Ownership>
 class AudioStreamBase {
+	static_assert(ownership::is_ownership_policy<Ownership>::value, "Ownership must be ownership::shared, ownership::unique, ownership::borrowed or ownership::copy_on_write");
+
+#pragma region Types
+public:
+
+	// the handle the buffer is kept in, picked by the ownership policy
+	using buffer_type = ownership::buffer_t<Ownership, BufferType>;
+
+	// the type of a new stream made from this one (clone, concat, a shifted copy)
+	using owning_type = AudioStreamBase<BufferType, ownership::owning_t<Ownership>>;
+
+	// the iterator of a const stream, which reads a rotated stream in logical order without normalizing it
+	using const_iterator = AudioStreamIterator<BufferType const>;
+
+#pragma endregion
 
 #pragma region Constructors
 public:
@@ -106,31 +193,81 @@ public:
 	/*
 	* constructs a new AudioStream and taking ownership over data with the specified deleter
 	* a common deleter d = std::default_delete<BufferType[]>()
+	* only a shared stream can hold a buffer with a custom deleter
 	*/
 	template <typename Deleter>
-	explicit AudioStreamBase(BufferType* data, size_t length, ownership::take_ownership, Deleter d);
+	requires (std::is_same_v<Ownership, ownership::shared>)
+		explicit AudioStreamBase(BufferType* data, size_t length, ownership::take_ownership, Deleter d);
 
 	/*
 	* constructs a new AudioStream pointing to data
 	*/
-	explicit AudioStreamBase(BufferType* data, size_t length, ownership::no_ownership);
+	explicit AudioStreamBase(BufferType* data, size_t length, ownership::no_ownership)
+		requires (!std::is_same_v<Ownership, ownership::unique> && !std::is_same_v<Ownership, ownership::copy_on_write>);
 
 	/*
 	* constructs a new AudioStream and copying the buffer from data
 	*/
-	explicit AudioStreamBase(BufferType* data, size_t length, ownership::copy);
+	explicit AudioStreamBase(BufferType* data, size_t length, ownership::copy)
+		requires (ownership::Owning<Ownership>);
+
+	/*
+	* constructs a new AudioStream and copying the buffer from data into a buffer from allocator
+	*/
+	explicit AudioStreamBase(BufferType* data, size_t length, ownership::copy, AudioAllocator& allocator)
+		requires (ownership::Owning<Ownership>);
+
+	/*
+	* constructs a new AudioStream of length zeroed samples in a buffer from allocator
+	*/
+	explicit AudioStreamBase(size_t length, AudioAllocator& allocator = defaultAllocator())
+		requires (ownership::Owning<Ownership>);
 
 	/*
 	* constructs a new AudioStream that points to a shared memory location
 	* this does not take ownership
 	*/
-	explicit AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::no_ownership);
+	explicit AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::no_ownership)
+		requires (std::is_same_v<Ownership, ownership::shared>);
 
 	// Copy Constructor
-	AudioStreamBase(AudioStreamBase<BufferType> const& stream) = delete;
+	AudioStreamBase(AudioStreamBase<BufferType, Ownership> const& stream) = delete;
 
 	// Move Constructor
-	AudioStreamBase(AudioStreamBase<BufferType>&& stream) = default;
+	AudioStreamBase(AudioStreamBase<BufferType, Ownership>&& stream) = default;
+
+	/*
+	* returns the buffer of a unique stream to its allocator, the handle does not keep the length to do it on its own
+	*/
+	~AudioStreamBase()
+		requires (std::is_same_v<Ownership, ownership::unique>);
+
+	~AudioStreamBase() = default;
+
+	/*
+	* constructs a new AudioStream by evaluating the expression into a newly allocated buffer
+	* this is where an expression like a * g + b is computed, in a single pass
+	*/
+	template <typename E>
+	requires (ownership::Owning<Ownership> && expression::Expression<E> && std::is_same_v<expression::value_t<E>, BufferType>)
+		AudioStreamBase(E const& expr);
+
+	/*
+	* constructs a new AudioStream by evaluating a temporary expression
+	* if the expression holds an rvalue stream that is the only owner of its buffer,
+	* the result is evaluated in place into that buffer and nothing is allocated
+	*/
+	template <typename E>
+	requires (ownership::Owning<Ownership> && expression::Expression<E> && !std::is_lvalue_reference_v<E> && std::is_same_v<expression::value_t<E>, BufferType>)
+		AudioStreamBase(E&& expr);
+
+	/*
+	* constructs a new AudioStream by evaluating the expression into a newly allocated buffer
+	* the samples are computed in chunks run by the execution policy
+	*/
+	template <execution::Policy P, typename E>
+	requires (ownership::Owning<Ownership> && expression::Expression<E> && std::is_same_v<expression::value_t<E>, BufferType>)
+		AudioStreamBase(P const& policy, E const& expr);
 
 #pragma endregion
 
@@ -143,59 +280,96 @@ public:
 	*/
 	template <typename Function>
 	requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
-		AudioStreamBase<BufferType>& transform(Function&& func);
+		AudioStreamBase<BufferType, Ownership>& transform(Function&& func);
 
 	/*
 	* does in-place transformation of the stream by the given function and the given stream
 	* applies func over every elements and assigns the result where the element was in the buffer
 	* both AudioStreams must be the same length, or other has a length of 1
 	*/
-	template <typename Function>
+	template <typename Function, typename O>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+		AudioStreamBase<BufferType, Ownership>& transform(Function&& func, AudioStreamBase<BufferType, O> const& other);
+
+	/*
+	* same as transform(func), with the buffer split into chunks run by the execution policy
+	* func may be called from several threads at once
+	*/
+	template <execution::Policy P, typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+		AudioStreamBase<BufferType, Ownership>& transform(P const& policy, Function&& func);
+
+	/*
+	* same as transform(func, other), with the buffers split into chunks run by the execution policy
+	* func may be called from several threads at once
+	*/
+	template <execution::Policy P, typename Function, typename O>
 	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
-		AudioStreamBase<BufferType>& transform(Function&& func, AudioStreamBase<BufferType> const& other);
+		AudioStreamBase<BufferType, Ownership>& transform(P const& policy, Function&& func, AudioStreamBase<BufferType, O> const& other);
+
+	/*
+	* evaluates the expression in-place into this AudioStream, in chunks run by the execution policy
+	* this is the compound assignment with a policy, a *= g is a.assign(execution::PARALLEL, a * g)
+	*/
+	template <execution::Policy P, typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& assign(P const& policy, E const& expr);
 
 	/*
 	* shifts all elements in the stream to the left
+	* this is a rotation followed by zeroing the o vacated elements, so it costs O(o) and not O(length)
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType>& shiftLeft(IntegralT const o);
+		AudioStreamBase<BufferType, Ownership>& shiftLeft(IntegralT const o);
 
 	/*
 	* shifts all elements in the stream to the right
+	* this is a rotation followed by zeroing the o vacated elements, so it costs O(o) and not O(length)
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType>& shiftRight(IntegralT const o);
+		AudioStreamBase<BufferType, Ownership>& shiftRight(IntegralT const o);
 
 	/*
 	* shifts (rotates) all elements in the stream to the left
+	* this only moves the logical start of the stream, no sample is touched
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType>& rotateLeft(IntegralT const o);
+		AudioStreamBase<BufferType, Ownership>& rotateLeft(IntegralT const o);
 
 	/*
 	* shifts (rotates) all elements in the stream to the right
+	* this only moves the logical start of the stream, no sample is touched
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType>& rotateRight(IntegralT const o);
+		AudioStreamBase<BufferType, Ownership>& rotateRight(IntegralT const o);
+
+	/*
+	* moves the samples of a rotated stream in place so the logical start is the first element of the buffer
+	* uses block swaps over the buffer, without allocating. does nothing if the stream is not rotated
+	*/
+	AudioStreamBase<BufferType, Ownership>& normalize();
 
 	/*
 	* makes a copy of the original AudioStream and returns it;
+	* a copy_on_write stream returns a stream sharing its buffer, which is copied by the first write to either of them
 	*/
-	AudioStreamBase<BufferType> clone() const;
+	owning_type clone() const;
 
 	/*
 	* returns a pointer to the first element of this AudioStream
+	* a rotated stream is normalized first, so the pointer walks the samples in order
 	*/
 	BufferType* begin();
 
 	/*
-	* returns a const pointer to the first element of this AudioStream
+	* returns an iterator to the first element of this AudioStream in logical order
+	* a const stream is read as it is and never normalized, the iterator wraps around the end of a rotated buffer
 	*/
-	BufferType const* begin() const;
+	const_iterator begin() const;
 
 	/*
 	* returns a pointer to the last element of this AudioStream
@@ -203,371 +377,386 @@ public:
 	BufferType* end();
 
 	/*
-	* returns a const pointer to the last element of this AudioStream
+	* returns an iterator past the last element of this AudioStream in logical order
 	*/
-	BufferType const* end() const;
+	const_iterator end() const;
 
 	/*
 	* returns the length of this AudioStream
 	*/
-	size_t size();
-
-#pragma endregion
-
-#pragma region Static Methods
-public:
+	size_t size() const;
 
 	/*
-	* creates a new AudioStream from two streams and a function the operates over two elements
-	*
-	* same as copying the a and transforming it with func and b
+	* returns the allocator the buffer of this AudioStream came from,
+	* or the default allocator if the buffer was not allocated by the library
 	*/
-	template <typename Function>
-	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
-		static AudioStreamBase<BufferType> zipWith(AudioStreamBase<BufferType> const& a, AudioStreamBase<BufferType> const& b, Function&& func);
+	AudioAllocator& allocator() const;
 
-#pragma endregion
+	/*
+	* returns true if this AudioStream is the only owner of its buffer,
+	* meaning a temporary stream can be modified in place instead of copied
+	*/
+	bool unique() const;
 
-#pragma region Operator Overloading
+	/*
+	* returns a non-owning view over the samples of this AudioStream
+	*/
+	AudioStreamView<BufferType> view();
 
-#pragma region Binary Operators
+	/*
+	* returns a non-owning view over length samples starting at offset, without copying
+	*/
+	AudioStreamView<BufferType> view(size_t offset, size_t length);
 
-#pragma region AudioStreamBase<BufferType> OP AudioStreamBase<BufferType>
-public:
+	/*
+	* returns the samples in logical order as two read-only views, the second is empty unless the stream is rotated.
+	* this reads a rotated stream without normalizing it, and is how a const stream is read as contiguous samples
+	*/
+	std::array<AudioStreamView<BufferType const>, 2> segments() const;
 
-	// AudioStreamBase<BufferType> + AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise addition
+	* returns the value every sample of this AudioStream is known to hold, or nothing if it is not known
+	* this only reads the flag, use detectConstant to scan the samples
 	*/
-	AudioStreamBase<BufferType> operator+(AudioStreamBase<BufferType> const& o) const;
+	std::optional<BufferType> constantValue() const;
 
-	// AudioStreamBase<BufferType> - AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise subtraction
+	* returns true if every sample of this AudioStream is known to be 0
 	*/
-	AudioStreamBase<BufferType> operator-(AudioStreamBase<BufferType> const& o) const;
+	bool isSilent() const;
 
-	// AudioStreamBase<BufferType> * AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise multiplication
+	* scans the samples and returns the value they all hold, or nothing if they differ
+	* a constant stream is remembered as one, so it is not scanned again while it owns its buffer.
+	* samples are compared by their bits, so 0 and -0 are not the same value here.
+	* a write through a mutable pointer, reference or view taken before this is not seen afterwards
 	*/
-	AudioStreamBase<BufferType> operator*(AudioStreamBase<BufferType> const& o) const;
+	std::optional<BufferType> detectConstant() const;
 
-	// AudioStreamBase<BufferType> / AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise division
+	* assigns value to every sample and remembers the stream as constant
+	* a write through a mutable pointer, reference or view taken before this is not seen afterwards
 	*/
-	AudioStreamBase<BufferType> operator/(AudioStreamBase<BufferType> const& o) const;
+	AudioStreamBase<BufferType, Ownership>& fill(BufferType const& value);
 
-	// AudioStreamBase<BufferType> % AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise modulous
+	* tells the stream that all of its samples hold the same value, without touching them
+	* for a producer that already knows it, like a source that rendered silence through a view.
+	* a write through a mutable pointer, reference or view taken before this is not seen afterwards
 	*/
-	AudioStreamBase<BufferType> operator%(AudioStreamBase<BufferType> const& o) const;
+	AudioStreamBase<BufferType, Ownership>& markConstant();
 
-	// AudioStreamBase<BufferType> ^ AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise XOR
+	* forgets that the stream is constant, after its samples were written through something it does not see
 	*/
-	AudioStreamBase<BufferType> operator^(AudioStreamBase<BufferType> const& o) const;
+	AudioStreamBase<BufferType, Ownership>& markVarying();
+
+#pragma endregion
+
+#pragma region Static Methods
+public:
 
-	// AudioStreamBase<BufferType> & AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise AND
+	* creates a new AudioStream from two streams and a function the operates over two elements
+	*
+	* same as copying the a and transforming it with func and b
+	* the result is a lazy expression, it is computed when assigned into an AudioStream
 	*/
-	AudioStreamBase<BufferType> operator&(AudioStreamBase<BufferType> const& o) const;
+	template <typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+		static expression::ZipExpression<BufferType, Function> zipWith(AudioStreamBase<BufferType, Ownership> const& a, AudioStreamBase<BufferType, Ownership> const& b, Function&& func);
 
-	// AudioStreamBase<BufferType> | AudioStreamBase<BufferType>
 	/*
-	* returns a new AudioStream where all elements are a result of memeber-wise OR
+	* creates a new AudioStream from two streams and a function the operates over two elements
+	* unlike zipWith(a, b, func) the result is computed here, in chunks run by the execution policy
 	*/
-	AudioStreamBase<BufferType> operator|(AudioStreamBase<BufferType> const& o) const;
+	template <execution::Policy P, typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+		static owning_type zipWith(P const& policy, AudioStreamBase<BufferType, Ownership> const& a, AudioStreamBase<BufferType, Ownership> const& b, Function&& func);
+
+#pragma endregion
 
-	// AudioStreamBase<BufferType> >> AudioStreamBase<BufferType>
+#pragma region Operator Overloading
+
+#pragma region Binary Operators
+
+#pragma region AudioStreamBase<BufferType, Ownership> OP AudioStreamBase<BufferType, Ownership>
+public:
+
+	// AudioStreamBase<BufferType, Ownership> >> AudioStreamBase<BufferType, Ownership>
 	/*
 	* concats two AudioStreams. this is inserted before o
 	*/
-	AudioStreamBase<BufferType> operator>>(AudioStreamBase<BufferType> const& o) const;
+	owning_type operator>>(AudioStreamBase<BufferType, Ownership> const& o) const;
 
-	// AudioStreamBase<BufferType> << AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> << AudioStreamBase<BufferType, Ownership>
 	/*
 	* concats two AudioStreams. this is appended to o
 	*/
-	AudioStreamBase<BufferType> operator<<(AudioStreamBase<BufferType> const& o) const;
+	owning_type operator<<(AudioStreamBase<BufferType, Ownership> const& o) const;
 
-	// AudioStreamBase<BufferType> += AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> += AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise addition
 	*/
-	AudioStreamBase<BufferType>& operator+=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator+=(AudioStreamBase<BufferType, O> const& o);
 
-	// AudioStreamBase<BufferType> -= AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> -= AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise subtraction
 	*/
-	AudioStreamBase<BufferType>& operator-=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator-=(AudioStreamBase<BufferType, O> const& o);
 
-	// AudioStreamBase<BufferType> *= AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> *= AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise multiplication
 	*/
-	AudioStreamBase<BufferType>& operator*=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator*=(AudioStreamBase<BufferType, O> const& o);
 
-	// AudioStreamBase<BufferType> /= AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> /= AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise division
 	*/
-	AudioStreamBase<BufferType>& operator/=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator/=(AudioStreamBase<BufferType, O> const& o);
 
-	// AudioStreamBase<BufferType> %= AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> %= AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise modulous
 	*/
-	AudioStreamBase<BufferType>& operator%=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator%=(AudioStreamBase<BufferType, O> const& o);
 
-	// AudioStreamBase<BufferType> ^= AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> ^= AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise XOR
 	*/
-	AudioStreamBase<BufferType>& operator^=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator^=(AudioStreamBase<BufferType, O> const& o);
 
-	// AudioStreamBase<BufferType> &= AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> &= AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise AND
 	*/
-	AudioStreamBase<BufferType>& operator&=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator&=(AudioStreamBase<BufferType, O> const& o);
 
-	// AudioStreamBase<BufferType> |= AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> |= AudioStreamBase<BufferType, Ownership>
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of member-wise OR
 	*/
-	AudioStreamBase<BufferType>& operator|=(AudioStreamBase<BufferType> const& o);
+	template <typename O>
+	AudioStreamBase<BufferType, Ownership>& operator|=(AudioStreamBase<BufferType, O> const& o);
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> OP BufferType
+#pragma region AudioStreamBase<BufferType, Ownership> OP BufferType
 public:
 
-	// AudioStreamBase<BufferType> + BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are shifted up by o
-	*/
-	AudioStreamBase<BufferType> operator+(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> - BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are shifted down by o
-	*/
-	AudioStreamBase<BufferType> operator-(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> * BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are scaled by o
-	*/
-	AudioStreamBase<BufferType> operator*(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> / BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are scaled inversly by o
-	*/
-	AudioStreamBase<BufferType> operator/(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> % BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are the remainder of the division by o
-	*/
-	AudioStreamBase<BufferType> operator%(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> ^ BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are the result of a XOR
-	*/
-	AudioStreamBase<BufferType> operator^(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> & BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are the result of a AND
-	*/
-	AudioStreamBase<BufferType> operator&(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> | BufferType
-	/*
-	* returns transformed version of this AudioStream where all members are the result of a OR
-	*/
-	AudioStreamBase<BufferType> operator|(BufferType const& o) const;
-
-	// AudioStreamBase<BufferType> += BufferType
+	// AudioStreamBase<BufferType, Ownership> += BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are shifted up by o
 	*/
-	AudioStreamBase<BufferType>& operator+=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator+=(BufferType const& o);
 
-	// AudioStreamBase<BufferType> -= BufferType
+	// AudioStreamBase<BufferType, Ownership> -= BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are shifted down by o
 	*/
-	AudioStreamBase<BufferType>& operator-=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator-=(BufferType const& o);
 
-	// AudioStreamBase<BufferType> *= BufferType
+	// AudioStreamBase<BufferType, Ownership> *= BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are scaled by o
 	*/
-	AudioStreamBase<BufferType>& operator*=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator*=(BufferType const& o);
 
-	// AudioStreamBase<BufferType> /= BufferType
+	// AudioStreamBase<BufferType, Ownership> /= BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are scaled inversly by o
 	*/
-	AudioStreamBase<BufferType>& operator/=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator/=(BufferType const& o);
 
-	// AudioStreamBase<BufferType> %= BufferType
+	// AudioStreamBase<BufferType, Ownership> %= BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are the remainder of the division by o
 	*/
-	AudioStreamBase<BufferType>& operator%=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator%=(BufferType const& o);
 
-	// AudioStreamBase<BufferType> ^= BufferType
+	// AudioStreamBase<BufferType, Ownership> ^= BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of a XOR
 	*/
-	AudioStreamBase<BufferType>& operator^=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator^=(BufferType const& o);
 
-	// AudioStreamBase<BufferType> &= BufferType
+	// AudioStreamBase<BufferType, Ownership> &= BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of a AND
 	*/
-	AudioStreamBase<BufferType>& operator&=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator&=(BufferType const& o);
 
-	// AudioStreamBase<BufferType> |= BufferType
+	// AudioStreamBase<BufferType, Ownership> |= BufferType
 	/*
 	* does in-place transformation of this AudioStream where all members are the result of a OR
 	*/
-	AudioStreamBase<BufferType>& operator|=(BufferType const& o);
+	AudioStreamBase<BufferType, Ownership>& operator|=(BufferType const& o);
 
 #pragma endregion
 
-#pragma region BufferType OP AudioStreamBase<BufferType>
-private:
+#pragma region AudioStreamBase<BufferType, Ownership> OP Expression
+public:
 
-	// BufferType + AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> += Expression
 	/*
-	* returns transformed version of this AudioStream where all members are shifted up by o
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise addition
 	*/
-	friend AudioStreamBase<BufferType> operator+(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator+=(E const& o);
 
-	// BufferType - AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> -= Expression
 	/*
-	* returns transformed version of this AudioStream where all members are negated and shifted up by o
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise subtraction
 	*/
-	friend AudioStreamBase<BufferType> operator-(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator-=(E const& o);
 
-	// BufferType * AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> *= Expression
 	/*
-	* returns transformed version of this AudioStream where all members are scaled by o
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise multiplication
 	*/
-	friend AudioStreamBase<BufferType> operator*(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator*=(E const& o);
 
-	// BufferType / AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> /= Expression
 	/*
-	* returns transformed version of this AudioStream where all members are inversed and scaled up by o
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise division
 	*/
-	friend AudioStreamBase<BufferType> operator/(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator/=(E const& o);
 
-	// BufferType % AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> %= Expression
 	/*
-	* returns transformed version of this AudioStream where all members are the result of o mod member
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise modulous
 	*/
-	friend AudioStreamBase<BufferType> operator%(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator%=(E const& o);
 
-	// BufferType ^ AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> ^= Expression
 	/*
-	* returns transformed version of this AudioStream where all members are the result of a XOR
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise XOR
 	*/
-	friend AudioStreamBase<BufferType> operator^(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator^=(E const& o);
 
-	// BufferType & AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> &= Expression
 	/*
-	* returns transformed version of this AudioStream where all members are the result of a AND
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise AND
 	*/
-	friend AudioStreamBase<BufferType> operator&(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator&=(E const& o);
 
-	// BufferType | AudioStreamBase<BufferType>
+	// AudioStreamBase<BufferType, Ownership> |= Expression
 	/*
-	* returns transformed version of this AudioStream where all members are the result of a OR
+	* evaluates the expression and does in-place transformation of this AudioStream where all members are the result of member-wise OR
 	*/
-	friend AudioStreamBase<BufferType> operator|(BufferType const& a, AudioStreamBase<BufferType> const& b);
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator|=(E const& o);
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> shift by integral
+#pragma region AudioStreamBase<BufferType, Ownership> shift by integral
 public:
 
-	// AudioStreamBase<BufferType> << integral
+	// AudioStreamBase<BufferType, Ownership> << integral
 	/*
 	* returns a copy of the AudioStream where all elements in the stream are shifted to the left
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType> operator<<(IntegralT const o) const;
+		owning_type operator<<(IntegralT const o) const&;
 
-	// AudioStreamBase<BufferType> >> integral
+	// AudioStreamBase<BufferType, Ownership>&& << integral
+	/*
+	* shifts a temporary AudioStream to the left in place and returns it, without copying
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		owning_type operator<<(IntegralT const o) &&;
+
+	// AudioStreamBase<BufferType, Ownership> >> integral
 	/*
 	* returns a copy of the AudioStream where all elements in the stream are shifted to the right
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType> operator>>(IntegralT const o) const;
+		owning_type operator>>(IntegralT const o) const&;
+
+	// AudioStreamBase<BufferType, Ownership>&& >> integral
+	/*
+	* shifts a temporary AudioStream to the right in place and returns it, without copying
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		owning_type operator>>(IntegralT const o) &&;
 
-	// AudioStreamBase<BufferType> <<= integral
+	// AudioStreamBase<BufferType, Ownership> <<= integral
 	/*
 	* shifts all elements in the stream to the left
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType>& operator<<=(IntegralT const o);
+		AudioStreamBase<BufferType, Ownership>& operator<<=(IntegralT const o);
 
-	// AudioStreamBase<BufferType> >>= integral
+	// AudioStreamBase<BufferType, Ownership> >>= integral
 	/*
 	* shifts all elements in the stream to the right
 	*/
 	template <typename IntegralT>
 	requires (std::is_integral_v<IntegralT>)
-		AudioStreamBase<BufferType>& operator>>=(IntegralT const o);
+		AudioStreamBase<BufferType, Ownership>& operator>>=(IntegralT const o);
 
 #pragma endregion
 
 	// Deleting the operator= so you can't assign stream by reference
-	AudioStreamBase<BufferType>& operator=(AudioStreamBase<BufferType> const& rhs) = delete;
+	AudioStreamBase<BufferType, Ownership>& operator=(AudioStreamBase<BufferType, Ownership> const& rhs) = delete;
+
+	// AudioStreamBase<BufferType, Ownership> = Expression
+	/*
+	* evaluates the expression in-place into this AudioStream, without allocating
+	* the expression must be the same length as this AudioStream (or broadcast)
+	*/
+	template <typename E>
+	requires (expression::Expression<E>)
+		AudioStreamBase<BufferType, Ownership>& operator=(E const& expr);
 
 #pragma endregion
 
 #pragma region Unary Operators
 public:
 
-	// + AudioStreamBase<BufferType>
+	// + AudioStreamBase<BufferType, Ownership>
 	/*
 	* returns a copy of this AudioStream
 	*/
-	AudioStreamBase<BufferType> operator+() const;
-
-	// - AudioStreamBase<BufferType>
-	/*
-	* returns a negated copy of this AudioStream
-	*/
-	AudioStreamBase<BufferType> operator-() const;
-
-	// ~ AudioStreamBase<BufferType>
-	/*
-	* returns a bitwise-not copy of this AudioStream
-	*/
-	AudioStreamBase<BufferType> operator~() const;
+	owning_type operator+() const;
 
 #pragma endregion
 
 #pragma region Indexing Operators
 public:
 
-	// AudioStreamBase<BufferType>[integral]
+	// AudioStreamBase<BufferType, Ownership>[integral]
 	/*
 	* returns the i-th element in this AudioStream
 	*/
@@ -575,7 +764,7 @@ public:
 	requires (std::is_integral_v<IntegralT>)
 		BufferType& operator[](IntegralT i);
 
-	// AudioStreamBase<BufferType>[integral]
+	// AudioStreamBase<BufferType, Ownership>[integral]
 	/*
 	* returns the i-th element in this AudioStream
 	*/
@@ -583,7 +772,7 @@ public:
 	requires (std::is_integral_v<IntegralT>)
 		BufferType const& operator[](IntegralT i) const;
 
-	// AudioStreamBase<BufferType>[floating_point]
+	// AudioStreamBase<BufferType, Ownership>[floating_point]
 	/*
 	* retuens the lement in the relative position in this AudioStream (where 0 <= x <= 1)
 	* might be removed in the future
@@ -592,7 +781,7 @@ public:
 	requires (std::is_floating_point_v<FloatingT>)
 		BufferType& operator[](FloatingT x);
 
-	// AudioStreamBase<BufferType>[floating_point]
+	// AudioStreamBase<BufferType, Ownership>[floating_point]
 	/*
 	* retuens the lement in the relative position in this AudioStream (where 0 <= x <= 1)
 	* might be removed in the future
@@ -603,47 +792,161 @@ public:
 
 #pragma endregion
 
+#pragma region Conversion Operators
+public:
+
+	// AudioStreamView<BufferType>(AudioStreamBase<BufferType, Ownership>)
+	/*
+	* converts to a non-owning view, so an AudioStream can be passed where a view is expected
+	*/
+	operator AudioStreamView<BufferType>();
+
+	// AudioStreamView<BufferType const>(AudioStreamBase<BufferType, Ownership>)
+	/*
+	* converts to a non-owning read-only view, a rotated stream is normalized first.
+	* a const stream has no contiguous view, read it through segments or begin and end
+	*/
+	operator AudioStreamView<BufferType const>();
+
+#pragma endregion
+
 #pragma region ostream << Overload
 private:
 
-	// ostream& << AudioStreamBase<BufferType>
+	// ostream& << AudioStreamBase<BufferType, Ownership>
 	/*
 	* outputs a string representation of the audio stream to s.
 	*/
-	template <typename BufferType>
-	friend std::ostream& operator<<(std::ostream& s, AudioStreamBase<BufferType> const& stream);
+	friend std::ostream& nyco::operator<< <>(std::ostream& s, AudioStreamBase<BufferType, Ownership> const& stream);
+
+#pragma endregion
 
 #pragma endregion
 
+	// ChunkedAudioStream takes over and allocates buffers as chunks
+	friend class ChunkedAudioStream<BufferType>;
+
+	// a stream makes copies with another ownership policy (a clone of borrowed samples is unique)
+	template <typename, typename>
+	friend class AudioStreamBase;
+
+#pragma region Private Methods
+private:
+
+	/*
+	* returns the stream a temporary expression is evaluated into, either a reusable stream it holds or a new one
+	*/
+	template <typename E>
+	static AudioStreamBase<BufferType, Ownership> acquire(E& expr);
+
+	/*
+	* constructs a new AudioStream owning a buffer returned by allocate, length is the length it was allocated with
+	*/
+	explicit AudioStreamBase(buffer_type buffer, size_t length);
+
+	/*
+	* returns an uninitialized, 64 byte aligned buffer of length samples from allocator.
+	* the buffer of a shared stream has its shared_ptr control block from the same allocator
+	*/
+	static buffer_type allocate(size_t length, AudioAllocator& allocator);
+
+	/*
+	* returns a buffer handle pointing to data, which it does not own
+	*/
+	static buffer_type borrow(BufferType* data);
+
+	/*
+	* gives a copy_on_write stream that shares its buffer a buffer of its own, before its samples are written.
+	* the samples are copied in logical order when keep is true, otherwise the new buffer is left uninitialized
+	* for a write that replaces all of them. does nothing for the other policies
+	*/
+	void detach(bool keep = true);
+
+	/*
+	* evaluates expr into the buffer. an expression that folds to a constant is filled with it instead,
+	* and not written at all if the stream already holds that constant
+	*/
+	template <typename E>
+	void evaluateFrom(E const& expr);
+
+	/*
+	* same as evaluateFrom(expr), in chunks run by the execution policy
+	*/
+	template <execution::Policy P, typename E>
+	void evaluateFrom(P const& policy, E const& expr);
+
+	/*
+	* writes samples [begin, end) of expr into the same logical elements, through the offset of a rotated stream.
+	* the leaves of expr may read this buffer through the same offset, so the samples are never moved first
+	*/
+	template <typename E>
+	void evaluateRange(size_t begin, size_t end, E const& expr);
+
+	/*
+	* normalizes the buffer of a rotated stream, the samples in logical order stay the same
+	*/
+	void linearize();
+
+	/*
+	* returns the position in the buffer of the i-th logical element
+	*/
+	size_t physicalIndex(size_t i) const;
+
+	/*
+	* returns true if no other handle can write the buffer, so the constant flag cannot go stale.
+	* a copy_on_write clone detaches before it writes, so its buffer is as good as owned
+	*/
+	bool ownsSamples() const;
+
+	/*
+	* assigns value to count logical elements starting at the logical element first
+	*/
+	void fill(size_t first, size_t count, BufferType const& value);
+
+	/*
+	* copies the samples in logical order into dst, which must hold m_nLength elements
+	*/
+	void copyTo(BufferType* dst) const;
+
+	/*
+	* rotates the length elements at data to the left by count using the block swap algorithm
+	* every swap walks two blocks front to back, so it stays cache friendly and needs no scratch buffer
+	*/
+	static void rotateBlocks(BufferType* data, size_t length, size_t count);
+
 #pragma endregion
 
 #pragma region Protected Members
 protected:
 
-	std::shared_ptr<BufferType> m_pBuffer;
+	buffer_type m_pBuffer;
 
 	size_t m_nLength;
 
+	// the position in m_pBuffer of the first logical element, rotating the stream only moves this
+	size_t m_nOffset;
+
+	// true when every sample is known to hold the same value. detectConstant sets it from const methods
+	mutable bool m_bConstant;
+
 #pragma endregion
 
 };
 
-template <typename T>
-class AudioStream : public AudioStreamBase<T> {
+template <typename T, typename Ownership = ownership::shared>
+class AudioStream : public AudioStreamBase<T, Ownership> {
 public:
-	using AudioStreamBase<T>::AudioStreamBase;
+	using AudioStreamBase<T, Ownership>::AudioStreamBase;
+	using AudioStreamBase<T, Ownership>::operator=;
 };
-
-template <typename BufferType>
-using MultiChannelAudioStream = AudioStream<AudioStream<BufferType>>;
 }
 
 #pragma endregion
 
 namespace std {
 // overloading this method since AudioStream % AudioStream uses std::fmod internally.
-template <typename BufferType>
-nyco::AudioStream<BufferType> fmod(nyco::AudioStream<BufferType> const& a, nyco::AudioStream<BufferType> const& b) {
+template <typename BufferType, typename Ownership>
+nyco::AudioStream<BufferType, nyco::ownership::owning_t<Ownership>> fmod(nyco::AudioStream<BufferType, Ownership> const& a, nyco::AudioStream<BufferType, Ownership> const& b) {
 	return a % b;
 }
 }
@@ -651,560 +954,514 @@ nyco::AudioStream<BufferType> fmod(nyco::AudioStream<BufferType> const& a, nyco:
 #pragma region nyco - AudioStream - Definitions
 
 namespace nyco {
-#pragma region AudioStreamBase<BufferType>
+#pragma region AudioStreamIterator<T>
 
-#pragma region AudioStreamBase<BufferType> - OPs
+template <typename T>
+AudioStreamIterator<T>::AudioStreamIterator(T* data, size_t length, size_t offset, size_t index)
+	: m_pData{ data }
+	, m_nLength{ length }
+	, m_nOffset{ offset }
+	, m_nIndex{ index }
+{
+}
 
-#pragma region AudioStreamBase<BufferType> - OPs - Indexers
+template <typename T>
+typename AudioStreamIterator<T>::reference AudioStreamIterator<T>::operator*() const
+{
+	size_t const index = m_nOffset + m_nIndex;
+	return m_pData[index < m_nLength ? index : index - m_nLength];
+}
 
-template <typename BufferType>
+template <typename T>
+typename AudioStreamIterator<T>::pointer AudioStreamIterator<T>::operator->() const
+{
+	return &**this;
+}
+
+template <typename T>
+typename AudioStreamIterator<T>::reference AudioStreamIterator<T>::operator[](difference_type n) const
+{
+	return *(*this + n);
+}
+
+template <typename T>
+AudioStreamIterator<T>& AudioStreamIterator<T>::operator++()
+{
+	++m_nIndex;
+	return *this;
+}
+
+template <typename T>
+AudioStreamIterator<T> AudioStreamIterator<T>::operator++(int)
+{
+	AudioStreamIterator<T> previous = *this;
+	++m_nIndex;
+	return previous;
+}
+
+template <typename T>
+AudioStreamIterator<T>& AudioStreamIterator<T>::operator--()
+{
+	--m_nIndex;
+	return *this;
+}
+
+template <typename T>
+AudioStreamIterator<T> AudioStreamIterator<T>::operator--(int)
+{
+	AudioStreamIterator<T> previous = *this;
+	--m_nIndex;
+	return previous;
+}
+
+template <typename T>
+AudioStreamIterator<T>& AudioStreamIterator<T>::operator+=(difference_type n)
+{
+	m_nIndex += n;
+	return *this;
+}
+
+template <typename T>
+AudioStreamIterator<T>& AudioStreamIterator<T>::operator-=(difference_type n)
+{
+	m_nIndex -= n;
+	return *this;
+}
+
+template <typename T>
+AudioStreamIterator<T> AudioStreamIterator<T>::operator+(difference_type n) const
+{
+	AudioStreamIterator<T> it = *this;
+	return it += n;
+}
+
+template <typename T>
+AudioStreamIterator<T> AudioStreamIterator<T>::operator-(difference_type n) const
+{
+	AudioStreamIterator<T> it = *this;
+	return it -= n;
+}
+
+template <typename T>
+typename AudioStreamIterator<T>::difference_type AudioStreamIterator<T>::operator-(AudioStreamIterator<T> const& other) const
+{
+	return static_cast<difference_type>(m_nIndex) - static_cast<difference_type>(other.m_nIndex);
+}
+
+template <typename T>
+bool AudioStreamIterator<T>::operator==(AudioStreamIterator<T> const& other) const
+{
+	return m_nIndex == other.m_nIndex;
+}
+
+template <typename T>
+std::strong_ordering AudioStreamIterator<T>::operator<=>(AudioStreamIterator<T> const& other) const
+{
+	return m_nIndex <=> other.m_nIndex;
+}
+
+#pragma endregion
+
+#pragma region AudioStreamBase<BufferType, Ownership>
+
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs
+
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Indexers
+
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-BufferType& AudioStreamBase<BufferType>::operator[](IntegralT x)
+BufferType& AudioStreamBase<BufferType, Ownership>::operator[](IntegralT x)
 {
+	m_bConstant = false;
+	detach();
 	if (x < 0) {
 		x += m_nLength;
 	}
 	assert(x < m_nLength&& x >= 0);
-	return m_pBuffer.get()[x];
+	return m_pBuffer.get()[physicalIndex(static_cast<size_t>(x))];
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-BufferType const& AudioStreamBase<BufferType>::operator[](IntegralT x) const
+BufferType const& AudioStreamBase<BufferType, Ownership>::operator[](IntegralT x) const
 {
 	if (x < 0) {
 		x += m_nLength;
 	}
 	assert(x < m_nLength&& x >= 0);
-	return m_pBuffer.get()[x];
+	return m_pBuffer.get()[physicalIndex(static_cast<size_t>(x))];
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename FloatingT>
 requires (std::is_floating_point_v<FloatingT>)
-BufferType& AudioStreamBase<BufferType>::operator[](FloatingT x)
+BufferType& AudioStreamBase<BufferType, Ownership>::operator[](FloatingT x)
 {
+	m_bConstant = false;
+	detach();
 	if (x < 0) {
 		x += m_nLength;
 	}
 	assert(x < m_nLength&& x >= 0);
-	return m_pBuffer.get()[x];
+	return m_pBuffer.get()[physicalIndex(static_cast<size_t>(x))];
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename FloatingT>
 requires (std::is_floating_point_v<FloatingT>)
-BufferType const& AudioStreamBase<BufferType>::operator[](FloatingT x) const
+BufferType const& AudioStreamBase<BufferType, Ownership>::operator[](FloatingT x) const
 {
 	if (x < 0) {
 		x += m_nLength;
 	}
 	assert(x < m_nLength&& x >= 0);
-	return m_pBuffer.get()[x];
+	return m_pBuffer.get()[physicalIndex(static_cast<size_t>(x))];
 }
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> - OPs - Unary OPs
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Conversions
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator+() const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::operator AudioStreamView<BufferType>()
 {
-	return this->clone();
-}
-
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator-() const
-{
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([](BufferType x) {
-		return -x;
-		});
-	return stream;
+	return view();
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator~() const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::operator AudioStreamView<BufferType const>()
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([](BufferType x) {
-		return ~x;
-		});
-	return stream;
+	// the samples are only read, so the constant flag stays and only a rotated buffer is touched
+	linearize();
+	return AudioStreamView<BufferType const>(m_pBuffer.get(), m_nLength);
 }
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> - OPs - Binary OPs
-
-#pragma region AudioStreamBase<BufferType> - OPs - Binary OPs - AudioStreamBase<BufferType> OP AudioStreambase<BufferType>
-
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator+(AudioStreamBase<BufferType> const& o) const
-{
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return a + b;
-		});
-}
-
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator-(AudioStreamBase<BufferType> const& o) const
-{
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return a - b;
-		});
-}
-
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator*(AudioStreamBase<BufferType> const& o) const
-{
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return a * b;
-		});
-}
-
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator/(AudioStreamBase<BufferType> const& o) const
-{
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return a / b;
-		});
-}
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Unary OPs
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator%(AudioStreamBase<BufferType> const& o) const
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::operator+() const
 {
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return std::fmod(a, b);
-		});
+	return this->clone();
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator^(AudioStreamBase<BufferType> const& o) const
-{
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return a ^ b;
-		});
-}
+#pragma endregion
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator&(AudioStreamBase<BufferType> const& o) const
-{
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return a & b;
-		});
-}
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Binary OPs
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator|(AudioStreamBase<BufferType> const& o) const
-{
-	return AudioStreamBase<BufferType>::zipWith(*this, o, [](BufferType a, BufferType b) {
-		return a | b;
-		});
-}
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Binary OPs - AudioStreamBase<BufferType, Ownership> OP AudioStreambase<BufferType>
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator>>(AudioStreamBase<BufferType> const& o) const
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::operator>>(AudioStreamBase<BufferType, Ownership> const& o) const
 {
-	BufferType* buffer = new BufferType[m_nLength + o.m_nLength];
-	std::memcpy(buffer, m_pBuffer.get(), m_nLength * sizeof(BufferType));
-	std::memcpy(buffer + m_nLength, o.m_pBuffer.get(), o.m_nLength * sizeof(BufferType));
-	return AudioStreamBase<BufferType>(buffer, m_nLength + o.m_nLength, ownership::TAKE, std::default_delete<BufferType[]>());
+	owning_type stream(owning_type::allocate(m_nLength + o.m_nLength, allocator()), m_nLength + o.m_nLength);
+	copyTo(stream.m_pBuffer.get());
+	o.copyTo(stream.m_pBuffer.get() + m_nLength);
+	std::optional<BufferType> const value = constantValue();
+	stream.m_bConstant = value && value == o.constantValue();
+	return stream;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator<<(AudioStreamBase<BufferType> const& o) const
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::operator<<(AudioStreamBase<BufferType, Ownership> const& o) const
 {
 	return (*this) >> o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator+=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator+=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return a + b;
-		}, o);
-	return *this;
+	return (*this) = (*this) + o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator-=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator-=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return a - b;
-		}, o);
-	return *this;
+	return (*this) = (*this) - o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator*=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator*=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return a * b;
-		}, o);
-	return *this;
+	return (*this) = (*this) * o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator/=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator/=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return a / b;
-		}, o);
-	return *this;
+	return (*this) = (*this) / o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator%=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator%=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return std::fmod(a, b);
-		}, o);
-	return *this;
+	return (*this) = (*this) % o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator^=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator^=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return a ^ b;
-		}, o);
-	return *this;
+	return (*this) = (*this) ^ o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator&=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator&=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return a & b;
-		}, o);
-	return *this;
+	return (*this) = (*this) & o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator|=(AudioStreamBase<BufferType> const& o)
+template <typename BufferType, typename Ownership>
+template <typename O>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator|=(AudioStreamBase<BufferType, O> const& o)
 {
-	transform([](BufferType a, BufferType b) {
-		return a | b;
-		}, o);
-	return *this;
+	return (*this) = (*this) | o;
 }
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> - OPs - Binary OPs - AudioStreamBase<BufferType> OP BufferType
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Binary OPs - AudioStreamBase<BufferType, Ownership> OP BufferType
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator+(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator+=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return in + o;
-		});
-	return stream;
+	return (*this) = (*this) + o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator-(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator-=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return in - o;
-		});
-	return stream;
+	return (*this) = (*this) - o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator*(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator*=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return in * o;
-		});
-	return stream;
+	return (*this) = (*this) * o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator/(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator/=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return in / o;
-		});
-	return stream;
+	return (*this) = (*this) / o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator%(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator%=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return std::fmod(in, o);
-		});
-	return stream;
+	return (*this) = (*this) % o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator^(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator^=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return in ^ o;
-		});
-	return stream;
+	return (*this) = (*this) ^ o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator&(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator&=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return in & o;
-		});
-	return stream;
+	return (*this) = (*this) & o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator|(BufferType const& o) const
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator|=(BufferType const& o)
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream.transform([o](BufferType in) {
-		return in | o;
-		});
-	return stream;
+	return (*this) = (*this) | o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator+=(BufferType const& o)
-{
-	transform([o](BufferType in) {
-		return in + o;
-		});
-	return *this;
-}
+#pragma endregion
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator-=(BufferType const& o)
-{
-	transform([o](BufferType in) {
-		return in - o;
-		});
-	return *this;
-}
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Binary OPs - AudioStreamBase<BufferType, Ownership> OP Expression
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator*=(BufferType const& o)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator+=(E const& o)
 {
-	transform([o](BufferType in) {
-		return in * o;
-		});
-	return *this;
+	return (*this) = (*this) + o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator/=(BufferType const& o)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator-=(E const& o)
 {
-	transform([o](BufferType in) {
-		return in / o;
-		});
-	return *this;
+	return (*this) = (*this) - o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator%=(BufferType const& o)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator*=(E const& o)
 {
-	transform([o](BufferType in) {
-		return std::fmod(in, o);
-		});
-	return *this;
+	return (*this) = (*this) * o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator^=(BufferType const& o)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator/=(E const& o)
 {
-	transform([o](BufferType in) {
-		return in ^ o;
-		});
-	return *this;
+	return (*this) = (*this) / o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator&=(BufferType const& o)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator%=(E const& o)
 {
-	transform([o](BufferType in) {
-		return in & o;
-		});
-	return *this;
+	return (*this) = (*this) % o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator|=(BufferType const& o)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator^=(E const& o)
 {
-	transform([o](BufferType in) {
-		return in | o;
-		});
-	return *this;
+	return (*this) = (*this) ^ o;
 }
 
-#pragma endregion
-
-#pragma region AudioStreamBase<BufferType> - OPs - Binary OPs - BufferType OP AudioStreamBase<BufferType>
-
-template <typename BufferType>
-AudioStreamBase<BufferType> operator+(BufferType const& a, AudioStreamBase<BufferType> const& b)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator&=(E const& o)
 {
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return a + in;
-		});
-	return stream;
+	return (*this) = (*this) & o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> operator-(BufferType const& a, AudioStreamBase<BufferType> const& b)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator|=(E const& o)
 {
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return a - in;
-		});
-	return stream;
+	return (*this) = (*this) | o;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> operator*(BufferType const& a, AudioStreamBase<BufferType> const& b)
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator=(E const& expr)
 {
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return a * in;
-		});
-	return stream;
+	evaluateFrom(expr);
+	return *this;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> operator/(BufferType const& a, AudioStreamBase<BufferType> const& b)
+template <typename BufferType, typename Ownership>
+template <execution::Policy P, typename E>
+requires (expression::Expression<E>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::assign(P const& policy, E const& expr)
 {
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return a / in;
-		});
-	return stream;
+	evaluateFrom(policy, expr);
+	return *this;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> operator%(BufferType const& a, AudioStreamBase<BufferType> const& b)
-{
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return std::fmod(a, in);
-		});
-	return stream;
-}
+#pragma endregion
 
-template <typename BufferType>
-AudioStreamBase<BufferType> operator^(BufferType const& a, AudioStreamBase<BufferType> const& b)
-{
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return a ^ in;
-		});
-	return stream;
-}
+#pragma region AudioStreamBase<BufferType, Ownership> - OPs - Binary OPs - AudioStreamBase<BufferType, Ownership> OP Integral
 
-template <typename BufferType>
-AudioStreamBase<BufferType> operator&(BufferType const& a, AudioStreamBase<BufferType> const& b)
+template <typename BufferType, typename Ownership>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::operator<<(IntegralT const o) const&
 {
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return a & in;
-		});
+	owning_type stream = this->clone();
+	stream <<= o;
 	return stream;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> operator|(BufferType const& a, AudioStreamBase<BufferType> const& b)
+template <typename BufferType, typename Ownership>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::operator<<(IntegralT const o) &&
 {
-	AudioStreamBase<BufferType> stream = b.clone();
-	stream.transform([a](BufferType in) {
-		return a | in;
-		});
-	return stream;
+	if constexpr (ownership::Owning<Ownership>) {
+		if (unique()) {
+			(*this) <<= o;
+			return std::move(*this);
+		}
+	}
+	return static_cast<AudioStreamBase<BufferType, Ownership> const&>(*this) << o;
 }
 
-#pragma endregion
-
-#pragma region AudioStreamBase<BufferType> - OPs - Binary OPs - AudioStreamBase<BufferType> OP Integral
-
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator<<(IntegralT const o) const
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::operator>>(IntegralT const o) const&
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream <<= o;
+	owning_type stream = this->clone();
+	stream >>= o;
 	return stream;
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::operator>>(IntegralT const o) const
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::operator>>(IntegralT const o) &&
 {
-	AudioStreamBase<BufferType> stream = this->clone();
-	stream >>= o;
-	return stream;
+	if constexpr (ownership::Owning<Ownership>) {
+		if (unique()) {
+			(*this) >>= o;
+			return std::move(*this);
+		}
+	}
+	return static_cast<AudioStreamBase<BufferType, Ownership> const&>(*this) >> o;
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator<<=(IntegralT const o)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator<<=(IntegralT const o)
 {
-	IntegralT shift = o;
-	if (shift >= m_nLength) {
-		shift = std::fmod(shift, m_nLength);
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return (*this) >>= -static_cast<long long>(o);
+		}
 	}
-	if (shift == 0) {
+	if (m_nLength == 0 || isSilent()) {
+		// shifting zeros into silence leaves it as it is
 		return *this;
 	}
-	if (shift < 0) {
-		return (*this) >>= shift;
-	}
-	BufferType* ptr = m_pBuffer.get();
-	for (int srcIndex = shift, dstIndex = 0; srcIndex < m_nLength; ++srcIndex, ++dstIndex) {
-		ptr[dstIndex] = ptr[srcIndex];
-	}
-	BufferType defaultValue = BufferType{};
-	for (int i = m_nLength - shift; i < m_nLength; ++i) {
-		ptr[i] = defaultValue;
+	size_t const shift = static_cast<size_t>(o) % m_nLength;
+	if (shift == 0) {
+		return *this;
 	}
+	m_bConstant = false;
+	rotateLeft(shift);
+	fill(m_nLength - shift, shift, BufferType{});
 	return *this;
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator>>=(IntegralT const o)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::operator>>=(IntegralT const o)
 {
-	IntegralT shift = o;
-	if (shift >= m_nLength) {
-		shift = std::fmod(shift, m_nLength);
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return (*this) <<= -static_cast<long long>(o);
+		}
 	}
-	if (shift == 0) {
+	if (m_nLength == 0 || isSilent()) {
+		// shifting zeros into silence leaves it as it is
 		return *this;
 	}
-	if (shift < 0) {
-		return (*this) <<= shift;
-	}
-	BufferType* ptr = m_pBuffer.get();
-	for (int srcIndex = m_nLength - shift - 1, dstIndex = m_nLength - 1; srcIndex >= 0; --srcIndex, --dstIndex) {
-		ptr[dstIndex] = ptr[srcIndex];
-	}
-	BufferType defaultValue = BufferType{};
-	for (int i = 0; i < shift; ++i) {
-		ptr[i] = defaultValue;
+	size_t const shift = static_cast<size_t>(o) % m_nLength;
+	if (shift == 0) {
+		return *this;
 	}
+	m_bConstant = false;
+	rotateRight(shift);
+	fill(0, shift, BufferType{});
 	return *this;
 }
 
@@ -1212,62 +1469,148 @@ AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::operator>>=(IntegralT
 
 #pragma endregion
 
-template <typename BufferType>
-std::ostream& operator<<(std::ostream& s, AudioStreamBase<BufferType> const& stream)
+template <typename BufferType, typename Ownership>
+std::ostream& operator<<(std::ostream& s, AudioStreamBase<BufferType, Ownership> const& stream)
 {
 	return s << "AudioStream(" << stream.m_nLength << " Samples [" << stream.m_nLength * sizeof(BufferType) << " Bytes] @ 0x" << stream.m_pBuffer.get() << ")";
 }
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> - Constructors
+#pragma region AudioStreamBase<BufferType, Ownership> - Constructors
 
-#pragma region AudioStreamBase<BufferType> - Constructors - By Pointer
+#pragma region AudioStreamBase<BufferType, Ownership> - Constructors - By Pointer
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename Deleter>
-AudioStreamBase<BufferType>::AudioStreamBase(BufferType* data, size_t length, ownership::take_ownership, Deleter d)
-	: m_pBuffer{ data, d }
+requires (std::is_same_v<Ownership, ownership::shared>)
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(BufferType* data, size_t length, ownership::take_ownership, Deleter d)
+	: m_pBuffer{ std::shared_ptr<BufferType>(data, d, AllocatorAdapter<BufferType>(defaultAllocator())) }
+	, m_nLength{ length }
+	, m_nOffset{ 0 }
+	, m_bConstant{ false }
+{
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(BufferType* data, size_t length, ownership::no_ownership)
+	requires (!std::is_same_v<Ownership, ownership::unique> && !std::is_same_v<Ownership, ownership::copy_on_write>)
+	: m_pBuffer{ borrow(data) }
 	, m_nLength{ length }
+	, m_nOffset{ 0 }
+	, m_bConstant{ false }
+{
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(BufferType* data, size_t length, ownership::copy)
+	requires (ownership::Owning<Ownership>)
+	: AudioStreamBase(data, length, ownership::COPY, defaultAllocator())
 {
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>::AudioStreamBase(BufferType* data, size_t length, ownership::no_ownership)
-	: m_pBuffer{ data, empty_delete<BufferType>() }
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(BufferType* data, size_t length, ownership::copy, AudioAllocator& allocator)
+	requires (ownership::Owning<Ownership>)
+	: m_pBuffer{ allocate(length, allocator) }
 	, m_nLength{ length }
+	, m_nOffset{ 0 }
+	, m_bConstant{ false }
 {
+	std::memcpy(m_pBuffer.get(), data, m_nLength * sizeof(BufferType));
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType>::AudioStreamBase(BufferType* data, size_t length, ownership::copy)
-	: m_pBuffer{ nullptr }
+#pragma endregion
+
+#pragma region AudioStreamBase<BufferType, Ownership> - Constructors - By Length
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(size_t length, AudioAllocator& allocator)
+	requires (ownership::Owning<Ownership>)
+	: m_pBuffer{ allocate(length, allocator) }
 	, m_nLength{ length }
+	, m_nOffset{ 0 }
+	, m_bConstant{ true }
 {
-	BufferType* newData = new BufferType[m_nLength];
-	std::memcpy(newData, data, m_nLength * sizeof(BufferType));
-	m_pBuffer = std::shared_ptr<BufferType>(newData, std::default_delete<BufferType[]>());
+	std::uninitialized_value_construct_n(m_pBuffer.get(), m_nLength);
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(buffer_type buffer, size_t length)
+	: m_pBuffer{ std::move(buffer) }
+	, m_nLength{ length }
+	, m_nOffset{ 0 }
+	, m_bConstant{ false }
+{
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::~AudioStreamBase()
+	requires (std::is_same_v<Ownership, ownership::unique>)
+{
+	m_pBuffer.deallocate(m_nLength);
 }
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> - Constructors - By Shared Pointer
+#pragma region AudioStreamBase<BufferType, Ownership> - Constructors - By Expression
 
-//template <typename BufferType>
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (ownership::Owning<Ownership> && expression::Expression<E> && std::is_same_v<expression::value_t<E>, BufferType>)
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(E const& expr)
+	: m_pBuffer{ allocate(expr.size(), defaultAllocator()) }
+	, m_nLength{ expr.size() }
+	, m_nOffset{ 0 }
+	, m_bConstant{ false }
+{
+	evaluateFrom(expr);
+}
+
+template <typename BufferType, typename Ownership>
+template <typename E>
+requires (ownership::Owning<Ownership> && expression::Expression<E> && !std::is_lvalue_reference_v<E> && std::is_same_v<expression::value_t<E>, BufferType>)
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(E&& expr)
+	: AudioStreamBase(acquire(expr))
+{
+	// the samples of the reused stream are read before they are overwritten, index by index
+	evaluateFrom(expr);
+}
+
+template <typename BufferType, typename Ownership>
+template <execution::Policy P, typename E>
+requires (ownership::Owning<Ownership> && expression::Expression<E> && std::is_same_v<expression::value_t<E>, BufferType>)
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(P const& policy, E const& expr)
+	: m_pBuffer{ allocate(expr.size(), defaultAllocator()) }
+	, m_nLength{ expr.size() }
+	, m_nOffset{ 0 }
+	, m_bConstant{ false }
+{
+	evaluateFrom(policy, expr);
+}
+
+#pragma endregion
+
+#pragma region AudioStreamBase<BufferType, Ownership> - Constructors - By Shared Pointer
+
+//template <typename BufferType, typename Ownership>
 //template <typename Deleter>
-//AudioStreamBase<BufferType>::AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::take_ownership, Deleter d)
+//AudioStreamBase<BufferType, Ownership>::AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::take_ownership, Deleter d)
 //{
 //}
 
-template <typename BufferType>
-AudioStreamBase<BufferType>::AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::no_ownership)
-	: m_pBuffer{ data }
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>::AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::no_ownership)
+	requires (std::is_same_v<Ownership, ownership::shared>)
+	: m_pBuffer{ std::move(data) }
 	, m_nLength{ length }
+	, m_nOffset{ 0 }
+	, m_bConstant{ false }
 {
 }
 
-//template <typename BufferType>
-//AudioStreamBase<BufferType>::AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::copy)
+//template <typename BufferType, typename Ownership>
+//AudioStreamBase<BufferType, Ownership>::AudioStreamBase(std::shared_ptr<BufferType> data, size_t length, ownership::copy)
 //{
 //}
 
@@ -1275,112 +1618,505 @@ AudioStreamBase<BufferType>::AudioStreamBase(std::shared_ptr<BufferType> data, s
 
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> - Methods
+#pragma region AudioStreamBase<BufferType, Ownership> - Methods
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename Function>
 requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::transform(Function&& func)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::transform(Function&& func)
 {
+	// func may keep state between calls, so a constant stream is not folded through it
+	m_bConstant = false;
+	detach();
+	// every element is transformed on its own, so a rotated stream does not need to be normalized
 	BufferType* ptr = m_pBuffer.get();
-	for (int i = 0; i < m_nLength; ++i) {
+	for (size_t i = 0; i < m_nLength; ++i) {
 		ptr[i] = func(ptr[i]);
 	}
 	return *this;
 }
 
-template <typename BufferType>
-template <typename Function>
+template <typename BufferType, typename Ownership>
+template <typename Function, typename O>
 requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::transform(Function&& func, AudioStreamBase<BufferType> const& other)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::transform(Function&& func, AudioStreamBase<BufferType, O> const& other)
 {
+	m_bConstant = false;
+	detach();
+	linearize();
+	BufferType* ptr = m_pBuffer.get();
 	if (other.m_nLength == 1) {
-		return transform([func](BufferType a) {
-			return func(a, other[0]);
-			});
+		// the broadcast value is hoisted so the loop is a plain pass the compiler can vectorize
+		BufferType const value = other.m_pBuffer.get()[0];
+		for (size_t i = 0; i < m_nLength; ++i) {
+			ptr[i] = func(ptr[i], value);
+		}
+		return *this;
 	}
 	assert(m_nLength == other.m_nLength);
-	BufferType* ptr = m_pBuffer.get();
-	for (int i = 0; i < m_nLength; ++i) {
-		ptr[i] = func(ptr[i], other[i]);
+	// other is const, a rotated one is read through its offset in two passes
+	std::array<AudioStreamView<BufferType const>, 2> const src = other.segments();
+	size_t const split = src[0].size();
+	BufferType const* head = src[0].data();
+	BufferType const* tail = src[1].data();
+	for (size_t i = 0; i < split; ++i) {
+		ptr[i] = func(ptr[i], head[i]);
 	}
+	for (size_t i = split; i < m_nLength; ++i) {
+		ptr[i] = func(ptr[i], tail[i - split]);
+	}
+	return *this;
+}
+
+template <typename BufferType, typename Ownership>
+template <execution::Policy P, typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::transform(P const& policy, Function&& func)
+{
+	m_bConstant = false;
+	detach();
+	BufferType* ptr = m_pBuffer.get();
+	execution::forEachChunk(policy, m_nLength, sizeof(BufferType), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			ptr[i] = func(ptr[i]);
+		}
+	});
 	return *this;
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
+template <execution::Policy P, typename Function, typename O>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::transform(P const& policy, Function&& func, AudioStreamBase<BufferType, O> const& other)
+{
+	m_bConstant = false;
+	detach();
+	linearize();
+	assert(m_nLength == other.m_nLength || other.m_nLength == 1);
+	BufferType* ptr = m_pBuffer.get();
+	// other is const, a rotated one is read through its offset, a chunk reads at most two contiguous parts of it
+	std::array<AudioStreamView<BufferType const>, 2> const src = other.segments();
+	size_t const split = src[0].size();
+	BufferType const* head = src[0].data();
+	BufferType const* tail = src[1].data();
+	bool const broadcast = other.m_nLength == 1;
+	execution::forEachChunk(policy, m_nLength, sizeof(BufferType), [&](size_t begin, size_t end) {
+		if (broadcast) {
+			BufferType const value = head[0];
+			for (size_t i = begin; i < end; ++i) {
+				ptr[i] = func(ptr[i], value);
+			}
+			return;
+		}
+		size_t const middle = std::clamp(split, begin, end);
+		for (size_t i = begin; i < middle; ++i) {
+			ptr[i] = func(ptr[i], head[i]);
+		}
+		for (size_t i = middle; i < end; ++i) {
+			ptr[i] = func(ptr[i], tail[i - split]);
+		}
+	});
+	return *this;
+}
+
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::shiftLeft(IntegralT const o) {
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::shiftLeft(IntegralT const o) {
 	return (*this) <<= o;
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::shiftRight(IntegralT const o) {
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::shiftRight(IntegralT const o) {
 	return (*this) >>= o;
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::rotateLeft(IntegralT const o) {
-	AudioStreamBase<BufferType> copy = this->clone();
-	return ((*this) <<= o) += (copy >>= (m_nLength - o));
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::rotateLeft(IntegralT const o) {
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return rotateRight(-static_cast<long long>(o));
+		}
+	}
+	if (m_nLength != 0) {
+		m_nOffset = (m_nOffset + static_cast<size_t>(o) % m_nLength) % m_nLength;
+	}
+	return *this;
 }
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
 template <typename IntegralT>
 requires (std::is_integral_v<IntegralT>)
-AudioStreamBase<BufferType>& AudioStreamBase<BufferType>::rotateRight(IntegralT const o) {
-	AudioStreamBase<BufferType> copy = this->clone();
-	return ((*this) >>= o) += (copy <<= (m_nLength - o));
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::rotateRight(IntegralT const o) {
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return rotateLeft(-static_cast<long long>(o));
+		}
+	}
+	if (m_nLength != 0) {
+		m_nOffset = (m_nOffset + m_nLength - static_cast<size_t>(o) % m_nLength) % m_nLength;
+	}
+	return *this;
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::normalize()
+{
+	linearize();
+	return *this;
 }
 
-template <typename BufferType>
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::clone() const
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::clone() const
 {
-	return AudioStreamBase<BufferType>(m_pBuffer.get(), m_nLength, ownership::COPY);
+	if constexpr (std::is_same_v<Ownership, ownership::copy_on_write>) {
+		owning_type stream(buffer_type(m_pBuffer), m_nLength);
+		stream.m_nOffset = m_nOffset;
+		stream.m_bConstant = constantValue().has_value();
+		return stream;
+	}
+	else {
+		owning_type stream(owning_type::allocate(m_nLength, allocator()), m_nLength);
+		copyTo(stream.m_pBuffer.get());
+		stream.m_bConstant = constantValue().has_value();
+		return stream;
+	}
 }
 
-template <typename BufferType>
-BufferType* AudioStreamBase<BufferType>::begin() {
+template <typename BufferType, typename Ownership>
+BufferType* AudioStreamBase<BufferType, Ownership>::begin() {
+	m_bConstant = false;
+	detach();
+	linearize();
 	return m_pBuffer.get();
 }
 
-template <typename BufferType>
-BufferType const* AudioStreamBase<BufferType>::begin() const {
-	return m_pBuffer.get();
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::const_iterator AudioStreamBase<BufferType, Ownership>::begin() const {
+	return const_iterator(m_pBuffer.get(), m_nLength, m_nOffset, 0);
 }
 
-template <typename BufferType>
-BufferType* AudioStreamBase<BufferType>::end() {
+template <typename BufferType, typename Ownership>
+BufferType* AudioStreamBase<BufferType, Ownership>::end() {
+	m_bConstant = false;
+	detach();
+	linearize();
 	return m_pBuffer.get() + m_nLength;
 }
 
-template <typename BufferType>
-BufferType const* AudioStreamBase<BufferType>::end() const {
-	return m_pBuffer.get() + m_nLength;
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::const_iterator AudioStreamBase<BufferType, Ownership>::end() const {
+	return const_iterator(m_pBuffer.get(), m_nLength, m_nOffset, m_nLength);
 }
 
-template <typename BufferType>
-size_t AudioStreamBase<BufferType>::size()
+template <typename BufferType, typename Ownership>
+size_t AudioStreamBase<BufferType, Ownership>::size() const
 {
 	return m_nLength;
 }
 
+template <typename BufferType, typename Ownership>
+AudioAllocator& AudioStreamBase<BufferType, Ownership>::allocator() const
+{
+	return m_pBuffer.allocator();
+}
+
+template <typename BufferType, typename Ownership>
+bool AudioStreamBase<BufferType, Ownership>::unique() const
+{
+	return m_pBuffer.unique();
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamView<BufferType> AudioStreamBase<BufferType, Ownership>::view()
+{
+	m_bConstant = false;
+	detach();
+	linearize();
+	return AudioStreamView<BufferType>(m_pBuffer.get(), m_nLength);
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamView<BufferType> AudioStreamBase<BufferType, Ownership>::view(size_t offset, size_t length)
+{
+	return view().slice(offset, length);
+}
+
+template <typename BufferType, typename Ownership>
+std::array<AudioStreamView<BufferType const>, 2> AudioStreamBase<BufferType, Ownership>::segments() const
+{
+	BufferType const* ptr = m_pBuffer.get();
+	return { AudioStreamView<BufferType const>(ptr + m_nOffset, m_nLength - m_nOffset), AudioStreamView<BufferType const>(ptr, m_nOffset) };
+}
+
+template <typename BufferType, typename Ownership>
+std::optional<BufferType> AudioStreamBase<BufferType, Ownership>::constantValue() const
+{
+	if (!m_bConstant || m_nLength == 0 || !m_pBuffer || !ownsSamples()) {
+		return std::nullopt;
+	}
+	// every sample holds the value, so the rotation does not matter
+	return m_pBuffer.get()[0];
+}
+
+template <typename BufferType, typename Ownership>
+bool AudioStreamBase<BufferType, Ownership>::isSilent() const
+{
+	std::optional<BufferType> const value = constantValue();
+	return value && *value == BufferType{};
+}
+
+template <typename BufferType, typename Ownership>
+std::optional<BufferType> AudioStreamBase<BufferType, Ownership>::detectConstant() const
+{
+	if (m_nLength == 0) {
+		return std::nullopt;
+	}
+	if (!m_bConstant || !ownsSamples()) {
+		// every sample equals the one after it exactly when the buffer equals itself shifted by one sample,
+		// and memcmp is the widest compare the platform has for any sample type
+		BufferType const* ptr = m_pBuffer.get();
+		if (std::memcmp(ptr, ptr + 1, (m_nLength - 1) * sizeof(BufferType)) != 0) {
+			return std::nullopt;
+		}
+		m_bConstant = true;
+	}
+	return m_pBuffer.get()[0];
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::fill(BufferType const& value)
+{
+	detach(false);
+	std::fill_n(m_pBuffer.get(), m_nLength, value);
+	m_bConstant = true;
+	return *this;
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::markConstant()
+{
+	m_bConstant = false;
+	assert(detectConstant());
+	m_bConstant = true;
+	return *this;
+}
+
+template <typename BufferType, typename Ownership>
+AudioStreamBase<BufferType, Ownership>& AudioStreamBase<BufferType, Ownership>::markVarying()
+{
+	m_bConstant = false;
+	return *this;
+}
+
 #pragma endregion
 
-#pragma region AudioStreamBase<BufferType> - Static Methods
+#pragma region AudioStreamBase<BufferType, Ownership> - Private Methods
+
+template <typename BufferType, typename Ownership>
+template <typename E>
+AudioStreamBase<BufferType, Ownership> AudioStreamBase<BufferType, Ownership>::acquire(E& expr)
+{
+	size_t const length = expr.size();
+	if (AudioStreamBase<BufferType, Ownership>* stream = expression::reusableStream<AudioStreamBase<BufferType, Ownership>>(expr, length)) {
+		return std::move(*stream);
+	}
+	return AudioStreamBase<BufferType, Ownership>(allocate(length, defaultAllocator()), length);
+}
+
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::buffer_type AudioStreamBase<BufferType, Ownership>::allocate(size_t length, AudioAllocator& allocator)
+{
+	return buffer_type::allocate(length, allocator);
+}
+
+template <typename BufferType, typename Ownership>
+typename AudioStreamBase<BufferType, Ownership>::buffer_type AudioStreamBase<BufferType, Ownership>::borrow(BufferType* data)
+{
+	if constexpr (std::is_same_v<Ownership, ownership::shared>) {
+		// the control block comes from the allocator of the RealTimeScope too, so borrowing is allocation-free in one
+		return buffer_type(std::shared_ptr<BufferType>(data, empty_delete<BufferType>(), AllocatorAdapter<BufferType>(defaultAllocator())));
+	}
+	else {
+		return buffer_type(data);
+	}
+}
+
+template <typename BufferType, typename Ownership>
+void AudioStreamBase<BufferType, Ownership>::detach(bool keep)
+{
+	if constexpr (std::is_same_v<Ownership, ownership::copy_on_write>) {
+		if (!m_pBuffer || m_pBuffer.unique()) {
+			return;
+		}
+		buffer_type buffer = allocate(m_nLength, allocator());
+		if (keep) {
+			copyTo(buffer.get());
+		}
+		m_pBuffer = std::move(buffer);
+		m_nOffset = 0;
+	}
+}
+
+template <typename BufferType, typename Ownership>
+template <typename E>
+void AudioStreamBase<BufferType, Ownership>::evaluateFrom(E const& expr)
+{
+	if (std::optional<BufferType> const value = expression::constantValue(expr)) {
+		if (constantValue() != value) {
+			fill(*value);
+		}
+		return;
+	}
+	assert(expr.size() == m_nLength || expr.size() <= 1);
+	m_bConstant = false;
+	detach(false);
+	evaluateRange(0, m_nLength, expr);
+}
+
+template <typename BufferType, typename Ownership>
+template <execution::Policy P, typename E>
+void AudioStreamBase<BufferType, Ownership>::evaluateFrom(P const& policy, E const& expr)
+{
+	if (std::optional<BufferType> const value = expression::constantValue(expr)) {
+		if (constantValue() != value) {
+			detach(false);
+			BufferType* ptr = m_pBuffer.get();
+			execution::forEachChunk(policy, m_nLength, sizeof(BufferType), [&](size_t begin, size_t end) {
+				std::fill_n(ptr + begin, end - begin, *value);
+			});
+			m_bConstant = true;
+		}
+		return;
+	}
+	assert(expr.size() == m_nLength || expr.size() <= 1);
+	m_bConstant = false;
+	detach(false);
+	execution::forEachChunk(policy, m_nLength, sizeof(BufferType), [&](size_t begin, size_t end) {
+		evaluateRange(begin, end, expr);
+	});
+}
 
-template <typename BufferType>
+template <typename BufferType, typename Ownership>
+template <typename E>
+void AudioStreamBase<BufferType, Ownership>::evaluateRange(size_t begin, size_t end, E const& expr)
+{
+	BufferType* ptr = m_pBuffer.get();
+	size_t const head = m_nLength - m_nOffset;
+	if (begin < head) {
+		size_t const split = std::min(end, head);
+		expression::evaluateRange(ptr + m_nOffset + begin, begin, split, expr);
+		begin = split;
+	}
+	if (begin < end) {
+		expression::evaluateRange(ptr + (begin - head), begin, end, expr);
+	}
+}
+
+template <typename BufferType, typename Ownership>
+void AudioStreamBase<BufferType, Ownership>::linearize()
+{
+	if (m_nOffset == 0) {
+		return;
+	}
+	if constexpr (std::is_same_v<Ownership, ownership::copy_on_write>) {
+		if (!m_pBuffer.unique()) {
+			// the clones read the samples where they are, so this stream moves to a normalized copy
+			detach();
+			return;
+		}
+	}
+	rotateBlocks(m_pBuffer.get(), m_nLength, m_nOffset);
+	m_nOffset = 0;
+}
+
+template <typename BufferType, typename Ownership>
+size_t AudioStreamBase<BufferType, Ownership>::physicalIndex(size_t i) const
+{
+	size_t const index = m_nOffset + i;
+	return index < m_nLength ? index : index - m_nLength;
+}
+
+template <typename BufferType, typename Ownership>
+bool AudioStreamBase<BufferType, Ownership>::ownsSamples() const
+{
+	if constexpr (std::is_same_v<Ownership, ownership::copy_on_write>) {
+		return true;
+	}
+	else {
+		return m_pBuffer.unique();
+	}
+}
+
+template <typename BufferType, typename Ownership>
+void AudioStreamBase<BufferType, Ownership>::fill(size_t first, size_t count, BufferType const& value)
+{
+	assert(first <= m_nLength && count <= m_nLength - first);
+	detach();
+	if (count == 0) {
+		return;
+	}
+	BufferType* ptr = m_pBuffer.get();
+	size_t const start = physicalIndex(first);
+	size_t const head = std::min(count, m_nLength - start);
+	std::fill_n(ptr + start, head, value);
+	std::fill_n(ptr, count - head, value);
+}
+
+template <typename BufferType, typename Ownership>
+void AudioStreamBase<BufferType, Ownership>::copyTo(BufferType* dst) const
+{
+	BufferType const* ptr = m_pBuffer.get();
+	size_t const head = m_nLength - m_nOffset;
+	std::memcpy(dst, ptr + m_nOffset, head * sizeof(BufferType));
+	std::memcpy(dst + head, ptr, m_nOffset * sizeof(BufferType));
+}
+
+template <typename BufferType, typename Ownership>
+void AudioStreamBase<BufferType, Ownership>::rotateBlocks(BufferType* data, size_t length, size_t count)
+{
+	if (count == 0 || count == length) {
+		return;
+	}
+	// left is the size of the block before the split at count, right is the size of the block after it
+	// the shorter block is swapped into its final place and the remaining part of the longer one is rotated
+	size_t left = count;
+	size_t right = length - count;
+	while (left != right) {
+		if (left < right) {
+			std::swap_ranges(data + count - left, data + count, data + count + right - left);
+			right -= left;
+		}
+		else {
+			std::swap_ranges(data + count - left, data + count - left + right, data + count);
+			left -= right;
+		}
+	}
+	std::swap_ranges(data + count - left, data + count, data + count);
+}
+
+#pragma endregion
+
+#pragma region AudioStreamBase<BufferType, Ownership> - Static Methods
+
+template <typename BufferType, typename Ownership>
 template <typename Function>
 requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
-AudioStreamBase<BufferType> AudioStreamBase<BufferType>::zipWith(AudioStreamBase<BufferType> const& a, AudioStreamBase<BufferType> const& b, Function&& func)
+expression::ZipExpression<BufferType, Function> AudioStreamBase<BufferType, Ownership>::zipWith(AudioStreamBase<BufferType, Ownership> const& a, AudioStreamBase<BufferType, Ownership> const& b, Function&& func)
 {
-	AudioStreamBase<BufferType> stream = a.clone();
-	stream.transform(func, b);
-	return stream;
+	return expression::ZipExpression<BufferType, Function>(expression::toNode(a), expression::toNode(b), std::forward<Function>(func));
+}
+
+template <typename BufferType, typename Ownership>
+template <execution::Policy P, typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+typename AudioStreamBase<BufferType, Ownership>::owning_type AudioStreamBase<BufferType, Ownership>::zipWith(P const& policy, AudioStreamBase<BufferType, Ownership> const& a, AudioStreamBase<BufferType, Ownership> const& b, Function&& func)
+{
+	return owning_type(policy, zipWith(a, b, std::forward<Function>(func)));
 }
 
 #pragma endregion
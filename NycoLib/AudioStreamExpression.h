@@ -0,0 +1,1444 @@
+#ifndef NYCOLIB_AUDIO_STREAM_EXPRESSION_H
+#define NYCOLIB_AUDIO_STREAM_EXPRESSION_H
+
+/*
+	Module: AudioStreamExpression (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		AudioStreamExpression contains the lazy expression nodes returned by the AudioStream
+		arithmetic and bitwise operators. nothing is computed when an operator is called,
+		the whole expression is evaluated in a single fused loop once it is assigned into
+		a destination AudioStream (or used to construct a new one).
+		a single operation over streams and scalars (a + b, a * g, a &= mask) is evaluated
+		with the vectorized kernels from SimdKernels.
+
+		an expression only references the lvalue streams it was built from, so it must not
+		outlive them. keep expressions inside the statement that assigns them.
+		an rvalue stream (a temporary, or std::move(a)) is moved into the expression instead,
+		and when its buffer is not shared the result is evaluated in place into that buffer,
+		so a chain like f(a) * g + b allocates nothing.
+
+		a leaf remembers whether its stream is known to be constant (see AudioStreamBase::constantValue),
+		so an expression over silent or constant streams is folded to a single value before it is
+		evaluated, and the destination is filled with that value instead of computed sample by sample.
+
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <assert.h>
+
+#include "operations.h"
+#include "SimdKernels.h"
+#include "ExecutionPolicy.h"
+
+
+#pragma region nyco - AudioStreamExpression - Declarations
+
+namespace nyco {
+
+// forward declaration of AudioStreamBase
+template <typename T, typename Ownership>
+class AudioStreamBase;
+
+// forward declaration of AudioStreamView
+template <typename T>
+class AudioStreamView;
+
+/*
+* base class of every expression node.
+* lives in nyco (and not in nyco::expression) so argument dependent lookup finds the operators
+*/
+struct AudioStreamExpressionBase {};
+
+namespace expression {
+
+#pragma region Concepts
+
+namespace detail {
+template <typename BufferType, typename Ownership>
+std::true_type isStream(AudioStreamBase<BufferType, Ownership> const*);
+
+std::false_type isStream(...);
+
+template <typename BufferType, typename Ownership>
+BufferType streamValue(AudioStreamBase<BufferType, Ownership> const*);
+
+template <typename T>
+struct IsView : std::false_type {};
+
+template <typename T>
+struct IsView<AudioStreamView<T>> : std::true_type {};
+}
+
+/*
+* any lazy expression node
+*/
+template <typename T>
+concept Expression = std::is_base_of_v<AudioStreamExpressionBase, std::remove_cvref_t<T>>;
+
+/*
+* AudioStreamBase or any class deriving from it
+*/
+template <typename T>
+concept Stream = decltype(detail::isStream(std::declval<std::remove_cvref_t<T>*>()))::value;
+
+/*
+* AudioStreamView over mutable or const samples
+*/
+template <typename T>
+concept View = detail::IsView<std::remove_cvref_t<T>>::value;
+
+/*
+* anything that can be a non-scalar operand of an expression
+*/
+template <typename T>
+concept Operand = Expression<T> || Stream<T> || View<T>;
+
+template <typename T>
+struct OperandTraits {};
+
+template <Expression T>
+struct OperandTraits<T> {
+	using value_type = typename std::remove_cvref_t<T>::value_type;
+};
+
+template <Stream T>
+struct OperandTraits<T> {
+	using value_type = decltype(detail::streamValue(std::declval<std::remove_cvref_t<T>*>()));
+};
+
+template <View T>
+struct OperandTraits<T> {
+	using value_type = typename std::remove_cvref_t<T>::value_type;
+};
+
+template <typename T>
+using value_t = typename OperandTraits<T>::value_type;
+
+/*
+* two operands that produce the same sample type
+*/
+template <typename L, typename R>
+concept Compatible = Operand<L> && Operand<R> && std::is_same_v<value_t<L>, value_t<R>>;
+
+/*
+* a value that is broadcast over every sample of the operand T
+*/
+template <typename S, typename T>
+concept ScalarOf = Operand<T> && !Operand<S> && std::is_convertible_v<S const&, value_t<T>>;
+
+#pragma endregion
+
+#pragma region Nodes
+
+/*
+* returns the length of an expression made of two operands of the given lengths.
+* a length of 0 is a scalar and a length of 1 is broadcast, both adapt to the other side
+*/
+size_t combineLengths(size_t a, size_t b);
+
+/*
+* a leaf that reads the samples of an AudioStream
+*/
+template <typename BufferType>
+class Terminal : public AudioStreamExpressionBase {
+public:
+	using value_type = BufferType;
+
+	explicit Terminal(BufferType const* data, size_t length, bool constant = false);
+
+	/*
+	* reads a rotated stream in place, the first split samples from head and the rest from tail
+	*/
+	Terminal(BufferType const* head, size_t split, BufferType const* tail, size_t length, bool constant);
+
+	BufferType operator[](size_t i) const;
+
+	/*
+	* reads sample i from data() alone, for an expression none of whose leaves wrap (see detail::wraps)
+	*/
+	BufferType at(size_t i) const;
+
+	size_t size() const;
+
+	BufferType const* data() const;
+
+	/*
+	* returns the number of samples read from data() before the leaf continues at tail()
+	*/
+	size_t split() const;
+
+	BufferType const* tail() const;
+
+	/*
+	* returns true if every sample of the stream is known to hold the same value
+	*/
+	bool constant() const;
+
+private:
+	BufferType const* m_pData;
+
+	// a rotated stream wraps to the start of its buffer after m_nSplit samples
+	BufferType const* m_pTail;
+
+	size_t m_nSplit;
+
+	size_t m_nLength;
+
+	// 0 when the stream is broadcast (length of 1), 1 otherwise
+	size_t m_nStride;
+
+	bool m_bConstant;
+};
+
+/*
+* a leaf that holds an rvalue AudioStream moved into the expression and reads its samples
+*/
+template <typename S>
+class OwnedTerminal : public AudioStreamExpressionBase {
+public:
+	using value_type = value_t<S>;
+
+	explicit OwnedTerminal(S&& stream);
+
+	value_type operator[](size_t i) const;
+
+	value_type at(size_t i) const;
+
+	size_t size() const;
+
+	value_type const* data() const;
+
+	/*
+	* returns the number of samples read from data() before the leaf continues at tail()
+	*/
+	size_t split() const;
+
+	value_type const* tail() const;
+
+	/*
+	* returns true if every sample of the stream is known to hold the same value
+	*/
+	bool constant() const;
+
+	S& stream();
+
+private:
+	S m_stream;
+
+	// the buffer moves with m_stream, so this stays valid after the stream is handed over
+	value_type const* m_pData;
+
+	// a rotated stream that is not unique is read in place, wrapping to the start of its buffer after m_nSplit samples
+	value_type const* m_pTail;
+
+	size_t m_nSplit;
+
+	size_t m_nLength;
+
+	// 0 when the stream is broadcast (length of 1), 1 otherwise
+	size_t m_nStride;
+
+	// taken when the stream is moved in, since m_stream may be handed over before the expression is folded
+	bool m_bConstant;
+};
+
+/*
+* a leaf that returns the same value for every sample
+*/
+template <typename BufferType>
+class Scalar : public AudioStreamExpressionBase {
+public:
+	using value_type = BufferType;
+
+	explicit Scalar(BufferType value);
+
+	BufferType operator[](size_t) const;
+
+	BufferType at(size_t) const;
+
+	size_t size() const;
+
+	BufferType value() const;
+
+private:
+	BufferType m_value;
+};
+
+/*
+* applies Op over every pair of samples of L and R
+*/
+template <typename Op, typename L, typename R>
+class Binary : public AudioStreamExpressionBase {
+public:
+	using value_type = typename L::value_type;
+
+	explicit Binary(L left, R right, Op op = Op{});
+
+	value_type operator[](size_t i) const;
+
+	value_type at(size_t i) const;
+
+	size_t size() const;
+
+	L const& left() const;
+
+	L& left();
+
+	R const& right() const;
+
+	R& right();
+
+private:
+	L m_left;
+
+	R m_right;
+
+	[[no_unique_address]] Op m_op;
+};
+
+/*
+* applies Op over every sample of E
+*/
+template <typename Op, typename E>
+class Unary : public AudioStreamExpressionBase {
+public:
+	using value_type = typename E::value_type;
+
+	explicit Unary(E operand, Op op = Op{});
+
+	value_type operator[](size_t i) const;
+
+	value_type at(size_t i) const;
+
+	size_t size() const;
+
+	E const& operand() const;
+
+	E& operand();
+
+private:
+	E m_operand;
+
+	[[no_unique_address]] Op m_op;
+};
+
+/*
+* a non-const rvalue stream, which is moved into the expression instead of referenced
+*/
+template <typename T>
+concept OwnedStream = Stream<T> && !std::is_lvalue_reference_v<T> && !std::is_const_v<std::remove_reference_t<T>>;
+
+/*
+* the node an operand is stored as inside an expression
+*/
+template <typename T>
+using node_t = std::conditional_t<Expression<T>, std::remove_cvref_t<T>,
+	std::conditional_t<OwnedStream<T>, OwnedTerminal<std::remove_cvref_t<T>>, Terminal<value_t<T>>>>;
+
+/*
+* the expression returned by AudioStreamBase<BufferType>::zipWith
+*/
+template <typename BufferType, typename Function>
+using ZipExpression = Binary<std::decay_t<Function>, Terminal<BufferType>, Terminal<BufferType>>;
+
+#pragma endregion
+
+#pragma region Helpers
+
+/*
+* returns the expression node of a stream, a view or an expression
+*/
+template <Operand T>
+node_t<T> toNode(T&& operand);
+
+/*
+* builds the node for a OP b, where a and b are operands or scalars of the other side
+*/
+template <typename Op, typename L, typename R>
+auto makeBinary(L&& a, R&& b);
+
+/*
+* returns a stream of type Target held by expr whose buffer can take the result of expr (length samples),
+* or nullptr if expr holds no such stream that is the right length and the only owner of its buffer
+*/
+template <typename Target, typename E>
+Target* reusableStream(E& expr, size_t length);
+
+template <typename Target, typename S>
+Target* reusableStream(OwnedTerminal<S>& expr, size_t length);
+
+template <typename Target, typename Op, typename L, typename R>
+Target* reusableStream(Binary<Op, L, R>& expr, size_t length);
+
+template <typename Target, typename Op, typename E>
+Target* reusableStream(Unary<Op, E>& expr, size_t length);
+
+/*
+* returns the value every sample of expr is known to hold without evaluating it, or nothing if it is not known.
+* only the operations in nyco::operations are folded, a zipWith function may keep state between calls.
+* for integral samples a product (or a bitwise AND) with a constant 0 is 0 whatever the other side holds,
+* which is how silence propagates through gains. a floating-point product is folded only when both sides
+* are constant, since an infinite or NaN sample times 0 is NaN
+*/
+template <typename BufferType>
+std::optional<BufferType> constantValue(Terminal<BufferType> const& expr);
+
+template <typename S>
+std::optional<value_t<S>> constantValue(OwnedTerminal<S> const& expr);
+
+template <typename BufferType>
+std::optional<BufferType> constantValue(Scalar<BufferType> const& expr);
+
+template <typename Op, typename L, typename R>
+std::optional<typename L::value_type> constantValue(Binary<Op, L, R> const& expr);
+
+template <typename Op, typename E>
+std::optional<typename E::value_type> constantValue(Unary<Op, E> const& expr);
+
+/*
+* true when E is a single operation over streams and scalars that has a vectorized kernel
+*/
+template <typename E>
+struct HasKernel : std::false_type {};
+
+template <typename Op, typename L, typename R>
+struct HasKernel<Binary<Op, L, R>>;
+
+/*
+* evaluates samples [begin, end) of a single operation over streams and scalars with the vectorized kernels into dst[0, end - begin)
+*/
+template <typename BufferType, typename Op, typename L, typename R>
+void evaluateKernel(BufferType* dst, size_t begin, size_t end, Binary<Op, L, R> const& expr);
+
+/*
+* writes samples [begin, end) of expr into dst[0, end - begin), dst points at the destination of sample begin
+*/
+template <typename BufferType, Expression E>
+void evaluateRange(BufferType* dst, size_t begin, size_t end, E const& expr);
+
+/*
+* writes every sample of expr into dst, which holds length samples
+*/
+template <typename BufferType, Expression E>
+void evaluate(BufferType* dst, size_t length, E const& expr);
+
+/*
+* writes every sample of expr into dst, which holds length samples, in chunks run by the policy
+*/
+template <execution::Policy P, typename BufferType, Expression E>
+void evaluate(P const& policy, BufferType* dst, size_t length, E const& expr);
+
+#pragma endregion
+
+}
+
+#pragma region Operators
+
+// Operand + Operand
+/*
+* returns an expression where all elements are a result of memeber-wise addition
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator+(L&& a, R&& b);
+
+// Operand - Operand
+/*
+* returns an expression where all elements are a result of memeber-wise subtraction
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator-(L&& a, R&& b);
+
+// Operand * Operand
+/*
+* returns an expression where all elements are a result of memeber-wise multiplication
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator*(L&& a, R&& b);
+
+// Operand / Operand
+/*
+* returns an expression where all elements are a result of memeber-wise division
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator/(L&& a, R&& b);
+
+// Operand % Operand
+/*
+* returns an expression where all elements are a result of memeber-wise modulous
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator%(L&& a, R&& b);
+
+// Operand ^ Operand
+/*
+* returns an expression where all elements are a result of memeber-wise XOR
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator^(L&& a, R&& b);
+
+// Operand & Operand
+/*
+* returns an expression where all elements are a result of memeber-wise AND
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator&(L&& a, R&& b);
+
+// Operand | Operand
+/*
+* returns an expression where all elements are a result of memeber-wise OR
+*/
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator|(L&& a, R&& b);
+
+// Operand + BufferType
+/*
+* returns an expression where all members are shifted up by b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator+(L&& a, S const& b);
+
+// Operand - BufferType
+/*
+* returns an expression where all members are shifted down by b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator-(L&& a, S const& b);
+
+// Operand * BufferType
+/*
+* returns an expression where all members are scaled by b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator*(L&& a, S const& b);
+
+// Operand / BufferType
+/*
+* returns an expression where all members are scaled inversly by b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator/(L&& a, S const& b);
+
+// Operand % BufferType
+/*
+* returns an expression where all members are the remainder of the division by b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator%(L&& a, S const& b);
+
+// Operand ^ BufferType
+/*
+* returns an expression where all members are the result of a XOR with b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator^(L&& a, S const& b);
+
+// Operand & BufferType
+/*
+* returns an expression where all members are the result of a AND with b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator&(L&& a, S const& b);
+
+// Operand | BufferType
+/*
+* returns an expression where all members are the result of a OR with b
+*/
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator|(L&& a, S const& b);
+
+// BufferType + Operand
+/*
+* returns an expression where all members are shifted up by a
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator+(S const& a, R&& b);
+
+// BufferType - Operand
+/*
+* returns an expression where all members are negated and shifted up by a
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator-(S const& a, R&& b);
+
+// BufferType * Operand
+/*
+* returns an expression where all members are scaled by a
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator*(S const& a, R&& b);
+
+// BufferType / Operand
+/*
+* returns an expression where all members are inversed and scaled up by a
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator/(S const& a, R&& b);
+
+// BufferType % Operand
+/*
+* returns an expression where all members are the result of a mod member
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator%(S const& a, R&& b);
+
+// BufferType ^ Operand
+/*
+* returns an expression where all members are the result of a XOR with a
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator^(S const& a, R&& b);
+
+// BufferType & Operand
+/*
+* returns an expression where all members are the result of a AND with a
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator&(S const& a, R&& b);
+
+// BufferType | Operand
+/*
+* returns an expression where all members are the result of a OR with a
+*/
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator|(S const& a, R&& b);
+
+// - Operand
+/*
+* returns an expression where all members are negated
+*/
+template <typename E>
+requires (expression::Operand<E>)
+auto operator-(E&& a);
+
+// ~ Operand
+/*
+* returns an expression where all members are bitwise-not
+*/
+template <typename E>
+requires (expression::Operand<E>)
+auto operator~(E&& a);
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#pragma region nyco - AudioStreamExpression - Definitions
+
+namespace nyco {
+namespace expression {
+
+#pragma region Nodes
+
+inline size_t combineLengths(size_t a, size_t b)
+{
+	if (a <= 1) {
+		return a > b ? a : b;
+	}
+	if (b <= 1) {
+		return a;
+	}
+	assert(a == b);
+	return a;
+}
+
+template <typename BufferType>
+Terminal<BufferType>::Terminal(BufferType const* data, size_t length, bool constant)
+	: Terminal(data, length, data, length, constant)
+{
+}
+
+template <typename BufferType>
+Terminal<BufferType>::Terminal(BufferType const* head, size_t split, BufferType const* tail, size_t length, bool constant)
+	: m_pData{ head }
+	, m_pTail{ tail }
+	, m_nSplit{ split }
+	, m_nLength{ length }
+	, m_nStride{ length == 1 ? 0u : 1u }
+	, m_bConstant{ (constant || length == 1) && length != 0 }
+{
+}
+
+template <typename BufferType>
+BufferType Terminal<BufferType>::operator[](size_t i) const
+{
+	size_t const index = i * m_nStride;
+	return index < m_nSplit ? m_pData[index] : m_pTail[index - m_nSplit];
+}
+
+template <typename BufferType>
+BufferType Terminal<BufferType>::at(size_t i) const
+{
+	return m_pData[i * m_nStride];
+}
+
+template <typename BufferType>
+size_t Terminal<BufferType>::size() const
+{
+	return m_nLength;
+}
+
+template <typename BufferType>
+BufferType const* Terminal<BufferType>::data() const
+{
+	return m_pData;
+}
+
+template <typename BufferType>
+size_t Terminal<BufferType>::split() const
+{
+	return m_nSplit;
+}
+
+template <typename BufferType>
+BufferType const* Terminal<BufferType>::tail() const
+{
+	return m_pTail;
+}
+
+template <typename BufferType>
+bool Terminal<BufferType>::constant() const
+{
+	return m_bConstant;
+}
+
+template <typename S>
+OwnedTerminal<S>::OwnedTerminal(S&& stream)
+	: m_stream{ std::move(stream) }
+	, m_nLength{ m_stream.size() }
+	, m_nStride{ m_nLength == 1 ? 0u : 1u }
+	, m_bConstant{ m_stream.constantValue().has_value() }
+{
+	// no one else reads a unique stream, so it is normalized and may be handed over as the result.
+	// a shared one is read in place through its offset
+	if (m_stream.unique()) {
+		m_stream.normalize();
+	}
+	auto const segments = std::as_const(m_stream).segments();
+	m_pData = segments[0].data();
+	m_nSplit = segments[0].size();
+	m_pTail = segments[1].data();
+}
+
+template <typename S>
+typename OwnedTerminal<S>::value_type OwnedTerminal<S>::operator[](size_t i) const
+{
+	size_t const index = i * m_nStride;
+	return index < m_nSplit ? m_pData[index] : m_pTail[index - m_nSplit];
+}
+
+template <typename S>
+typename OwnedTerminal<S>::value_type OwnedTerminal<S>::at(size_t i) const
+{
+	return m_pData[i * m_nStride];
+}
+
+template <typename S>
+size_t OwnedTerminal<S>::size() const
+{
+	return m_nLength;
+}
+
+template <typename S>
+typename OwnedTerminal<S>::value_type const* OwnedTerminal<S>::data() const
+{
+	return m_pData;
+}
+
+template <typename S>
+size_t OwnedTerminal<S>::split() const
+{
+	return m_nSplit;
+}
+
+template <typename S>
+typename OwnedTerminal<S>::value_type const* OwnedTerminal<S>::tail() const
+{
+	return m_pTail;
+}
+
+template <typename S>
+bool OwnedTerminal<S>::constant() const
+{
+	return m_bConstant;
+}
+
+template <typename S>
+S& OwnedTerminal<S>::stream()
+{
+	return m_stream;
+}
+
+template <typename BufferType>
+Scalar<BufferType>::Scalar(BufferType value)
+	: m_value{ value }
+{
+}
+
+template <typename BufferType>
+BufferType Scalar<BufferType>::operator[](size_t) const
+{
+	return m_value;
+}
+
+template <typename BufferType>
+BufferType Scalar<BufferType>::at(size_t) const
+{
+	return m_value;
+}
+
+template <typename BufferType>
+size_t Scalar<BufferType>::size() const
+{
+	return 0;
+}
+
+template <typename BufferType>
+BufferType Scalar<BufferType>::value() const
+{
+	return m_value;
+}
+
+template <typename Op, typename L, typename R>
+Binary<Op, L, R>::Binary(L left, R right, Op op)
+	: m_left{ std::move(left) }
+	, m_right{ std::move(right) }
+	, m_op{ std::move(op) }
+{
+}
+
+template <typename Op, typename L, typename R>
+typename Binary<Op, L, R>::value_type Binary<Op, L, R>::operator[](size_t i) const
+{
+	return m_op(m_left[i], m_right[i]);
+}
+
+template <typename Op, typename L, typename R>
+typename Binary<Op, L, R>::value_type Binary<Op, L, R>::at(size_t i) const
+{
+	return m_op(m_left.at(i), m_right.at(i));
+}
+
+template <typename Op, typename L, typename R>
+size_t Binary<Op, L, R>::size() const
+{
+	return combineLengths(m_left.size(), m_right.size());
+}
+
+template <typename Op, typename L, typename R>
+L const& Binary<Op, L, R>::left() const
+{
+	return m_left;
+}
+
+template <typename Op, typename L, typename R>
+L& Binary<Op, L, R>::left()
+{
+	return m_left;
+}
+
+template <typename Op, typename L, typename R>
+R const& Binary<Op, L, R>::right() const
+{
+	return m_right;
+}
+
+template <typename Op, typename L, typename R>
+R& Binary<Op, L, R>::right()
+{
+	return m_right;
+}
+
+template <typename Op, typename E>
+Unary<Op, E>::Unary(E operand, Op op)
+	: m_operand{ std::move(operand) }
+	, m_op{ std::move(op) }
+{
+}
+
+template <typename Op, typename E>
+typename Unary<Op, E>::value_type Unary<Op, E>::operator[](size_t i) const
+{
+	return m_op(m_operand[i]);
+}
+
+template <typename Op, typename E>
+typename Unary<Op, E>::value_type Unary<Op, E>::at(size_t i) const
+{
+	return m_op(m_operand.at(i));
+}
+
+template <typename Op, typename E>
+size_t Unary<Op, E>::size() const
+{
+	return m_operand.size();
+}
+
+template <typename Op, typename E>
+E const& Unary<Op, E>::operand() const
+{
+	return m_operand;
+}
+
+template <typename Op, typename E>
+E& Unary<Op, E>::operand()
+{
+	return m_operand;
+}
+
+#pragma endregion
+
+#pragma region Helpers
+
+template <Operand T>
+node_t<T> toNode(T&& operand)
+{
+	if constexpr (Expression<T>) {
+		return std::forward<T>(operand);
+	}
+	else if constexpr (OwnedStream<T>) {
+		return node_t<T>(std::move(operand));
+	}
+	else if constexpr (Stream<T>) {
+		// read through const so a rotated stream is not normalized under its other owners
+		auto const segments = std::as_const(operand).segments();
+		return Terminal<value_t<T>>(segments[0].data(), segments[0].size(), segments[1].data(), operand.size(), operand.constantValue().has_value());
+	}
+	else {
+		return Terminal<value_t<T>>(operand.begin(), operand.end() - operand.begin());
+	}
+}
+
+template <typename Op, typename L, typename R>
+auto makeBinary(L&& a, R&& b)
+{
+	if constexpr (!Operand<L>) {
+		using BufferType = value_t<R>;
+		return Binary<Op, Scalar<BufferType>, node_t<R>>(Scalar<BufferType>(static_cast<BufferType>(a)), toNode(std::forward<R>(b)));
+	}
+	else if constexpr (!Operand<R>) {
+		using BufferType = value_t<L>;
+		return Binary<Op, node_t<L>, Scalar<BufferType>>(toNode(std::forward<L>(a)), Scalar<BufferType>(static_cast<BufferType>(b)));
+	}
+	else {
+		return Binary<Op, node_t<L>, node_t<R>>(toNode(std::forward<L>(a)), toNode(std::forward<R>(b)));
+	}
+}
+
+template <typename Target, typename E>
+Target* reusableStream(E&, size_t)
+{
+	return nullptr;
+}
+
+template <typename Target, typename S>
+Target* reusableStream(OwnedTerminal<S>& expr, size_t length)
+{
+	// only a stream with the same ownership policy can be handed over as the result
+	if constexpr (!std::is_base_of_v<Target, S>) {
+		return nullptr;
+	}
+	else {
+		if (expr.size() != length || !expr.stream().unique()) {
+			return nullptr;
+		}
+		return &expr.stream();
+	}
+}
+
+template <typename Target, typename Op, typename L, typename R>
+Target* reusableStream(Binary<Op, L, R>& expr, size_t length)
+{
+	if (Target* stream = reusableStream<Target>(expr.left(), length)) {
+		return stream;
+	}
+	return reusableStream<Target>(expr.right(), length);
+}
+
+template <typename Target, typename Op, typename E>
+Target* reusableStream(Unary<Op, E>& expr, size_t length)
+{
+	return reusableStream<Target>(expr.operand(), length);
+}
+
+namespace detail {
+template <typename Op>
+struct IsFoldable : std::disjunction<
+	std::is_same<Op, operations::Add>, std::is_same<Op, operations::Subtract>,
+	std::is_same<Op, operations::Multiply>, std::is_same<Op, operations::Divide>,
+	std::is_same<Op, operations::Modulo>, std::is_same<Op, operations::Minimum>,
+	std::is_same<Op, operations::Maximum>, std::is_same<Op, operations::Greater>,
+	std::is_same<Op, operations::BitwiseXor>, std::is_same<Op, operations::BitwiseAnd>,
+	std::is_same<Op, operations::BitwiseOr>, std::is_same<Op, operations::Negate>,
+	std::is_same<Op, operations::BitwiseNot>> {};
+
+// true for the operations where a constant 0 on either side makes the result 0, which holds only for integral T
+template <typename Op, typename T>
+struct IsAnnihilatedByZero : std::conjunction<std::is_integral<T>,
+	std::disjunction<std::is_same<Op, operations::Multiply>, std::is_same<Op, operations::BitwiseAnd>>> {};
+}
+
+template <typename BufferType>
+std::optional<BufferType> constantValue(Terminal<BufferType> const& expr)
+{
+	if (!expr.constant()) {
+		return std::nullopt;
+	}
+	return expr.data()[0];
+}
+
+template <typename S>
+std::optional<value_t<S>> constantValue(OwnedTerminal<S> const& expr)
+{
+	if (!expr.constant()) {
+		return std::nullopt;
+	}
+	return expr.data()[0];
+}
+
+template <typename BufferType>
+std::optional<BufferType> constantValue(Scalar<BufferType> const& expr)
+{
+	return expr.value();
+}
+
+template <typename Op, typename L, typename R>
+std::optional<typename L::value_type> constantValue(Binary<Op, L, R> const& expr)
+{
+	using BufferType = typename L::value_type;
+	if constexpr (!detail::IsFoldable<Op>::value) {
+		return std::nullopt;
+	}
+	else {
+		std::optional<BufferType> const left = constantValue(expr.left());
+		if constexpr (detail::IsAnnihilatedByZero<Op, BufferType>::value) {
+			if (left && *left == BufferType{}) {
+				return BufferType{};
+			}
+		}
+		std::optional<BufferType> const right = constantValue(expr.right());
+		if constexpr (detail::IsAnnihilatedByZero<Op, BufferType>::value) {
+			if (right && *right == BufferType{}) {
+				return BufferType{};
+			}
+		}
+		if (!left || !right) {
+			return std::nullopt;
+		}
+		return Op{}(*left, *right);
+	}
+}
+
+template <typename Op, typename E>
+std::optional<typename E::value_type> constantValue(Unary<Op, E> const& expr)
+{
+	if constexpr (!detail::IsFoldable<Op>::value) {
+		return std::nullopt;
+	}
+	else {
+		std::optional<typename E::value_type> const value = constantValue(expr.operand());
+		if (!value) {
+			return std::nullopt;
+		}
+		return Op{}(*value);
+	}
+}
+
+namespace detail {
+template <typename T>
+struct IsLeaf : std::false_type {};
+
+template <typename BufferType>
+struct IsLeaf<Terminal<BufferType>> : std::true_type {};
+
+template <typename BufferType>
+struct IsLeaf<Scalar<BufferType>> : std::true_type {};
+
+template <typename S>
+struct IsLeaf<OwnedTerminal<S>> : std::true_type {};
+
+/*
+* returns the samples of a leaf from index i on, and shortens count to the part of them that is contiguous
+*/
+template <typename Leaf>
+typename Leaf::value_type const* leafData(Leaf const& leaf, size_t i, size_t& count)
+{
+	if (i < leaf.split()) {
+		count = std::min(count, leaf.split() - i);
+		return leaf.data() + i;
+	}
+	return leaf.tail() + (i - leaf.split());
+}
+
+template <typename BufferType>
+BufferType const* leafData(Scalar<BufferType> const&, size_t, size_t&)
+{
+	return nullptr;
+}
+
+/*
+* returns true if a leaf of the expression reads a rotated stream that wraps to the start of its buffer
+*/
+template <typename BufferType>
+bool wraps(Terminal<BufferType> const& leaf);
+
+template <typename S>
+bool wraps(OwnedTerminal<S> const& leaf);
+
+template <typename BufferType>
+bool wraps(Scalar<BufferType> const&);
+
+template <typename Op, typename L, typename R>
+bool wraps(Binary<Op, L, R> const& expr);
+
+template <typename Op, typename E>
+bool wraps(Unary<Op, E> const& expr);
+
+template <typename BufferType>
+bool wraps(Terminal<BufferType> const& leaf)
+{
+	return leaf.split() < leaf.size();
+}
+
+template <typename S>
+bool wraps(OwnedTerminal<S> const& leaf)
+{
+	return leaf.split() < leaf.size();
+}
+
+template <typename BufferType>
+bool wraps(Scalar<BufferType> const&)
+{
+	return false;
+}
+
+template <typename Op, typename L, typename R>
+bool wraps(Binary<Op, L, R> const& expr)
+{
+	return wraps(expr.left()) || wraps(expr.right());
+}
+
+template <typename Op, typename E>
+bool wraps(Unary<Op, E> const& expr)
+{
+	return wraps(expr.operand());
+}
+}
+
+template <typename Op, typename L, typename R>
+struct HasKernel<Binary<Op, L, R>> : std::bool_constant<
+	detail::IsLeaf<L>::value && detail::IsLeaf<R>::value && simd::hasKernel<Op, typename L::value_type>()> {};
+
+template <typename BufferType, typename Op, typename L, typename R>
+void evaluateKernel(BufferType* dst, size_t begin, size_t end, Binary<Op, L, R> const& expr)
+{
+	// a leaf of length 1 is broadcast, the kernels take it as a value
+	bool const broadcastLeft = expr.left().size() <= 1;
+	bool const broadcastRight = expr.right().size() <= 1;
+	if (broadcastLeft && broadcastRight) {
+		BufferType const value = expr[0];
+		for (size_t i = begin; i < end; ++i) {
+			dst[i - begin] = value;
+		}
+		return;
+	}
+	// a rotated leaf wraps once, so the range is run in at most three parts contiguous in both leaves
+	for (size_t i = begin; i < end;) {
+		size_t length = end - i;
+		if (broadcastLeft) {
+			BufferType const* right = detail::leafData(expr.right(), i, length);
+			simd::applyScalarLeft<Op>(dst + (i - begin), expr.left()[0], right, length);
+		}
+		else if (broadcastRight) {
+			BufferType const* left = detail::leafData(expr.left(), i, length);
+			simd::applyScalarRight<Op>(dst + (i - begin), left, expr.right()[0], length);
+		}
+		else {
+			BufferType const* left = detail::leafData(expr.left(), i, length);
+			BufferType const* right = detail::leafData(expr.right(), i, length);
+			simd::apply<Op>(dst + (i - begin), left, right, length);
+		}
+		i += length;
+	}
+}
+
+template <typename BufferType, Expression E>
+void evaluateRange(BufferType* dst, size_t begin, size_t end, E const& expr)
+{
+	if constexpr (HasKernel<E>::value) {
+		evaluateKernel(dst, begin, end, expr);
+		return;
+	}
+	if (detail::wraps(expr)) {
+		for (size_t i = begin; i < end; ++i) {
+			dst[i - begin] = expr[i];
+		}
+		return;
+	}
+	// no leaf is rotated, so the samples are read without the wrap check and the loop can be vectorized
+	for (size_t i = begin; i < end; ++i) {
+		dst[i - begin] = expr.at(i);
+	}
+}
+
+template <typename BufferType, Expression E>
+void evaluate(BufferType* dst, size_t length, E const& expr)
+{
+	assert(expr.size() == length || expr.size() <= 1);
+	evaluateRange(dst, 0, length, expr);
+}
+
+template <execution::Policy P, typename BufferType, Expression E>
+void evaluate(P const& policy, BufferType* dst, size_t length, E const& expr)
+{
+	assert(expr.size() == length || expr.size() <= 1);
+	execution::forEachChunk(policy, length, sizeof(BufferType), [&](size_t begin, size_t end) {
+		evaluateRange(dst + begin, begin, end, expr);
+	});
+}
+
+#pragma endregion
+
+}
+
+#pragma region Operators
+
+#pragma region Operand OP Operand
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator+(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::Add>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator-(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::Subtract>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator*(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::Multiply>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator/(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::Divide>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator%(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::Modulo>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator^(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::BitwiseXor>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator&(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::BitwiseAnd>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template <typename L, typename R>
+requires (expression::Compatible<L, R>)
+auto operator|(L&& a, R&& b)
+{
+	return expression::makeBinary<operations::BitwiseOr>(std::forward<L>(a), std::forward<R>(b));
+}
+
+#pragma endregion
+
+#pragma region Operand OP BufferType
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator+(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::Add>(std::forward<L>(a), b);
+}
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator-(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::Subtract>(std::forward<L>(a), b);
+}
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator*(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::Multiply>(std::forward<L>(a), b);
+}
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator/(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::Divide>(std::forward<L>(a), b);
+}
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator%(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::Modulo>(std::forward<L>(a), b);
+}
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator^(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::BitwiseXor>(std::forward<L>(a), b);
+}
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator&(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::BitwiseAnd>(std::forward<L>(a), b);
+}
+
+template <typename L, typename S>
+requires (expression::ScalarOf<S, L>)
+auto operator|(L&& a, S const& b)
+{
+	return expression::makeBinary<operations::BitwiseOr>(std::forward<L>(a), b);
+}
+
+#pragma endregion
+
+#pragma region BufferType OP Operand
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator+(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::Add>(a, std::forward<R>(b));
+}
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator-(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::Subtract>(a, std::forward<R>(b));
+}
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator*(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::Multiply>(a, std::forward<R>(b));
+}
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator/(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::Divide>(a, std::forward<R>(b));
+}
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator%(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::Modulo>(a, std::forward<R>(b));
+}
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator^(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::BitwiseXor>(a, std::forward<R>(b));
+}
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator&(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::BitwiseAnd>(a, std::forward<R>(b));
+}
+
+template <typename S, typename R>
+requires (expression::ScalarOf<S, R>)
+auto operator|(S const& a, R&& b)
+{
+	return expression::makeBinary<operations::BitwiseOr>(a, std::forward<R>(b));
+}
+
+#pragma endregion
+
+#pragma region Unary
+
+template <typename E>
+requires (expression::Operand<E>)
+auto operator-(E&& a)
+{
+	return expression::Unary<operations::Negate, expression::node_t<E>>(expression::toNode(std::forward<E>(a)));
+}
+
+template <typename E>
+requires (expression::Operand<E>)
+auto operator~(E&& a)
+{
+	return expression::Unary<operations::BitwiseNot, expression::node_t<E>>(expression::toNode(std::forward<E>(a)));
+}
+
+#pragma endregion
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_AUDIO_STREAM_EXPRESSION_H
@@ -0,0 +1,403 @@
+#ifndef NYCOLIB_AUDIO_STREAM_VIEW_H
+#define NYCOLIB_AUDIO_STREAM_VIEW_H
+
+/*
+	Module: AudioStreamView (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		AudioStreamView contains the AudioStreamView class, a non-owning pointer + length
+		over samples that live somewhere else (a host buffer, an AudioStream, a slice of one).
+		a view never allocates and never touches a reference count, so it is safe to create
+		on the real-time thread every block.
+
+		a view supports the same operators as AudioStream. copying a view copies the
+		pointer, assigning an expression to a view writes into the samples it points to.
+
+*/
+
+
+#include <cstddef>
+#include <type_traits>
+#include <assert.h>
+
+#include "AudioStreamExpression.h"
+
+
+#pragma region nyco - AudioStreamView - Declarations
+
+namespace nyco {
+
+template <typename T>
+class AudioStreamView {
+
+#pragma region Types
+public:
+
+	using value_type = std::remove_const_t<T>;
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs an empty view
+	*/
+	AudioStreamView() = default;
+
+	/*
+	* constructs a view over length samples starting at data
+	*/
+	AudioStreamView(T* data, size_t length);
+
+	/*
+	* constructs a read-only view from a mutable one
+	*/
+	template <typename U>
+	requires (std::is_convertible_v<U(*)[], T(*)[]> && !std::is_same_v<U, T>)
+		AudioStreamView(AudioStreamView<U> const& other);
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* does in-place transformation of the viewed samples by the given function
+	*/
+	template <typename Function>
+	requires (!std::is_const_v<T> && std::is_same_v<std::invoke_result_t<Function, std::remove_const_t<T>>, std::remove_const_t<T>>)
+		AudioStreamView<T> const& transform(Function&& func) const;
+
+	/*
+	* does in-place transformation of the viewed samples by the given function and the given view
+	* both views must be the same length, or other has a length of 1
+	*/
+	template <typename Function>
+	requires (!std::is_const_v<T> && std::is_same_v<std::invoke_result_t<Function, std::remove_const_t<T>, std::remove_const_t<T>>, std::remove_const_t<T>>)
+		AudioStreamView<T> const& transform(Function&& func, AudioStreamView<value_type const> other) const;
+
+	/*
+	* returns a view of length samples starting at offset, without copying
+	*/
+	AudioStreamView<T> slice(size_t offset, size_t length) const;
+
+	/*
+	* returns a pointer to the first element of this view
+	*/
+	T* begin() const;
+
+	/*
+	* returns a pointer past the last element of this view
+	*/
+	T* end() const;
+
+	/*
+	* returns a pointer to the first element of this view
+	*/
+	T* data() const;
+
+	/*
+	* returns the length of this view
+	*/
+	size_t size() const;
+
+	/*
+	* returns true if this view has no samples
+	*/
+	bool empty() const;
+
+#pragma endregion
+
+#pragma region Operator Overloading
+public:
+
+	// AudioStreamView<T> = Expression
+	/*
+	* evaluates the expression into the viewed samples
+	*/
+	template <typename E>
+	requires (!std::is_const_v<T> && expression::Expression<E>)
+		AudioStreamView<T> const& operator=(E const& expr) const;
+
+	// AudioStreamView<T> += Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise addition
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator+=(O const& o) const;
+
+	// AudioStreamView<T> -= Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise subtraction
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator-=(O const& o) const;
+
+	// AudioStreamView<T> *= Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise multiplication
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator*=(O const& o) const;
+
+	// AudioStreamView<T> /= Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise division
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator/=(O const& o) const;
+
+	// AudioStreamView<T> %= Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise modulous
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator%=(O const& o) const;
+
+	// AudioStreamView<T> ^= Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise XOR
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator^=(O const& o) const;
+
+	// AudioStreamView<T> &= Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise AND
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator&=(O const& o) const;
+
+	// AudioStreamView<T> |= Operand
+	/*
+	* does in-place transformation of the viewed samples where all members are the result of member-wise OR
+	*/
+	template <typename O>
+	requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+		AudioStreamView<T> const& operator|=(O const& o) const;
+
+	// AudioStreamView<T>[integral]
+	/*
+	* returns the i-th element in this view, negative indices count from the end
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		T& operator[](IntegralT i) const;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	T* m_pData = nullptr;
+
+	size_t m_nLength = 0;
+
+#pragma endregion
+
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - AudioStreamView - Definitions
+
+namespace nyco {
+
+#pragma region AudioStreamView<T> - Constructors
+
+template <typename T>
+AudioStreamView<T>::AudioStreamView(T* data, size_t length)
+	: m_pData{ data }
+	, m_nLength{ length }
+{
+}
+
+template <typename T>
+template <typename U>
+requires (std::is_convertible_v<U(*)[], T(*)[]> && !std::is_same_v<U, T>)
+AudioStreamView<T>::AudioStreamView(AudioStreamView<U> const& other)
+	: m_pData{ other.data() }
+	, m_nLength{ other.size() }
+{
+}
+
+#pragma endregion
+
+#pragma region AudioStreamView<T> - Methods
+
+template <typename T>
+template <typename Function>
+requires (!std::is_const_v<T> && std::is_same_v<std::invoke_result_t<Function, std::remove_const_t<T>>, std::remove_const_t<T>>)
+AudioStreamView<T> const& AudioStreamView<T>::transform(Function&& func) const
+{
+	for (size_t i = 0; i < m_nLength; ++i) {
+		m_pData[i] = func(m_pData[i]);
+	}
+	return *this;
+}
+
+template <typename T>
+template <typename Function>
+requires (!std::is_const_v<T> && std::is_same_v<std::invoke_result_t<Function, std::remove_const_t<T>, std::remove_const_t<T>>, std::remove_const_t<T>>)
+AudioStreamView<T> const& AudioStreamView<T>::transform(Function&& func, AudioStreamView<value_type const> other) const
+{
+	if (other.size() == 1) {
+		value_type const value = other.data()[0];
+		for (size_t i = 0; i < m_nLength; ++i) {
+			m_pData[i] = func(m_pData[i], value);
+		}
+		return *this;
+	}
+	assert(m_nLength == other.size());
+	value_type const* src = other.data();
+	for (size_t i = 0; i < m_nLength; ++i) {
+		m_pData[i] = func(m_pData[i], src[i]);
+	}
+	return *this;
+}
+
+template <typename T>
+AudioStreamView<T> AudioStreamView<T>::slice(size_t offset, size_t length) const
+{
+	assert(offset <= m_nLength && length <= m_nLength - offset);
+	return AudioStreamView<T>(m_pData + offset, length);
+}
+
+template <typename T>
+T* AudioStreamView<T>::begin() const
+{
+	return m_pData;
+}
+
+template <typename T>
+T* AudioStreamView<T>::end() const
+{
+	return m_pData + m_nLength;
+}
+
+template <typename T>
+T* AudioStreamView<T>::data() const
+{
+	return m_pData;
+}
+
+template <typename T>
+size_t AudioStreamView<T>::size() const
+{
+	return m_nLength;
+}
+
+template <typename T>
+bool AudioStreamView<T>::empty() const
+{
+	return m_nLength == 0;
+}
+
+#pragma endregion
+
+#pragma region AudioStreamView<T> - OPs
+
+template <typename T>
+template <typename E>
+requires (!std::is_const_v<T> && expression::Expression<E>)
+AudioStreamView<T> const& AudioStreamView<T>::operator=(E const& expr) const
+{
+	expression::evaluate(m_pData, m_nLength, expr);
+	return *this;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator+=(O const& o) const
+{
+	return (*this) = (*this) + o;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator-=(O const& o) const
+{
+	return (*this) = (*this) - o;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator*=(O const& o) const
+{
+	return (*this) = (*this) * o;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator/=(O const& o) const
+{
+	return (*this) = (*this) / o;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator%=(O const& o) const
+{
+	return (*this) = (*this) % o;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator^=(O const& o) const
+{
+	return (*this) = (*this) ^ o;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator&=(O const& o) const
+{
+	return (*this) = (*this) & o;
+}
+
+template <typename T>
+template <typename O>
+requires (!std::is_const_v<T> && (expression::Operand<O> || expression::ScalarOf<O, AudioStreamView<T>>))
+AudioStreamView<T> const& AudioStreamView<T>::operator|=(O const& o) const
+{
+	return (*this) = (*this) | o;
+}
+
+template <typename T>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+T& AudioStreamView<T>::operator[](IntegralT x) const
+{
+	if (x < 0) {
+		x += m_nLength;
+	}
+	assert(x < m_nLength && x >= 0);
+	return m_pData[x];
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_AUDIO_STREAM_VIEW_H
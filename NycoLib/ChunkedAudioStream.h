@@ -0,0 +1,635 @@
+#ifndef NYCOLIB_CHUNKED_AUDIO_STREAM_H
+#define NYCOLIB_CHUNKED_AUDIO_STREAM_H
+
+/*
+	Module: ChunkedAudioStream (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		ChunkedAudioStream contains the ChunkedAudioStream class, an append-optimized stream
+		made of chunks. every chunk is a reference counted buffer, shared between every
+		ChunkedAudioStream (and slice) that contains it.
+
+		the chunks are the leaves of a rope, a balanced (AVL) binary tree whose nodes hold the
+		number of samples and chunks under them. the nodes are never changed once they are shared,
+		so streams share whole subtrees: clone is O(1), and appending a block, concatenating two
+		streams (>>, <<, >>=) and slicing are O(log n) in the number of chunks. neither copies
+		samples, so assembling a long render out of thousands of blocks is linear in the number
+		of blocks and not quadratic in the number of samples. indexing and chunk(i) descend the
+		tree in O(log n).
+
+		transform and forEachChunk run over every chunk as a contiguous block. a chunk (or a node)
+		that is shared is copied before it is transformed, so streams that share it are not changed.
+		flatten copies everything into one contiguous AudioStream, only when it is needed.
+
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <assert.h>
+
+#include "AudioStream.h"
+#include "AudioStreamView.h"
+
+
+#pragma region nyco - ChunkedAudioStream - Declarations
+
+namespace nyco {
+
+template <typename BufferType>
+class ChunkedAudioStream {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new empty ChunkedAudioStream
+	*/
+	ChunkedAudioStream();
+
+	/*
+	* constructs a new ChunkedAudioStream of a single chunk, taking the buffer of stream
+	*/
+	explicit ChunkedAudioStream(AudioStreamBase<BufferType>&& stream);
+
+	/*
+	* constructs a new ChunkedAudioStream of a single chunk, copying samples
+	*/
+	explicit ChunkedAudioStream(AudioStreamView<BufferType const> samples, AudioAllocator& allocator = defaultAllocator());
+
+	// Copy Constructor
+	ChunkedAudioStream(ChunkedAudioStream<BufferType> const& stream) = delete;
+
+	// Move Constructor
+	ChunkedAudioStream(ChunkedAudioStream<BufferType>&& stream) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* appends the samples of stream as a new chunk in O(log n). the buffer is taken over if stream is its only owner
+	*/
+	ChunkedAudioStream<BufferType>& append(AudioStreamBase<BufferType>&& stream);
+
+	/*
+	* appends a copy of samples as a new chunk
+	*/
+	ChunkedAudioStream<BufferType>& append(AudioStreamView<BufferType const> samples, AudioAllocator& allocator = defaultAllocator());
+
+	/*
+	* appends the chunks of other in O(log n), sharing them without copying samples
+	*/
+	ChunkedAudioStream<BufferType>& append(ChunkedAudioStream<BufferType> const& other);
+
+	/*
+	* does in-place transformation of the stream by the given function, one chunk at a time
+	* a chunk that is shared with another stream is copied first
+	*/
+	template <typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+		ChunkedAudioStream<BufferType>& transform(Function&& func);
+
+	/*
+	* calls func with a read-only view over every chunk, in order
+	*/
+	template <typename Function>
+	requires (std::is_invocable_v<Function, AudioStreamView<BufferType const>>)
+		void forEachChunk(Function&& func) const;
+
+	/*
+	* returns a ChunkedAudioStream of length samples starting at offset in O(log n), sharing the chunks
+	*/
+	ChunkedAudioStream<BufferType> slice(size_t offset, size_t length) const;
+
+	/*
+	* returns a ChunkedAudioStream that shares every chunk of this one, in O(1)
+	*/
+	ChunkedAudioStream<BufferType> clone() const;
+
+	/*
+	* copies every chunk, in order, into a new contiguous AudioStream
+	*/
+	AudioStreamBase<BufferType> flatten(AudioAllocator& allocator = defaultAllocator()) const;
+
+	/*
+	* returns a read-only view over the i-th chunk, in O(log n)
+	*/
+	AudioStreamView<BufferType const> chunk(size_t i) const;
+
+	/*
+	* returns the number of chunks
+	*/
+	size_t chunkCount() const;
+
+	/*
+	* returns the number of samples in all the chunks
+	*/
+	size_t size() const;
+
+	/*
+	* returns true if this stream has no samples
+	*/
+	bool empty() const;
+
+#pragma endregion
+
+#pragma region Operator Overloading
+public:
+
+	// ChunkedAudioStream<BufferType> >> ChunkedAudioStream<BufferType>
+	/*
+	* concats two streams in O(log n), this is inserted before o. no samples are copied
+	*/
+	ChunkedAudioStream<BufferType> operator>>(ChunkedAudioStream<BufferType> const& o) const;
+
+	// ChunkedAudioStream<BufferType> << ChunkedAudioStream<BufferType>
+	/*
+	* concats two streams in O(log n), this is inserted before o. no samples are copied
+	*/
+	ChunkedAudioStream<BufferType> operator<<(ChunkedAudioStream<BufferType> const& o) const;
+
+	// ChunkedAudioStream<BufferType> >>= ChunkedAudioStream<BufferType>
+	/*
+	* appends the chunks of o to this stream
+	*/
+	ChunkedAudioStream<BufferType>& operator>>=(ChunkedAudioStream<BufferType> const& o);
+
+	// ChunkedAudioStream<BufferType> >>= AudioStreamBase<BufferType>&&
+	/*
+	* appends stream to this stream as a new chunk
+	*/
+	ChunkedAudioStream<BufferType>& operator>>=(AudioStreamBase<BufferType>&& stream);
+
+	// ChunkedAudioStream<BufferType>[integral]
+	/*
+	* returns the i-th element in this stream in O(log n), negative indices count from the end
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		BufferType const& operator[](IntegralT i) const;
+
+	// Deleting the operator= so you can't assign stream by reference
+	ChunkedAudioStream<BufferType>& operator=(ChunkedAudioStream<BufferType> const& rhs) = delete;
+
+	// Move Assignment
+	ChunkedAudioStream<BufferType>& operator=(ChunkedAudioStream<BufferType>&& rhs) = default;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	struct Chunk {
+		// points to the first sample of the chunk and shares the ownership of the whole buffer
+		std::shared_ptr<BufferType> data;
+
+		size_t length;
+	};
+
+	/*
+	* a node of the rope, a leaf holds one chunk and an inner node its two children.
+	* a node is only changed in place by transform, and only while nothing else shares it
+	*/
+	struct Node {
+		Chunk chunk;
+
+		std::shared_ptr<Node> left;
+
+		std::shared_ptr<Node> right;
+
+		// the samples and the chunks under this node
+		size_t length;
+		size_t chunks;
+
+		// 1 for a leaf
+		int height;
+	};
+
+	using NodePtr = std::shared_ptr<Node>;
+
+	/*
+	* constructs a stream over the rope under root
+	*/
+	explicit ChunkedAudioStream(NodePtr root);
+
+	/*
+	* adds a chunk at the end
+	*/
+	void push(Chunk chunk);
+
+	/*
+	* returns a leaf holding chunk, its node comes from the default allocator like the chunks
+	*/
+	static NodePtr leaf(Chunk chunk);
+
+	/*
+	* returns an inner node over left and right, which differ in height by at most one
+	*/
+	static NodePtr node(NodePtr left, NodePtr right);
+
+	/*
+	* returns an inner node over left and right, which differ in height by at most two, rotated back into balance
+	*/
+	static NodePtr balance(NodePtr left, NodePtr right);
+
+	/*
+	* returns the rope of the chunks of left followed by those of right, in O(|height(left) - height(right)| + 1)
+	*/
+	static NodePtr join(NodePtr const& left, NodePtr const& right);
+
+	/*
+	* returns the ropes of the first position samples of root and of the rest, in O(log n)
+	*/
+	static std::pair<NodePtr, NodePtr> split(NodePtr const& root, size_t position);
+
+	/*
+	* transforms every chunk under root, copying the nodes and chunks it shares with other streams first
+	*/
+	template <typename Function>
+	static void transform(NodePtr& root, Function& func);
+
+	/*
+	* calls func with every chunk under root, in order
+	*/
+	template <typename Function>
+	static void forEachChunk(Node const* root, Function& func);
+
+	static size_t lengthOf(NodePtr const& root);
+
+	static size_t chunksOf(NodePtr const& root);
+
+	NodePtr m_pRoot;
+
+#pragma endregion
+
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - ChunkedAudioStream - Definitions
+
+namespace nyco {
+
+#pragma region ChunkedAudioStream<BufferType> - Constructors
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>::ChunkedAudioStream()
+	: m_pRoot{}
+{
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>::ChunkedAudioStream(NodePtr root)
+	: m_pRoot{ std::move(root) }
+{
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>::ChunkedAudioStream(AudioStreamBase<BufferType>&& stream)
+	: ChunkedAudioStream()
+{
+	append(std::move(stream));
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>::ChunkedAudioStream(AudioStreamView<BufferType const> samples, AudioAllocator& allocator)
+	: ChunkedAudioStream()
+{
+	append(samples, allocator);
+}
+
+#pragma endregion
+
+#pragma region ChunkedAudioStream<BufferType> - Methods
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>& ChunkedAudioStream<BufferType>::append(AudioStreamBase<BufferType>&& stream)
+{
+	if (!stream.unique()) {
+		// the buffer is shared or not owned, it could change under this stream.
+		// it is copied in logical order without normalizing it under its other owners
+		auto const segments = std::as_const(stream).segments();
+		for (AudioStreamView<BufferType const> const& segment : segments) {
+			if (segment.size() > 0) {
+				append(segment);
+			}
+		}
+		return *this;
+	}
+	stream.linearize();
+	push(Chunk{ stream.m_pBuffer.release(), stream.m_nLength });
+	stream.m_nLength = 0;
+	return *this;
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>& ChunkedAudioStream<BufferType>::append(AudioStreamView<BufferType const> samples, AudioAllocator& allocator)
+{
+	std::shared_ptr<BufferType> buffer = AudioStreamBase<BufferType>::allocate(samples.size(), allocator).release();
+	std::memcpy(buffer.get(), samples.data(), samples.size() * sizeof(BufferType));
+	push(Chunk{ std::move(buffer), samples.size() });
+	return *this;
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>& ChunkedAudioStream<BufferType>::append(ChunkedAudioStream<BufferType> const& other)
+{
+	// the nodes of other are never changed once shared, so other may be this stream
+	m_pRoot = join(m_pRoot, other.m_pRoot);
+	return *this;
+}
+
+template <typename BufferType>
+template <typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+ChunkedAudioStream<BufferType>& ChunkedAudioStream<BufferType>::transform(Function&& func)
+{
+	transform(m_pRoot, func);
+	return *this;
+}
+
+template <typename BufferType>
+template <typename Function>
+requires (std::is_invocable_v<Function, AudioStreamView<BufferType const>>)
+void ChunkedAudioStream<BufferType>::forEachChunk(Function&& func) const
+{
+	forEachChunk(m_pRoot.get(), func);
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType> ChunkedAudioStream<BufferType>::slice(size_t offset, size_t length) const
+{
+	assert(offset <= size() && length <= size() - offset);
+	NodePtr const tail = split(m_pRoot, offset).second;
+	return ChunkedAudioStream<BufferType>(split(tail, length).first);
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType> ChunkedAudioStream<BufferType>::clone() const
+{
+	return ChunkedAudioStream<BufferType>(m_pRoot);
+}
+
+template <typename BufferType>
+AudioStreamBase<BufferType> ChunkedAudioStream<BufferType>::flatten(AudioAllocator& allocator) const
+{
+	AudioStreamBase<BufferType> stream(AudioStreamBase<BufferType>::allocate(size(), allocator), size());
+	BufferType* ptr = stream.m_pBuffer.get();
+	forEachChunk([&](AudioStreamView<BufferType const> chunk) {
+		std::memcpy(ptr, chunk.data(), chunk.size() * sizeof(BufferType));
+		ptr += chunk.size();
+	});
+	return stream;
+}
+
+template <typename BufferType>
+AudioStreamView<BufferType const> ChunkedAudioStream<BufferType>::chunk(size_t i) const
+{
+	assert(i < chunkCount());
+	Node const* node = m_pRoot.get();
+	while (node->height > 1) {
+		size_t const left = node->left->chunks;
+		if (i < left) {
+			node = node->left.get();
+		}
+		else {
+			i -= left;
+			node = node->right.get();
+		}
+	}
+	return AudioStreamView<BufferType const>(node->chunk.data.get(), node->chunk.length);
+}
+
+template <typename BufferType>
+size_t ChunkedAudioStream<BufferType>::chunkCount() const
+{
+	return chunksOf(m_pRoot);
+}
+
+template <typename BufferType>
+size_t ChunkedAudioStream<BufferType>::size() const
+{
+	return lengthOf(m_pRoot);
+}
+
+template <typename BufferType>
+bool ChunkedAudioStream<BufferType>::empty() const
+{
+	return m_pRoot == nullptr;
+}
+
+#pragma endregion
+
+#pragma region ChunkedAudioStream<BufferType> - OPs
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType> ChunkedAudioStream<BufferType>::operator>>(ChunkedAudioStream<BufferType> const& o) const
+{
+	return ChunkedAudioStream<BufferType>(join(m_pRoot, o.m_pRoot));
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType> ChunkedAudioStream<BufferType>::operator<<(ChunkedAudioStream<BufferType> const& o) const
+{
+	return (*this) >> o;
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>& ChunkedAudioStream<BufferType>::operator>>=(ChunkedAudioStream<BufferType> const& o)
+{
+	return append(o);
+}
+
+template <typename BufferType>
+ChunkedAudioStream<BufferType>& ChunkedAudioStream<BufferType>::operator>>=(AudioStreamBase<BufferType>&& stream)
+{
+	return append(std::move(stream));
+}
+
+template <typename BufferType>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+BufferType const& ChunkedAudioStream<BufferType>::operator[](IntegralT x) const
+{
+	size_t const length = size();
+	if (x < 0) {
+		x += length;
+	}
+	assert(x < length && x >= 0);
+	size_t position = static_cast<size_t>(x);
+	Node const* node = m_pRoot.get();
+	while (node->height > 1) {
+		size_t const left = node->left->length;
+		if (position < left) {
+			node = node->left.get();
+		}
+		else {
+			position -= left;
+			node = node->right.get();
+		}
+	}
+	return node->chunk.data.get()[position];
+}
+
+#pragma endregion
+
+#pragma region ChunkedAudioStream<BufferType> - Private Methods
+
+template <typename BufferType>
+void ChunkedAudioStream<BufferType>::push(Chunk chunk)
+{
+	if (chunk.length == 0) {
+		return;
+	}
+	m_pRoot = join(m_pRoot, leaf(std::move(chunk)));
+}
+
+template <typename BufferType>
+typename ChunkedAudioStream<BufferType>::NodePtr ChunkedAudioStream<BufferType>::leaf(Chunk chunk)
+{
+	size_t const length = chunk.length;
+	return std::allocate_shared<Node>(AllocatorAdapter<Node>(defaultAllocator()), Node{ std::move(chunk), nullptr, nullptr, length, 1, 1 });
+}
+
+template <typename BufferType>
+typename ChunkedAudioStream<BufferType>::NodePtr ChunkedAudioStream<BufferType>::node(NodePtr left, NodePtr right)
+{
+	size_t const length = left->length + right->length;
+	size_t const chunks = left->chunks + right->chunks;
+	int const height = std::max(left->height, right->height) + 1;
+	return std::allocate_shared<Node>(AllocatorAdapter<Node>(defaultAllocator()), Node{ Chunk{}, std::move(left), std::move(right), length, chunks, height });
+}
+
+template <typename BufferType>
+typename ChunkedAudioStream<BufferType>::NodePtr ChunkedAudioStream<BufferType>::balance(NodePtr left, NodePtr right)
+{
+	if (left->height > right->height + 1) {
+		// left heavy, a double rotation when the weight is on the inner grandchild
+		if (left->right->height > left->left->height) {
+			return node(node(left->left, left->right->left), node(left->right->right, std::move(right)));
+		}
+		return node(left->left, node(left->right, std::move(right)));
+	}
+	if (right->height > left->height + 1) {
+		if (right->left->height > right->right->height) {
+			return node(node(std::move(left), right->left->left), node(right->left->right, right->right));
+		}
+		return node(node(std::move(left), right->left), right->right);
+	}
+	return node(std::move(left), std::move(right));
+}
+
+template <typename BufferType>
+typename ChunkedAudioStream<BufferType>::NodePtr ChunkedAudioStream<BufferType>::join(NodePtr const& left, NodePtr const& right)
+{
+	if (left == nullptr) {
+		return right;
+	}
+	if (right == nullptr) {
+		return left;
+	}
+	// the shorter rope is joined along the facing spine of the taller one, at a subtree of about its height
+	if (left->height > right->height + 1) {
+		return balance(left->left, join(left->right, right));
+	}
+	if (right->height > left->height + 1) {
+		return balance(join(left, right->left), right->right);
+	}
+	return node(left, right);
+}
+
+template <typename BufferType>
+std::pair<typename ChunkedAudioStream<BufferType>::NodePtr, typename ChunkedAudioStream<BufferType>::NodePtr> ChunkedAudioStream<BufferType>::split(NodePtr const& root, size_t position)
+{
+	if (position == 0) {
+		return { nullptr, root };
+	}
+	if (position >= lengthOf(root)) {
+		return { root, nullptr };
+	}
+	if (root->height == 1) {
+		Chunk const& chunk = root->chunk;
+		// the aliasing constructor keeps the whole buffer alive while pointing into it
+		return { leaf(Chunk{ chunk.data, position }), leaf(Chunk{ std::shared_ptr<BufferType>(chunk.data, chunk.data.get() + position), chunk.length - position }) };
+	}
+	size_t const left = root->left->length;
+	if (position < left) {
+		auto [head, tail] = split(root->left, position);
+		return { std::move(head), join(tail, root->right) };
+	}
+	if (position > left) {
+		auto [head, tail] = split(root->right, position - left);
+		return { join(root->left, head), std::move(tail) };
+	}
+	return { root->left, root->right };
+}
+
+template <typename BufferType>
+template <typename Function>
+void ChunkedAudioStream<BufferType>::transform(NodePtr& root, Function& func)
+{
+	if (root == nullptr) {
+		return;
+	}
+	if (root.use_count() != 1) {
+		root = std::allocate_shared<Node>(AllocatorAdapter<Node>(defaultAllocator()), *root);
+	}
+	if (root->height > 1) {
+		transform(root->left, func);
+		transform(root->right, func);
+		return;
+	}
+	Chunk& chunk = root->chunk;
+	if (chunk.data.use_count() != 1) {
+		std::shared_ptr<BufferType> buffer = AudioStreamBase<BufferType>::allocate(chunk.length, defaultAllocator()).release();
+		std::memcpy(buffer.get(), chunk.data.get(), chunk.length * sizeof(BufferType));
+		chunk.data = std::move(buffer);
+	}
+	BufferType* ptr = chunk.data.get();
+	for (size_t i = 0; i < chunk.length; ++i) {
+		ptr[i] = func(ptr[i]);
+	}
+}
+
+template <typename BufferType>
+template <typename Function>
+void ChunkedAudioStream<BufferType>::forEachChunk(Node const* root, Function& func)
+{
+	if (root == nullptr) {
+		return;
+	}
+	if (root->height > 1) {
+		forEachChunk(root->left.get(), func);
+		forEachChunk(root->right.get(), func);
+		return;
+	}
+	func(AudioStreamView<BufferType const>(root->chunk.data.get(), root->chunk.length));
+}
+
+template <typename BufferType>
+size_t ChunkedAudioStream<BufferType>::lengthOf(NodePtr const& root)
+{
+	return root != nullptr ? root->length : 0;
+}
+
+template <typename BufferType>
+size_t ChunkedAudioStream<BufferType>::chunksOf(NodePtr const& root)
+{
+	return root != nullptr ? root->chunks : 0;
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_CHUNKED_AUDIO_STREAM_H
@@ -0,0 +1,493 @@
+#ifndef NYCOLIB_CONVOLUTION_H
+#define NYCOLIB_CONVOLUTION_H
+
+/*
+	Module: Convolution (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		Convolution contains the ImpulseResponse and Convolver classes, a partitioned FFT
+		convolution engine for long impulse responses.
+
+		an ImpulseResponse splits an impulse response into partitions and keeps their
+		spectra. it is immutable once constructed, so a single ImpulseResponse can be
+		shared (through a std::shared_ptr) by the Convolvers of any number of channels,
+		on any number of threads. a Convolver owns the state of one channel: the frequency
+		domain delay lines of the past input spectra and the overlap-save windows.
+
+		partitions of the same size form a level. with uniform partitions there is one
+		level of blockSize partitions, and every block costs one forward and one inverse
+		FFT of 2 * blockSize points plus a complex multiply-accumulate per partition.
+		with non-uniform partitions the size doubles from level to level (two partitions
+		per level, the last level takes the rest of the response) up to a maximum, so
+		the multiply-accumulate work grows with the logarithm of the response length
+		instead of linearly. a level of partition size L runs once every L / blockSize
+		blocks, so the cost of a single block is not constant with non-uniform partitions.
+
+		there is no latency: the output block n is the convolution up to the input block n.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <assert.h>
+
+#include "operations.h"
+#include "SimdKernels.h"
+#include "AudioAllocator.h"
+#include "AudioStreamView.h"
+#include "MultiChannelAudioStream.h"
+#include "FFT.h"
+
+
+#pragma region nyco - Convolution - Declarations
+
+namespace nyco {
+
+namespace detail {
+template <typename T>
+struct ConvolutionLevel;
+}
+
+template <typename BufferType>
+class Convolver;
+
+/*
+* the partitioned spectrum of an impulse response, shared by the Convolvers that apply it
+*/
+template <typename BufferType>
+class ImpulseResponse {
+
+#pragma region Constructors
+public:
+
+	/*
+	* partitions ir uniformly into partitions of blockSize samples
+	*/
+	explicit ImpulseResponse(AudioStreamView<BufferType const> ir, size_t blockSize, AudioAllocator& allocator = defaultAllocator());
+
+	/*
+	* partitions ir non-uniformly, from blockSize samples up to maxPartitionSize (blockSize times a power of two)
+	*/
+	explicit ImpulseResponse(AudioStreamView<BufferType const> ir, size_t blockSize, size_t maxPartitionSize, AudioAllocator& allocator = defaultAllocator());
+
+	ImpulseResponse(ImpulseResponse<BufferType> const&) = delete;
+
+	ImpulseResponse(ImpulseResponse<BufferType>&&) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the length of the impulse response
+	*/
+	size_t size() const;
+
+	/*
+	* returns the number of samples processed by a Convolver at a time
+	*/
+	size_t blockSize() const;
+
+	/*
+	* returns the number of partitions of the impulse response
+	*/
+	size_t partitions() const;
+
+#pragma endregion
+
+	ImpulseResponse<BufferType>& operator=(ImpulseResponse<BufferType> const&) = delete;
+
+	ImpulseResponse<BufferType>& operator=(ImpulseResponse<BufferType>&&) = default;
+
+#pragma region Private Members
+private:
+
+	friend class Convolver<BufferType>;
+
+	size_t m_nLength;
+	size_t m_nBlockSize;
+
+	// ordered by offset, the partition size doubles from a level to the next
+	std::vector<detail::ConvolutionLevel<BufferType>> m_levels;
+
+#pragma endregion
+};
+
+/*
+* convolves a single channel with an ImpulseResponse, using uniformly or non-uniformly partitioned overlap-save
+*/
+template <typename BufferType>
+class Convolver {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new Convolver<BufferType> of ir, with its state from allocator
+	*/
+	explicit Convolver(std::shared_ptr<ImpulseResponse<BufferType> const> ir, AudioAllocator& allocator = defaultAllocator());
+
+	Convolver(Convolver<BufferType> const&) = delete;
+
+	Convolver(Convolver<BufferType>&&) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the impulse response of this Convolver
+	*/
+	ImpulseResponse<BufferType> const& impulseResponse() const;
+
+	/*
+	* output = the next input.size() samples of the input convolved with the impulse response.
+	* the size is a multiple of the block size, and output may be input
+	*/
+	void process(AudioStreamView<BufferType const> input, AudioStreamView<BufferType> output);
+
+	/*
+	* clears the past input, as if no sample had been processed
+	*/
+	void reset();
+
+#pragma endregion
+
+	Convolver<BufferType>& operator=(Convolver<BufferType> const&) = delete;
+
+	Convolver<BufferType>& operator=(Convolver<BufferType>&&) = default;
+
+#pragma region Private Members
+private:
+
+	// the state of a level of the impulse response
+	struct Level {
+		RealFFT<BufferType> fft;
+
+		// the overlap-save window, the spectrum accumulator, then the delay line of the past input spectra
+		MultiChannelAudioStream<BufferType> buffers;
+
+		// the delay line channel of the latest spectrum
+		size_t head;
+
+		// the samples of the current partition received so far
+		size_t fill;
+	};
+
+	void processBlock(BufferType const* input, BufferType* output);
+
+	std::shared_ptr<ImpulseResponse<BufferType> const> m_pImpulseResponse;
+
+	std::vector<Level> m_levels;
+
+	// the future output the levels have computed, a ring of blockSize + the offset of the last level
+	MultiChannelAudioStream<BufferType> m_output;
+	size_t m_nOutputHead;
+
+#pragma endregion
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - Convolution - Definitions
+
+namespace nyco {
+
+namespace detail {
+
+#pragma region Kernels
+
+/*
+* partitions of the same size, offset samples into the impulse response
+*/
+template <typename T>
+struct ConvolutionLevel {
+	size_t partitionSize;
+	size_t offset;
+
+	// a channel per partition, the RealFFT packed spectrum of its samples zero padded to 2 * partitionSize, over 2 * partitionSize
+	MultiChannelAudioStream<T> spectra;
+};
+
+/*
+* acc += x * h for the n bins of two RealFFT packed spectra. bin 0 packs the real DC and Nyquist bins
+*/
+template <typename V, typename T>
+void multiplyAccumulate(T* accRe, T* accIm, T const* xRe, T const* xIm, T const* hRe, T const* hIm, size_t n)
+{
+	T const dc = accRe[0] + xRe[0] * hRe[0];
+	T const nyquist = accIm[0] + xIm[0] * hIm[0];
+	size_t i = 0;
+	// the registers only reach the operations of V by reference, see simd::scalar::Vec
+	typename V::reg xr;
+	typename V::reg xi;
+	typename V::reg hr;
+	typename V::reg hi;
+	typename V::reg acc;
+	typename V::reg x;
+	typename V::reg y;
+	for (; i + V::width <= n; i += V::width) {
+		V::load(xr, xRe + i);
+		V::load(xi, xIm + i);
+		V::load(hr, hRe + i);
+		V::load(hi, hIm + i);
+		mul<V>(x, xr, hr);
+		mul<V>(y, xi, hi);
+		sub<V>(x, x, y);
+		V::load(acc, accRe + i);
+		add<V>(acc, acc, x);
+		V::store(accRe + i, acc);
+		mul<V>(x, xr, hi);
+		mul<V>(y, xi, hr);
+		add<V>(x, x, y);
+		V::load(acc, accIm + i);
+		add<V>(acc, acc, x);
+		V::store(accIm + i, acc);
+	}
+	for (; i < n; ++i) {
+		T const xr = xRe[i];
+		T const xi = xIm[i];
+		accRe[i] += xr * hRe[i] - xi * hIm[i];
+		accIm[i] += xr * hIm[i] + xi * hRe[i];
+	}
+	accRe[0] = dc;
+	accIm[0] = nyquist;
+}
+
+#if NYCO_SIMD_X86
+template <typename T>
+NYCO_SIMD_TARGET_SSE2 NYCO_SIMD_FLATTEN void multiplyAccumulateSse2(T* accRe, T* accIm, T const* xRe, T const* xIm, T const* hRe, T const* hIm, size_t n)
+{
+	multiplyAccumulate<simd::sse2::Vec<T>>(accRe, accIm, xRe, xIm, hRe, hIm, n);
+}
+
+template <typename T>
+NYCO_SIMD_TARGET_AVX2 NYCO_SIMD_FLATTEN void multiplyAccumulateAvx2(T* accRe, T* accIm, T const* xRe, T const* xIm, T const* hRe, T const* hIm, size_t n)
+{
+	multiplyAccumulate<simd::avx2::Vec<T>>(accRe, accIm, xRe, xIm, hRe, hIm, n);
+}
+#endif
+
+/*
+* multiplyAccumulate with the selected instruction set
+*/
+template <typename T>
+void multiplyAccumulate(T* accRe, T* accIm, T const* xRe, T const* xIm, T const* hRe, T const* hIm, size_t n)
+{
+#if NYCO_SIMD_X86
+	switch (simd::instructionSet()) {
+	case simd::InstructionSet::AVX512:
+	case simd::InstructionSet::AVX2:
+		multiplyAccumulateAvx2(accRe, accIm, xRe, xIm, hRe, hIm, n);
+		return;
+	case simd::InstructionSet::SSE2:
+		multiplyAccumulateSse2(accRe, accIm, xRe, xIm, hRe, hIm, n);
+		return;
+	default:
+		break;
+	}
+#endif
+	multiplyAccumulate<simd::scalar::Vec<T>>(accRe, accIm, xRe, xIm, hRe, hIm, n);
+}
+
+#pragma endregion
+
+}
+
+#pragma region ImpulseResponse<BufferType>
+
+template <typename BufferType>
+ImpulseResponse<BufferType>::ImpulseResponse(AudioStreamView<BufferType const> ir, size_t blockSize, AudioAllocator& allocator)
+	: ImpulseResponse(ir, blockSize, blockSize, allocator)
+{
+}
+
+template <typename BufferType>
+ImpulseResponse<BufferType>::ImpulseResponse(AudioStreamView<BufferType const> ir, size_t blockSize, size_t maxPartitionSize, AudioAllocator& allocator)
+	: m_nLength{ ir.size() }
+	, m_nBlockSize{ blockSize }
+{
+	assert(blockSize > 0 && maxPartitionSize >= blockSize && maxPartitionSize % blockSize == 0);
+	assert(((maxPartitionSize / blockSize) & (maxPartitionSize / blockSize - 1)) == 0);
+
+	size_t offset = 0;
+	size_t partitionSize = blockSize;
+	while (offset < m_nLength) {
+		size_t const rest = m_nLength - offset;
+		size_t count = (rest + partitionSize - 1) / partitionSize;
+		// two partitions per level keeps the offset of the next level past its partition size, so it is never late
+		if (partitionSize < maxPartitionSize && count > 2) {
+			count = 2;
+		}
+
+		size_t const fftSize = 2 * partitionSize;
+		RealFFT<BufferType> fft(fftSize, allocator);
+		detail::ConvolutionLevel<BufferType> level{ partitionSize, offset, MultiChannelAudioStream<BufferType>(count, fftSize, allocator) };
+		// the 1 / fftSize normalization of the inverse transforms is folded into the spectra
+		BufferType const scale = BufferType(1) / BufferType(fftSize);
+		for (size_t p = 0; p < count; ++p) {
+			BufferType* const spectrum = level.spectra.channel(p).data();
+			size_t const start = offset + p * partitionSize;
+			size_t const length = std::min(partitionSize, m_nLength - start);
+			for (size_t i = 0; i < length; ++i) {
+				spectrum[i] = ir[start + i] * scale;
+			}
+			std::memset(spectrum + length, 0, (fftSize - length) * sizeof(BufferType));
+			fft.forward(level.spectra.channel(p));
+		}
+		m_levels.push_back(std::move(level));
+
+		offset += count * partitionSize;
+		if (partitionSize < maxPartitionSize) {
+			partitionSize *= 2;
+		}
+	}
+}
+
+template <typename BufferType>
+size_t ImpulseResponse<BufferType>::size() const
+{
+	return m_nLength;
+}
+
+template <typename BufferType>
+size_t ImpulseResponse<BufferType>::blockSize() const
+{
+	return m_nBlockSize;
+}
+
+template <typename BufferType>
+size_t ImpulseResponse<BufferType>::partitions() const
+{
+	size_t count = 0;
+	for (detail::ConvolutionLevel<BufferType> const& level : m_levels) {
+		count += level.spectra.channels();
+	}
+	return count;
+}
+
+#pragma endregion
+
+#pragma region Convolver<BufferType>
+
+template <typename BufferType>
+Convolver<BufferType>::Convolver(std::shared_ptr<ImpulseResponse<BufferType> const> ir, AudioAllocator& allocator)
+	: m_pImpulseResponse{ std::move(ir) }
+	, m_output(1, m_pImpulseResponse->blockSize() + (m_pImpulseResponse->m_levels.empty() ? 0 : m_pImpulseResponse->m_levels.back().offset), allocator)
+	, m_nOutputHead{ 0 }
+{
+	m_levels.reserve(m_pImpulseResponse->m_levels.size());
+	for (detail::ConvolutionLevel<BufferType> const& level : m_pImpulseResponse->m_levels) {
+		size_t const fftSize = 2 * level.partitionSize;
+		m_levels.push_back(Level{ RealFFT<BufferType>(fftSize, allocator), MultiChannelAudioStream<BufferType>(2 + level.spectra.channels(), fftSize, allocator), 0, 0 });
+	}
+	reset();
+}
+
+template <typename BufferType>
+ImpulseResponse<BufferType> const& Convolver<BufferType>::impulseResponse() const
+{
+	return *m_pImpulseResponse;
+}
+
+template <typename BufferType>
+void Convolver<BufferType>::process(AudioStreamView<BufferType const> input, AudioStreamView<BufferType> output)
+{
+	size_t const blockSize = m_pImpulseResponse->blockSize();
+	assert(input.size() == output.size() && input.size() % blockSize == 0);
+	for (size_t i = 0; i < input.size(); i += blockSize) {
+		processBlock(input.data() + i, output.data() + i);
+	}
+}
+
+template <typename BufferType>
+void Convolver<BufferType>::reset()
+{
+	for (Level& level : m_levels) {
+		for (size_t c = 0; c < level.buffers.channels(); ++c) {
+			std::memset(level.buffers.channel(c).data(), 0, level.buffers.size() * sizeof(BufferType));
+		}
+		level.head = 0;
+		level.fill = 0;
+	}
+	std::memset(m_output.channel(0).data(), 0, m_output.size() * sizeof(BufferType));
+	m_nOutputHead = 0;
+}
+
+template <typename BufferType>
+void Convolver<BufferType>::processBlock(BufferType const* input, BufferType* output)
+{
+	size_t const blockSize = m_pImpulseResponse->blockSize();
+	size_t const ringSize = m_output.size();
+	BufferType* const ring = m_output.channel(0).data();
+
+	for (size_t l = 0; l < m_levels.size(); ++l) {
+		Level& level = m_levels[l];
+		detail::ConvolutionLevel<BufferType> const& ir = m_pImpulseResponse->m_levels[l];
+		size_t const partitionSize = ir.partitionSize;
+		size_t const fftSize = 2 * partitionSize;
+		size_t const count = ir.spectra.channels();
+
+		// the window is the previous partition of the input followed by the current one
+		BufferType* const window = level.buffers.channel(0).data();
+		std::memcpy(window + partitionSize + level.fill, input, blockSize * sizeof(BufferType));
+		level.fill += blockSize;
+		if (level.fill < partitionSize) {
+			continue;
+		}
+		level.fill = 0;
+
+		// the spectrum of the window becomes the latest of the delay line
+		level.head = (level.head == 0 ? count : level.head) - 1;
+		AudioStreamView<BufferType> const latest = level.buffers.channel(2 + level.head);
+		std::memcpy(latest.data(), window, fftSize * sizeof(BufferType));
+		std::memcpy(window, window + partitionSize, partitionSize * sizeof(BufferType));
+		level.fft.forward(latest);
+
+		// the spectrum of the output is the sum of every past input spectrum times the partition of its age
+		AudioStreamView<BufferType> const acc = level.buffers.channel(1);
+		std::memset(acc.data(), 0, fftSize * sizeof(BufferType));
+		for (size_t p = 0; p < count; ++p) {
+			BufferType const* const x = level.buffers.channel(2 + (level.head + p) % count).data();
+			BufferType const* const h = ir.spectra.channel(p).data();
+			detail::multiplyAccumulate(acc.data(), acc.data() + partitionSize, x, x + partitionSize, h, h + partitionSize, partitionSize);
+		}
+		level.fft.inverse(acc);
+
+		// overlap-save: the second half is the output of the current partition, due offset samples after its input.
+		// the current partition ended with this block, so its output starts partitionSize - blockSize before the block
+		size_t position = (m_nOutputHead + blockSize + ir.offset - partitionSize) % ringSize;
+		BufferType const* valid = acc.data() + partitionSize;
+		size_t remaining = partitionSize;
+		while (remaining > 0) {
+			size_t const n = std::min(remaining, ringSize - position);
+			for (size_t i = 0; i < n; ++i) {
+				ring[position + i] += valid[i];
+			}
+			valid += n;
+			remaining -= n;
+			position = 0;
+		}
+	}
+
+	std::memcpy(output, ring + m_nOutputHead, blockSize * sizeof(BufferType));
+	std::memset(ring + m_nOutputHead, 0, blockSize * sizeof(BufferType));
+	m_nOutputHead = (m_nOutputHead + blockSize) % ringSize;
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_CONVOLUTION_H
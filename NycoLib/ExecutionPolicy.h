@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "ThreadPool.h"
+
+
+namespace nyco {
+	namespace execution {
+		// below this many bytes an operation runs inline on the calling thread, a per-block call never pays for the pool
+		static constexpr size_t PARALLEL_THRESHOLD = 1 << 20;
+
+		// bytes in every chunk a parallel operation is split into, so a chunk stays in the L2 cache of its core
+		static constexpr size_t CHUNK_SIZE = 1 << 18;
+
+		struct sequential {};
+
+		struct parallel {
+			// the pool the operation runs on, the library pool if nullptr
+			ThreadPool* pool = nullptr;
+		};
+
+		// the chunk loops are already vectorized, so this runs the same as parallel
+		struct parallel_unsequenced {
+			// the pool the operation runs on, the library pool if nullptr
+			ThreadPool* pool = nullptr;
+		};
+
+		template <typename T>
+		struct is_execution_policy : std::false_type {};
+
+		template <>
+		struct is_execution_policy<sequential> : std::true_type {};
+
+		template <>
+		struct is_execution_policy<parallel> : std::true_type {};
+
+		template <>
+		struct is_execution_policy<parallel_unsequenced> : std::true_type {};
+
+		template <typename T>
+		concept Policy = is_execution_policy<std::remove_cvref_t<T>>::value;
+
+		static constexpr auto SEQUENTIAL = sequential{};
+		static constexpr auto PARALLEL = parallel{};
+		static constexpr auto PARALLEL_UNSEQUENCED = parallel_unsequenced{};
+
+		/*
+		* calls func(begin, end) over consecutive ranges that cover [0, length), each of at most
+		* CHUNK_SIZE bytes of elements of elementSize bytes. the ranges run on the pool of the policy,
+		* or as a single range on the calling thread when the policy is sequential or the data is small
+		*/
+		template <Policy P, typename Function>
+		void forEachChunk(P const& policy, size_t length, size_t elementSize, Function&& func)
+		{
+			if constexpr (std::is_same_v<std::remove_cvref_t<P>, sequential>) {
+				func(size_t{ 0 }, length);
+			}
+			else {
+				if (length * elementSize < PARALLEL_THRESHOLD) {
+					func(size_t{ 0 }, length);
+					return;
+				}
+				ThreadPool& pool = policy.pool != nullptr ? *policy.pool : threadPool();
+				// an element larger than a chunk (a whole channel, say) is a chunk of its own
+				size_t const chunk = elementSize < CHUNK_SIZE ? CHUNK_SIZE / elementSize : 1;
+				size_t const chunks = (length + chunk - 1) / chunk;
+				pool.parallelFor(chunks, [&](size_t i) {
+					size_t const begin = i * chunk;
+					func(begin, begin + chunk < length ? begin + chunk : length);
+				});
+			}
+		}
+	}
+}
@@ -0,0 +1,850 @@
+#ifndef NYCOLIB_FFT_H
+#define NYCOLIB_FFT_H
+
+/*
+	Module: FFT (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		FFT contains the FFT (complex) and RealFFT (real <-> complex) classes, transforms
+		of any size that work on the samples of AudioStreams directly. complex data is
+		split: the real and the imaginary parts are two streams, so every butterfly is a
+		handful of vector operations over consecutive samples.
+
+		a transform is a sequence of Stockham (self sorting, no bit reversal) stages of
+		radix 4, 2, 3 and 5, with a slower generic stage for any other prime factor. the
+		stages and their twiddle factors are a plan, built once per size and shared by
+		every FFT of that size, an FFT only owns its scratch buffers. the butterflies are
+		vectorized with the Vec types of SimdKernels for the selected instruction set.
+
+		the inverse transforms are not normalized: inverse(forward(x)) is size() * x.
+
+*/
+
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <type_traits>
+#include <vector>
+#include <assert.h>
+
+#include "operations.h"
+#include "SimdKernels.h"
+#include "AudioAllocator.h"
+#include "AudioStreamView.h"
+#include "MultiChannelAudioStream.h"
+#include "SampleConversion.h"
+
+
+#pragma region nyco - FFT - Declarations
+
+namespace nyco {
+
+namespace detail {
+template <typename T>
+struct FFTPlan;
+
+template <typename T>
+struct RealFFTPlan;
+}
+
+/*
+* a complex FFT of a fixed size over split complex data
+*/
+template <typename BufferType>
+class FFT {
+
+	static_assert(std::is_floating_point_v<BufferType>, "FFT is only implemented for floating point samples");
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new FFT<BufferType> of size points, with its scratch buffers from allocator
+	*/
+	explicit FFT(size_t size, AudioAllocator& allocator = defaultAllocator());
+
+	FFT(FFT<BufferType> const&) = delete;
+
+	FFT(FFT<BufferType>&&) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the number of points of this FFT
+	*/
+	size_t size() const;
+
+	/*
+	* out = DFT(in), every view is size() samples long and in may be out
+	*/
+	void forward(AudioStreamView<BufferType const> inRe, AudioStreamView<BufferType const> inIm, AudioStreamView<BufferType> outRe, AudioStreamView<BufferType> outIm);
+
+	/*
+	* out = size() * IDFT(in), every view is size() samples long and in may be out
+	*/
+	void inverse(AudioStreamView<BufferType const> inRe, AudioStreamView<BufferType const> inIm, AudioStreamView<BufferType> outRe, AudioStreamView<BufferType> outIm);
+
+	/*
+	* transforms re and im in place
+	*/
+	void forward(AudioStreamView<BufferType> re, AudioStreamView<BufferType> im);
+
+	/*
+	* inverse transforms re and im in place
+	*/
+	void inverse(AudioStreamView<BufferType> re, AudioStreamView<BufferType> im);
+
+#pragma endregion
+
+	FFT<BufferType>& operator=(FFT<BufferType> const&) = delete;
+
+	FFT<BufferType>& operator=(FFT<BufferType>&&) = default;
+
+#pragma region Private Members
+private:
+
+	std::shared_ptr<detail::FFTPlan<BufferType> const> m_pPlan;
+
+	// two complex scratch buffers, re and im of the first then of the second
+	MultiChannelAudioStream<BufferType> m_work;
+
+#pragma endregion
+};
+
+/*
+* a real to complex FFT of a fixed, even size
+* the spectrum of size() real samples is the size() / 2 + 1 bins from DC to Nyquist, whose imaginary
+* parts at DC and Nyquist are always 0. it is stored in two halves of size() / 2: re[k] and im[k] are
+* bin k, except im[0], which holds the real part of the Nyquist bin
+*/
+template <typename BufferType>
+class RealFFT {
+
+	static_assert(std::is_floating_point_v<BufferType>, "RealFFT is only implemented for floating point samples");
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new RealFFT<BufferType> of size (even) points, with its scratch buffers from allocator
+	*/
+	explicit RealFFT(size_t size, AudioAllocator& allocator = defaultAllocator());
+
+	RealFFT(RealFFT<BufferType> const&) = delete;
+
+	RealFFT(RealFFT<BufferType>&&) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the number of real points of this RealFFT
+	*/
+	size_t size() const;
+
+	/*
+	* transforms the size() samples of input into the size() / 2 samples of re and im
+	*/
+	void forward(AudioStreamView<BufferType const> input, AudioStreamView<BufferType> re, AudioStreamView<BufferType> im);
+
+	/*
+	* output = size() * IDFT(re, im), see forward(input, re, im)
+	*/
+	void inverse(AudioStreamView<BufferType const> re, AudioStreamView<BufferType const> im, AudioStreamView<BufferType> output);
+
+	/*
+	* transforms the size() samples of data in place, into re in the first half and im in the second
+	*/
+	void forward(AudioStreamView<BufferType> data);
+
+	/*
+	* inverse transforms data in place, see forward(data)
+	*/
+	void inverse(AudioStreamView<BufferType> data);
+
+#pragma endregion
+
+	RealFFT<BufferType>& operator=(RealFFT<BufferType> const&) = delete;
+
+	RealFFT<BufferType>& operator=(RealFFT<BufferType>&&) = default;
+
+#pragma region Private Members
+private:
+
+	std::shared_ptr<detail::RealFFTPlan<BufferType> const> m_pPlan;
+
+	// three complex scratch buffers of size() / 2
+	MultiChannelAudioStream<BufferType> m_work;
+
+#pragma endregion
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - FFT - Definitions
+
+namespace nyco {
+
+namespace detail {
+
+#pragma region Plans
+
+// one Stockham stage: radix butterflies over span groups of stride consecutive points
+struct FFTStage {
+	size_t radix;
+	size_t stride;
+	size_t span;
+	// where the (radix - 1) * span twiddles of the stage start in the tables of the plan,
+	// followed for a generic radix by its radix roots of unity
+	size_t twiddles;
+};
+
+/*
+* returns the plan of the given kind and size, built the first time it is asked for and shared after that
+*/
+template <typename Plan>
+std::shared_ptr<Plan const> cachedPlan(size_t size);
+
+template <typename T>
+struct FFTPlan {
+	explicit FFTPlan(size_t size);
+
+	size_t size;
+	std::vector<FFTStage> stages;
+	std::vector<T> twiddleRe;
+	std::vector<T> twiddleIm;
+};
+
+template <typename T>
+struct RealFFTPlan {
+	explicit RealFFTPlan(size_t size);
+
+	size_t size;
+	// the complex plan of size / 2 points the real transform runs on
+	std::shared_ptr<FFTPlan<T> const> half;
+	// exp(-2 pi i k / size) for k in [0, size / 4]
+	std::vector<T> twiddleRe;
+	std::vector<T> twiddleIm;
+};
+
+template <typename T>
+FFTPlan<T>::FFTPlan(size_t size)
+	: size{ size }
+	, stages{}
+	, twiddleRe{}
+	, twiddleIm{}
+{
+	assert(size != 0);
+	std::vector<size_t> radices;
+	size_t rest = size;
+	while (rest % 4 == 0) {
+		radices.push_back(4);
+		rest /= 4;
+	}
+	if (rest % 2 == 0) {
+		radices.push_back(2);
+		rest /= 2;
+	}
+	for (size_t f = 3; rest > 1; f += 2) {
+		while (rest % f == 0) {
+			radices.push_back(f);
+			rest /= f;
+		}
+	}
+
+	// the twiddles are computed in double and rounded once
+	size_t length = size;
+	size_t stride = 1;
+	for (size_t radix : radices) {
+		size_t const span = length / radix;
+		stages.push_back(FFTStage{ radix, stride, span, twiddleRe.size() });
+		for (size_t k = 1; k < radix; ++k) {
+			for (size_t p = 0; p < span; ++p) {
+				double const angle = -2.0 * std::numbers::pi * static_cast<double>(p * k) / static_cast<double>(length);
+				twiddleRe.push_back(static_cast<T>(std::cos(angle)));
+				twiddleIm.push_back(static_cast<T>(std::sin(angle)));
+			}
+		}
+		if (radix > 5) {
+			for (size_t j = 0; j < radix; ++j) {
+				double const angle = -2.0 * std::numbers::pi * static_cast<double>(j) / static_cast<double>(radix);
+				twiddleRe.push_back(static_cast<T>(std::cos(angle)));
+				twiddleIm.push_back(static_cast<T>(std::sin(angle)));
+			}
+		}
+		length = span;
+		stride *= radix;
+	}
+}
+
+template <typename T>
+RealFFTPlan<T>::RealFFTPlan(size_t size)
+	: size{ size }
+	, half{}
+	, twiddleRe{}
+	, twiddleIm{}
+{
+	assert(size >= 2 && size % 2 == 0 && "RealFFT needs an even size");
+	half = cachedPlan<FFTPlan<T>>(size / 2);
+	for (size_t k = 0; k <= size / 4; ++k) {
+		double const angle = -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(size);
+		twiddleRe.push_back(static_cast<T>(std::cos(angle)));
+		twiddleIm.push_back(static_cast<T>(std::sin(angle)));
+	}
+}
+
+template <typename Plan>
+std::shared_ptr<Plan const> cachedPlan(size_t size)
+{
+	static std::mutex lock;
+	static std::map<size_t, std::shared_ptr<Plan const>> plans;
+	std::lock_guard<std::mutex> guard(lock);
+	std::shared_ptr<Plan const>& plan = plans[size];
+	if (!plan) {
+		plan = std::make_shared<Plan const>(size);
+	}
+	return plan;
+}
+
+#pragma endregion
+
+#pragma region Butterflies
+
+// the source and destination of a stage, split complex
+template <typename T>
+struct FFTBuffers {
+	T const* xr;
+	T const* xi;
+	T* yr;
+	T* yi;
+};
+
+/*
+* out = a + b, and so on. the butterflies are not compiled for the instruction set of V,
+* so a register is only ever passed by reference to them and to the operations of V
+*/
+template <typename V>
+void add(typename V::reg& out, typename V::reg const& a, typename V::reg const& b)
+{
+	V::apply(operations::Add{}, out, a, b);
+}
+
+template <typename V>
+void sub(typename V::reg& out, typename V::reg const& a, typename V::reg const& b)
+{
+	V::apply(operations::Subtract{}, out, a, b);
+}
+
+template <typename V>
+void mul(typename V::reg& out, typename V::reg const& a, typename V::reg const& b)
+{
+	V::apply(operations::Multiply{}, out, a, b);
+}
+
+/*
+* stores (re, im) * w at y[i]
+*/
+template <typename V, typename T>
+void storeTwiddled(FFTBuffers<T> const& b, size_t i, typename V::reg const& re, typename V::reg const& im, typename V::reg const& wr, typename V::reg const& wi)
+{
+	typename V::reg x;
+	typename V::reg y;
+	mul<V>(x, re, wr);
+	mul<V>(y, im, wi);
+	sub<V>(x, x, y);
+	V::store(b.yr + i, x);
+	mul<V>(x, re, wi);
+	mul<V>(y, im, wr);
+	add<V>(x, x, y);
+	V::store(b.yi + i, x);
+}
+
+/*
+* the butterflies of group p of a radix R stage for the points [begin, end) of the group, end - begin a multiple of V::width
+* a_j = x[q + stride * (p + j * span)], y[q + stride * (R * p + k)] = DFT_R(a)_k * w_p^k
+*/
+template <size_t R, typename V, typename T>
+void butterflies(FFTStage const& st, T const* wr, T const* wi, FFTBuffers<T> const& b, size_t p, size_t begin, size_t end)
+{
+	using reg = typename V::reg;
+	size_t const s = st.stride;
+	size_t const m = st.span;
+	reg w[R][2];
+	for (size_t k = 1; k < R; ++k) {
+		V::broadcast(w[k][0], wr[(k - 1) * m + p]);
+		V::broadcast(w[k][1], wi[(k - 1) * m + p]);
+	}
+	for (size_t q = begin; q < end; q += V::width) {
+		size_t const in = q + s * p;
+		size_t const out = q + s * R * p;
+		reg ar[R];
+		reg ai[R];
+		for (size_t j = 0; j < R; ++j) {
+			V::load(ar[j], b.xr + in + j * s * m);
+			V::load(ai[j], b.xi + in + j * s * m);
+		}
+		reg x;
+		reg y;
+		if constexpr (R == 2) {
+			add<V>(x, ar[0], ar[1]);
+			V::store(b.yr + out, x);
+			add<V>(x, ai[0], ai[1]);
+			V::store(b.yi + out, x);
+			sub<V>(x, ar[0], ar[1]);
+			sub<V>(y, ai[0], ai[1]);
+			storeTwiddled<V>(b, out + s, x, y, w[1][0], w[1][1]);
+		}
+		else if constexpr (R == 3) {
+			// b1, b2 = a0 - (a1 + a2) / 2 -+ i sin(2 pi / 3) (a1 - a2)
+			reg half;
+			reg sine;
+			V::broadcast(half, T(0.5));
+			V::broadcast(sine, T(0.86602540378443864676));
+			reg sr;
+			reg si;
+			reg tr;
+			reg ti;
+			reg dr;
+			reg di;
+			add<V>(sr, ar[1], ar[2]);
+			add<V>(si, ai[1], ai[2]);
+			mul<V>(x, half, sr);
+			sub<V>(tr, ar[0], x);
+			mul<V>(x, half, si);
+			sub<V>(ti, ai[0], x);
+			sub<V>(x, ar[1], ar[2]);
+			mul<V>(dr, sine, x);
+			sub<V>(x, ai[1], ai[2]);
+			mul<V>(di, sine, x);
+			add<V>(x, ar[0], sr);
+			V::store(b.yr + out, x);
+			add<V>(x, ai[0], si);
+			V::store(b.yi + out, x);
+			add<V>(x, tr, di);
+			sub<V>(y, ti, dr);
+			storeTwiddled<V>(b, out + s, x, y, w[1][0], w[1][1]);
+			sub<V>(x, tr, di);
+			add<V>(y, ti, dr);
+			storeTwiddled<V>(b, out + 2 * s, x, y, w[2][0], w[2][1]);
+		}
+		else if constexpr (R == 4) {
+			reg t0r;
+			reg t0i;
+			reg t1r;
+			reg t1i;
+			reg t2r;
+			reg t2i;
+			reg t3r;
+			reg t3i;
+			add<V>(t0r, ar[0], ar[2]);
+			add<V>(t0i, ai[0], ai[2]);
+			sub<V>(t1r, ar[0], ar[2]);
+			sub<V>(t1i, ai[0], ai[2]);
+			add<V>(t2r, ar[1], ar[3]);
+			add<V>(t2i, ai[1], ai[3]);
+			sub<V>(t3r, ar[1], ar[3]);
+			sub<V>(t3i, ai[1], ai[3]);
+			add<V>(x, t0r, t2r);
+			V::store(b.yr + out, x);
+			add<V>(x, t0i, t2i);
+			V::store(b.yi + out, x);
+			// b1 = t1 - i t3, b2 = t0 - t2, b3 = t1 + i t3
+			add<V>(x, t1r, t3i);
+			sub<V>(y, t1i, t3r);
+			storeTwiddled<V>(b, out + s, x, y, w[1][0], w[1][1]);
+			sub<V>(x, t0r, t2r);
+			sub<V>(y, t0i, t2i);
+			storeTwiddled<V>(b, out + 2 * s, x, y, w[2][0], w[2][1]);
+			sub<V>(x, t1r, t3i);
+			add<V>(y, t1i, t3r);
+			storeTwiddled<V>(b, out + 3 * s, x, y, w[3][0], w[3][1]);
+		}
+		else {
+			static_assert(R == 5);
+			reg c1;
+			reg c2;
+			reg s1;
+			reg s2;
+			V::broadcast(c1, T(0.30901699437494742410));
+			V::broadcast(c2, T(-0.80901699437494742410));
+			V::broadcast(s1, T(0.95105651629515357212));
+			V::broadcast(s2, T(0.58778525229247312917));
+			// t1 = a1 + a4, t2 = a2 + a3, t3 = a1 - a4, t4 = a2 - a3
+			reg t[5][2];
+			add<V>(t[1][0], ar[1], ar[4]);
+			add<V>(t[1][1], ai[1], ai[4]);
+			add<V>(t[2][0], ar[2], ar[3]);
+			add<V>(t[2][1], ai[2], ai[3]);
+			sub<V>(t[3][0], ar[1], ar[4]);
+			sub<V>(t[3][1], ai[1], ai[4]);
+			sub<V>(t[4][0], ar[2], ar[3]);
+			sub<V>(t[4][1], ai[2], ai[3]);
+			// m1 = a0 + c1 t1 + c2 t2, m2 = a0 + c2 t1 + c1 t2, n1 = s1 t3 + s2 t4, n2 = s2 t3 - s1 t4
+			reg m1[2];
+			reg m2[2];
+			reg n1[2];
+			reg n2[2];
+			for (size_t c = 0; c < 2; ++c) {
+				reg const& a0 = c == 0 ? ar[0] : ai[0];
+				mul<V>(x, c1, t[1][c]);
+				mul<V>(y, c2, t[2][c]);
+				add<V>(x, x, y);
+				add<V>(m1[c], a0, x);
+				mul<V>(x, c2, t[1][c]);
+				mul<V>(y, c1, t[2][c]);
+				add<V>(x, x, y);
+				add<V>(m2[c], a0, x);
+				mul<V>(x, s1, t[3][c]);
+				mul<V>(y, s2, t[4][c]);
+				add<V>(n1[c], x, y);
+				mul<V>(x, s2, t[3][c]);
+				mul<V>(y, s1, t[4][c]);
+				sub<V>(n2[c], x, y);
+				add<V>(x, t[1][c], t[2][c]);
+				add<V>(x, a0, x);
+				V::store((c == 0 ? b.yr : b.yi) + out, x);
+			}
+			// b1, b4 = m1 -+ i n1, b2, b3 = m2 -+ i n2
+			add<V>(x, m1[0], n1[1]);
+			sub<V>(y, m1[1], n1[0]);
+			storeTwiddled<V>(b, out + s, x, y, w[1][0], w[1][1]);
+			add<V>(x, m2[0], n2[1]);
+			sub<V>(y, m2[1], n2[0]);
+			storeTwiddled<V>(b, out + 2 * s, x, y, w[2][0], w[2][1]);
+			sub<V>(x, m2[0], n2[1]);
+			add<V>(y, m2[1], n2[0]);
+			storeTwiddled<V>(b, out + 3 * s, x, y, w[3][0], w[3][1]);
+			sub<V>(x, m1[0], n1[1]);
+			add<V>(y, m1[1], n1[0]);
+			storeTwiddled<V>(b, out + 4 * s, x, y, w[4][0], w[4][1]);
+		}
+	}
+}
+
+// the Vec of half the width a stage whose stride does not fill a register of V runs with
+template <typename V, typename T>
+struct NarrowerVec {
+	using type = simd::scalar::Vec<T>;
+};
+
+#if NYCO_SIMD_X86
+template <typename T>
+struct NarrowerVec<simd::avx2::Vec<T>, T> {
+	using type = simd::sse2::Vec<T>;
+};
+#endif
+
+template <size_t R, typename V, typename T>
+void radixStage(FFTStage const& st, T const* wr, T const* wi, FFTBuffers<T> const& b)
+{
+	if constexpr (V::width > 1) {
+		if (st.stride < V::width) {
+			radixStage<R, typename NarrowerVec<V, T>::type>(st, wr, wi, b);
+			return;
+		}
+	}
+	// the points of a group are consecutive, so they are vectorized once the stride fills a register
+	size_t const vectorEnd = st.stride / V::width * V::width;
+	for (size_t p = 0; p < st.span; ++p) {
+		butterflies<R, V>(st, wr, wi, b, p, 0, vectorEnd);
+		butterflies<R, simd::scalar::Vec<T>>(st, wr, wi, b, p, vectorEnd, st.stride);
+	}
+}
+
+/*
+* a stage of any other radix, a direct DFT of every group with the roots of unity stored after its twiddles
+*/
+template <typename T>
+void genericStage(FFTStage const& st, T const* wr, T const* wi, FFTBuffers<T> const& b)
+{
+	size_t const r = st.radix;
+	size_t const s = st.stride;
+	size_t const m = st.span;
+	T const* rootRe = wr + (r - 1) * m;
+	T const* rootIm = wi + (r - 1) * m;
+	for (size_t p = 0; p < m; ++p) {
+		for (size_t q = 0; q < s; ++q) {
+			size_t const in = q + s * p;
+			size_t const out = q + s * r * p;
+			for (size_t k = 0; k < r; ++k) {
+				T re = 0;
+				T im = 0;
+				for (size_t j = 0; j < r; ++j) {
+					size_t const root = (j * k) % r;
+					T const xr = b.xr[in + j * s * m];
+					T const xi = b.xi[in + j * s * m];
+					re += xr * rootRe[root] - xi * rootIm[root];
+					im += xr * rootIm[root] + xi * rootRe[root];
+				}
+				T const twr = k == 0 ? T(1) : wr[(k - 1) * m + p];
+				T const twi = k == 0 ? T(0) : wi[(k - 1) * m + p];
+				b.yr[out + k * s] = re * twr - im * twi;
+				b.yi[out + k * s] = re * twi + im * twr;
+			}
+		}
+	}
+}
+
+/*
+* runs every stage of plan from in to out, through the scratch buffers a and b
+* in may be out or a, out and b must not overlap anything else
+*/
+template <typename V, typename T>
+void transform(FFTPlan<T> const& plan, T const* inRe, T const* inIm, T* outRe, T* outIm, T* aRe, T* aIm, T* bRe, T* bIm)
+{
+	size_t const count = plan.stages.size();
+	T const* srcRe = inRe;
+	T const* srcIm = inIm;
+	for (size_t i = 0; i < count; ++i) {
+		// the last stage writes out and the ones before alternate with a, a stage is never in place,
+		// so a first stage that would overwrite its own input writes b instead
+		bool const toOut = (count - 1 - i) % 2 == 0;
+		T* dstRe = toOut ? outRe : aRe;
+		T* dstIm = toOut ? outIm : aIm;
+		if (dstRe == srcRe) {
+			dstRe = bRe;
+			dstIm = bIm;
+		}
+		FFTStage const& st = plan.stages[i];
+		T const* wr = plan.twiddleRe.data() + st.twiddles;
+		T const* wi = plan.twiddleIm.data() + st.twiddles;
+		FFTBuffers<T> const buffers{ srcRe, srcIm, dstRe, dstIm };
+		switch (st.radix) {
+		case 2:
+			radixStage<2, V>(st, wr, wi, buffers);
+			break;
+		case 3:
+			radixStage<3, V>(st, wr, wi, buffers);
+			break;
+		case 4:
+			radixStage<4, V>(st, wr, wi, buffers);
+			break;
+		case 5:
+			radixStage<5, V>(st, wr, wi, buffers);
+			break;
+		default:
+			genericStage(st, wr, wi, buffers);
+			break;
+		}
+		srcRe = dstRe;
+		srcIm = dstIm;
+	}
+	// a single point, or a single stage in place, ends outside out
+	if (srcRe != outRe) {
+		std::memcpy(outRe, srcRe, plan.size * sizeof(T));
+		std::memcpy(outIm, srcIm, plan.size * sizeof(T));
+	}
+}
+
+#if NYCO_SIMD_X86
+template <typename T>
+NYCO_SIMD_TARGET_SSE2 NYCO_SIMD_FLATTEN void transformSse2(FFTPlan<T> const& plan, T const* inRe, T const* inIm, T* outRe, T* outIm, T* aRe, T* aIm, T* bRe, T* bIm)
+{
+	transform<simd::sse2::Vec<T>>(plan, inRe, inIm, outRe, outIm, aRe, aIm, bRe, bIm);
+}
+
+template <typename T>
+NYCO_SIMD_TARGET_AVX2 NYCO_SIMD_FLATTEN void transformAvx2(FFTPlan<T> const& plan, T const* inRe, T const* inIm, T* outRe, T* outIm, T* aRe, T* aIm, T* bRe, T* bIm)
+{
+	transform<simd::avx2::Vec<T>>(plan, inRe, inIm, outRe, outIm, aRe, aIm, bRe, bIm);
+}
+#endif
+
+/*
+* runs plan with the butterflies of the selected instruction set, see transform<V>
+*/
+template <typename T>
+void transform(FFTPlan<T> const& plan, T const* inRe, T const* inIm, T* outRe, T* outIm, T* aRe, T* aIm, T* bRe, T* bIm)
+{
+#if NYCO_SIMD_X86
+	switch (simd::instructionSet()) {
+	case simd::InstructionSet::AVX512:
+	case simd::InstructionSet::AVX2:
+		transformAvx2(plan, inRe, inIm, outRe, outIm, aRe, aIm, bRe, bIm);
+		return;
+	case simd::InstructionSet::SSE2:
+		transformSse2(plan, inRe, inIm, outRe, outIm, aRe, aIm, bRe, bIm);
+		return;
+	default:
+		break;
+	}
+#endif
+	transform<simd::scalar::Vec<T>>(plan, inRe, inIm, outRe, outIm, aRe, aIm, bRe, bIm);
+}
+
+#pragma endregion
+
+}
+
+#pragma region FFT<BufferType>
+
+template <typename BufferType>
+FFT<BufferType>::FFT(size_t size, AudioAllocator& allocator)
+	: m_pPlan{ detail::cachedPlan<detail::FFTPlan<BufferType>>(size) }
+	, m_work(4, size, allocator)
+{
+}
+
+template <typename BufferType>
+size_t FFT<BufferType>::size() const
+{
+	return m_pPlan->size;
+}
+
+template <typename BufferType>
+void FFT<BufferType>::forward(AudioStreamView<BufferType const> inRe, AudioStreamView<BufferType const> inIm, AudioStreamView<BufferType> outRe, AudioStreamView<BufferType> outIm)
+{
+	assert(inRe.size() == size() && inIm.size() == size() && outRe.size() == size() && outIm.size() == size());
+	detail::transform(*m_pPlan, inRe.data(), inIm.data(), outRe.data(), outIm.data(),
+		m_work.channel(0).data(), m_work.channel(1).data(), m_work.channel(2).data(), m_work.channel(3).data());
+}
+
+template <typename BufferType>
+void FFT<BufferType>::inverse(AudioStreamView<BufferType const> inRe, AudioStreamView<BufferType const> inIm, AudioStreamView<BufferType> outRe, AudioStreamView<BufferType> outIm)
+{
+	// the inverse DFT is the DFT with the real and imaginary parts swapped on the way in and out
+	forward(inIm, inRe, outIm, outRe);
+}
+
+template <typename BufferType>
+void FFT<BufferType>::forward(AudioStreamView<BufferType> re, AudioStreamView<BufferType> im)
+{
+	forward(AudioStreamView<BufferType const>(re), AudioStreamView<BufferType const>(im), re, im);
+}
+
+template <typename BufferType>
+void FFT<BufferType>::inverse(AudioStreamView<BufferType> re, AudioStreamView<BufferType> im)
+{
+	forward(AudioStreamView<BufferType const>(im), AudioStreamView<BufferType const>(re), im, re);
+}
+
+#pragma endregion
+
+#pragma region RealFFT<BufferType>
+
+template <typename BufferType>
+RealFFT<BufferType>::RealFFT(size_t size, AudioAllocator& allocator)
+	: m_pPlan{ detail::cachedPlan<detail::RealFFTPlan<BufferType>>(size) }
+	, m_work(6, size / 2, allocator)
+{
+}
+
+template <typename BufferType>
+size_t RealFFT<BufferType>::size() const
+{
+	return m_pPlan->size;
+}
+
+template <typename BufferType>
+void RealFFT<BufferType>::forward(AudioStreamView<BufferType const> input, AudioStreamView<BufferType> re, AudioStreamView<BufferType> im)
+{
+	size_t const half = size() / 2;
+	assert(input.size() == size() && re.size() == half && im.size() == half);
+	BufferType* work[6];
+	for (size_t c = 0; c < 6; ++c) {
+		work[c] = m_work.channel(c).data();
+	}
+
+	// the even samples are the real part and the odd ones the imaginary part of a complex signal of half the size
+	conversion::deinterleave(work, input.data(), 2, half);
+	detail::transform(*m_pPlan->half, work[0], work[1], re.data(), im.data(), work[2], work[3], work[4], work[5]);
+
+	// the spectra of the even and odd samples are separated by symmetry, and combined into the spectrum of the whole
+	BufferType* const r = re.data();
+	BufferType* const i = im.data();
+	BufferType const* const wr = m_pPlan->twiddleRe.data();
+	BufferType const* const wi = m_pPlan->twiddleIm.data();
+	BufferType const dc = r[0];
+	r[0] = dc + i[0];
+	i[0] = dc - i[0];
+	for (size_t k = 1; k <= half / 2; ++k) {
+		size_t const j = half - k;
+		// even = (Z[k] + conj(Z[j])) / 2, odd = (Z[k] - conj(Z[j])) / 2i
+		BufferType const er = (r[k] + r[j]) * BufferType(0.5);
+		BufferType const ei = (i[k] - i[j]) * BufferType(0.5);
+		BufferType const orr = (i[k] + i[j]) * BufferType(0.5);
+		BufferType const oi = (r[j] - r[k]) * BufferType(0.5);
+		BufferType const tr = wr[k] * orr - wi[k] * oi;
+		BufferType const ti = wr[k] * oi + wi[k] * orr;
+		r[k] = er + tr;
+		i[k] = ei + ti;
+		r[j] = er - tr;
+		i[j] = ti - ei;
+	}
+}
+
+template <typename BufferType>
+void RealFFT<BufferType>::inverse(AudioStreamView<BufferType const> re, AudioStreamView<BufferType const> im, AudioStreamView<BufferType> output)
+{
+	size_t const half = size() / 2;
+	assert(output.size() == size() && re.size() == half && im.size() == half);
+	BufferType* work[6];
+	for (size_t c = 0; c < 6; ++c) {
+		work[c] = m_work.channel(c).data();
+	}
+
+	// the inverse of forward: the spectra of the even and odd samples are recombined into Z, times 2
+	BufferType const* const r = re.data();
+	BufferType const* const i = im.data();
+	BufferType const* const wr = m_pPlan->twiddleRe.data();
+	BufferType const* const wi = m_pPlan->twiddleIm.data();
+	BufferType* const zr = work[0];
+	BufferType* const zi = work[1];
+	zr[0] = r[0] + i[0];
+	zi[0] = r[0] - i[0];
+	for (size_t k = 1; k <= half / 2; ++k) {
+		size_t const j = half - k;
+		// 2 even = X[k] + conj(X[j]), 2 odd = (X[k] - conj(X[j])) conj(w)
+		BufferType const er = r[k] + r[j];
+		BufferType const ei = i[k] - i[j];
+		BufferType const dr = r[k] - r[j];
+		BufferType const di = i[k] + i[j];
+		BufferType const orr = dr * wr[k] + di * wi[k];
+		BufferType const oi = di * wr[k] - dr * wi[k];
+		zr[k] = er - oi;
+		zi[k] = ei + orr;
+		zr[j] = er + oi;
+		zi[j] = orr - ei;
+	}
+	detail::transform(*m_pPlan->half, zi, zr, work[3], work[2], zi, zr, work[5], work[4]);
+	BufferType const* const planes[2] = { work[2], work[3] };
+	conversion::interleave(output.data(), planes, 2, half);
+}
+
+template <typename BufferType>
+void RealFFT<BufferType>::forward(AudioStreamView<BufferType> data)
+{
+	size_t const half = size() / 2;
+	assert(data.size() == size());
+	forward(AudioStreamView<BufferType const>(data), data.slice(0, half), data.slice(half, half));
+}
+
+template <typename BufferType>
+void RealFFT<BufferType>::inverse(AudioStreamView<BufferType> data)
+{
+	size_t const half = size() / 2;
+	assert(data.size() == size());
+	inverse(AudioStreamView<BufferType const>(data.slice(0, half)), AudioStreamView<BufferType const>(data.slice(half, half)), data);
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_FFT_H
@@ -0,0 +1,1233 @@
+#ifndef NYCOLIB_FIXED_AUDIO_STREAM_H
+#define NYCOLIB_FIXED_AUDIO_STREAM_H
+
+/*
+	Module: FixedAudioStream (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		FixedAudioStream contains the FixedAudioStream class, an AudioStream whose length N is
+		known at compile time and whose samples live inline in the object instead of on the heap.
+		it is meant for small fixed blocks: a frame of SIMD width, a 64 sample block, a filter kernel.
+		nothing is allocated and nothing is reference counted, and every loop runs over a constant
+		N so the compiler unrolls and vectorizes it for that size.
+
+		unlike AudioStream a FixedAudioStream is a plain value: it is copyable, the operators
+		compute their result right away instead of building an expression, and everything except
+		the conversions to AudioStreamView (and %, which uses std::fmod) is constexpr, so tables
+		can be built at compile time with generate.
+		view() gives an AudioStreamView, which is how a FixedAudioStream takes part in expressions
+		with AudioStreams and is passed to the rest of the library.
+
+*/
+
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+#include <assert.h>
+
+#include "operations.h"
+#include "AudioAllocator.h"
+#include "AudioStreamView.h"
+
+
+#pragma region nyco - FixedAudioStream - Declarations
+
+namespace nyco {
+
+namespace detail {
+/*
+* returns the alignment of the inline buffer of N samples of BufferType.
+* the buffer is aligned to its own size rounded up to a power of 2, up to AudioAllocator::ALIGNMENT,
+* so a block is aligned like a heap buffer but an array of 4 sample frames is not padded to 64 bytes
+*/
+template <typename BufferType, size_t N>
+constexpr size_t fixedAlignment();
+}
+
+template <typename BufferType, size_t N>
+class FixedAudioStream {
+	static_assert(N > 0, "a FixedAudioStream holds at least one sample");
+
+#pragma region Types
+public:
+
+	using value_type = BufferType;
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new FixedAudioStream of N zeroed samples
+	*/
+	constexpr FixedAudioStream();
+
+	/*
+	* constructs a new FixedAudioStream holding the given samples
+	*/
+	constexpr explicit FixedAudioStream(std::array<BufferType, N> const& samples);
+
+	/*
+	* constructs a new FixedAudioStream by copying the samples of view, which must hold N samples
+	*/
+	explicit FixedAudioStream(AudioStreamView<BufferType const> view);
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* does in-place transformation of the stream by the given function
+	* applies func over every elements and assigns the result where the element was in the buffer
+	*/
+	template <typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+		constexpr FixedAudioStream<BufferType, N>& transform(Function&& func);
+
+	/*
+	* does in-place transformation of the stream by the given function and the given stream
+	* applies func over every elements and assigns the result where the element was in the buffer
+	*/
+	template <typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+		constexpr FixedAudioStream<BufferType, N>& transform(Function&& func, FixedAudioStream<BufferType, N> const& other);
+
+	/*
+	* assigns value to every sample
+	*/
+	constexpr FixedAudioStream<BufferType, N>& fill(BufferType const& value);
+
+	/*
+	* shifts all elements in the stream to the left, the vacated elements are zeroed
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N>& shiftLeft(IntegralT const o);
+
+	/*
+	* shifts all elements in the stream to the right, the vacated elements are zeroed
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N>& shiftRight(IntegralT const o);
+
+	/*
+	* shifts (rotates) all elements in the stream to the left
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N>& rotateLeft(IntegralT const o);
+
+	/*
+	* shifts (rotates) all elements in the stream to the right
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N>& rotateRight(IntegralT const o);
+
+	/*
+	* returns a pointer to the first element of this FixedAudioStream
+	*/
+	constexpr BufferType* begin();
+
+	/*
+	* returns a const pointer to the first element of this FixedAudioStream
+	*/
+	constexpr BufferType const* begin() const;
+
+	/*
+	* returns a pointer past the last element of this FixedAudioStream
+	*/
+	constexpr BufferType* end();
+
+	/*
+	* returns a const pointer past the last element of this FixedAudioStream
+	*/
+	constexpr BufferType const* end() const;
+
+	/*
+	* returns the length of this FixedAudioStream, which is N
+	*/
+	static constexpr size_t size();
+
+	/*
+	* returns a non-owning view over the samples of this FixedAudioStream
+	*/
+	AudioStreamView<BufferType> view();
+
+	/*
+	* returns a non-owning read-only view over the samples of this FixedAudioStream
+	*/
+	AudioStreamView<BufferType const> view() const;
+
+#pragma endregion
+
+#pragma region Static Methods
+public:
+
+	/*
+	* creates a new FixedAudioStream where the i-th sample is func(i)
+	* with a constexpr func this builds a table at compile time, e.g. a window or a wavetable
+	*/
+	template <typename Function>
+	requires (std::is_convertible_v<std::invoke_result_t<Function, size_t>, BufferType>)
+		static constexpr FixedAudioStream<BufferType, N> generate(Function&& func);
+
+#pragma endregion
+
+#pragma region Operator Overloading
+
+#pragma region Binary Operators
+
+#pragma region FixedAudioStream<BufferType, N> OP FixedAudioStream<BufferType, N>
+public:
+
+	// FixedAudioStream<BufferType, N> >> FixedAudioStream<BufferType, M>
+	/*
+	* concats two FixedAudioStreams. this is inserted before o
+	*/
+	template <size_t M>
+	constexpr FixedAudioStream<BufferType, N + M> operator>>(FixedAudioStream<BufferType, M> const& o) const;
+
+	// FixedAudioStream<BufferType, N> << FixedAudioStream<BufferType, M>
+	/*
+	* concats two FixedAudioStreams. this is appended to o
+	*/
+	template <size_t M>
+	constexpr FixedAudioStream<BufferType, N + M> operator<<(FixedAudioStream<BufferType, M> const& o) const;
+
+	// FixedAudioStream<BufferType, N> += FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise addition
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator+=(FixedAudioStream<BufferType, N> const& o);
+
+	// FixedAudioStream<BufferType, N> -= FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise subtraction
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator-=(FixedAudioStream<BufferType, N> const& o);
+
+	// FixedAudioStream<BufferType, N> *= FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise multiplication
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator*=(FixedAudioStream<BufferType, N> const& o);
+
+	// FixedAudioStream<BufferType, N> /= FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise division
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator/=(FixedAudioStream<BufferType, N> const& o);
+
+	// FixedAudioStream<BufferType, N> %= FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise modulous
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator%=(FixedAudioStream<BufferType, N> const& o);
+
+	// FixedAudioStream<BufferType, N> ^= FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise XOR
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator^=(FixedAudioStream<BufferType, N> const& o);
+
+	// FixedAudioStream<BufferType, N> &= FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise AND
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator&=(FixedAudioStream<BufferType, N> const& o);
+
+	// FixedAudioStream<BufferType, N> |= FixedAudioStream<BufferType, N>
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of member-wise OR
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator|=(FixedAudioStream<BufferType, N> const& o);
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> OP BufferType
+public:
+
+	// FixedAudioStream<BufferType, N> += BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are shifted up by o
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator+=(BufferType const& o);
+
+	// FixedAudioStream<BufferType, N> -= BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are shifted down by o
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator-=(BufferType const& o);
+
+	// FixedAudioStream<BufferType, N> *= BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are scaled by o
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator*=(BufferType const& o);
+
+	// FixedAudioStream<BufferType, N> /= BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are scaled inversly by o
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator/=(BufferType const& o);
+
+	// FixedAudioStream<BufferType, N> %= BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the remainder of the division by o
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator%=(BufferType const& o);
+
+	// FixedAudioStream<BufferType, N> ^= BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of a XOR
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator^=(BufferType const& o);
+
+	// FixedAudioStream<BufferType, N> &= BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of a AND
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator&=(BufferType const& o);
+
+	// FixedAudioStream<BufferType, N> |= BufferType
+	/*
+	* does in-place transformation of this FixedAudioStream where all members are the result of a OR
+	*/
+	constexpr FixedAudioStream<BufferType, N>& operator|=(BufferType const& o);
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> shift by integral
+public:
+
+	// FixedAudioStream<BufferType, N> << integral
+	/*
+	* returns a copy of the FixedAudioStream where all elements in the stream are shifted to the left
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N> operator<<(IntegralT const o) const;
+
+	// FixedAudioStream<BufferType, N> >> integral
+	/*
+	* returns a copy of the FixedAudioStream where all elements in the stream are shifted to the right
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N> operator>>(IntegralT const o) const;
+
+	// FixedAudioStream<BufferType, N> <<= integral
+	/*
+	* shifts all elements in the stream to the left
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N>& operator<<=(IntegralT const o);
+
+	// FixedAudioStream<BufferType, N> >>= integral
+	/*
+	* shifts all elements in the stream to the right
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr FixedAudioStream<BufferType, N>& operator>>=(IntegralT const o);
+
+#pragma endregion
+
+#pragma region Comparison Operators
+public:
+
+	// FixedAudioStream<BufferType, N> == FixedAudioStream<BufferType, N>
+	/*
+	* returns true if both FixedAudioStreams hold the same samples
+	*/
+	constexpr bool operator==(FixedAudioStream<BufferType, N> const& o) const = default;
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region Unary Operators
+public:
+
+	// + FixedAudioStream<BufferType, N>
+	/*
+	* returns a copy of this FixedAudioStream
+	*/
+	constexpr FixedAudioStream<BufferType, N> operator+() const;
+
+	// - FixedAudioStream<BufferType, N>
+	/*
+	* returns a copy of this FixedAudioStream where all members are negated
+	*/
+	constexpr FixedAudioStream<BufferType, N> operator-() const;
+
+	// ~ FixedAudioStream<BufferType, N>
+	/*
+	* returns a copy of this FixedAudioStream where all members are bitwise-not
+	*/
+	constexpr FixedAudioStream<BufferType, N> operator~() const;
+
+#pragma endregion
+
+#pragma region Indexing Operators
+public:
+
+	// FixedAudioStream<BufferType, N>[integral]
+	/*
+	* returns the i-th element in this FixedAudioStream, a negative i counts from the end
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr BufferType& operator[](IntegralT i);
+
+	// FixedAudioStream<BufferType, N>[integral]
+	/*
+	* returns the i-th element in this FixedAudioStream, a negative i counts from the end
+	*/
+	template <typename IntegralT>
+	requires (std::is_integral_v<IntegralT>)
+		constexpr BufferType const& operator[](IntegralT i) const;
+
+#pragma endregion
+
+#pragma region Conversion Operators
+public:
+
+	// AudioStreamView<BufferType>(FixedAudioStream<BufferType, N>)
+	/*
+	* converts to a non-owning view, so a FixedAudioStream can be passed where a view is expected
+	*/
+	operator AudioStreamView<BufferType>();
+
+	// AudioStreamView<BufferType const>(FixedAudioStream<BufferType, N>)
+	/*
+	* converts to a non-owning read-only view
+	*/
+	operator AudioStreamView<BufferType const>() const;
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region Private Methods
+private:
+
+	/*
+	* assigns Op over every pair of samples of this and o to this
+	*/
+	template <typename Op>
+	constexpr FixedAudioStream<BufferType, N>& apply(FixedAudioStream<BufferType, N> const& o);
+
+	/*
+	* assigns Op over every sample of this and o to this
+	*/
+	template <typename Op>
+	constexpr FixedAudioStream<BufferType, N>& apply(BufferType const& o);
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	alignas(detail::fixedAlignment<BufferType, N>()) BufferType m_buffer[N];
+
+#pragma endregion
+
+};
+
+#pragma region FixedAudioStream<BufferType, N> free operators
+
+// FixedAudioStream<BufferType, N> + FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise addition
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator+(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> - FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise subtraction
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator-(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> * FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise multiplication
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator*(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> / FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise division
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator/(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> % FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise modulous
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator%(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> ^ FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise XOR
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator^(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> & FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise AND
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator&(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> | FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise OR
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator|(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b);
+
+// FixedAudioStream<BufferType, N> + BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise addition with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator+(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// FixedAudioStream<BufferType, N> - BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise subtraction with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator-(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// FixedAudioStream<BufferType, N> * BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise multiplication with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator*(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// FixedAudioStream<BufferType, N> / BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise division with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator/(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// FixedAudioStream<BufferType, N> % BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise modulous with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator%(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// FixedAudioStream<BufferType, N> ^ BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise XOR with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator^(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// FixedAudioStream<BufferType, N> & BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise AND with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator&(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// FixedAudioStream<BufferType, N> | BufferType
+/*
+* returns a FixedAudioStream where all members are the result of member-wise OR with b
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator|(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b);
+
+// BufferType + FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise addition of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator+(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+// BufferType - FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise subtraction of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator-(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+// BufferType * FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise multiplication of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator*(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+// BufferType / FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise division of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator/(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+// BufferType % FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise modulous of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator%(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+// BufferType ^ FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise XOR of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator^(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+// BufferType & FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise AND of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator&(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+// BufferType | FixedAudioStream<BufferType, N>
+/*
+* returns a FixedAudioStream where all members are the result of member-wise OR of a with them
+*/
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator|(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b);
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#pragma region nyco - FixedAudioStream - Definitions
+
+namespace nyco {
+
+namespace detail {
+template <typename BufferType, size_t N>
+constexpr size_t fixedAlignment()
+{
+	size_t const alignment = std::bit_ceil(sizeof(BufferType) * N);
+	return std::max(alignof(BufferType), std::min(alignment, AudioAllocator::ALIGNMENT));
+}
+}
+
+#pragma region FixedAudioStream<BufferType, N>
+
+#pragma region FixedAudioStream<BufferType, N> - Constructors
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>::FixedAudioStream()
+	: m_buffer{}
+{
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>::FixedAudioStream(std::array<BufferType, N> const& samples)
+	: m_buffer{}
+{
+	std::copy_n(samples.begin(), N, m_buffer);
+}
+
+template <typename BufferType, size_t N>
+FixedAudioStream<BufferType, N>::FixedAudioStream(AudioStreamView<BufferType const> view)
+	: m_buffer{}
+{
+	assert(view.size() == N);
+	std::copy_n(view.begin(), N, m_buffer);
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - Methods
+
+template <typename BufferType, size_t N>
+template <typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::transform(Function&& func)
+{
+	for (size_t i = 0; i < N; ++i) {
+		m_buffer[i] = func(m_buffer[i]);
+	}
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+template <typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::transform(Function&& func, FixedAudioStream<BufferType, N> const& other)
+{
+	for (size_t i = 0; i < N; ++i) {
+		m_buffer[i] = func(m_buffer[i], other.m_buffer[i]);
+	}
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::fill(BufferType const& value)
+{
+	std::fill_n(m_buffer, N, value);
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::shiftLeft(IntegralT const o)
+{
+	return (*this) <<= o;
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::shiftRight(IntegralT const o)
+{
+	return (*this) >>= o;
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::rotateLeft(IntegralT const o)
+{
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return rotateRight(-static_cast<long long>(o));
+		}
+	}
+	std::rotate(m_buffer, m_buffer + static_cast<size_t>(o) % N, m_buffer + N);
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::rotateRight(IntegralT const o)
+{
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return rotateLeft(-static_cast<long long>(o));
+		}
+	}
+	std::rotate(m_buffer, m_buffer + (N - static_cast<size_t>(o) % N) % N, m_buffer + N);
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+constexpr BufferType* FixedAudioStream<BufferType, N>::begin()
+{
+	return m_buffer;
+}
+
+template <typename BufferType, size_t N>
+constexpr BufferType const* FixedAudioStream<BufferType, N>::begin() const
+{
+	return m_buffer;
+}
+
+template <typename BufferType, size_t N>
+constexpr BufferType* FixedAudioStream<BufferType, N>::end()
+{
+	return m_buffer + N;
+}
+
+template <typename BufferType, size_t N>
+constexpr BufferType const* FixedAudioStream<BufferType, N>::end() const
+{
+	return m_buffer + N;
+}
+
+template <typename BufferType, size_t N>
+constexpr size_t FixedAudioStream<BufferType, N>::size()
+{
+	return N;
+}
+
+template <typename BufferType, size_t N>
+AudioStreamView<BufferType> FixedAudioStream<BufferType, N>::view()
+{
+	return AudioStreamView<BufferType>(m_buffer, N);
+}
+
+template <typename BufferType, size_t N>
+AudioStreamView<BufferType const> FixedAudioStream<BufferType, N>::view() const
+{
+	return AudioStreamView<BufferType const>(m_buffer, N);
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - Static Methods
+
+template <typename BufferType, size_t N>
+template <typename Function>
+requires (std::is_convertible_v<std::invoke_result_t<Function, size_t>, BufferType>)
+constexpr FixedAudioStream<BufferType, N> FixedAudioStream<BufferType, N>::generate(Function&& func)
+{
+	FixedAudioStream<BufferType, N> stream;
+	for (size_t i = 0; i < N; ++i) {
+		stream.m_buffer[i] = static_cast<BufferType>(func(i));
+	}
+	return stream;
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - OPs
+
+#pragma region FixedAudioStream<BufferType, N> - OPs - Binary OPs - FixedAudioStream<BufferType, N> OP FixedAudioStream<BufferType, N>
+
+template <typename BufferType, size_t N>
+template <size_t M>
+constexpr FixedAudioStream<BufferType, N + M> FixedAudioStream<BufferType, N>::operator>>(FixedAudioStream<BufferType, M> const& o) const
+{
+	FixedAudioStream<BufferType, N + M> stream;
+	std::copy_n(m_buffer, N, stream.begin());
+	std::copy_n(o.begin(), M, stream.begin() + N);
+	return stream;
+}
+
+template <typename BufferType, size_t N>
+template <size_t M>
+constexpr FixedAudioStream<BufferType, N + M> FixedAudioStream<BufferType, N>::operator<<(FixedAudioStream<BufferType, M> const& o) const
+{
+	return (*this) >> o;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator+=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::Add>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator-=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::Subtract>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator*=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::Multiply>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator/=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::Divide>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator%=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::Modulo>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator^=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::BitwiseXor>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator&=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::BitwiseAnd>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator|=(FixedAudioStream<BufferType, N> const& o)
+{
+	return apply<operations::BitwiseOr>(o);
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - OPs - Binary OPs - FixedAudioStream<BufferType, N> OP BufferType
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator+=(BufferType const& o)
+{
+	return apply<operations::Add>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator-=(BufferType const& o)
+{
+	return apply<operations::Subtract>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator*=(BufferType const& o)
+{
+	return apply<operations::Multiply>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator/=(BufferType const& o)
+{
+	return apply<operations::Divide>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator%=(BufferType const& o)
+{
+	return apply<operations::Modulo>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator^=(BufferType const& o)
+{
+	return apply<operations::BitwiseXor>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator&=(BufferType const& o)
+{
+	return apply<operations::BitwiseAnd>(o);
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator|=(BufferType const& o)
+{
+	return apply<operations::BitwiseOr>(o);
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - OPs - Binary OPs - FixedAudioStream<BufferType, N> OP Integral
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N> FixedAudioStream<BufferType, N>::operator<<(IntegralT const o) const
+{
+	FixedAudioStream<BufferType, N> stream = *this;
+	stream <<= o;
+	return stream;
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N> FixedAudioStream<BufferType, N>::operator>>(IntegralT const o) const
+{
+	FixedAudioStream<BufferType, N> stream = *this;
+	stream >>= o;
+	return stream;
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator<<=(IntegralT const o)
+{
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return (*this) >>= -static_cast<long long>(o);
+		}
+	}
+	size_t const shift = static_cast<size_t>(o) % N;
+	std::copy(m_buffer + shift, m_buffer + N, m_buffer);
+	std::fill(m_buffer + N - shift, m_buffer + N, BufferType{});
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::operator>>=(IntegralT const o)
+{
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (o < 0) {
+			return (*this) <<= -static_cast<long long>(o);
+		}
+	}
+	size_t const shift = static_cast<size_t>(o) % N;
+	std::copy_backward(m_buffer, m_buffer + N - shift, m_buffer + N);
+	std::fill(m_buffer, m_buffer + shift, BufferType{});
+	return *this;
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - OPs - Unary OPs
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> FixedAudioStream<BufferType, N>::operator+() const
+{
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> FixedAudioStream<BufferType, N>::operator-() const
+{
+	FixedAudioStream<BufferType, N> stream = *this;
+	return stream.transform(operations::Negate{});
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> FixedAudioStream<BufferType, N>::operator~() const
+{
+	FixedAudioStream<BufferType, N> stream = *this;
+	return stream.transform(operations::BitwiseNot{});
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - OPs - Indexers
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr BufferType& FixedAudioStream<BufferType, N>::operator[](IntegralT x)
+{
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (x < 0) {
+			x += static_cast<IntegralT>(N);
+		}
+		assert(x >= 0);
+	}
+	assert(static_cast<size_t>(x) < N);
+	return m_buffer[static_cast<size_t>(x)];
+}
+
+template <typename BufferType, size_t N>
+template <typename IntegralT>
+requires (std::is_integral_v<IntegralT>)
+constexpr BufferType const& FixedAudioStream<BufferType, N>::operator[](IntegralT x) const
+{
+	if constexpr (std::is_signed_v<IntegralT>) {
+		if (x < 0) {
+			x += static_cast<IntegralT>(N);
+		}
+		assert(x >= 0);
+	}
+	assert(static_cast<size_t>(x) < N);
+	return m_buffer[static_cast<size_t>(x)];
+}
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - OPs - Conversions
+
+template <typename BufferType, size_t N>
+FixedAudioStream<BufferType, N>::operator AudioStreamView<BufferType>()
+{
+	return view();
+}
+
+template <typename BufferType, size_t N>
+FixedAudioStream<BufferType, N>::operator AudioStreamView<BufferType const>() const
+{
+	return view();
+}
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - Private Methods
+
+template <typename BufferType, size_t N>
+template <typename Op>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::apply(FixedAudioStream<BufferType, N> const& o)
+{
+	// N is a constant, so the compiler unrolls and vectorizes this loop for the exact size
+	for (size_t i = 0; i < N; ++i) {
+		m_buffer[i] = Op{}(m_buffer[i], o.m_buffer[i]);
+	}
+	return *this;
+}
+
+template <typename BufferType, size_t N>
+template <typename Op>
+constexpr FixedAudioStream<BufferType, N>& FixedAudioStream<BufferType, N>::apply(BufferType const& o)
+{
+	for (size_t i = 0; i < N; ++i) {
+		m_buffer[i] = Op{}(m_buffer[i], o);
+	}
+	return *this;
+}
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region FixedAudioStream<BufferType, N> - Free Operators
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator+(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a += b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator-(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a -= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator*(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a *= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator/(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a /= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator%(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a %= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator^(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a ^= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator&(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a &= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator|(FixedAudioStream<BufferType, N> a, FixedAudioStream<BufferType, N> const& b)
+{
+	return a |= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator+(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a += b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator-(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a -= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator*(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a *= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator/(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a /= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator%(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a %= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator^(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a ^= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator&(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a &= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator|(FixedAudioStream<BufferType, N> a, std::type_identity_t<BufferType> const& b)
+{
+	return a |= b;
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator+(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::Add{}(a, b[i]); });
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator-(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::Subtract{}(a, b[i]); });
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator*(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::Multiply{}(a, b[i]); });
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator/(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::Divide{}(a, b[i]); });
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator%(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::Modulo{}(a, b[i]); });
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator^(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::BitwiseXor{}(a, b[i]); });
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator&(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::BitwiseAnd{}(a, b[i]); });
+}
+
+template <typename BufferType, size_t N>
+constexpr FixedAudioStream<BufferType, N> operator|(std::type_identity_t<BufferType> const& a, FixedAudioStream<BufferType, N> const& b)
+{
+	return FixedAudioStream<BufferType, N>::generate([&](size_t i) { return operations::BitwiseOr{}(a, b[i]); });
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_FIXED_AUDIO_STREAM_H
@@ -0,0 +1,503 @@
+#ifndef NYCOLIB_METERING_H
+#define NYCOLIB_METERING_H
+
+/*
+	Module: Metering (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		Metering contains the Statistics struct, the statistics functions and the
+		TruePeakMeter class, the reductions used to meter streams.
+
+		statistics computes the minimum, the maximum, the sum, the sum of squares and the
+		number of samples louder than a threshold in a single pass, so the peak, the RMS and
+		the DC offset of a stream cost one read of it. the pass is vectorized with the Vec
+		types of SimdKernels for the selected instruction set, the sums are kept in the
+		sample type for a tile at a time and in double across tiles.
+		statistics takes a view or a stream, a rotated stream is read through its segments.
+
+		Statistics of consecutive blocks (or of the chunks of a parallel pass) merge with +=,
+		so a meter accumulates a stream block by block.
+
+		TruePeakMeter estimates the peak of the continuous signal between the samples, by
+		oversampling every block with a Resampler (4 times by default, as in ITU-R BS.1770).
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <assert.h>
+
+#include "operations.h"
+#include "SimdKernels.h"
+#include "ExecutionPolicy.h"
+#include "AudioAllocator.h"
+#include "AudioStreamView.h"
+#include "AudioStream.h"
+#include "MultiChannelAudioStream.h"
+#include "Resampler.h"
+
+
+#pragma region nyco - Metering - Declarations
+
+namespace nyco {
+
+/*
+* the reductions of a stream, or of several blocks merged with +=
+*/
+template <typename BufferType>
+struct Statistics {
+
+	/*
+	* returns the largest absolute sample
+	*/
+	BufferType peak() const;
+
+	/*
+	* returns the root mean square of the samples
+	*/
+	BufferType rms() const;
+
+	/*
+	* returns the mean of the samples
+	*/
+	BufferType dcOffset() const;
+
+	/*
+	* merges the statistics of other, of samples disjoint from these
+	*/
+	Statistics<BufferType>& operator+=(Statistics<BufferType> const& other);
+
+	size_t count = 0;
+
+	// the samples whose absolute value is greater than the threshold
+	size_t above = 0;
+
+	BufferType minimum = std::numeric_limits<BufferType>::infinity();
+	BufferType maximum = -std::numeric_limits<BufferType>::infinity();
+	double sum = 0.0;
+	double sumOfSquares = 0.0;
+};
+
+/*
+* returns the statistics of stream, counting the samples whose absolute value is greater than threshold
+*/
+template <typename BufferType>
+Statistics<BufferType> statistics(AudioStreamView<BufferType const> stream, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* same as statistics(AudioStreamView<BufferType const>(stream), threshold)
+*/
+template <typename BufferType>
+	requires (!std::is_const_v<BufferType>)
+Statistics<BufferType> statistics(AudioStreamView<BufferType> stream, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* returns the statistics of the samples of stream, a rotated stream is read through its segments
+*/
+template <typename BufferType, typename Ownership>
+Statistics<BufferType> statistics(AudioStreamBase<BufferType, Ownership> const& stream, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* same as statistics(stream, threshold), with stream split into chunks run by the execution policy
+*/
+template <execution::Policy P, typename BufferType>
+Statistics<BufferType> statistics(P const& policy, AudioStreamView<BufferType const> stream, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* same as statistics(policy, AudioStreamView<BufferType const>(stream), threshold)
+*/
+template <execution::Policy P, typename BufferType>
+	requires (!std::is_const_v<BufferType>)
+Statistics<BufferType> statistics(P const& policy, AudioStreamView<BufferType> stream, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* same as statistics(stream, threshold), with the segments of stream split into chunks run by the execution policy
+*/
+template <execution::Policy P, typename BufferType, typename Ownership>
+Statistics<BufferType> statistics(P const& policy, AudioStreamBase<BufferType, Ownership> const& stream, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* out[c] = statistics(streams[c], threshold) for every channel
+*/
+template <typename BufferType>
+void statistics(MultiChannelAudioStream<BufferType> const& streams, Statistics<BufferType>* out, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* same as statistics(streams, out, threshold), with the channels run by the execution policy
+*/
+template <execution::Policy P, typename BufferType>
+void statistics(P const& policy, MultiChannelAudioStream<BufferType> const& streams, Statistics<BufferType>* out, std::type_identity_t<BufferType> threshold = std::numeric_limits<BufferType>::infinity());
+
+/*
+* a streaming true-peak (inter-sample peak) estimator of a single channel
+*/
+template <typename BufferType>
+class TruePeakMeter {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new TruePeakMeter<BufferType> oversampling by the given factor, with its buffers from allocator
+	*/
+	explicit TruePeakMeter(size_t oversampling = 4, ResamplerQuality quality = ResamplerQuality::Fast, AudioAllocator& allocator = defaultAllocator());
+
+	TruePeakMeter(TruePeakMeter<BufferType> const&) = delete;
+
+	TruePeakMeter(TruePeakMeter<BufferType>&&) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* meters the next block of the stream, and returns its true peak
+	*/
+	BufferType process(AudioStreamView<BufferType const> block);
+
+	/*
+	* returns the true peak of every block since the construction or the last reset
+	*/
+	BufferType peak() const;
+
+	/*
+	* forgets the past blocks
+	*/
+	void reset();
+
+#pragma endregion
+
+	TruePeakMeter<BufferType>& operator=(TruePeakMeter<BufferType> const&) = delete;
+
+	TruePeakMeter<BufferType>& operator=(TruePeakMeter<BufferType>&&) = default;
+
+#pragma region Private Members
+private:
+
+	// the input samples oversampled at a time
+	static constexpr size_t CHUNK_SIZE = 1024;
+
+	Resampler<BufferType> m_resampler;
+
+	MultiChannelAudioStream<BufferType> m_oversampled;
+
+	BufferType m_peak;
+
+#pragma endregion
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - Metering - Definitions
+
+namespace nyco {
+
+#pragma region Statistics<BufferType>
+
+template <typename BufferType>
+BufferType Statistics<BufferType>::peak() const
+{
+	return count == 0 ? BufferType(0) : std::max(std::abs(minimum), std::abs(maximum));
+}
+
+template <typename BufferType>
+BufferType Statistics<BufferType>::rms() const
+{
+	return count == 0 ? BufferType(0) : BufferType(std::sqrt(sumOfSquares / double(count)));
+}
+
+template <typename BufferType>
+BufferType Statistics<BufferType>::dcOffset() const
+{
+	return count == 0 ? BufferType(0) : BufferType(sum / double(count));
+}
+
+template <typename BufferType>
+Statistics<BufferType>& Statistics<BufferType>::operator+=(Statistics<BufferType> const& other)
+{
+	count += other.count;
+	above += other.above;
+	minimum = std::min(minimum, other.minimum);
+	maximum = std::max(maximum, other.maximum);
+	sum += other.sum;
+	sumOfSquares += other.sumOfSquares;
+	return *this;
+}
+
+#pragma endregion
+
+namespace detail {
+
+#pragma region Kernels
+
+// the samples whose sums are kept in the sample type before they are added to the double sums
+inline constexpr size_t STATISTICS_TILE_SIZE = 4096;
+
+// reduceLanes and statisticsOf are not compiled for the instruction set of V, their registers only reach V by reference
+template <typename V, typename T>
+T reduceLanes(typename V::reg const& v)
+{
+	T lanes[V::width];
+	V::store(lanes, v);
+	T sum = T(0);
+	for (size_t i = 0; i < V::width; ++i) {
+		sum += lanes[i];
+	}
+	return sum;
+}
+
+/*
+* statistics of data[0, length), Count when the samples above threshold are counted
+*/
+template <typename V, bool Count, typename T>
+Statistics<T> statisticsOf(T const* data, size_t length, T threshold)
+{
+	using reg = typename V::reg;
+	Statistics<T> result;
+	result.count = length;
+	reg minimum;
+	reg maximum;
+	reg high;
+	reg low;
+	V::broadcast(minimum, std::numeric_limits<T>::infinity());
+	V::broadcast(maximum, -std::numeric_limits<T>::infinity());
+	V::broadcast(high, threshold);
+	V::broadcast(low, -threshold);
+
+	size_t i = 0;
+	while (i + V::width <= length) {
+		size_t const tileEnd = std::min(length, i + STATISTICS_TILE_SIZE);
+		reg sum;
+		reg sumOfSquares;
+		reg above;
+		V::broadcast(sum, T(0));
+		V::broadcast(sumOfSquares, T(0));
+		V::broadcast(above, T(0));
+		for (; i + V::width <= tileEnd; i += V::width) {
+			reg x;
+			V::load(x, data + i);
+			V::apply(operations::Minimum{}, minimum, minimum, x);
+			V::apply(operations::Maximum{}, maximum, maximum, x);
+			V::apply(operations::Add{}, sum, sum, x);
+			V::multiplyAdd(sumOfSquares, x, x, sumOfSquares);
+			if constexpr (Count) {
+				// |x| > t is x > t or -t > x, which never both hold for t >= 0
+				reg over;
+				reg under;
+				V::apply(operations::Greater{}, over, x, high);
+				V::apply(operations::Greater{}, under, low, x);
+				V::apply(operations::Add{}, over, over, under);
+				V::apply(operations::Add{}, above, above, over);
+			}
+		}
+		result.sum += double(reduceLanes<V, T>(sum));
+		result.sumOfSquares += double(reduceLanes<V, T>(sumOfSquares));
+		if constexpr (Count) {
+			result.above += size_t(reduceLanes<V, T>(above));
+		}
+	}
+
+	T lanes[V::width];
+	V::store(lanes, minimum);
+	for (size_t j = 0; j < V::width; ++j) {
+		result.minimum = std::min(result.minimum, lanes[j]);
+	}
+	V::store(lanes, maximum);
+	for (size_t j = 0; j < V::width; ++j) {
+		result.maximum = std::max(result.maximum, lanes[j]);
+	}
+	for (; i < length; ++i) {
+		T const x = data[i];
+		result.minimum = std::min(result.minimum, x);
+		result.maximum = std::max(result.maximum, x);
+		result.sum += double(x);
+		result.sumOfSquares += double(x) * double(x);
+		if constexpr (Count) {
+			result.above += std::abs(x) > threshold ? 1 : 0;
+		}
+	}
+	return result;
+}
+
+template <typename V, typename T>
+Statistics<T> statisticsOf(T const* data, size_t length, T threshold)
+{
+	if (threshold == std::numeric_limits<T>::infinity()) {
+		return statisticsOf<V, false>(data, length, threshold);
+	}
+	return statisticsOf<V, true>(data, length, threshold);
+}
+
+#if NYCO_SIMD_X86
+template <typename T>
+NYCO_SIMD_TARGET_SSE2 NYCO_SIMD_FLATTEN Statistics<T> statisticsSse2(T const* data, size_t length, T threshold)
+{
+	return statisticsOf<simd::sse2::Vec<T>>(data, length, threshold);
+}
+
+template <typename T>
+NYCO_SIMD_TARGET_AVX2 NYCO_SIMD_FLATTEN Statistics<T> statisticsAvx2(T const* data, size_t length, T threshold)
+{
+	return statisticsOf<simd::avx2::Vec<T>>(data, length, threshold);
+}
+
+template <typename T>
+NYCO_SIMD_TARGET_AVX512 NYCO_SIMD_FLATTEN Statistics<T> statisticsAvx512(T const* data, size_t length, T threshold)
+{
+	return statisticsOf<simd::avx512::Vec<T>>(data, length, threshold);
+}
+#endif
+
+/*
+* statisticsOf with the selected instruction set
+*/
+template <typename T>
+Statistics<T> statisticsOf(T const* data, size_t length, T threshold)
+{
+	static_assert(std::is_floating_point_v<T>, "statistics reduces float or double streams");
+	assert(threshold >= T(0));
+#if NYCO_SIMD_X86
+	switch (simd::instructionSet()) {
+	case simd::InstructionSet::AVX512:
+		return statisticsAvx512(data, length, threshold);
+	case simd::InstructionSet::AVX2:
+		return statisticsAvx2(data, length, threshold);
+	case simd::InstructionSet::SSE2:
+		return statisticsSse2(data, length, threshold);
+	default:
+		break;
+	}
+#endif
+	return statisticsOf<simd::scalar::Vec<T>>(data, length, threshold);
+}
+
+#pragma endregion
+
+}
+
+template <typename BufferType>
+Statistics<BufferType> statistics(AudioStreamView<BufferType const> stream, std::type_identity_t<BufferType> threshold)
+{
+	return detail::statisticsOf(stream.data(), stream.size(), threshold);
+}
+
+template <typename BufferType>
+	requires (!std::is_const_v<BufferType>)
+Statistics<BufferType> statistics(AudioStreamView<BufferType> stream, std::type_identity_t<BufferType> threshold)
+{
+	return statistics(AudioStreamView<BufferType const>(stream), threshold);
+}
+
+template <typename BufferType, typename Ownership>
+Statistics<BufferType> statistics(AudioStreamBase<BufferType, Ownership> const& stream, std::type_identity_t<BufferType> threshold)
+{
+	Statistics<BufferType> result;
+	for (AudioStreamView<BufferType const> const& segment : stream.segments()) {
+		result += statistics(segment, threshold);
+	}
+	return result;
+}
+
+template <execution::Policy P, typename BufferType>
+Statistics<BufferType> statistics(P const& policy, AudioStreamView<BufferType const> stream, std::type_identity_t<BufferType> threshold)
+{
+	Statistics<BufferType> result;
+	std::mutex lock;
+	execution::forEachChunk(policy, stream.size(), sizeof(BufferType), [&](size_t begin, size_t end) {
+		Statistics<BufferType> const chunk = detail::statisticsOf(stream.data() + begin, end - begin, threshold);
+		std::lock_guard<std::mutex> guard(lock);
+		result += chunk;
+	});
+	return result;
+}
+
+template <execution::Policy P, typename BufferType>
+	requires (!std::is_const_v<BufferType>)
+Statistics<BufferType> statistics(P const& policy, AudioStreamView<BufferType> stream, std::type_identity_t<BufferType> threshold)
+{
+	return statistics(policy, AudioStreamView<BufferType const>(stream), threshold);
+}
+
+template <execution::Policy P, typename BufferType, typename Ownership>
+Statistics<BufferType> statistics(P const& policy, AudioStreamBase<BufferType, Ownership> const& stream, std::type_identity_t<BufferType> threshold)
+{
+	Statistics<BufferType> result;
+	for (AudioStreamView<BufferType const> const& segment : stream.segments()) {
+		result += statistics(policy, segment, threshold);
+	}
+	return result;
+}
+
+template <typename BufferType>
+void statistics(MultiChannelAudioStream<BufferType> const& streams, Statistics<BufferType>* out, std::type_identity_t<BufferType> threshold)
+{
+	for (size_t c = 0; c < streams.channels(); ++c) {
+		out[c] = statistics(streams.channel(c), threshold);
+	}
+}
+
+template <execution::Policy P, typename BufferType>
+void statistics(P const& policy, MultiChannelAudioStream<BufferType> const& streams, Statistics<BufferType>* out, std::type_identity_t<BufferType> threshold)
+{
+	// a channel is too short to be worth splitting, the channels are spread over the pool instead
+	execution::forEachChunk(policy, streams.channels(), streams.size() * sizeof(BufferType), [&](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; ++c) {
+			out[c] = statistics(streams.channel(c), threshold);
+		}
+	});
+}
+
+#pragma region TruePeakMeter<BufferType>
+
+template <typename BufferType>
+TruePeakMeter<BufferType>::TruePeakMeter(size_t oversampling, ResamplerQuality quality, AudioAllocator& allocator)
+	: m_resampler(1, oversampling, quality, allocator)
+	, m_oversampled(1, oversampling * CHUNK_SIZE + oversampling, allocator)
+	, m_peak{ 0 }
+{
+	assert(oversampling > 0);
+}
+
+template <typename BufferType>
+BufferType TruePeakMeter<BufferType>::process(AudioStreamView<BufferType const> block)
+{
+	BufferType peak = BufferType(0);
+	for (size_t i = 0; i < block.size(); i += CHUNK_SIZE) {
+		AudioStreamView<BufferType const> const chunk = block.slice(i, std::min(CHUNK_SIZE, block.size() - i));
+		size_t const produced = m_resampler.process(chunk, m_oversampled.channel(0));
+		// the samples themselves are points of the signal too, whatever the filter does to them
+		peak = std::max({ peak, statistics(chunk).peak(), statistics(AudioStreamView<BufferType const>(m_oversampled.channel(0).data(), produced)).peak() });
+	}
+	m_peak = std::max(m_peak, peak);
+	return peak;
+}
+
+template <typename BufferType>
+BufferType TruePeakMeter<BufferType>::peak() const
+{
+	return m_peak;
+}
+
+template <typename BufferType>
+void TruePeakMeter<BufferType>::reset()
+{
+	m_resampler.reset();
+	m_peak = BufferType(0);
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_METERING_H
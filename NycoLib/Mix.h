@@ -0,0 +1,354 @@
+#ifndef NYCOLIB_MIX_H
+#define NYCOLIB_MIX_H
+
+/*
+	Module: Mix (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		Mix contains the MixInput struct and the mix and mixAdd functions, a summing bus
+		that adds any number of streams, each with its own gain or gain ramp, into a
+		destination in a single pass over it.
+
+		summing with operator+ and operator* streams a temporary per input, and even +=
+		reads and writes the whole destination once per input. mix splits the destination
+		into tiles small enough to stay in the L1 cache, and accumulates every input into a
+		tile before moving to the next. the inputs are added four at a time with the fused
+		multiply-add of the selected instruction set, so a tile is read and written once
+		per four inputs, from the cache.
+
+		a gain ramp goes linearly from the start gain at the first sample to the end gain at
+		the sample after the last, so the next block of a stream continues where it ended.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <assert.h>
+
+#include "SimdKernels.h"
+#include "ExecutionPolicy.h"
+#include "AudioStreamView.h"
+
+
+#pragma region nyco - Mix - Declarations
+
+namespace nyco {
+
+/*
+* an input of mix, a stream and its gain, constant or a linear ramp over the length of the stream
+*/
+template <typename BufferType>
+struct MixInput {
+
+	/*
+	* an input of a constant gain
+	*/
+	MixInput(AudioStreamView<BufferType const> stream, BufferType gain = BufferType(1));
+
+	/*
+	* an input of a gain ramp from startGain at the first sample to endGain after the last
+	*/
+	MixInput(AudioStreamView<BufferType const> stream, BufferType startGain, BufferType endGain);
+
+	AudioStreamView<BufferType const> stream;
+	BufferType startGain;
+	BufferType endGain;
+};
+
+/*
+* dest[i] = sum of inputs[k].stream[i] * gain of inputs[k] at i. every input is as long as dest, and none overlaps it
+*/
+template <typename BufferType>
+void mix(AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count);
+
+/*
+* same as mix(dest, inputs, count)
+*/
+template <typename BufferType>
+void mix(AudioStreamView<BufferType> dest, std::initializer_list<MixInput<std::type_identity_t<BufferType>>> inputs);
+
+/*
+* same as mix(dest, inputs, count), with dest split into chunks run by the execution policy
+*/
+template <execution::Policy P, typename BufferType>
+void mix(P const& policy, AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count);
+
+/*
+* dest[i] += sum of inputs[k].stream[i] * gain of inputs[k] at i, see mix
+*/
+template <typename BufferType>
+void mixAdd(AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count);
+
+/*
+* same as mixAdd(dest, inputs, count)
+*/
+template <typename BufferType>
+void mixAdd(AudioStreamView<BufferType> dest, std::initializer_list<MixInput<std::type_identity_t<BufferType>>> inputs);
+
+/*
+* same as mixAdd(dest, inputs, count), with dest split into chunks run by the execution policy
+*/
+template <execution::Policy P, typename BufferType>
+void mixAdd(P const& policy, AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count);
+
+}
+
+#pragma endregion
+
+#pragma region nyco - Mix - Definitions
+
+namespace nyco {
+
+#pragma region MixInput<BufferType>
+
+template <typename BufferType>
+MixInput<BufferType>::MixInput(AudioStreamView<BufferType const> stream, BufferType gain)
+	: stream{ stream }
+	, startGain{ gain }
+	, endGain{ gain }
+{
+}
+
+template <typename BufferType>
+MixInput<BufferType>::MixInput(AudioStreamView<BufferType const> stream, BufferType startGain, BufferType endGain)
+	: stream{ stream }
+	, startGain{ startGain }
+	, endGain{ endGain }
+{
+}
+
+#pragma endregion
+
+namespace detail {
+
+#pragma region Kernels
+
+// the samples of a tile, the part of the destination every input is accumulated into before the next
+template <typename T>
+inline constexpr size_t MIX_TILE_SIZE = 8192 / sizeof(T);
+
+// the number of inputs accumulated in a pass over a tile
+inline constexpr size_t MIX_GROUP_SIZE = 4;
+
+/*
+* dst[begin, end) (+)= the inputs of a group, Ramp when any of them has a gain ramp.
+* the gain of input k at i is start[k] + slope[k] * i
+*/
+template <typename V, size_t K, bool Ramp, typename T>
+void mixGroup(T* dst, size_t begin, size_t end, T const* const* data, T const* start, T const* slope, bool accumulate)
+{
+	// mixGroup is not compiled for the instruction set of V, its registers only reach V by reference
+	using reg = typename V::reg;
+	reg gain[K];
+	reg slopes[K];
+	for (size_t k = 0; k < K; ++k) {
+		V::broadcast(gain[k], start[k]);
+		V::broadcast(slopes[k], slope[k]);
+	}
+	T lanes[V::width];
+	for (size_t j = 0; j < V::width; ++j) {
+		lanes[j] = T(j);
+	}
+	reg iota;
+	V::load(iota, lanes);
+
+	reg acc;
+	reg x;
+	size_t i = begin;
+	for (; i + V::width <= end; i += V::width) {
+		if (accumulate) {
+			V::load(acc, dst + i);
+		}
+		else {
+			V::broadcast(acc, T(0));
+		}
+		if constexpr (Ramp) {
+			reg index;
+			reg g;
+			V::broadcast(index, T(i));
+			V::apply(operations::Add{}, index, index, iota);
+			for (size_t k = 0; k < K; ++k) {
+				V::multiplyAdd(g, slopes[k], index, gain[k]);
+				V::load(x, data[k] + i);
+				V::multiplyAdd(acc, g, x, acc);
+			}
+		}
+		else {
+			for (size_t k = 0; k < K; ++k) {
+				V::load(x, data[k] + i);
+				V::multiplyAdd(acc, gain[k], x, acc);
+			}
+		}
+		V::store(dst + i, acc);
+	}
+	for (; i < end; ++i) {
+		T acc = accumulate ? dst[i] : T(0);
+		for (size_t k = 0; k < K; ++k) {
+			acc += (start[k] + slope[k] * T(i)) * data[k][i];
+		}
+		dst[i] = acc;
+	}
+}
+
+/*
+* dst[begin, end) (+)= the count inputs, a tile at a time
+*/
+template <typename V, typename T>
+void mixRange(T* dst, size_t begin, size_t end, size_t length, MixInput<T> const* inputs, size_t count, bool accumulate)
+{
+	if (count == 0) {
+		if (!accumulate && end > begin) {
+			std::memset(dst + begin, 0, (end - begin) * sizeof(T));
+		}
+		return;
+	}
+	for (size_t tile = begin; tile < end; tile += MIX_TILE_SIZE<T>) {
+		size_t const tileEnd = std::min(end, tile + MIX_TILE_SIZE<T>);
+		for (size_t first = 0; first < count; first += MIX_GROUP_SIZE) {
+			size_t const k = std::min(MIX_GROUP_SIZE, count - first);
+			T const* data[MIX_GROUP_SIZE] = {};
+			T start[MIX_GROUP_SIZE] = {};
+			T slope[MIX_GROUP_SIZE] = {};
+			bool ramp = false;
+			for (size_t j = 0; j < k; ++j) {
+				MixInput<T> const& input = inputs[first + j];
+				data[j] = input.stream.data();
+				start[j] = input.startGain;
+				slope[j] = (input.endGain - input.startGain) / T(length);
+				ramp = ramp || slope[j] != T(0);
+			}
+			// the first group of a tile of mix writes it without reading it
+			bool const add = accumulate || first > 0;
+			switch (k) {
+			case 1:
+				ramp ? mixGroup<V, 1, true>(dst, tile, tileEnd, data, start, slope, add) : mixGroup<V, 1, false>(dst, tile, tileEnd, data, start, slope, add);
+				break;
+			case 2:
+				ramp ? mixGroup<V, 2, true>(dst, tile, tileEnd, data, start, slope, add) : mixGroup<V, 2, false>(dst, tile, tileEnd, data, start, slope, add);
+				break;
+			case 3:
+				ramp ? mixGroup<V, 3, true>(dst, tile, tileEnd, data, start, slope, add) : mixGroup<V, 3, false>(dst, tile, tileEnd, data, start, slope, add);
+				break;
+			default:
+				ramp ? mixGroup<V, 4, true>(dst, tile, tileEnd, data, start, slope, add) : mixGroup<V, 4, false>(dst, tile, tileEnd, data, start, slope, add);
+				break;
+			}
+		}
+	}
+}
+
+#if NYCO_SIMD_X86
+template <typename T>
+NYCO_SIMD_TARGET_SSE2 NYCO_SIMD_FLATTEN void mixRangeSse2(T* dst, size_t begin, size_t end, size_t length, MixInput<T> const* inputs, size_t count, bool accumulate)
+{
+	mixRange<simd::sse2::Vec<T>>(dst, begin, end, length, inputs, count, accumulate);
+}
+
+template <typename T>
+NYCO_SIMD_TARGET_AVX2 NYCO_SIMD_FLATTEN void mixRangeAvx2(T* dst, size_t begin, size_t end, size_t length, MixInput<T> const* inputs, size_t count, bool accumulate)
+{
+	mixRange<simd::avx2::Vec<T>>(dst, begin, end, length, inputs, count, accumulate);
+}
+
+template <typename T>
+NYCO_SIMD_TARGET_AVX512 NYCO_SIMD_FLATTEN void mixRangeAvx512(T* dst, size_t begin, size_t end, size_t length, MixInput<T> const* inputs, size_t count, bool accumulate)
+{
+	mixRange<simd::avx512::Vec<T>>(dst, begin, end, length, inputs, count, accumulate);
+}
+#endif
+
+/*
+* mixRange with the selected instruction set
+*/
+template <typename T>
+void mixRange(T* dst, size_t begin, size_t end, size_t length, MixInput<T> const* inputs, size_t count, bool accumulate)
+{
+	static_assert(std::is_floating_point_v<T>, "mix sums float or double streams");
+#if NYCO_SIMD_X86
+	switch (simd::instructionSet()) {
+	case simd::InstructionSet::AVX512:
+		mixRangeAvx512(dst, begin, end, length, inputs, count, accumulate);
+		return;
+	case simd::InstructionSet::AVX2:
+		mixRangeAvx2(dst, begin, end, length, inputs, count, accumulate);
+		return;
+	case simd::InstructionSet::SSE2:
+		mixRangeSse2(dst, begin, end, length, inputs, count, accumulate);
+		return;
+	default:
+		break;
+	}
+#endif
+	mixRange<simd::scalar::Vec<T>>(dst, begin, end, length, inputs, count, accumulate);
+}
+
+template <typename T>
+void assertMixable(AudioStreamView<T> dest, MixInput<T> const* inputs, size_t count)
+{
+	for (size_t k = 0; k < count; ++k) {
+		assert(inputs[k].stream.size() == dest.size());
+	}
+	(void)dest;
+	(void)inputs;
+	(void)count;
+}
+
+#pragma endregion
+
+}
+
+template <typename BufferType>
+void mix(AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count)
+{
+	detail::assertMixable(dest, inputs, count);
+	detail::mixRange(dest.data(), 0, dest.size(), dest.size(), inputs, count, false);
+}
+
+template <typename BufferType>
+void mix(AudioStreamView<BufferType> dest, std::initializer_list<MixInput<std::type_identity_t<BufferType>>> inputs)
+{
+	mix(dest, inputs.begin(), inputs.size());
+}
+
+template <execution::Policy P, typename BufferType>
+void mix(P const& policy, AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count)
+{
+	detail::assertMixable(dest, inputs, count);
+	// a chunk is sized by the bytes of every stream it touches
+	execution::forEachChunk(policy, dest.size(), sizeof(BufferType) * (count + 1), [&](size_t begin, size_t end) {
+		detail::mixRange(dest.data(), begin, end, dest.size(), inputs, count, false);
+	});
+}
+
+template <typename BufferType>
+void mixAdd(AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count)
+{
+	detail::assertMixable(dest, inputs, count);
+	detail::mixRange(dest.data(), 0, dest.size(), dest.size(), inputs, count, true);
+}
+
+template <typename BufferType>
+void mixAdd(AudioStreamView<BufferType> dest, std::initializer_list<MixInput<std::type_identity_t<BufferType>>> inputs)
+{
+	mixAdd(dest, inputs.begin(), inputs.size());
+}
+
+template <execution::Policy P, typename BufferType>
+void mixAdd(P const& policy, AudioStreamView<BufferType> dest, MixInput<BufferType> const* inputs, size_t count)
+{
+	detail::assertMixable(dest, inputs, count);
+	execution::forEachChunk(policy, dest.size(), sizeof(BufferType) * (count + 1), [&](size_t begin, size_t end) {
+		detail::mixRange(dest.data(), begin, end, dest.size(), inputs, count, true);
+	});
+}
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_MIX_H
@@ -0,0 +1,848 @@
+#ifndef NYCOLIB_MULTI_CHANNEL_AUDIO_STREAM_H
+#define NYCOLIB_MULTI_CHANNEL_AUDIO_STREAM_H
+
+/*
+	Module: MultiChannelAudioStream (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		MultiChannelAudioStream contains the MultiChannelAudioStream class, a planar buffer
+		holding every channel in one contiguous, 64 byte aligned allocation. each channel
+		starts a fixed stride after the previous one (the length rounded up to a whole
+		cache line), so channel access is a multiplication and every operation walks
+		the buffer front to back in a single pass.
+
+*/
+
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <assert.h>
+
+#include "ownership.h"
+#include "AudioAllocator.h"
+#include "operations.h"
+#include "AudioStreamExpression.h"
+#include "AudioStreamView.h"
+
+
+#pragma region nyco - MultiChannelAudioStream - Declarations
+
+namespace nyco {
+
+template <typename BufferType>
+class MultiChannelAudioStream {
+
+	static_assert(std::is_trivially_copyable_v<BufferType>, "MultiChannelAudioStream samples are copied with memcpy");
+
+#pragma region Constants
+public:
+
+	// alignment in bytes of the buffer and of the start of every channel
+	static constexpr size_t ALIGNMENT = AudioAllocator::ALIGNMENT;
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new MultiChannelAudioStream<BufferType> of channels x length zeroed samples in a buffer from allocator
+	*/
+	explicit MultiChannelAudioStream(size_t channels, size_t length, AudioAllocator& allocator = defaultAllocator());
+
+	/*
+	* constructs a new MultiChannelAudioStream<BufferType> and copying every channel from the planar pointers in data
+	*/
+	explicit MultiChannelAudioStream(BufferType const* const* data, size_t channels, size_t length, ownership::copy, AudioAllocator& allocator = defaultAllocator());
+
+	// Copy Constructor
+	MultiChannelAudioStream(MultiChannelAudioStream<BufferType> const& stream) = delete;
+
+	// Move Constructor
+	MultiChannelAudioStream(MultiChannelAudioStream<BufferType>&& stream) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* does in-place transformation of every channel by the given function
+	*/
+	template <typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+		MultiChannelAudioStream<BufferType>& transform(Function&& func);
+
+	/*
+	* does in-place transformation of every channel by the given function and the matching channel of other
+	* other must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	template <typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+		MultiChannelAudioStream<BufferType>& transform(Function&& func, MultiChannelAudioStream<BufferType> const& other);
+
+	/*
+	* makes a copy of the original MultiChannelAudioStream<BufferType> and returns it
+	*/
+	MultiChannelAudioStream<BufferType> clone() const;
+
+	/*
+	* returns a view over the samples of channel c
+	*/
+	AudioStreamView<BufferType> channel(size_t c);
+
+	/*
+	* returns a read-only view over the samples of channel c
+	*/
+	AudioStreamView<BufferType const> channel(size_t c) const;
+
+	/*
+	* returns the number of channels
+	*/
+	size_t channels() const;
+
+	/*
+	* returns the number of samples in every channel
+	*/
+	size_t size() const;
+
+	/*
+	* returns the distance in samples between the start of two consecutive channels
+	*/
+	size_t stride() const;
+
+	/*
+	* returns the allocator the buffer of this MultiChannelAudioStream<BufferType> came from
+	*/
+	AudioAllocator& allocator() const;
+
+	/*
+	* returns a pointer to the first sample of the first channel
+	*/
+	BufferType* data();
+
+	/*
+	* returns a const pointer to the first sample of the first channel
+	*/
+	BufferType const* data() const;
+
+#pragma endregion
+
+#pragma region Static Methods
+public:
+
+	/*
+	* creates a new MultiChannelAudioStream<BufferType> from two multichannel streams and a function the operates over two elements
+	*
+	* same as copying the a and transforming it with func and b
+	*/
+	template <typename Function>
+	requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+		static MultiChannelAudioStream<BufferType> zipWith(MultiChannelAudioStream<BufferType> const& a, MultiChannelAudioStream<BufferType> const& b, Function&& func);
+
+	/*
+	* returns the stride used for channels of the given length
+	*/
+	static size_t strideFor(size_t length);
+
+#pragma endregion
+
+#pragma region Operator Overloading
+
+#pragma region MultiChannelAudioStream<BufferType> OP MultiChannelAudioStream<BufferType>
+public:
+
+	// MultiChannelAudioStream<BufferType> + MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise addition
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator+(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> - MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise subtraction
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator-(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> * MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise multiplication
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator*(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> / MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise division
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator/(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> % MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise modulous
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator%(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> ^ MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise XOR
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator^(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> & MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise AND
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator&(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> | MultiChannelAudioStream<BufferType>
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all elements are a result of member-wise OR
+	* o must have the same number of channels, or a single channel that is applied to every channel
+	*/
+	MultiChannelAudioStream<BufferType> operator|(MultiChannelAudioStream<BufferType> const& o) const;
+
+	// MultiChannelAudioStream<BufferType> += MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise addition
+	*/
+	MultiChannelAudioStream<BufferType>& operator+=(MultiChannelAudioStream<BufferType> const& o);
+
+	// MultiChannelAudioStream<BufferType> -= MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise subtraction
+	*/
+	MultiChannelAudioStream<BufferType>& operator-=(MultiChannelAudioStream<BufferType> const& o);
+
+	// MultiChannelAudioStream<BufferType> *= MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise multiplication
+	*/
+	MultiChannelAudioStream<BufferType>& operator*=(MultiChannelAudioStream<BufferType> const& o);
+
+	// MultiChannelAudioStream<BufferType> /= MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise division
+	*/
+	MultiChannelAudioStream<BufferType>& operator/=(MultiChannelAudioStream<BufferType> const& o);
+
+	// MultiChannelAudioStream<BufferType> %= MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise modulous
+	*/
+	MultiChannelAudioStream<BufferType>& operator%=(MultiChannelAudioStream<BufferType> const& o);
+
+	// MultiChannelAudioStream<BufferType> ^= MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise XOR
+	*/
+	MultiChannelAudioStream<BufferType>& operator^=(MultiChannelAudioStream<BufferType> const& o);
+
+	// MultiChannelAudioStream<BufferType> &= MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise AND
+	*/
+	MultiChannelAudioStream<BufferType>& operator&=(MultiChannelAudioStream<BufferType> const& o);
+
+	// MultiChannelAudioStream<BufferType> |= MultiChannelAudioStream<BufferType>
+	/*
+	* does in-place transformation of all channels where all members are the result of member-wise OR
+	*/
+	MultiChannelAudioStream<BufferType>& operator|=(MultiChannelAudioStream<BufferType> const& o);
+
+#pragma endregion
+
+#pragma region MultiChannelAudioStream<BufferType> OP BufferType
+public:
+
+	// MultiChannelAudioStream<BufferType> + BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are shifted up by o
+	*/
+	MultiChannelAudioStream<BufferType> operator+(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> - BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are shifted down by o
+	*/
+	MultiChannelAudioStream<BufferType> operator-(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> * BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are scaled by o
+	*/
+	MultiChannelAudioStream<BufferType> operator*(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> / BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are scaled inversly by o
+	*/
+	MultiChannelAudioStream<BufferType> operator/(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> % BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are the remainder of the division by o
+	*/
+	MultiChannelAudioStream<BufferType> operator%(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> ^ BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are the result of a XOR
+	*/
+	MultiChannelAudioStream<BufferType> operator^(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> & BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are the result of a AND
+	*/
+	MultiChannelAudioStream<BufferType> operator&(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> | BufferType
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where all members are the result of a OR
+	*/
+	MultiChannelAudioStream<BufferType> operator|(BufferType const& o) const;
+
+	// MultiChannelAudioStream<BufferType> += BufferType
+	/*
+	* does in-place transformation of all channels where all members are shifted up by o
+	*/
+	MultiChannelAudioStream<BufferType>& operator+=(BufferType const& o);
+
+	// MultiChannelAudioStream<BufferType> -= BufferType
+	/*
+	* does in-place transformation of all channels where all members are shifted down by o
+	*/
+	MultiChannelAudioStream<BufferType>& operator-=(BufferType const& o);
+
+	// MultiChannelAudioStream<BufferType> *= BufferType
+	/*
+	* does in-place transformation of all channels where all members are scaled by o
+	*/
+	MultiChannelAudioStream<BufferType>& operator*=(BufferType const& o);
+
+	// MultiChannelAudioStream<BufferType> /= BufferType
+	/*
+	* does in-place transformation of all channels where all members are scaled inversly by o
+	*/
+	MultiChannelAudioStream<BufferType>& operator/=(BufferType const& o);
+
+	// MultiChannelAudioStream<BufferType> %= BufferType
+	/*
+	* does in-place transformation of all channels where all members are the remainder of the division by o
+	*/
+	MultiChannelAudioStream<BufferType>& operator%=(BufferType const& o);
+
+	// MultiChannelAudioStream<BufferType> ^= BufferType
+	/*
+	* does in-place transformation of all channels where all members are the result of a XOR
+	*/
+	MultiChannelAudioStream<BufferType>& operator^=(BufferType const& o);
+
+	// MultiChannelAudioStream<BufferType> &= BufferType
+	/*
+	* does in-place transformation of all channels where all members are the result of a AND
+	*/
+	MultiChannelAudioStream<BufferType>& operator&=(BufferType const& o);
+
+	// MultiChannelAudioStream<BufferType> |= BufferType
+	/*
+	* does in-place transformation of all channels where all members are the result of a OR
+	*/
+	MultiChannelAudioStream<BufferType>& operator|=(BufferType const& o);
+
+#pragma endregion
+
+#pragma region Indexing Operators
+public:
+
+	// MultiChannelAudioStream<BufferType>[integral]
+	/*
+	* returns a view over the samples of channel c
+	*/
+	AudioStreamView<BufferType> operator[](size_t c);
+
+	// MultiChannelAudioStream<BufferType>[integral]
+	/*
+	* returns a read-only view over the samples of channel c
+	*/
+	AudioStreamView<BufferType const> operator[](size_t c) const;
+
+#pragma endregion
+
+	// Deleting the operator= so you can't assign stream by reference
+	MultiChannelAudioStream<BufferType>& operator=(MultiChannelAudioStream<BufferType> const& rhs) = delete;
+
+	// Move Assignment
+	MultiChannelAudioStream<BufferType>& operator=(MultiChannelAudioStream<BufferType>&& rhs) = default;
+
+#pragma endregion
+
+#pragma region Private Methods
+private:
+
+	/*
+	* allocates an uninitialized buffer of the given shape
+	*/
+	explicit MultiChannelAudioStream(size_t channels, size_t length, size_t stride, AudioAllocator& allocator);
+
+	/*
+	* returns a new MultiChannelAudioStream<BufferType> where every channel is a OP b, touching every sample once
+	*/
+	template <typename Op, typename O>
+	static MultiChannelAudioStream<BufferType> combine(MultiChannelAudioStream<BufferType> const& a, O const& b);
+
+	/*
+	* does in-place transformation of every channel by OP b
+	*/
+	template <typename Op, typename O>
+	MultiChannelAudioStream<BufferType>& combineInPlace(O const& b);
+
+#pragma endregion
+
+#pragma region Protected Members
+protected:
+
+	std::unique_ptr<BufferType[], allocator_delete<BufferType>> m_pBuffer;
+
+	size_t m_nChannels;
+
+	size_t m_nLength;
+
+	size_t m_nStride;
+
+#pragma endregion
+
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - MultiChannelAudioStream - Definitions
+
+namespace nyco {
+
+#pragma region MultiChannelAudioStream<BufferType> - Constructors
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>::MultiChannelAudioStream(size_t channels, size_t length, size_t stride, AudioAllocator& allocator)
+	: m_pBuffer{ nullptr }
+	, m_nChannels{ channels }
+	, m_nLength{ length }
+	, m_nStride{ stride }
+{
+	AudioAllocator& source = resolveAllocator(allocator);
+	m_pBuffer = std::unique_ptr<BufferType[], allocator_delete<BufferType>>(
+		static_cast<BufferType*>(source.allocate(m_nChannels * m_nStride * sizeof(BufferType))), allocator_delete<BufferType>(source, m_nChannels * m_nStride));
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>::MultiChannelAudioStream(size_t channels, size_t length, AudioAllocator& allocator)
+	: MultiChannelAudioStream(channels, length, strideFor(length), allocator)
+{
+	std::uninitialized_value_construct_n(m_pBuffer.get(), m_nChannels * m_nStride);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>::MultiChannelAudioStream(BufferType const* const* data, size_t channels, size_t length, ownership::copy, AudioAllocator& allocator)
+	: MultiChannelAudioStream(channels, length, allocator)
+{
+	for (size_t c = 0; c < m_nChannels; ++c) {
+		std::memcpy(m_pBuffer.get() + c * m_nStride, data[c], m_nLength * sizeof(BufferType));
+	}
+}
+
+#pragma endregion
+
+#pragma region MultiChannelAudioStream<BufferType> - Methods
+
+template <typename BufferType>
+template <typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType>, BufferType>)
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::transform(Function&& func)
+{
+	for (size_t c = 0; c < m_nChannels; ++c) {
+		BufferType* ptr = m_pBuffer.get() + c * m_nStride;
+		for (size_t i = 0; i < m_nLength; ++i) {
+			ptr[i] = func(ptr[i]);
+		}
+	}
+	return *this;
+}
+
+template <typename BufferType>
+template <typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::transform(Function&& func, MultiChannelAudioStream<BufferType> const& other)
+{
+	assert(other.m_nChannels == 1 || other.m_nChannels == m_nChannels);
+	assert(other.m_nLength == m_nLength);
+	size_t const otherStride = other.m_nChannels == 1 ? 0 : other.m_nStride;
+	for (size_t c = 0; c < m_nChannels; ++c) {
+		BufferType* ptr = m_pBuffer.get() + c * m_nStride;
+		BufferType const* src = other.m_pBuffer.get() + c * otherStride;
+		for (size_t i = 0; i < m_nLength; ++i) {
+			ptr[i] = func(ptr[i], src[i]);
+		}
+	}
+	return *this;
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::clone() const
+{
+	MultiChannelAudioStream<BufferType> stream(m_nChannels, m_nLength, m_nStride, allocator());
+	std::memcpy(stream.m_pBuffer.get(), m_pBuffer.get(), m_nChannels * m_nStride * sizeof(BufferType));
+	return stream;
+}
+
+template <typename BufferType>
+AudioStreamView<BufferType> MultiChannelAudioStream<BufferType>::channel(size_t c)
+{
+	assert(c < m_nChannels);
+	return AudioStreamView<BufferType>(m_pBuffer.get() + c * m_nStride, m_nLength);
+}
+
+template <typename BufferType>
+AudioStreamView<BufferType const> MultiChannelAudioStream<BufferType>::channel(size_t c) const
+{
+	assert(c < m_nChannels);
+	return AudioStreamView<BufferType const>(m_pBuffer.get() + c * m_nStride, m_nLength);
+}
+
+template <typename BufferType>
+size_t MultiChannelAudioStream<BufferType>::channels() const
+{
+	return m_nChannels;
+}
+
+template <typename BufferType>
+size_t MultiChannelAudioStream<BufferType>::size() const
+{
+	return m_nLength;
+}
+
+template <typename BufferType>
+size_t MultiChannelAudioStream<BufferType>::stride() const
+{
+	return m_nStride;
+}
+
+template <typename BufferType>
+AudioAllocator& MultiChannelAudioStream<BufferType>::allocator() const
+{
+	return m_pBuffer.get_deleter().allocator();
+}
+
+template <typename BufferType>
+BufferType* MultiChannelAudioStream<BufferType>::data()
+{
+	return m_pBuffer.get();
+}
+
+template <typename BufferType>
+BufferType const* MultiChannelAudioStream<BufferType>::data() const
+{
+	return m_pBuffer.get();
+}
+
+#pragma endregion
+
+#pragma region MultiChannelAudioStream<BufferType> - Static Methods
+
+template <typename BufferType>
+template <typename Function>
+requires (std::is_same_v<std::invoke_result_t<Function, BufferType, BufferType>, BufferType>)
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::zipWith(MultiChannelAudioStream<BufferType> const& a, MultiChannelAudioStream<BufferType> const& b, Function&& func)
+{
+	MultiChannelAudioStream<BufferType> stream = a.clone();
+	stream.transform(std::forward<Function>(func), b);
+	return stream;
+}
+
+template <typename BufferType>
+size_t MultiChannelAudioStream<BufferType>::strideFor(size_t length)
+{
+	if constexpr (ALIGNMENT % sizeof(BufferType) == 0) {
+		constexpr size_t samplesPerLine = ALIGNMENT / sizeof(BufferType);
+		return (length + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
+	}
+	else {
+		return length;
+	}
+}
+
+#pragma endregion
+
+#pragma region MultiChannelAudioStream<BufferType> - Private Methods
+
+template <typename BufferType>
+template <typename Op, typename O>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::combine(MultiChannelAudioStream<BufferType> const& a, O const& b)
+{
+	MultiChannelAudioStream<BufferType> stream(a.m_nChannels, a.m_nLength, a.m_nStride, a.allocator());
+	for (size_t c = 0; c < a.m_nChannels; ++c) {
+		if constexpr (std::is_same_v<O, MultiChannelAudioStream<BufferType>>) {
+			assert(b.m_nChannels == 1 || b.m_nChannels == a.m_nChannels);
+			stream.channel(c) = expression::makeBinary<Op>(a.channel(c), b.channel(b.m_nChannels == 1 ? 0 : c));
+		}
+		else {
+			stream.channel(c) = expression::makeBinary<Op>(a.channel(c), b);
+		}
+	}
+	return stream;
+}
+
+template <typename BufferType>
+template <typename Op, typename O>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::combineInPlace(O const& b)
+{
+	for (size_t c = 0; c < m_nChannels; ++c) {
+		if constexpr (std::is_same_v<O, MultiChannelAudioStream<BufferType>>) {
+			assert(b.m_nChannels == 1 || b.m_nChannels == m_nChannels);
+			channel(c) = expression::makeBinary<Op>(channel(c), b.channel(b.m_nChannels == 1 ? 0 : c));
+		}
+		else {
+			channel(c) = expression::makeBinary<Op>(channel(c), b);
+		}
+	}
+	return *this;
+}
+
+#pragma endregion
+
+#pragma region MultiChannelAudioStream<BufferType> - OPs
+
+#pragma region MultiChannelAudioStream<BufferType> - OPs - MultiChannelAudioStream<BufferType> OP MultiChannelAudioStream<BufferType>
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator+(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::Add>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator-(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::Subtract>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator*(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::Multiply>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator/(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::Divide>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator%(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::Modulo>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator^(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::BitwiseXor>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator&(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::BitwiseAnd>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator|(MultiChannelAudioStream<BufferType> const& o) const
+{
+	return combine<operations::BitwiseOr>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator+=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::Add>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator-=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::Subtract>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator*=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::Multiply>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator/=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::Divide>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator%=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::Modulo>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator^=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::BitwiseXor>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator&=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::BitwiseAnd>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator|=(MultiChannelAudioStream<BufferType> const& o)
+{
+	return combineInPlace<operations::BitwiseOr>(o);
+}
+
+#pragma endregion
+
+#pragma region MultiChannelAudioStream<BufferType> - OPs - MultiChannelAudioStream<BufferType> OP BufferType
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator+(BufferType const& o) const
+{
+	return combine<operations::Add>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator-(BufferType const& o) const
+{
+	return combine<operations::Subtract>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator*(BufferType const& o) const
+{
+	return combine<operations::Multiply>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator/(BufferType const& o) const
+{
+	return combine<operations::Divide>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator%(BufferType const& o) const
+{
+	return combine<operations::Modulo>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator^(BufferType const& o) const
+{
+	return combine<operations::BitwiseXor>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator&(BufferType const& o) const
+{
+	return combine<operations::BitwiseAnd>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType> MultiChannelAudioStream<BufferType>::operator|(BufferType const& o) const
+{
+	return combine<operations::BitwiseOr>(*this, o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator+=(BufferType const& o)
+{
+	return combineInPlace<operations::Add>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator-=(BufferType const& o)
+{
+	return combineInPlace<operations::Subtract>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator*=(BufferType const& o)
+{
+	return combineInPlace<operations::Multiply>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator/=(BufferType const& o)
+{
+	return combineInPlace<operations::Divide>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator%=(BufferType const& o)
+{
+	return combineInPlace<operations::Modulo>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator^=(BufferType const& o)
+{
+	return combineInPlace<operations::BitwiseXor>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator&=(BufferType const& o)
+{
+	return combineInPlace<operations::BitwiseAnd>(o);
+}
+
+template <typename BufferType>
+MultiChannelAudioStream<BufferType>& MultiChannelAudioStream<BufferType>::operator|=(BufferType const& o)
+{
+	return combineInPlace<operations::BitwiseOr>(o);
+}
+
+#pragma endregion
+
+#pragma region MultiChannelAudioStream<BufferType> - OPs - Indexers
+
+template <typename BufferType>
+AudioStreamView<BufferType> MultiChannelAudioStream<BufferType>::operator[](size_t c)
+{
+	return channel(c);
+}
+
+template <typename BufferType>
+AudioStreamView<BufferType const> MultiChannelAudioStream<BufferType>::operator[](size_t c) const
+{
+	return channel(c);
+}
+
+#pragma endregion
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_MULTI_CHANNEL_AUDIO_STREAM_H
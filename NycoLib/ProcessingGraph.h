@@ -0,0 +1,700 @@
+#ifndef NYCOLIB_PROCESSING_GRAPH_H
+#define NYCOLIB_PROCESSING_GRAPH_H
+
+/*
+	Module: ProcessingGraph (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		ProcessingGraph contains the AudioNode interface and the ProcessingGraph class,
+		a block based DSP graph. nodes read their inputs and write their outputs through
+		AudioStreamViews, each port carrying one channel of a block.
+
+		compile() schedules the graph once, in levels: every node runs after the nodes
+		that feed it, and the nodes of a level do not depend on each other, so with a
+		parallel policy a level runs on the thread pool. it then assigns every output
+		port a buffer from a small set, like a register allocator: a buffer is free
+		again once the last node reading it has run, and a node that allows it writes
+		its output over the buffer of its input. all the buffers are one allocation,
+		made by compile(), so process() never allocates. nor does the parallel process():
+		a level is handed to the pool as one task per worker ring, which are fixed in size.
+
+		graph inputs are read by the nodes in place, and an output port connected to a
+		graph output writes to the host buffer directly.
+
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <assert.h>
+
+#include "AudioAllocator.h"
+#include "AudioStreamView.h"
+#include "ExecutionPolicy.h"
+#include "MultiChannelAudioStream.h"
+
+
+#pragma region nyco - ProcessingGraph - Declarations
+
+namespace nyco {
+
+/*
+* a processor in a ProcessingGraph, with a fixed number of single channel input and output ports
+*/
+template <typename BufferType>
+class AudioNode {
+
+#pragma region Constructors
+public:
+
+	virtual ~AudioNode() = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the number of input ports
+	*/
+	virtual size_t inputs() const = 0;
+
+	/*
+	* returns the number of output ports
+	*/
+	virtual size_t outputs() const = 0;
+
+	/*
+	* true when output i may share the buffer of input i, then sample n of input i
+	* must be read before sample n of output i is written
+	*/
+	virtual bool inPlace() const;
+
+	/*
+	* called by ProcessingGraph::compile() with the largest block the graph will process,
+	* the place for a node to allocate what it needs
+	*/
+	virtual void prepare(size_t maxBlockSize);
+
+	/*
+	* processes one block: inputs[0 .. inputs()) and outputs[0 .. outputs()) are all views of the same length
+	*/
+	virtual void process(AudioStreamView<BufferType const> const* inputs, AudioStreamView<BufferType> const* outputs) = 0;
+
+#pragma endregion
+};
+
+/*
+* an AudioNode that calls func(inputs, outputs) for every block
+*/
+template <typename BufferType, typename Function>
+class FunctionNode : public AudioNode<BufferType> {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new FunctionNode with the given ports, see AudioNode::inPlace() for inPlace
+	*/
+	explicit FunctionNode(size_t inputs, size_t outputs, Function func, bool inPlace = false);
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	size_t inputs() const override;
+
+	size_t outputs() const override;
+
+	bool inPlace() const override;
+
+	void process(AudioStreamView<BufferType const> const* inputs, AudioStreamView<BufferType> const* outputs) override;
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	size_t m_nInputs;
+
+	size_t m_nOutputs;
+
+	bool m_bInPlace;
+
+	Function m_func;
+
+#pragma endregion
+};
+
+template <typename BufferType>
+class ProcessingGraph {
+
+#pragma region Types
+public:
+
+	using NodeId = size_t;
+
+	// the pseudo node whose outputs are the inputs of the graph
+	static constexpr NodeId INPUT = SIZE_MAX;
+
+	// the pseudo node whose inputs are the outputs of the graph
+	static constexpr NodeId OUTPUT = SIZE_MAX - 1;
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs an empty ProcessingGraph with the given number of input and output channels
+	* the buffers compile() assigns come from allocator
+	*/
+	explicit ProcessingGraph(size_t inputs, size_t outputs, AudioAllocator& allocator = defaultAllocator());
+
+	ProcessingGraph(ProcessingGraph<BufferType> const&) = delete;
+
+	ProcessingGraph(ProcessingGraph<BufferType>&&) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* adds node to the graph and returns its id
+	*/
+	NodeId add(std::unique_ptr<AudioNode<BufferType>> node);
+
+	/*
+	* adds a FunctionNode calling func(inputs, outputs) to the graph and returns its id
+	*/
+	template <typename Function>
+	NodeId add(size_t inputs, size_t outputs, Function&& func, bool inPlace = false);
+
+	/*
+	* returns the node with the given id
+	*/
+	AudioNode<BufferType>& node(NodeId id);
+
+	/*
+	* connects output port output of from to input port input of to
+	* from may be INPUT and to may be OUTPUT, an input port has at most one connection,
+	* an output port may feed any number of them. an unconnected input reads silence
+	*/
+	void connect(NodeId from, size_t output, NodeId to, size_t input);
+
+	/*
+	* schedules the graph and assigns its buffers for blocks of up to maxBlockSize samples
+	* must be called after the last change to the graph and before process()
+	*/
+	void compile(size_t maxBlockSize);
+
+	/*
+	* returns the number of intermediate buffers compile() assigned, silence included
+	*/
+	size_t buffers() const;
+
+	/*
+	* returns the number of levels of the schedule, the nodes of a level run in parallel
+	*/
+	size_t levels() const;
+
+	/*
+	* processes one block of frames samples, from the planar inputs to the planar outputs
+	* the input and output buffers of the host must not overlap
+	*/
+	void process(BufferType const* const* inputs, BufferType* const* outputs, size_t frames);
+
+	/*
+	* processes one block, running the nodes of every level on the pool of the policy
+	* does not allocate either, see ThreadPool::parallelFor
+	*/
+	template <execution::Policy P>
+	void process(P const& policy, BufferType const* const* inputs, BufferType* const* outputs, size_t frames);
+
+#pragma endregion
+
+	ProcessingGraph<BufferType>& operator=(ProcessingGraph<BufferType> const&) = delete;
+
+	ProcessingGraph<BufferType>& operator=(ProcessingGraph<BufferType>&&) = default;
+
+#pragma region Private Members
+private:
+
+	// no node, no port or no slot
+	static constexpr size_t NONE = SIZE_MAX - 2;
+
+	struct Connection {
+		NodeId from;
+		size_t output;
+		NodeId to;
+		size_t input;
+	};
+
+	// the source of a node input or a graph output: a node port, a graph input (INPUT) or nothing
+	struct Source {
+		NodeId node = NONE;
+		size_t port = 0;
+	};
+
+	// a scheduled node, its ports are m_inputSlots / m_outputSlots [first, first + count)
+	struct Step {
+		AudioNode<BufferType>* node;
+		size_t firstInput;
+		size_t firstOutput;
+	};
+
+	/*
+	* binds the views of step to the slots for a block of frames and runs it
+	*/
+	void run(Step const& step, size_t frames);
+
+	/*
+	* runs the compiled schedule, calling forLevel(begin, end) with the steps of every level
+	*/
+	template <typename ForLevel>
+	void execute(BufferType const* const* inputs, BufferType* const* outputs, size_t frames, ForLevel&& forLevel);
+
+	size_t m_nInputs;
+
+	size_t m_nOutputs;
+
+	AudioAllocator* m_pAllocator;
+
+	std::vector<std::unique_ptr<AudioNode<BufferType>>> m_nodes;
+
+	std::vector<Connection> m_connections;
+
+	// the schedule, level l is m_steps [m_levels[l], m_levels[l + 1])
+	std::vector<Step> m_steps;
+
+	std::vector<size_t> m_levels;
+
+	// the slot every port of the schedule reads or writes
+	std::vector<size_t> m_inputSlots;
+
+	std::vector<size_t> m_outputSlots;
+
+	// the views handed to the nodes, rebound for every block
+	std::vector<AudioStreamView<BufferType const>> m_inputViews;
+
+	std::vector<AudioStreamView<BufferType>> m_outputViews;
+
+	// slots: the graph inputs, the graph outputs, silence, then the intermediate buffers
+	std::vector<BufferType*> m_slots;
+
+	// graph outputs copied from another slot after the schedule ran, and the ones left silent
+	std::vector<std::pair<size_t, size_t>> m_copies;
+
+	std::vector<size_t> m_silentOutputs;
+
+	std::optional<MultiChannelAudioStream<BufferType>> m_storage;
+
+	size_t m_nMaxBlockSize;
+
+	bool m_bCompiled;
+
+#pragma endregion
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - ProcessingGraph - Definitions
+
+namespace nyco {
+
+#pragma region AudioNode<BufferType>
+
+template <typename BufferType>
+bool AudioNode<BufferType>::inPlace() const
+{
+	return false;
+}
+
+template <typename BufferType>
+void AudioNode<BufferType>::prepare(size_t)
+{
+}
+
+#pragma endregion
+
+#pragma region FunctionNode<BufferType, Function>
+
+template <typename BufferType, typename Function>
+FunctionNode<BufferType, Function>::FunctionNode(size_t inputs, size_t outputs, Function func, bool inPlace)
+	: m_nInputs{ inputs }
+	, m_nOutputs{ outputs }
+	, m_bInPlace{ inPlace }
+	, m_func(std::move(func))
+{
+}
+
+template <typename BufferType, typename Function>
+size_t FunctionNode<BufferType, Function>::inputs() const
+{
+	return m_nInputs;
+}
+
+template <typename BufferType, typename Function>
+size_t FunctionNode<BufferType, Function>::outputs() const
+{
+	return m_nOutputs;
+}
+
+template <typename BufferType, typename Function>
+bool FunctionNode<BufferType, Function>::inPlace() const
+{
+	return m_bInPlace;
+}
+
+template <typename BufferType, typename Function>
+void FunctionNode<BufferType, Function>::process(AudioStreamView<BufferType const> const* inputs, AudioStreamView<BufferType> const* outputs)
+{
+	m_func(inputs, outputs);
+}
+
+#pragma endregion
+
+#pragma region ProcessingGraph<BufferType> - Constructors
+
+template <typename BufferType>
+ProcessingGraph<BufferType>::ProcessingGraph(size_t inputs, size_t outputs, AudioAllocator& allocator)
+	: m_nInputs{ inputs }
+	, m_nOutputs{ outputs }
+	, m_pAllocator{ &allocator }
+	, m_nodes{}
+	, m_connections{}
+	, m_steps{}
+	, m_levels{}
+	, m_inputSlots{}
+	, m_outputSlots{}
+	, m_inputViews{}
+	, m_outputViews{}
+	, m_slots{}
+	, m_copies{}
+	, m_silentOutputs{}
+	, m_storage{}
+	, m_nMaxBlockSize{ 0 }
+	, m_bCompiled{ false }
+{
+}
+
+#pragma endregion
+
+#pragma region ProcessingGraph<BufferType> - Methods
+
+template <typename BufferType>
+typename ProcessingGraph<BufferType>::NodeId ProcessingGraph<BufferType>::add(std::unique_ptr<AudioNode<BufferType>> node)
+{
+	assert(node != nullptr);
+	m_nodes.push_back(std::move(node));
+	m_bCompiled = false;
+	return m_nodes.size() - 1;
+}
+
+template <typename BufferType>
+template <typename Function>
+typename ProcessingGraph<BufferType>::NodeId ProcessingGraph<BufferType>::add(size_t inputs, size_t outputs, Function&& func, bool inPlace)
+{
+	using Node = FunctionNode<BufferType, std::decay_t<Function>>;
+	return add(std::make_unique<Node>(inputs, outputs, std::forward<Function>(func), inPlace));
+}
+
+template <typename BufferType>
+AudioNode<BufferType>& ProcessingGraph<BufferType>::node(NodeId id)
+{
+	assert(id < m_nodes.size());
+	return *m_nodes[id];
+}
+
+template <typename BufferType>
+void ProcessingGraph<BufferType>::connect(NodeId from, size_t output, NodeId to, size_t input)
+{
+	assert(from == INPUT ? output < m_nInputs : (from < m_nodes.size() && output < m_nodes[from]->outputs()));
+	assert(to == OUTPUT ? input < m_nOutputs : (to < m_nodes.size() && input < m_nodes[to]->inputs()));
+	m_connections.push_back(Connection{ from, output, to, input });
+	m_bCompiled = false;
+}
+
+template <typename BufferType>
+void ProcessingGraph<BufferType>::compile(size_t maxBlockSize)
+{
+	size_t const nodes = m_nodes.size();
+
+	// every output port of every node gets an index, port p of node n is outputBase[n] + p
+	std::vector<size_t> inputBase(nodes + 1, 0);
+	std::vector<size_t> outputBase(nodes + 1, 0);
+	for (size_t n = 0; n < nodes; ++n) {
+		inputBase[n + 1] = inputBase[n] + m_nodes[n]->inputs();
+		outputBase[n + 1] = outputBase[n] + m_nodes[n]->outputs();
+	}
+	size_t const ports = outputBase[nodes];
+
+	std::vector<Source> inputSources(inputBase[nodes]);
+	std::vector<Source> outputSources(m_nOutputs);
+	std::vector<size_t> dependencies(nodes, 0);
+	std::vector<std::vector<NodeId>> dependents(nodes);
+	std::vector<size_t> consumers(ports, 0);
+	std::vector<std::vector<size_t>> graphOutputs(ports);
+	for (Connection const& c : m_connections) {
+		Source& source = c.to == OUTPUT ? outputSources[c.input] : inputSources[inputBase[c.to] + c.input];
+		assert(source.node == NONE && "an input has at most one connection");
+		source = Source{ c.from, c.output };
+		if (c.from == INPUT) {
+			continue;
+		}
+		size_t const port = outputBase[c.from] + c.output;
+		if (c.to == OUTPUT) {
+			graphOutputs[port].push_back(c.input);
+		}
+		else {
+			++consumers[port];
+			++dependencies[c.to];
+			dependents[c.from].push_back(c.to);
+		}
+	}
+
+	// Kahn's algorithm, one wave at a time: a wave is a level
+	std::vector<size_t> level(nodes, 0);
+	std::vector<NodeId> order;
+	std::vector<size_t> levels{ 0 };
+	order.reserve(nodes);
+	for (NodeId n = 0; n < nodes; ++n) {
+		if (dependencies[n] == 0) {
+			order.push_back(n);
+		}
+	}
+	for (size_t begin = 0; begin < order.size(); ) {
+		size_t const end = order.size();
+		for (size_t i = begin; i < end; ++i) {
+			for (NodeId d : dependents[order[i]]) {
+				if (--dependencies[d] == 0) {
+					level[d] = levels.size();
+					order.push_back(d);
+				}
+			}
+		}
+		levels.push_back(end);
+		begin = end;
+	}
+	assert(order.size() == nodes && "the graph has a cycle");
+
+	// the level after which the buffer of every port is no longer read
+	std::vector<size_t> lastUse(ports, 0);
+	for (NodeId n = 0; n < nodes; ++n) {
+		for (size_t p = 0; p < m_nodes[n]->outputs(); ++p) {
+			lastUse[outputBase[n] + p] = level[n];
+		}
+	}
+	for (NodeId n = 0; n < nodes; ++n) {
+		for (size_t i = 0; i < m_nodes[n]->inputs(); ++i) {
+			Source const& source = inputSources[inputBase[n] + i];
+			if (source.node != NONE && source.node != INPUT) {
+				size_t& last = lastUse[outputBase[source.node] + source.port];
+				last = std::max(last, level[n]);
+			}
+		}
+	}
+
+	// linear scan over the levels: a buffer released at the end of a level is reused from the next one,
+	// so the nodes of a level never share a buffer and can run at the same time
+	size_t const silence = m_nInputs + m_nOutputs;
+	size_t slots = silence + 1;
+	std::vector<size_t> portSlot(ports, NONE);
+	std::vector<size_t> owner;
+	std::vector<size_t> free;
+	std::vector<std::vector<size_t>> releases(levels.size());
+	m_copies.clear();
+	m_silentOutputs.clear();
+	auto slotOf = [&](Source const& source) {
+		if (source.node == NONE) {
+			return silence;
+		}
+		if (source.node == INPUT) {
+			return source.port;
+		}
+		return portSlot[outputBase[source.node] + source.port];
+	};
+	for (size_t l = 0; l + 1 < levels.size(); ++l) {
+		for (size_t s = levels[l]; s < levels[l + 1]; ++s) {
+			NodeId const n = order[s];
+			AudioNode<BufferType>& node = *m_nodes[n];
+			for (size_t p = 0; p < node.outputs(); ++p) {
+				size_t const port = outputBase[n] + p;
+				if (!graphOutputs[port].empty()) {
+					// written to the host buffer of its first graph output, pinned there
+					portSlot[port] = m_nInputs + graphOutputs[port][0];
+					for (size_t o = 1; o < graphOutputs[port].size(); ++o) {
+						m_copies.emplace_back(portSlot[port], graphOutputs[port][o]);
+					}
+					continue;
+				}
+				if (node.inPlace() && p < node.inputs()) {
+					// takes over the buffer of the matching input when this node is its only reader
+					Source const& source = inputSources[inputBase[n] + p];
+					if (source.node != NONE && source.node != INPUT) {
+						size_t const from = outputBase[source.node] + source.port;
+						if (consumers[from] == 1 && portSlot[from] > silence) {
+							portSlot[port] = portSlot[from];
+							owner[portSlot[port] - silence - 1] = port;
+							releases[lastUse[port]].push_back(port);
+							continue;
+						}
+					}
+				}
+				if (free.empty()) {
+					free.push_back(slots++);
+					owner.push_back(NONE);
+				}
+				portSlot[port] = free.back();
+				free.pop_back();
+				owner[portSlot[port] - silence - 1] = port;
+				releases[lastUse[port]].push_back(port);
+			}
+		}
+		for (size_t port : releases[l]) {
+			if (owner[portSlot[port] - silence - 1] == port) {
+				owner[portSlot[port] - silence - 1] = NONE;
+				free.push_back(portSlot[port]);
+			}
+		}
+	}
+	for (size_t o = 0; o < m_nOutputs; ++o) {
+		Source const& source = outputSources[o];
+		if (source.node == NONE) {
+			m_silentOutputs.push_back(o);
+		}
+		else if (source.node == INPUT) {
+			m_copies.emplace_back(source.port, o);
+		}
+	}
+
+	m_steps.clear();
+	m_inputSlots.clear();
+	m_outputSlots.clear();
+	for (NodeId n : order) {
+		AudioNode<BufferType>& node = *m_nodes[n];
+		m_steps.push_back(Step{ &node, m_inputSlots.size(), m_outputSlots.size() });
+		for (size_t i = 0; i < node.inputs(); ++i) {
+			m_inputSlots.push_back(slotOf(inputSources[inputBase[n] + i]));
+		}
+		for (size_t p = 0; p < node.outputs(); ++p) {
+			m_outputSlots.push_back(portSlot[outputBase[n] + p]);
+		}
+	}
+	m_levels = std::move(levels);
+	m_inputViews.assign(m_inputSlots.size(), AudioStreamView<BufferType const>());
+	m_outputViews.assign(m_outputSlots.size(), AudioStreamView<BufferType>());
+
+	// silence and the intermediate buffers are the channels of a single zeroed stream
+	m_storage.reset();
+	m_storage.emplace(slots - silence, maxBlockSize, *m_pAllocator);
+	m_slots.assign(slots, nullptr);
+	for (size_t s = silence; s < slots; ++s) {
+		m_slots[s] = m_storage->channel(s - silence).data();
+	}
+	m_nMaxBlockSize = maxBlockSize;
+	for (auto& node : m_nodes) {
+		node->prepare(maxBlockSize);
+	}
+	m_bCompiled = true;
+}
+
+template <typename BufferType>
+size_t ProcessingGraph<BufferType>::buffers() const
+{
+	return m_storage ? m_storage->channels() : 0;
+}
+
+template <typename BufferType>
+size_t ProcessingGraph<BufferType>::levels() const
+{
+	return m_levels.empty() ? 0 : m_levels.size() - 1;
+}
+
+template <typename BufferType>
+void ProcessingGraph<BufferType>::process(BufferType const* const* inputs, BufferType* const* outputs, size_t frames)
+{
+	execute(inputs, outputs, frames, [this, frames](size_t begin, size_t end) {
+		for (size_t s = begin; s < end; ++s) {
+			run(m_steps[s], frames);
+		}
+	});
+}
+
+template <typename BufferType>
+template <execution::Policy P>
+void ProcessingGraph<BufferType>::process(P const& policy, BufferType const* const* inputs, BufferType* const* outputs, size_t frames)
+{
+	if constexpr (std::is_same_v<std::remove_cvref_t<P>, execution::sequential>) {
+		process(inputs, outputs, frames);
+	}
+	else {
+		ThreadPool& pool = policy.pool != nullptr ? *policy.pool : threadPool();
+		execute(inputs, outputs, frames, [this, frames, &pool](size_t begin, size_t end) {
+			pool.parallelFor(end - begin, [this, frames, begin](size_t i) {
+				run(m_steps[begin + i], frames);
+			});
+		});
+	}
+}
+
+#pragma endregion
+
+#pragma region ProcessingGraph<BufferType> - Private Methods
+
+template <typename BufferType>
+void ProcessingGraph<BufferType>::run(Step const& step, size_t frames)
+{
+	AudioNode<BufferType>& node = *step.node;
+	for (size_t i = 0; i < node.inputs(); ++i) {
+		m_inputViews[step.firstInput + i] = AudioStreamView<BufferType const>(m_slots[m_inputSlots[step.firstInput + i]], frames);
+	}
+	for (size_t p = 0; p < node.outputs(); ++p) {
+		m_outputViews[step.firstOutput + p] = AudioStreamView<BufferType>(m_slots[m_outputSlots[step.firstOutput + p]], frames);
+	}
+	node.process(m_inputViews.data() + step.firstInput, m_outputViews.data() + step.firstOutput);
+}
+
+template <typename BufferType>
+template <typename ForLevel>
+void ProcessingGraph<BufferType>::execute(BufferType const* const* inputs, BufferType* const* outputs, size_t frames, ForLevel&& forLevel)
+{
+	assert(m_bCompiled && "compile() the graph after changing it");
+	assert(frames <= m_nMaxBlockSize);
+	for (size_t i = 0; i < m_nInputs; ++i) {
+		// the graph inputs are only ever bound to input ports, so they are never written through this pointer
+		m_slots[i] = const_cast<BufferType*>(inputs[i]);
+	}
+	for (size_t o = 0; o < m_nOutputs; ++o) {
+		m_slots[m_nInputs + o] = outputs[o];
+	}
+	for (size_t l = 0; l + 1 < m_levels.size(); ++l) {
+		forLevel(m_levels[l], m_levels[l + 1]);
+	}
+	for (auto const& [from, to] : m_copies) {
+		std::copy_n(m_slots[from], frames, outputs[to]);
+	}
+	for (size_t o : m_silentOutputs) {
+		std::fill_n(outputs[o], frames, BufferType{});
+	}
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_PROCESSING_GRAPH_H
@@ -0,0 +1,427 @@
+#ifndef NYCOLIB_REAL_TIME_POOL_H
+#define NYCOLIB_REAL_TIME_POOL_H
+
+/*
+	Module: RealTimePool (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		RealTimePool contains the RealTimePool allocator and the RealTimeScope guard.
+
+		a RealTimePool takes all of its memory up front (blockCount buffers of up to
+		blockSize bytes, plus as many small blocks for the shared_ptr control blocks)
+		and hands it out and takes it back with lock-free stacks, so allocating from it
+		never locks, never calls malloc and has a bounded cost.
+
+		while a RealTimeScope is alive on a thread, every buffer the library allocates
+		on that thread (clone, operators, expressions, concat) comes from the scope's pool,
+		and so does the shared_ptr control block of a stream over a borrowed or adopted buffer.
+		a request the pool can not serve falls back to the heap and is reported to the
+		scope, which counts it or traps, so a process callback can be proven allocation-free:
+
+			RealTimeScope scope(pool, RealTimeScope::TRAP);
+			AudioStream<float> wet = dry * gain + reverb;
+
+*/
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <assert.h>
+
+#include "AudioAllocator.h"
+
+
+#pragma region nyco - RealTimePool - Declarations
+
+namespace nyco {
+
+/*
+* a fixed number of fixed size blocks, preallocated and recycled with lock-free stacks
+* any thread may allocate and deallocate concurrently
+*/
+class RealTimePool : public AudioAllocator {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new RealTimePool of blockCount buffers of blockSize bytes (rounded up to ALIGNMENT)
+	* all the memory is taken from upstream here, and returned to it when the pool is destroyed
+	*/
+	explicit RealTimePool(size_t blockSize, size_t blockCount, AudioAllocator& upstream = alignedAllocator());
+
+	RealTimePool(RealTimePool const&) = delete;
+
+	~RealTimePool() override;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns a block of the pool. a request larger than blockSize, or one made when the pool is
+	* empty, is served by the upstream allocator and reported to the RealTimeScope of this thread
+	*/
+	void* allocate(size_t bytes) override;
+
+	void deallocate(void* p, size_t bytes) override;
+
+	/*
+	* returns the size in bytes of every buffer block
+	*/
+	size_t blockSize() const;
+
+	/*
+	* returns the number of buffer blocks
+	*/
+	size_t blockCount() const;
+
+	/*
+	* returns the number of buffer blocks that are not allocated
+	*/
+	size_t available() const;
+
+	/*
+	* returns true if p is a block of this pool
+	*/
+	bool owns(void const* p) const;
+
+#pragma endregion
+
+	RealTimePool& operator=(RealTimePool const&) = delete;
+
+#pragma region Private Members
+private:
+
+	/*
+	* a lock-free stack of count blocks of size bytes, carved from one preallocated region.
+	* the head holds the index of the top block and a tag that changes on every update,
+	* so a block that is popped and pushed back between a load and a compare-exchange is detected
+	*/
+	class BlockStack {
+	public:
+		explicit BlockStack(size_t size, size_t count, AudioAllocator& upstream);
+
+		BlockStack(BlockStack const&) = delete;
+
+		~BlockStack();
+
+		void* pop();
+
+		void push(void* p);
+
+		bool owns(void const* p) const;
+
+		size_t size() const;
+
+		size_t count() const;
+
+		size_t available() const;
+
+	private:
+		static constexpr uint32_t EMPTY = UINT32_MAX;
+
+		static uint64_t pack(uint64_t tag, uint32_t index);
+
+		AudioAllocator& m_upstream;
+
+		unsigned char* m_pBlocks;
+
+		size_t m_nSize;
+
+		size_t m_nCount;
+
+		std::unique_ptr<std::atomic<uint32_t>[]> m_pNext;
+
+		alignas(ALIGNMENT) std::atomic<uint64_t> m_nHead;
+
+		alignas(ALIGNMENT) std::atomic<size_t> m_nAvailable;
+	};
+
+	AudioAllocator& m_upstream;
+
+	// the blocks the sample buffers are taken from
+	BlockStack m_buffers;
+
+	// the blocks the shared_ptr control blocks are taken from
+	BlockStack m_smallBlocks;
+
+#pragma endregion
+
+};
+
+/*
+* routes every allocation the library makes on this thread to a RealTimePool while it is alive,
+* and counts (or traps on) the ones that had to go to the heap. scopes can be nested
+*/
+class RealTimeScope {
+
+#pragma region Types
+public:
+
+	enum Policy {
+		// heap allocations are counted, see heapAllocations()
+		COUNT,
+		// the first heap allocation aborts the process, so a debugger stops at it
+		TRAP
+	};
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new RealTimeScope on the calling thread
+	*/
+	explicit RealTimeScope(RealTimePool& pool, Policy policy = COUNT);
+
+	RealTimeScope(RealTimeScope const&) = delete;
+
+	~RealTimeScope();
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the number of heap allocations made on this thread since the scope was constructed
+	*/
+	size_t heapAllocations() const;
+
+	/*
+	* returns the innermost scope of the calling thread, or nullptr
+	*/
+	static RealTimeScope* current();
+
+	/*
+	* reports a heap allocation of bytes bytes made by the library on the calling thread
+	*/
+	static void reportHeapAllocation(size_t bytes);
+
+#pragma endregion
+
+	RealTimeScope& operator=(RealTimeScope const&) = delete;
+
+#pragma region Private Members
+private:
+
+	static RealTimeScope*& currentSlot();
+
+	RealTimePool& m_pool;
+
+	Policy m_policy;
+
+	size_t m_nHeapAllocations;
+
+	RealTimeScope* m_pPrevious;
+
+#pragma endregion
+
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - RealTimePool - Definitions
+
+namespace nyco {
+
+#pragma region RealTimePool::BlockStack
+
+inline RealTimePool::BlockStack::BlockStack(size_t size, size_t count, AudioAllocator& upstream)
+	: m_upstream{ upstream }
+	, m_pBlocks{ static_cast<unsigned char*>(upstream.allocate(size * count)) }
+	, m_nSize{ size }
+	, m_nCount{ count }
+	, m_pNext{ new std::atomic<uint32_t>[count] }
+	, m_nHead{ pack(0, count == 0 ? EMPTY : 0) }
+	, m_nAvailable{ count }
+{
+	assert(count < EMPTY);
+	for (size_t i = 0; i < count; ++i) {
+		m_pNext[i].store(i + 1 < count ? static_cast<uint32_t>(i + 1) : EMPTY, std::memory_order_relaxed);
+	}
+}
+
+inline RealTimePool::BlockStack::~BlockStack()
+{
+	assert(m_nAvailable.load() == m_nCount && "a RealTimePool was destroyed while its blocks are still in use");
+	m_upstream.deallocate(m_pBlocks, m_nSize * m_nCount);
+}
+
+inline void* RealTimePool::BlockStack::pop()
+{
+	uint64_t head = m_nHead.load(std::memory_order_acquire);
+	while (true) {
+		uint32_t const index = static_cast<uint32_t>(head);
+		if (index == EMPTY) {
+			return nullptr;
+		}
+		uint32_t const next = m_pNext[index].load(std::memory_order_relaxed);
+		if (m_nHead.compare_exchange_weak(head, pack((head >> 32) + 1, next), std::memory_order_acquire, std::memory_order_acquire)) {
+			m_nAvailable.fetch_sub(1, std::memory_order_relaxed);
+			return m_pBlocks + index * m_nSize;
+		}
+	}
+}
+
+inline void RealTimePool::BlockStack::push(void* p)
+{
+	uint32_t const index = static_cast<uint32_t>((static_cast<unsigned char*>(p) - m_pBlocks) / m_nSize);
+	uint64_t head = m_nHead.load(std::memory_order_relaxed);
+	do {
+		m_pNext[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+	} while (!m_nHead.compare_exchange_weak(head, pack((head >> 32) + 1, index), std::memory_order_release, std::memory_order_relaxed));
+	m_nAvailable.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline bool RealTimePool::BlockStack::owns(void const* p) const
+{
+	std::uintptr_t const address = reinterpret_cast<std::uintptr_t>(p);
+	std::uintptr_t const first = reinterpret_cast<std::uintptr_t>(m_pBlocks);
+	return address >= first && address < first + m_nSize * m_nCount;
+}
+
+inline size_t RealTimePool::BlockStack::size() const
+{
+	return m_nSize;
+}
+
+inline size_t RealTimePool::BlockStack::count() const
+{
+	return m_nCount;
+}
+
+inline size_t RealTimePool::BlockStack::available() const
+{
+	return m_nAvailable.load(std::memory_order_relaxed);
+}
+
+inline uint64_t RealTimePool::BlockStack::pack(uint64_t tag, uint32_t index)
+{
+	return (tag << 32) | index;
+}
+
+#pragma endregion
+
+#pragma region RealTimePool
+
+inline RealTimePool::RealTimePool(size_t blockSize, size_t blockCount, AudioAllocator& upstream)
+	: m_upstream{ upstream }
+	, m_buffers{ (blockSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, blockCount, upstream }
+	, m_smallBlocks{ ALIGNMENT, blockCount, upstream }
+{
+}
+
+inline RealTimePool::~RealTimePool() = default;
+
+inline void* RealTimePool::allocate(size_t bytes)
+{
+	BlockStack& stack = bytes <= m_smallBlocks.size() ? m_smallBlocks : m_buffers;
+	if (bytes <= stack.size()) {
+		if (void* p = stack.pop()) {
+			return p;
+		}
+	}
+	RealTimeScope::reportHeapAllocation(bytes);
+	return m_upstream.allocate(bytes);
+}
+
+inline void RealTimePool::deallocate(void* p, size_t bytes)
+{
+	if (m_smallBlocks.owns(p)) {
+		m_smallBlocks.push(p);
+	}
+	else if (m_buffers.owns(p)) {
+		m_buffers.push(p);
+	}
+	else {
+		m_upstream.deallocate(p, bytes);
+	}
+}
+
+inline size_t RealTimePool::blockSize() const
+{
+	return m_buffers.size();
+}
+
+inline size_t RealTimePool::blockCount() const
+{
+	return m_buffers.count();
+}
+
+inline size_t RealTimePool::available() const
+{
+	return m_buffers.available();
+}
+
+inline bool RealTimePool::owns(void const* p) const
+{
+	return m_buffers.owns(p) || m_smallBlocks.owns(p);
+}
+
+#pragma endregion
+
+#pragma region RealTimeScope
+
+inline RealTimeScope::RealTimeScope(RealTimePool& pool, Policy policy)
+	: m_pool{ pool }
+	, m_policy{ policy }
+	, m_nHeapAllocations{ 0 }
+	, m_pPrevious{ currentSlot() }
+{
+	currentSlot() = this;
+	detail::scopeAllocatorSlot() = &m_pool;
+}
+
+inline RealTimeScope::~RealTimeScope()
+{
+	assert(currentSlot() == this && "RealTimeScopes must be destroyed in reverse order, on the thread that created them");
+	currentSlot() = m_pPrevious;
+	detail::scopeAllocatorSlot() = m_pPrevious != nullptr ? &m_pPrevious->m_pool : nullptr;
+}
+
+inline size_t RealTimeScope::heapAllocations() const
+{
+	return m_nHeapAllocations;
+}
+
+inline RealTimeScope* RealTimeScope::current()
+{
+	return currentSlot();
+}
+
+inline void RealTimeScope::reportHeapAllocation(size_t)
+{
+	RealTimeScope* scope = currentSlot();
+	if (scope == nullptr) {
+		return;
+	}
+	++scope->m_nHeapAllocations;
+	if (scope->m_policy == TRAP) {
+		std::abort();
+	}
+}
+
+inline RealTimeScope*& RealTimeScope::currentSlot()
+{
+	static thread_local RealTimeScope* scope = nullptr;
+	return scope;
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_REAL_TIME_POOL_H
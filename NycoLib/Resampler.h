@@ -0,0 +1,586 @@
+#ifndef NYCOLIB_RESAMPLER_H
+#define NYCOLIB_RESAMPLER_H
+
+/*
+	Module: Resampler (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		Resampler contains the Resampler class, a streaming polyphase sample rate
+		converter, and the ResamplerQuality presets.
+
+		every output sample is the inner product of the input around its time with a
+		phase of a windowed sinc (Kaiser) filter bank. the bank is computed once per
+		design and shared by every Resampler that uses it.
+
+		between integer sample rates whose reduced ratio L / M has a small L, the bank has
+		exactly L phases and the position advances by exact integer steps, so the
+		conversion never drifts. any other ratio, and varispeed (setRatio), uses a bank of
+		the preset's number of phases and interpolates linearly between the two phases
+		around the position, kept in 32.32 fixed point.
+
+		when downsampling the cutoff follows the output Nyquist frequency and the filter
+		is longer by the same factor, to keep its transition band.
+
+		a Resampler keeps the history of its input between blocks, so a stream can be fed
+		in blocks of any size. a Resampler converts a single channel.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <numeric>
+#include <tuple>
+#include <vector>
+#include <assert.h>
+
+#include "operations.h"
+#include "SimdKernels.h"
+#include "AudioAllocator.h"
+#include "AudioStreamView.h"
+#include "MultiChannelAudioStream.h"
+
+
+#pragma region nyco - Resampler - Declarations
+
+namespace nyco {
+
+/*
+* trades the length of the filter (and the number of phases) for speed
+*/
+enum class ResamplerQuality {
+	Fast,
+	Balanced,
+	High,
+	Best
+};
+
+namespace detail {
+template <typename T>
+struct FilterBank;
+
+template <typename T>
+struct ResamplerDesign;
+}
+
+/*
+* a streaming polyphase sample rate converter of a single channel
+*/
+template <typename BufferType>
+class Resampler {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new Resampler<BufferType> from inputRate to outputRate, with its history buffer from allocator
+	*/
+	explicit Resampler(size_t inputRate, size_t outputRate, ResamplerQuality quality = ResamplerQuality::Balanced, AudioAllocator& allocator = defaultAllocator());
+
+	/*
+	* constructs a new varispeed Resampler<BufferType> of ratio output samples per input sample.
+	* the filter is designed for ratio, setRatio with a lower ratio than that aliases
+	*/
+	explicit Resampler(double ratio, ResamplerQuality quality = ResamplerQuality::Balanced, AudioAllocator& allocator = defaultAllocator());
+
+	Resampler(Resampler<BufferType> const&) = delete;
+
+	Resampler(Resampler<BufferType>&&) = default;
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the number of output samples per input sample
+	*/
+	double ratio() const;
+
+	/*
+	* sets the number of output samples per input sample, a varispeed Resampler only
+	*/
+	void setRatio(double ratio);
+
+	/*
+	* returns the number of input samples that follow an input sample before the output at its time is produced
+	*/
+	size_t latency() const;
+
+	/*
+	* returns the number of output samples the next process of inputSize samples produces
+	*/
+	size_t maxOutput(size_t inputSize) const;
+
+	/*
+	* resamples all of input into output, which has room for maxOutput(input.size()) samples.
+	* returns the number of samples written to output
+	*/
+	size_t process(AudioStreamView<BufferType const> input, AudioStreamView<BufferType> output);
+
+	/*
+	* clears the history, as if no sample had been processed
+	*/
+	void reset();
+
+#pragma endregion
+
+	Resampler<BufferType>& operator=(Resampler<BufferType> const&) = delete;
+
+	Resampler<BufferType>& operator=(Resampler<BufferType>&&) = default;
+
+#pragma region Private Members
+private:
+
+	// the input samples appended to the history at a time
+	static constexpr size_t CHUNK_SIZE = 2048;
+
+	explicit Resampler(detail::ResamplerDesign<BufferType> design, AudioAllocator& allocator);
+
+	std::shared_ptr<detail::FilterBank<BufferType> const> m_pBank;
+
+	// the position is m_nIndex + m_nFraction / m_nDenominator samples into the history, and advances by the step
+	uint64_t m_nDenominator;
+	size_t m_nStepWhole;
+	uint64_t m_nStepFraction;
+	size_t m_nIndex;
+	uint64_t m_nFraction;
+
+	bool m_bVarispeed;
+
+	// the past input, taps + CHUNK_SIZE samples of which m_nFill are valid
+	MultiChannelAudioStream<BufferType> m_history;
+	size_t m_nFill;
+
+#pragma endregion
+};
+
+}
+
+#pragma endregion
+
+#pragma region nyco - Resampler - Definitions
+
+namespace nyco {
+
+namespace detail {
+
+#pragma region Filter Banks
+
+// the design parameters of a ResamplerQuality
+struct ResamplerPreset {
+	size_t taps;
+	size_t phases;
+	double beta;
+	double bandwidth;
+};
+
+inline ResamplerPreset resamplerPreset(ResamplerQuality quality)
+{
+	switch (quality) {
+	case ResamplerQuality::Fast:
+		return { 16, 128, 6.0, 0.85 };
+	case ResamplerQuality::High:
+		return { 64, 512, 10.0, 0.94 };
+	case ResamplerQuality::Best:
+		return { 128, 1024, 12.0, 0.96 };
+	default:
+		return { 32, 256, 8.0, 0.90 };
+	}
+}
+
+/*
+* the zeroth order modified Bessel function of the first kind, of the Kaiser window
+*/
+inline double besselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 64; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-17) {
+			break;
+		}
+	}
+	return sum;
+}
+
+/*
+* phases + 1 rows of taps coefficients, row p filters the input at p / phases samples after a sample.
+* the last row (one sample after) is there for the interpolation between phases
+*/
+template <typename T>
+struct FilterBank {
+	FilterBank(size_t phases, size_t taps, double cutoff, double beta);
+
+	size_t phases;
+	size_t taps;
+	std::vector<T> coefficients;
+};
+
+template <typename T>
+FilterBank<T>::FilterBank(size_t phases, size_t taps, double cutoff, double beta)
+	: phases{ phases }
+	, taps{ taps }
+	, coefficients((phases + 1) * taps)
+{
+	double const half = double(taps / 2);
+	double const norm = 1.0 / besselI0(beta);
+	std::vector<double> row(taps);
+	for (size_t p = 0; p <= phases; ++p) {
+		double const phase = double(p) / double(phases);
+		double sum = 0.0;
+		for (size_t k = 0; k < taps; ++k) {
+			// the distance from the output time to the k-th input sample of the window
+			double const t = phase + half - 1.0 - double(k);
+			double const x = std::numbers::pi * cutoff * t;
+			double const sinc = x == 0.0 ? 1.0 : std::sin(x) / x;
+			double const u = t / half;
+			double const window = u * u < 1.0 ? besselI0(beta * std::sqrt(1.0 - u * u)) * norm : 0.0;
+			row[k] = sinc * window;
+			sum += row[k];
+		}
+		// unity gain at DC for every phase
+		for (size_t k = 0; k < taps; ++k) {
+			coefficients[p * taps + k] = T(row[k] / sum);
+		}
+	}
+}
+
+/*
+* returns the filter bank of the given design, computed the first time it is asked for and shared after that
+*/
+template <typename T>
+std::shared_ptr<FilterBank<T> const> cachedFilterBank(size_t phases, size_t taps, double cutoff, double beta)
+{
+	static std::mutex lock;
+	static std::map<std::tuple<size_t, size_t, double, double>, std::shared_ptr<FilterBank<T> const>> banks;
+	std::lock_guard<std::mutex> guard(lock);
+	std::shared_ptr<FilterBank<T> const>& bank = banks[{ phases, taps, cutoff, beta }];
+	if (!bank) {
+		bank = std::make_shared<FilterBank<T> const>(phases, taps, cutoff, beta);
+	}
+	return bank;
+}
+
+/*
+* the filter bank and the step of a Resampler
+*/
+template <typename T>
+struct ResamplerDesign {
+	std::shared_ptr<FilterBank<T> const> bank;
+	uint64_t denominator;
+	size_t stepWhole;
+	uint64_t stepFraction;
+	bool varispeed;
+};
+
+/*
+* the design of a Resampler of ratio output samples per input sample, in 32.32 fixed point
+*/
+template <typename T>
+ResamplerDesign<T> resamplerDesign(double ratio, ResamplerQuality quality)
+{
+	assert(ratio > 0.0);
+	ResamplerPreset const preset = resamplerPreset(quality);
+	double const cutoff = std::min(1.0, ratio);
+	// the filter is longer by the downsampling factor, rounded to whole registers
+	size_t const taps = (size_t(std::ceil(double(preset.taps) / cutoff)) + 7) & ~size_t(7);
+	uint64_t const step = uint64_t(std::llround(std::ldexp(1.0 / ratio, 32)));
+	assert(step > 0);
+	return { cachedFilterBank<T>(preset.phases, taps, cutoff * preset.bandwidth, preset.beta), uint64_t(1) << 32, size_t(step >> 32), step & 0xFFFFFFFFu, true };
+}
+
+/*
+* the design of a Resampler from inputRate to outputRate. a small reduced ratio gets a bank of
+* exactly its phases, every position is then a phase
+*/
+template <typename T>
+ResamplerDesign<T> resamplerDesign(size_t inputRate, size_t outputRate, ResamplerQuality quality)
+{
+	assert(inputRate > 0 && outputRate > 0);
+	size_t const divisor = std::gcd(inputRate, outputRate);
+	size_t const up = outputRate / divisor;
+	size_t const down = inputRate / divisor;
+	if (up > 4096) {
+		ResamplerDesign<T> design = resamplerDesign<T>(double(outputRate) / double(inputRate), quality);
+		design.varispeed = false;
+		return design;
+	}
+	ResamplerPreset const preset = resamplerPreset(quality);
+	double const cutoff = std::min(1.0, double(up) / double(down));
+	size_t const taps = (size_t(std::ceil(double(preset.taps) / cutoff)) + 7) & ~size_t(7);
+	return { cachedFilterBank<T>(up, taps, cutoff * preset.bandwidth, preset.beta), up, down / up, down % up, false };
+}
+
+#pragma endregion
+
+#pragma region Kernels
+
+// the position of a Resampler in its history, and its step per output sample
+struct ResamplerPosition {
+	size_t index;
+	uint64_t fraction;
+	uint64_t denominator;
+	size_t stepWhole;
+	uint64_t stepFraction;
+};
+
+// dot and dot2 are not compiled for the instruction set of V, their registers only reach V by reference
+template <typename V, typename T>
+T dot(T const* x, T const* h, size_t n)
+{
+	typename V::reg acc;
+	typename V::reg a;
+	typename V::reg b;
+	V::broadcast(acc, T(0));
+	size_t k = 0;
+	for (; k + V::width <= n; k += V::width) {
+		V::load(a, x + k);
+		V::load(b, h + k);
+		V::apply(operations::Multiply{}, a, a, b);
+		V::apply(operations::Add{}, acc, acc, a);
+	}
+	T lanes[V::width];
+	V::store(lanes, acc);
+	T sum = T(0);
+	for (size_t i = 0; i < V::width; ++i) {
+		sum += lanes[i];
+	}
+	for (; k < n; ++k) {
+		sum += x[k] * h[k];
+	}
+	return sum;
+}
+
+template <typename V, typename T>
+T dot2(T const* x, T const* h0, T const* h1, T weight, size_t n)
+{
+	typename V::reg acc0;
+	typename V::reg acc1;
+	typename V::reg v;
+	typename V::reg a;
+	typename V::reg b;
+	V::broadcast(acc0, T(0));
+	V::broadcast(acc1, T(0));
+	size_t k = 0;
+	for (; k + V::width <= n; k += V::width) {
+		V::load(v, x + k);
+		V::load(a, h0 + k);
+		V::load(b, h1 + k);
+		V::apply(operations::Multiply{}, a, v, a);
+		V::apply(operations::Multiply{}, b, v, b);
+		V::apply(operations::Add{}, acc0, acc0, a);
+		V::apply(operations::Add{}, acc1, acc1, b);
+	}
+	T lanes0[V::width];
+	T lanes1[V::width];
+	V::store(lanes0, acc0);
+	V::store(lanes1, acc1);
+	T sum0 = T(0);
+	T sum1 = T(0);
+	for (size_t i = 0; i < V::width; ++i) {
+		sum0 += lanes0[i];
+		sum1 += lanes1[i];
+	}
+	for (; k < n; ++k) {
+		sum0 += x[k] * h0[k];
+		sum1 += x[k] * h1[k];
+	}
+	return sum0 + (sum1 - sum0) * weight;
+}
+
+/*
+* writes up to size output samples from the available samples of history, advancing position.
+* returns the number of samples written
+*/
+template <typename V, typename T>
+size_t resample(FilterBank<T> const& bank, T const* history, size_t available, ResamplerPosition& position, T* output, size_t size)
+{
+	size_t const taps = bank.taps;
+	T const* const coefficients = bank.coefficients.data();
+	bool const interpolate = position.denominator != bank.phases;
+	T const scale = T(1) / T(position.denominator);
+	size_t n = 0;
+	while (n < size && position.index + taps <= available) {
+		uint64_t const scaled = position.fraction * bank.phases;
+		size_t const row = size_t(scaled / position.denominator);
+		T const* const h = coefficients + row * taps;
+		if (interpolate) {
+			output[n] = dot2<V>(history + position.index, h, h + taps, T(scaled % position.denominator) * scale, taps);
+		}
+		else {
+			output[n] = dot<V>(history + position.index, h, taps);
+		}
+		++n;
+
+		position.fraction += position.stepFraction;
+		if (position.fraction >= position.denominator) {
+			position.fraction -= position.denominator;
+			++position.index;
+		}
+		position.index += position.stepWhole;
+	}
+	return n;
+}
+
+#if NYCO_SIMD_X86
+template <typename T>
+NYCO_SIMD_TARGET_SSE2 NYCO_SIMD_FLATTEN size_t resampleSse2(FilterBank<T> const& bank, T const* history, size_t available, ResamplerPosition& position, T* output, size_t size)
+{
+	return resample<simd::sse2::Vec<T>>(bank, history, available, position, output, size);
+}
+
+template <typename T>
+NYCO_SIMD_TARGET_AVX2 NYCO_SIMD_FLATTEN size_t resampleAvx2(FilterBank<T> const& bank, T const* history, size_t available, ResamplerPosition& position, T* output, size_t size)
+{
+	return resample<simd::avx2::Vec<T>>(bank, history, available, position, output, size);
+}
+#endif
+
+/*
+* resample with the selected instruction set
+*/
+template <typename T>
+size_t resample(FilterBank<T> const& bank, T const* history, size_t available, ResamplerPosition& position, T* output, size_t size)
+{
+#if NYCO_SIMD_X86
+	switch (simd::instructionSet()) {
+	case simd::InstructionSet::AVX512:
+	case simd::InstructionSet::AVX2:
+		return resampleAvx2(bank, history, available, position, output, size);
+	case simd::InstructionSet::SSE2:
+		return resampleSse2(bank, history, available, position, output, size);
+	default:
+		break;
+	}
+#endif
+	return resample<simd::scalar::Vec<T>>(bank, history, available, position, output, size);
+}
+
+#pragma endregion
+
+}
+
+#pragma region Resampler<BufferType>
+
+template <typename BufferType>
+Resampler<BufferType>::Resampler(size_t inputRate, size_t outputRate, ResamplerQuality quality, AudioAllocator& allocator)
+	: Resampler(detail::resamplerDesign<BufferType>(inputRate, outputRate, quality), allocator)
+{
+}
+
+template <typename BufferType>
+Resampler<BufferType>::Resampler(double ratio, ResamplerQuality quality, AudioAllocator& allocator)
+	: Resampler(detail::resamplerDesign<BufferType>(ratio, quality), allocator)
+{
+}
+
+template <typename BufferType>
+Resampler<BufferType>::Resampler(detail::ResamplerDesign<BufferType> design, AudioAllocator& allocator)
+	: m_pBank{ std::move(design.bank) }
+	, m_nDenominator{ design.denominator }
+	, m_nStepWhole{ design.stepWhole }
+	, m_nStepFraction{ design.stepFraction }
+	, m_nIndex{ 0 }
+	, m_nFraction{ 0 }
+	, m_bVarispeed{ design.varispeed }
+	, m_history(1, m_pBank->taps + CHUNK_SIZE, allocator)
+	, m_nFill{ 0 }
+{
+	reset();
+}
+
+template <typename BufferType>
+double Resampler<BufferType>::ratio() const
+{
+	return double(m_nDenominator) / (double(m_nStepWhole) * double(m_nDenominator) + double(m_nStepFraction));
+}
+
+template <typename BufferType>
+void Resampler<BufferType>::setRatio(double ratio)
+{
+	assert(m_bVarispeed && ratio > 0.0);
+	uint64_t const step = uint64_t(std::llround(std::ldexp(1.0 / ratio, 32)));
+	assert(step > 0);
+	m_nStepWhole = size_t(step >> 32);
+	m_nStepFraction = step & 0xFFFFFFFFu;
+}
+
+template <typename BufferType>
+size_t Resampler<BufferType>::latency() const
+{
+	return m_pBank->taps / 2;
+}
+
+template <typename BufferType>
+size_t Resampler<BufferType>::maxOutput(size_t inputSize) const
+{
+	size_t const available = m_nFill + inputSize;
+	size_t const taps = m_pBank->taps;
+	if (available < taps || m_nIndex > available - taps) {
+		return 0;
+	}
+	// the positions, in 1 / m_nDenominator samples, of the first and the last output the available samples cover
+	assert(available - taps < (size_t(1) << 31));
+	uint64_t const first = uint64_t(m_nIndex) * m_nDenominator + m_nFraction;
+	uint64_t const last = uint64_t(available - taps + 1) * m_nDenominator - 1;
+	uint64_t const step = uint64_t(m_nStepWhole) * m_nDenominator + m_nStepFraction;
+	return size_t((last - first) / step) + 1;
+}
+
+template <typename BufferType>
+size_t Resampler<BufferType>::process(AudioStreamView<BufferType const> input, AudioStreamView<BufferType> output)
+{
+	assert(output.size() >= maxOutput(input.size()));
+	BufferType* const history = m_history.channel(0).data();
+	size_t const capacity = m_history.size();
+	detail::ResamplerPosition position{ m_nIndex, m_nFraction, m_nDenominator, m_nStepWhole, m_nStepFraction };
+
+	size_t consumed = 0;
+	size_t produced = 0;
+	do {
+		size_t const n = std::min(input.size() - consumed, capacity - m_nFill);
+		std::memcpy(history + m_nFill, input.data() + consumed, n * sizeof(BufferType));
+		m_nFill += n;
+		consumed += n;
+		produced += detail::resample(*m_pBank, history, m_nFill, position, output.data() + produced, output.size() - produced);
+
+		// the samples before the position are not needed anymore, a step longer than the history skips input too
+		size_t const drop = std::min(position.index, m_nFill);
+		std::memmove(history, history + drop, (m_nFill - drop) * sizeof(BufferType));
+		m_nFill -= drop;
+		position.index -= drop;
+	} while (consumed < input.size());
+
+	m_nIndex = position.index;
+	m_nFraction = position.fraction;
+	return produced;
+}
+
+template <typename BufferType>
+void Resampler<BufferType>::reset()
+{
+	// the window of the first output is centered on the first input sample, the samples before it are silence
+	m_nFill = m_pBank->taps / 2 - 1;
+	std::memset(m_history.channel(0).data(), 0, m_nFill * sizeof(BufferType));
+	m_nIndex = 0;
+	m_nFraction = 0;
+}
+
+#pragma endregion
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_RESAMPLER_H
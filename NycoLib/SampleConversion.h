@@ -0,0 +1,972 @@
+#ifndef NYCOLIB_SAMPLE_CONVERSION_H
+#define NYCOLIB_SAMPLE_CONVERSION_H
+
+/*
+	Module: SampleConversion (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		SampleConversion contains the vectorized kernels that move samples in and out of
+		float streams: int16, packed 24 bit, int32 and double PCM to float and back, scaled
+		to [-1, 1), clipped on the way down with optional TPDF dither, and the interleaved
+		<-> planar transposes for 2, 4, 8 and any number of channels. the kernels dispatch
+		on the instruction set selected in SimdKernels.
+
+		interleave() and deinterleave() convert the sample type on the way, a tile that
+		fits in the L1 cache at a time, so a host or file buffer is read and the planar
+		channels are written in a single pass.
+
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <assert.h>
+
+#include "SimdKernels.h"
+#include "AudioStreamView.h"
+#include "MultiChannelAudioStream.h"
+
+
+#pragma region nyco - SampleConversion - Declarations
+
+namespace nyco {
+namespace conversion {
+
+/*
+* a packed little endian 24 bit PCM sample, the layout of files and most audio interfaces
+*/
+struct Int24 {
+	unsigned char bytes[3];
+};
+
+static_assert(sizeof(Int24) == 3, "Int24 must be packed");
+
+/*
+* triangular (TPDF) dither of +-1 LSB, added to samples before they are rounded to a narrower integer
+* every value is the difference of two uniform values drawn from one of eight xorshift generators,
+* one per lane of the widest kernel. the state is kept between calls, so use one TpdfDither per
+* stream and never share it between threads
+*/
+class TpdfDither {
+
+#pragma region Constants
+public:
+
+	// the number of independent generators
+	static constexpr size_t LANES = 8;
+
+#pragma endregion
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new TpdfDither with every generator seeded from seed
+	*/
+	explicit TpdfDither(uint32_t seed = 0x9E3779B9u);
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* returns the next dither value, in (-1, 1) LSB
+	*/
+	float next();
+
+	/*
+	* returns the LANES generators, loaded and written back by the vector kernels
+	*/
+	uint32_t* state();
+
+#pragma endregion
+
+#pragma region Private Members
+private:
+
+	uint32_t m_state[LANES];
+	size_t m_nLane;
+
+#pragma endregion
+};
+
+// integer PCM to float: scaled by 2^-(bits - 1), dither is ignored
+void convert(float* dst, int16_t const* src, size_t length, TpdfDither* dither = nullptr);
+void convert(float* dst, Int24 const* src, size_t length, TpdfDither* dither = nullptr);
+void convert(float* dst, int32_t const* src, size_t length, TpdfDither* dither = nullptr);
+
+// float to integer PCM: scaled by 2^(bits - 1), dithered when dither is not nullptr, clipped and rounded to nearest
+void convert(int16_t* dst, float const* src, size_t length, TpdfDither* dither = nullptr);
+void convert(Int24* dst, float const* src, size_t length, TpdfDither* dither = nullptr);
+void convert(int32_t* dst, float const* src, size_t length, TpdfDither* dither = nullptr);
+
+// float <-> double and float <-> float, dither is ignored
+void convert(float* dst, double const* src, size_t length, TpdfDither* dither = nullptr);
+void convert(double* dst, float const* src, size_t length, TpdfDither* dither = nullptr);
+void convert(float* dst, float const* src, size_t length, TpdfDither* dither = nullptr);
+
+/*
+* converts dst.size() samples at src into dst
+*/
+template <typename Source>
+void convert(AudioStreamView<float> dst, Source const* src);
+
+/*
+* converts the samples of src into dst, see convert(Target*, float const*, size_t, TpdfDither*)
+*/
+template <typename Target>
+void convert(Target* dst, AudioStreamView<float const> src, TpdfDither* dither = nullptr);
+
+/*
+* dst[f * channelCount + c] = channels[c][f] for every frame f in [0, frames), converted to Target
+*/
+template <typename Target, typename Source>
+void interleave(Target* dst, Source const* const* channels, size_t channelCount, size_t frames, TpdfDither* dither = nullptr);
+
+/*
+* interleaves every channel of src into dst, see interleave(Target*, Source const* const*, ...)
+*/
+template <typename Target, typename Source>
+void interleave(Target* dst, MultiChannelAudioStream<Source> const& src, TpdfDither* dither = nullptr);
+
+/*
+* channels[c][f] = src[f * channelCount + c] for every frame f in [0, frames), converted to Target
+*/
+template <typename Target, typename Source>
+void deinterleave(Target* const* channels, Source const* src, size_t channelCount, size_t frames, TpdfDither* dither = nullptr);
+
+/*
+* deinterleaves dst.size() frames of dst.channels() channels at src into dst
+*/
+template <typename Target, typename Source>
+void deinterleave(MultiChannelAudioStream<Target>& dst, Source const* src, TpdfDither* dither = nullptr);
+
+}
+}
+
+#pragma endregion
+
+#pragma region nyco - SampleConversion - Definitions
+
+namespace nyco {
+namespace conversion {
+
+#pragma region TpdfDither
+
+inline TpdfDither::TpdfDither(uint32_t seed)
+	: m_state{}
+	, m_nLane{ 0 }
+{
+	for (size_t i = 0; i < LANES; ++i) {
+		// a murmur finalizer spreads the seed, xorshift never leaves a zero state so one is replaced
+		uint32_t x = seed + 0x9E3779B9u * static_cast<uint32_t>(i + 1);
+		x ^= x >> 16;
+		x *= 0x85EBCA6Bu;
+		x ^= x >> 13;
+		x *= 0xC2B2AE35u;
+		x ^= x >> 16;
+		m_state[i] = x != 0 ? x : 1;
+	}
+}
+
+inline float TpdfDither::next()
+{
+	uint32_t& s = m_state[m_nLane];
+	m_nLane = (m_nLane + 1) % LANES;
+	auto step = [&s]() {
+		s ^= s << 13;
+		s ^= s >> 17;
+		s ^= s << 5;
+		return static_cast<int32_t>(s >> 8);
+	};
+	int32_t const a = step();
+	int32_t const b = step();
+	return static_cast<float>(a - b) * (1.0f / 16777216.0f);
+}
+
+inline uint32_t* TpdfDither::state()
+{
+	return m_state;
+}
+
+#pragma endregion
+
+#pragma region Scalar Kernels
+
+namespace scalar {
+// the PCM scale and the largest value (as a float) of a signed integer of the given bits
+template <int Bits>
+struct Range {
+	static constexpr float scale = static_cast<float>(uint64_t{ 1 } << (Bits - 1));
+	static constexpr float high = Bits <= 24 ? scale - 1.0f : 2147483520.0f;
+};
+
+template <int Bits>
+int32_t quantize(float x, TpdfDither* dither)
+{
+	float v = x * Range<Bits>::scale;
+	if (dither != nullptr) {
+		v += dither->next();
+	}
+	// the comparisons are ordered like maxps / minps, so NaN clips to the bottom in every kernel
+	v = v > -Range<Bits>::scale ? v : -Range<Bits>::scale;
+	v = v < Range<Bits>::high ? v : Range<Bits>::high;
+	return static_cast<int32_t>(std::lrint(v));
+}
+
+inline void run(float* dst, int16_t const* src, size_t length, TpdfDither*)
+{
+	for (size_t i = 0; i < length; ++i) {
+		dst[i] = static_cast<float>(src[i]) * (1.0f / 32768.0f);
+	}
+}
+
+inline void run(float* dst, Int24 const* src, size_t length, TpdfDither*)
+{
+	for (size_t i = 0; i < length; ++i) {
+		uint32_t const bits = (static_cast<uint32_t>(src[i].bytes[2]) << 24) | (static_cast<uint32_t>(src[i].bytes[1]) << 16) | (static_cast<uint32_t>(src[i].bytes[0]) << 8);
+		dst[i] = static_cast<float>(static_cast<int32_t>(bits)) * (1.0f / 2147483648.0f);
+	}
+}
+
+inline void run(float* dst, int32_t const* src, size_t length, TpdfDither*)
+{
+	for (size_t i = 0; i < length; ++i) {
+		dst[i] = static_cast<float>(src[i]) * (1.0f / 2147483648.0f);
+	}
+}
+
+inline void run(int16_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	for (size_t i = 0; i < length; ++i) {
+		dst[i] = static_cast<int16_t>(quantize<16>(src[i], dither));
+	}
+}
+
+inline void run(Int24* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	for (size_t i = 0; i < length; ++i) {
+		uint32_t const v = static_cast<uint32_t>(quantize<24>(src[i], dither));
+		dst[i].bytes[0] = static_cast<unsigned char>(v);
+		dst[i].bytes[1] = static_cast<unsigned char>(v >> 8);
+		dst[i].bytes[2] = static_cast<unsigned char>(v >> 16);
+	}
+}
+
+inline void run(int32_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	for (size_t i = 0; i < length; ++i) {
+		dst[i] = quantize<32>(src[i], dither);
+	}
+}
+
+inline void run(float* dst, double const* src, size_t length, TpdfDither*)
+{
+	for (size_t i = 0; i < length; ++i) {
+		dst[i] = static_cast<float>(src[i]);
+	}
+}
+
+inline void run(double* dst, float const* src, size_t length, TpdfDither*)
+{
+	for (size_t i = 0; i < length; ++i) {
+		dst[i] = static_cast<double>(src[i]);
+	}
+}
+
+inline void run(float* dst, float const* src, size_t length, TpdfDither*)
+{
+	if (length != 0 && dst != src) {
+		std::memmove(dst, src, length * sizeof(float));
+	}
+}
+}
+
+#pragma endregion
+
+#if NYCO_SIMD_X86
+
+#pragma region SSE2 Kernels
+
+// every vector kernel returns the number of samples it converted, the dispatcher finishes the rest with scalar code
+namespace sse2 {
+NYCO_SIMD_TARGET_SSE2 inline __m128i xorshift(__m128i s)
+{
+	s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+	s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+	return _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+}
+
+// the next four dither values, one from each of the first four generators
+NYCO_SIMD_TARGET_SSE2 inline __m128 dither(__m128i& s)
+{
+	s = xorshift(s);
+	__m128i const a = _mm_srli_epi32(s, 8);
+	s = xorshift(s);
+	__m128i const b = _mm_srli_epi32(s, 8);
+	return _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(a, b)), _mm_set1_ps(1.0f / 16777216.0f));
+}
+
+template <int Bits>
+NYCO_SIMD_TARGET_SSE2 __m128i quantize(__m128 x, __m128i* state)
+{
+	__m128 v = _mm_mul_ps(x, _mm_set1_ps(scalar::Range<Bits>::scale));
+	if (state != nullptr) {
+		v = _mm_add_ps(v, dither(*state));
+	}
+	v = _mm_max_ps(v, _mm_set1_ps(-scalar::Range<Bits>::scale));
+	v = _mm_min_ps(v, _mm_set1_ps(scalar::Range<Bits>::high));
+	return _mm_cvtps_epi32(v);
+}
+
+NYCO_SIMD_TARGET_SSE2 inline size_t run(float* dst, int16_t const* src, size_t length, TpdfDither*)
+{
+	__m128 const scale = _mm_set1_ps(1.0f / 32768.0f);
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		__m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		// the samples are moved to the top half of every lane, and sign extended by the arithmetic shift
+		__m128i const lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i const hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_SSE2 inline size_t run(float* dst, int32_t const* src, size_t length, TpdfDither*)
+{
+	__m128 const scale = _mm_set1_ps(1.0f / 2147483648.0f);
+	size_t i = 0;
+	for (; i + 4 <= length; i += 4) {
+		__m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_SSE2 inline size_t run(int16_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	__m128i state = dither != nullptr ? _mm_loadu_si128(reinterpret_cast<__m128i const*>(dither->state())) : _mm_setzero_si128();
+	__m128i* const s = dither != nullptr ? &state : nullptr;
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		__m128i const lo = quantize<16>(_mm_loadu_ps(src + i), s);
+		__m128i const hi = quantize<16>(_mm_loadu_ps(src + i + 4), s);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+	}
+	if (dither != nullptr) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dither->state()), state);
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_SSE2 inline size_t run(int32_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	__m128i state = dither != nullptr ? _mm_loadu_si128(reinterpret_cast<__m128i const*>(dither->state())) : _mm_setzero_si128();
+	__m128i* const s = dither != nullptr ? &state : nullptr;
+	size_t i = 0;
+	for (; i + 4 <= length; i += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), quantize<32>(_mm_loadu_ps(src + i), s));
+	}
+	if (dither != nullptr) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dither->state()), state);
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_SSE2 inline size_t run(float* dst, double const* src, size_t length, TpdfDither*)
+{
+	size_t i = 0;
+	for (; i + 4 <= length; i += 4) {
+		__m128 const lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+		__m128 const hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+		_mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_SSE2 inline size_t run(double* dst, float const* src, size_t length, TpdfDither*)
+{
+	size_t i = 0;
+	for (; i + 4 <= length; i += 4) {
+		__m128 const v = _mm_loadu_ps(src + i);
+		_mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+		_mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+	}
+	return i;
+}
+
+template <typename Target, typename Source>
+constexpr bool supports = requires(Target* dst, Source const* src, size_t length, TpdfDither* dither) { run(dst, src, length, dither); };
+
+// the transposes move 32 bit samples as floats, they return the number of frames moved
+NYCO_SIMD_TARGET_SSE2 inline size_t interleave2(float* dst, float const* const* channels, size_t frames)
+{
+	size_t f = 0;
+	for (; f + 4 <= frames; f += 4) {
+		__m128 const l = _mm_loadu_ps(channels[0] + f);
+		__m128 const r = _mm_loadu_ps(channels[1] + f);
+		_mm_storeu_ps(dst + 2 * f, _mm_unpacklo_ps(l, r));
+		_mm_storeu_ps(dst + 2 * f + 4, _mm_unpackhi_ps(l, r));
+	}
+	return f;
+}
+
+NYCO_SIMD_TARGET_SSE2 inline size_t deinterleave2(float* const* channels, float const* src, size_t frames)
+{
+	size_t f = 0;
+	for (; f + 4 <= frames; f += 4) {
+		__m128 const a = _mm_loadu_ps(src + 2 * f);
+		__m128 const b = _mm_loadu_ps(src + 2 * f + 4);
+		_mm_storeu_ps(channels[0] + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(channels[1] + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+	return f;
+}
+
+// 4 x 4 blocks, every group of four channels is transposed on its own
+template <size_t N>
+NYCO_SIMD_TARGET_SSE2 size_t interleaveBlocks(float* dst, float const* const* channels, size_t frames)
+{
+	size_t f = 0;
+	for (; f + 4 <= frames; f += 4) {
+		for (size_t c = 0; c < N; c += 4) {
+			__m128 r0 = _mm_loadu_ps(channels[c] + f);
+			__m128 r1 = _mm_loadu_ps(channels[c + 1] + f);
+			__m128 r2 = _mm_loadu_ps(channels[c + 2] + f);
+			__m128 r3 = _mm_loadu_ps(channels[c + 3] + f);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(dst + f * N + c, r0);
+			_mm_storeu_ps(dst + (f + 1) * N + c, r1);
+			_mm_storeu_ps(dst + (f + 2) * N + c, r2);
+			_mm_storeu_ps(dst + (f + 3) * N + c, r3);
+		}
+	}
+	return f;
+}
+
+template <size_t N>
+NYCO_SIMD_TARGET_SSE2 size_t deinterleaveBlocks(float* const* channels, float const* src, size_t frames)
+{
+	size_t f = 0;
+	for (; f + 4 <= frames; f += 4) {
+		for (size_t c = 0; c < N; c += 4) {
+			__m128 r0 = _mm_loadu_ps(src + f * N + c);
+			__m128 r1 = _mm_loadu_ps(src + (f + 1) * N + c);
+			__m128 r2 = _mm_loadu_ps(src + (f + 2) * N + c);
+			__m128 r3 = _mm_loadu_ps(src + (f + 3) * N + c);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(channels[c] + f, r0);
+			_mm_storeu_ps(channels[c + 1] + f, r1);
+			_mm_storeu_ps(channels[c + 2] + f, r2);
+			_mm_storeu_ps(channels[c + 3] + f, r3);
+		}
+	}
+	return f;
+}
+}
+
+#pragma endregion
+
+#pragma region AVX2 Kernels
+
+namespace avx2 {
+NYCO_SIMD_TARGET_AVX2 inline __m256i xorshift(__m256i s)
+{
+	s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 13));
+	s = _mm256_xor_si256(s, _mm256_srli_epi32(s, 17));
+	return _mm256_xor_si256(s, _mm256_slli_epi32(s, 5));
+}
+
+NYCO_SIMD_TARGET_AVX2 inline __m256 dither(__m256i& s)
+{
+	s = xorshift(s);
+	__m256i const a = _mm256_srli_epi32(s, 8);
+	s = xorshift(s);
+	__m256i const b = _mm256_srli_epi32(s, 8);
+	return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(a, b)), _mm256_set1_ps(1.0f / 16777216.0f));
+}
+
+template <int Bits>
+NYCO_SIMD_TARGET_AVX2 __m256i quantize(__m256 x, __m256i* state)
+{
+	__m256 v = _mm256_mul_ps(x, _mm256_set1_ps(scalar::Range<Bits>::scale));
+	if (state != nullptr) {
+		v = _mm256_add_ps(v, dither(*state));
+	}
+	v = _mm256_max_ps(v, _mm256_set1_ps(-scalar::Range<Bits>::scale));
+	v = _mm256_min_ps(v, _mm256_set1_ps(scalar::Range<Bits>::high));
+	return _mm256_cvtps_epi32(v);
+}
+
+NYCO_SIMD_TARGET_AVX2 inline __m256i loadState(TpdfDither* dither)
+{
+	return dither != nullptr ? _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dither->state())) : _mm256_setzero_si256();
+}
+
+NYCO_SIMD_TARGET_AVX2 inline void storeState(TpdfDither* dither, __m256i state)
+{
+	if (dither != nullptr) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dither->state()), state);
+	}
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t run(float* dst, int16_t const* src, size_t length, TpdfDither*)
+{
+	__m256 const scale = _mm256_set1_ps(1.0f / 32768.0f);
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		__m256i const v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i)));
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+	}
+	return i;
+}
+
+// the 24 bit kernels move 8 samples as two 12 byte halves with 16 byte loads and stores,
+// so they stop while the 4 bytes past the last half are still inside the buffer
+NYCO_SIMD_TARGET_AVX2 inline size_t run(float* dst, Int24 const* src, size_t length, TpdfDither*)
+{
+	unsigned char const* bytes = reinterpret_cast<unsigned char const*>(src);
+	// every sample lands in the top three bytes of its lane, so its sign is the sign of the int32
+	__m256i const spread = _mm256_setr_epi8(
+		-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+		-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+	__m256 const scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+	size_t i = 0;
+	for (; i + 10 <= length; i += 8) {
+		unsigned char const* p = bytes + 3 * i;
+		__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))),
+			_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 12)), 1);
+		v = _mm256_shuffle_epi8(v, spread);
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t run(float* dst, int32_t const* src, size_t length, TpdfDither*)
+{
+	__m256 const scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		__m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t run(int16_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	__m256i state = loadState(dither);
+	__m256i* const s = dither != nullptr ? &state : nullptr;
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16) {
+		__m256i const lo = quantize<16>(_mm256_loadu_ps(src + i), s);
+		__m256i const hi = quantize<16>(_mm256_loadu_ps(src + i + 8), s);
+		// packs works within 128 bit lanes, the permute puts the four quarters back in order
+		__m256i const packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+	}
+	storeState(dither, state);
+	return i;
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t run(Int24* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	unsigned char* bytes = reinterpret_cast<unsigned char*>(dst);
+	__m256i const pack = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	__m256i state = loadState(dither);
+	__m256i* const s = dither != nullptr ? &state : nullptr;
+	size_t i = 0;
+	for (; i + 10 <= length; i += 8) {
+		unsigned char* p = bytes + 3 * i;
+		__m256i const v = _mm256_shuffle_epi8(quantize<24>(_mm256_loadu_ps(src + i), s), pack);
+		// the second store overwrites the 4 unused bytes of the first one
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(v));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p + 12), _mm256_extracti128_si256(v, 1));
+	}
+	storeState(dither, state);
+	return i;
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t run(int32_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	__m256i state = loadState(dither);
+	__m256i* const s = dither != nullptr ? &state : nullptr;
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), quantize<32>(_mm256_loadu_ps(src + i), s));
+	}
+	storeState(dither, state);
+	return i;
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t run(float* dst, double const* src, size_t length, TpdfDither*)
+{
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		_mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+		_mm_storeu_ps(dst + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 4)));
+	}
+	return i;
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t run(double* dst, float const* src, size_t length, TpdfDither*)
+{
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		_mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+		_mm256_storeu_pd(dst + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(src + i + 4)));
+	}
+	return i;
+}
+
+template <typename Target, typename Source>
+constexpr bool supports = requires(Target* dst, Source const* src, size_t length, TpdfDither* dither) { run(dst, src, length, dither); };
+
+NYCO_SIMD_TARGET_AVX2 inline size_t interleave2(float* dst, float const* const* channels, size_t frames)
+{
+	size_t f = 0;
+	for (; f + 8 <= frames; f += 8) {
+		__m256 const l = _mm256_loadu_ps(channels[0] + f);
+		__m256 const r = _mm256_loadu_ps(channels[1] + f);
+		// unpack works within 128 bit lanes: lo holds frames 0, 1, 4, 5 and hi frames 2, 3, 6, 7
+		__m256 const lo = _mm256_unpacklo_ps(l, r);
+		__m256 const hi = _mm256_unpackhi_ps(l, r);
+		_mm256_storeu_ps(dst + 2 * f, _mm256_permute2f128_ps(lo, hi, 0x20));
+		_mm256_storeu_ps(dst + 2 * f + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+	}
+	return f;
+}
+
+NYCO_SIMD_TARGET_AVX2 inline size_t deinterleave2(float* const* channels, float const* src, size_t frames)
+{
+	size_t f = 0;
+	for (; f + 8 <= frames; f += 8) {
+		__m256 const a = _mm256_loadu_ps(src + 2 * f);
+		__m256 const b = _mm256_loadu_ps(src + 2 * f + 8);
+		__m256 const lo = _mm256_permute2f128_ps(a, b, 0x20);
+		__m256 const hi = _mm256_permute2f128_ps(a, b, 0x31);
+		_mm256_storeu_ps(channels[0] + f, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm256_storeu_ps(channels[1] + f, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+	return f;
+}
+}
+
+#pragma endregion
+
+#endif
+
+#pragma region Dispatch
+
+namespace detail {
+// the bytes of the tile a converting interleave or deinterleave goes through, it stays in the L1 cache
+static constexpr size_t TILE_SIZE = 16384;
+
+template <typename Target, typename Source>
+void dispatch(Target* dst, Source const* src, size_t length, TpdfDither* dither)
+{
+	if (length == 0) {
+		return;
+	}
+	size_t done = 0;
+#if NYCO_SIMD_X86
+	// there are no AVX-512 kernels, a conversion is bound by memory bandwidth well before the AVX2 ones
+	switch (simd::instructionSet()) {
+	case simd::InstructionSet::AVX512:
+	case simd::InstructionSet::AVX2:
+		if constexpr (avx2::supports<Target, Source>) {
+			done = avx2::run(dst, src, length, dither);
+			break;
+		}
+		[[fallthrough]];
+	case simd::InstructionSet::SSE2:
+		if constexpr (sse2::supports<Target, Source>) {
+			done = sse2::run(dst, src, length, dither);
+		}
+		break;
+	default:
+		break;
+	}
+#endif
+	scalar::run(dst + done, src + done, length - done, dither);
+}
+
+/*
+* dst[f * N + c] = channel(c)[offset + f] for N (a compile time channel count) channels
+*/
+template <size_t N, typename T, typename Channels>
+void interleaveFixed(T* dst, Channels const& channel, size_t offset, size_t frames)
+{
+	T const* src[N];
+	for (size_t c = 0; c < N; ++c) {
+		src[c] = channel(c) + offset;
+	}
+	size_t f = 0;
+#if NYCO_SIMD_X86
+	if constexpr (sizeof(T) == sizeof(float)) {
+		auto const out = reinterpret_cast<float*>(dst);
+		auto const in = reinterpret_cast<float const* const*>(src);
+		simd::InstructionSet const set = simd::instructionSet();
+		if constexpr (N == 2) {
+			f = set >= simd::InstructionSet::AVX2 ? avx2::interleave2(out, in, frames)
+				: set >= simd::InstructionSet::SSE2 ? sse2::interleave2(out, in, frames) : 0;
+		}
+		else if (set >= simd::InstructionSet::SSE2) {
+			f = sse2::interleaveBlocks<N>(out, in, frames);
+		}
+	}
+#endif
+	for (; f < frames; ++f) {
+		for (size_t c = 0; c < N; ++c) {
+			dst[f * N + c] = src[c][f];
+		}
+	}
+}
+
+template <size_t N, typename T, typename Channels>
+void deinterleaveFixed(Channels const& channel, T const* src, size_t offset, size_t frames)
+{
+	T* dst[N];
+	for (size_t c = 0; c < N; ++c) {
+		dst[c] = channel(c) + offset;
+	}
+	size_t f = 0;
+#if NYCO_SIMD_X86
+	if constexpr (sizeof(T) == sizeof(float)) {
+		auto const out = reinterpret_cast<float* const*>(dst);
+		auto const in = reinterpret_cast<float const*>(src);
+		simd::InstructionSet const set = simd::instructionSet();
+		if constexpr (N == 2) {
+			f = set >= simd::InstructionSet::AVX2 ? avx2::deinterleave2(out, in, frames)
+				: set >= simd::InstructionSet::SSE2 ? sse2::deinterleave2(out, in, frames) : 0;
+		}
+		else if (set >= simd::InstructionSet::SSE2) {
+			f = sse2::deinterleaveBlocks<N>(out, in, frames);
+		}
+	}
+#endif
+	for (; f < frames; ++f) {
+		for (size_t c = 0; c < N; ++c) {
+			dst[c][f] = src[f * N + c];
+		}
+	}
+}
+
+/*
+* moves frames [offset, offset + frames) of channel(0) .. channel(channelCount - 1) into dst interleaved
+*/
+template <typename T, typename Channels>
+void interleaveFrames(T* dst, Channels const& channel, size_t channelCount, size_t offset, size_t frames)
+{
+	switch (channelCount) {
+	case 1:
+		if (frames != 0) {
+			std::memcpy(dst, channel(0) + offset, frames * sizeof(T));
+		}
+		return;
+	case 2:
+		interleaveFixed<2>(dst, channel, offset, frames);
+		return;
+	case 4:
+		interleaveFixed<4>(dst, channel, offset, frames);
+		return;
+	case 8:
+		interleaveFixed<8>(dst, channel, offset, frames);
+		return;
+	default:
+		break;
+	}
+	// any other count walks a block of frames per channel, so the block of dst stays in the cache between channels
+	constexpr size_t block = 256;
+	for (size_t begin = 0; begin < frames; begin += block) {
+		size_t const end = std::min(begin + block, frames);
+		for (size_t c = 0; c < channelCount; ++c) {
+			T const* src = channel(c) + offset;
+			for (size_t f = begin; f < end; ++f) {
+				dst[f * channelCount + c] = src[f];
+			}
+		}
+	}
+}
+
+template <typename T, typename Channels>
+void deinterleaveFrames(Channels const& channel, T const* src, size_t channelCount, size_t offset, size_t frames)
+{
+	switch (channelCount) {
+	case 1:
+		if (frames != 0) {
+			std::memcpy(channel(0) + offset, src, frames * sizeof(T));
+		}
+		return;
+	case 2:
+		deinterleaveFixed<2>(channel, src, offset, frames);
+		return;
+	case 4:
+		deinterleaveFixed<4>(channel, src, offset, frames);
+		return;
+	case 8:
+		deinterleaveFixed<8>(channel, src, offset, frames);
+		return;
+	default:
+		break;
+	}
+	constexpr size_t block = 256;
+	for (size_t begin = 0; begin < frames; begin += block) {
+		size_t const end = std::min(begin + block, frames);
+		for (size_t c = 0; c < channelCount; ++c) {
+			T* dst = channel(c) + offset;
+			for (size_t f = begin; f < end; ++f) {
+				dst[f] = src[f * channelCount + c];
+			}
+		}
+	}
+}
+
+/*
+* interleaves the planar channels returned by channel(c) into dst, converting a tile at a time
+*/
+template <typename Target, typename Channels>
+void interleave(Target* dst, Channels const& channel, size_t channelCount, size_t frames, TpdfDither* dither)
+{
+	using Source = std::remove_cv_t<std::remove_pointer_t<decltype(channel(0))>>;
+	if constexpr (std::is_same_v<Target, Source>) {
+		interleaveFrames(dst, channel, channelCount, 0, frames);
+	}
+	else {
+		alignas(64) Source tile[TILE_SIZE / sizeof(Source)];
+		constexpr size_t tileLength = TILE_SIZE / sizeof(Source);
+		assert(channelCount <= tileLength && "a frame must fit in one tile");
+		size_t const tileFrames = tileLength / channelCount;
+		for (size_t f = 0; f < frames; f += tileFrames) {
+			size_t const count = std::min(tileFrames, frames - f);
+			interleaveFrames(tile, channel, channelCount, f, count);
+			dispatch(dst + f * channelCount, tile, count * channelCount, dither);
+		}
+	}
+}
+
+template <typename Source, typename Channels>
+void deinterleave(Channels const& channel, Source const* src, size_t channelCount, size_t frames, TpdfDither* dither)
+{
+	using Target = std::remove_pointer_t<decltype(channel(0))>;
+	if constexpr (std::is_same_v<Target, Source>) {
+		deinterleaveFrames(channel, src, channelCount, 0, frames);
+	}
+	else {
+		alignas(64) Target tile[TILE_SIZE / sizeof(Target)];
+		constexpr size_t tileLength = TILE_SIZE / sizeof(Target);
+		assert(channelCount <= tileLength && "a frame must fit in one tile");
+		size_t const tileFrames = tileLength / channelCount;
+		for (size_t f = 0; f < frames; f += tileFrames) {
+			size_t const count = std::min(tileFrames, frames - f);
+			dispatch(tile, src + f * channelCount, count * channelCount, dither);
+			deinterleaveFrames(channel, static_cast<Target const*>(tile), channelCount, f, count);
+		}
+	}
+}
+}
+
+inline void convert(float* dst, int16_t const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(float* dst, Int24 const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(float* dst, int32_t const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(int16_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(Int24* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(int32_t* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(float* dst, double const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(double* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+inline void convert(float* dst, float const* src, size_t length, TpdfDither* dither)
+{
+	detail::dispatch(dst, src, length, dither);
+}
+
+template <typename Source>
+void convert(AudioStreamView<float> dst, Source const* src)
+{
+	convert(dst.data(), src, dst.size());
+}
+
+template <typename Target>
+void convert(Target* dst, AudioStreamView<float const> src, TpdfDither* dither)
+{
+	convert(dst, src.data(), src.size(), dither);
+}
+
+template <typename Target, typename Source>
+void interleave(Target* dst, Source const* const* channels, size_t channelCount, size_t frames, TpdfDither* dither)
+{
+	detail::interleave(dst, [channels](size_t c) { return channels[c]; }, channelCount, frames, dither);
+}
+
+template <typename Target, typename Source>
+void interleave(Target* dst, MultiChannelAudioStream<Source> const& src, TpdfDither* dither)
+{
+	Source const* const base = src.data();
+	size_t const stride = src.stride();
+	detail::interleave(dst, [base, stride](size_t c) { return base + c * stride; }, src.channels(), src.size(), dither);
+}
+
+template <typename Target, typename Source>
+void deinterleave(Target* const* channels, Source const* src, size_t channelCount, size_t frames, TpdfDither* dither)
+{
+	detail::deinterleave([channels](size_t c) { return channels[c]; }, src, channelCount, frames, dither);
+}
+
+template <typename Target, typename Source>
+void deinterleave(MultiChannelAudioStream<Target>& dst, Source const* src, TpdfDither* dither)
+{
+	Target* const base = dst.data();
+	size_t const stride = dst.stride();
+	detail::deinterleave([base, stride](size_t c) { return base + c * stride; }, src, dst.channels(), dst.size(), dither);
+}
+
+#pragma endregion
+
+}
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_SAMPLE_CONVERSION_H
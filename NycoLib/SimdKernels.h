@@ -0,0 +1,693 @@
+#ifndef NYCOLIB_SIMD_KERNELS_H
+#define NYCOLIB_SIMD_KERNELS_H
+
+/*
+	Module: SimdKernels (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		SimdKernels contains hand-vectorized SSE2 / AVX2 / AVX-512 loops for the element-wise
+		operations used by AudioStream (arithmetic for float, double, int16 and int32, and
+		bitwise for the integer types). the widest instruction set supported by the running
+		CPU is detected once and used by every call, the remainder of a buffer that does not
+		fill a whole register is processed with scalar code.
+
+		every kernel allows dst to alias one of its inputs, so it is used for both the
+		compound (+=) and the copying (+) operators.
+
+*/
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "operations.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NYCO_SIMD_X86 1
+#else
+#define NYCO_SIMD_X86 0
+#endif
+
+#if NYCO_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC allows every intrinsic anywhere, gcc and clang need the functions that use them to be marked
+#if NYCO_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define NYCO_SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define NYCO_SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define NYCO_SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define NYCO_SIMD_TARGET_SSE2
+#define NYCO_SIMD_TARGET_AVX2
+#define NYCO_SIMD_TARGET_AVX512
+#endif
+
+// a kernel written once over a Vec type is instantiated from a per instruction set entry point.
+// the kernel is correct as it is, called or inlined, since it only passes registers by reference (see scalar::Vec).
+// flattening the entry point is an optimization: it inlines the kernel and the Vec operations into code compiled
+// for the instruction set, so the registers stay in registers instead of going through memory on every call
+#if defined(__GNUC__) || defined(__clang__)
+#define NYCO_SIMD_FLATTEN __attribute__((flatten))
+#else
+#define NYCO_SIMD_FLATTEN
+#endif
+
+
+#pragma region nyco - SimdKernels - Declarations
+
+namespace nyco {
+namespace simd {
+
+/*
+* the instruction sets the kernels are implemented for, ordered from narrowest to widest. AVX2 includes FMA
+*/
+enum class InstructionSet {
+	Scalar,
+	SSE2,
+	AVX2,
+	AVX512
+};
+
+/*
+* queries the CPU (and the OS support for the wider registers) for the widest usable instruction set
+*/
+InstructionSet detectInstructionSet();
+
+/*
+* returns the instruction set the kernels currently dispatch to
+*/
+InstructionSet instructionSet();
+
+/*
+* limits the kernels to the given instruction set (it is clamped to what the CPU supports)
+* mostly useful for testing and benchmarking the narrower kernels
+*/
+void setInstructionSet(InstructionSet set);
+
+/*
+* true when Op over T has a vectorized kernel on at least one instruction set
+*/
+template <typename Op, typename T>
+constexpr bool hasKernel();
+
+/*
+* dst[i] = op(a[i], b[i])
+*/
+template <typename Op, typename T>
+void apply(T* dst, T const* a, T const* b, size_t length);
+
+/*
+* dst[i] = op(a[i], b)
+*/
+template <typename Op, typename T>
+void applyScalarRight(T* dst, T const* a, T b, size_t length);
+
+/*
+* dst[i] = op(a, b[i])
+*/
+template <typename Op, typename T>
+void applyScalarLeft(T* dst, T a, T const* b, size_t length);
+
+}
+}
+
+#pragma endregion
+
+#pragma region nyco - SimdKernels - Definitions
+
+namespace nyco {
+namespace simd {
+
+#pragma region Instruction Set Detection
+
+inline InstructionSet detectInstructionSet()
+{
+#if NYCO_SIMD_X86
+	unsigned int regs[4] = {};
+	auto cpuid = [&regs](unsigned int leaf) {
+#if defined(_MSC_VER)
+		__cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), 0);
+#else
+		__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	};
+
+	cpuid(0);
+	unsigned int const maxLeaf = regs[0];
+
+	cpuid(1);
+	bool const sse2 = (regs[3] & (1u << 26)) != 0;
+	bool const fma = (regs[2] & (1u << 12)) != 0;
+	bool const osxsave = (regs[2] & (1u << 27)) != 0;
+	if (!sse2) {
+		return InstructionSet::Scalar;
+	}
+	if (!osxsave || maxLeaf < 7) {
+		return InstructionSet::SSE2;
+	}
+
+	// the OS must save the ymm (and zmm) registers on context switches
+	unsigned long long xcr0;
+#if defined(_MSC_VER)
+	xcr0 = _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	bool const ymmState = (xcr0 & 0x06) == 0x06;
+	bool const zmmState = (xcr0 & 0xE6) == 0xE6;
+
+	cpuid(7);
+	bool const avx2 = (regs[1] & (1u << 5)) != 0;
+	bool const avx512f = (regs[1] & (1u << 16)) != 0;
+	bool const avx512bw = (regs[1] & (1u << 30)) != 0;
+
+	if (zmmState && avx512f && avx512bw) {
+		return InstructionSet::AVX512;
+	}
+	if (ymmState && avx2 && fma) {
+		return InstructionSet::AVX2;
+	}
+	return InstructionSet::SSE2;
+#else
+	return InstructionSet::Scalar;
+#endif
+}
+
+namespace detail {
+inline InstructionSet detectedInstructionSet()
+{
+	static InstructionSet const detected = detectInstructionSet();
+	return detected;
+}
+
+inline std::atomic<InstructionSet>& activeInstructionSet()
+{
+	static std::atomic<InstructionSet> active{ detectedInstructionSet() };
+	return active;
+}
+}
+
+inline InstructionSet instructionSet()
+{
+	return detail::activeInstructionSet().load(std::memory_order_relaxed);
+}
+
+inline void setInstructionSet(InstructionSet set)
+{
+	InstructionSet const detected = detail::detectedInstructionSet();
+	detail::activeInstructionSet().store(set < detected ? set : detected, std::memory_order_relaxed);
+}
+
+#pragma endregion
+
+#pragma region Scalar Kernels
+
+namespace scalar {
+// a Vec of a single sample, the fallback of the kernels written over a Vec type.
+// every Vec also has forms of load, broadcast, apply and multiplyAdd that return through their first argument.
+// a kernel written over a Vec type is not compiled for the instruction set of the Vec, so it must only use those
+// (and store): a register passed or returned by value across that boundary does not have the same ABI on both sides
+template <typename T>
+struct Vec {
+	using reg = T;
+	static constexpr size_t width = 1;
+	static reg load(T const* p) { return *p; }
+	static void store(T* p, reg const& v) { *p = v; }
+	static reg broadcast(T x) { return x; }
+	static reg apply(operations::Add, reg a, reg b) { return a + b; }
+	static reg apply(operations::Subtract, reg a, reg b) { return a - b; }
+	static reg apply(operations::Multiply, reg a, reg b) { return a * b; }
+	static reg apply(operations::Divide, reg a, reg b) { return a / b; }
+	static reg apply(operations::Minimum, reg a, reg b) { return b < a ? b : a; }
+	static reg apply(operations::Maximum, reg a, reg b) { return a < b ? b : a; }
+	static reg apply(operations::Greater, reg a, reg b) { return reg(a > b); }
+	static reg multiplyAdd(reg a, reg b, reg c) { return a * b + c; }
+	static void load(reg& out, T const* p) { out = load(p); }
+	static void broadcast(reg& out, T x) { out = broadcast(x); }
+	template <typename Op>
+	static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+	static void multiplyAdd(reg& out, reg const& a, reg const& b, reg const& c) { out = multiplyAdd(a, b, c); }
+};
+
+template <typename Op, typename T, bool BroadcastA, bool BroadcastB>
+void run(T* dst, T const* a, T const* b, size_t length)
+{
+	Op op{};
+	T const sa = *a;
+	T const sb = *b;
+	for (size_t i = 0; i < length; ++i) {
+		dst[i] = op(BroadcastA ? sa : a[i], BroadcastB ? sb : b[i]);
+	}
+}
+}
+
+#pragma endregion
+
+#if NYCO_SIMD_X86
+
+#pragma region SSE2 Kernels
+
+namespace sse2 {
+template <typename T>
+struct Vec {};
+
+template <>
+struct Vec<float> {
+	using reg = __m128;
+	static constexpr size_t width = 4;
+	NYCO_SIMD_TARGET_SSE2 static reg load(float const* p) { return _mm_loadu_ps(p); }
+	NYCO_SIMD_TARGET_SSE2 static void store(float* p, reg const& v) { _mm_storeu_ps(p, v); }
+	NYCO_SIMD_TARGET_SSE2 static reg broadcast(float x) { return _mm_set1_ps(x); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Add, reg a, reg b) { return _mm_add_ps(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Subtract, reg a, reg b) { return _mm_sub_ps(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Multiply, reg a, reg b) { return _mm_mul_ps(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Divide, reg a, reg b) { return _mm_div_ps(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Minimum, reg a, reg b) { return _mm_min_ps(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Maximum, reg a, reg b) { return _mm_max_ps(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Greater, reg a, reg b) { return _mm_and_ps(_mm_cmpgt_ps(a, b), _mm_set1_ps(1.0f)); }
+	NYCO_SIMD_TARGET_SSE2 static reg multiplyAdd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	NYCO_SIMD_TARGET_SSE2 static void load(reg& out, float const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_SSE2 static void broadcast(reg& out, float x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_SSE2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+	NYCO_SIMD_TARGET_SSE2 static void multiplyAdd(reg& out, reg const& a, reg const& b, reg const& c) { out = multiplyAdd(a, b, c); }
+};
+
+template <>
+struct Vec<double> {
+	using reg = __m128d;
+	static constexpr size_t width = 2;
+	NYCO_SIMD_TARGET_SSE2 static reg load(double const* p) { return _mm_loadu_pd(p); }
+	NYCO_SIMD_TARGET_SSE2 static void store(double* p, reg const& v) { _mm_storeu_pd(p, v); }
+	NYCO_SIMD_TARGET_SSE2 static reg broadcast(double x) { return _mm_set1_pd(x); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Add, reg a, reg b) { return _mm_add_pd(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Subtract, reg a, reg b) { return _mm_sub_pd(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Multiply, reg a, reg b) { return _mm_mul_pd(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Divide, reg a, reg b) { return _mm_div_pd(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Minimum, reg a, reg b) { return _mm_min_pd(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Maximum, reg a, reg b) { return _mm_max_pd(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Greater, reg a, reg b) { return _mm_and_pd(_mm_cmpgt_pd(a, b), _mm_set1_pd(1.0)); }
+	NYCO_SIMD_TARGET_SSE2 static reg multiplyAdd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+	NYCO_SIMD_TARGET_SSE2 static void load(reg& out, double const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_SSE2 static void broadcast(reg& out, double x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_SSE2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+	NYCO_SIMD_TARGET_SSE2 static void multiplyAdd(reg& out, reg const& a, reg const& b, reg const& c) { out = multiplyAdd(a, b, c); }
+};
+
+template <>
+struct Vec<int32_t> {
+	using reg = __m128i;
+	static constexpr size_t width = 4;
+	NYCO_SIMD_TARGET_SSE2 static reg load(int32_t const* p) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+	NYCO_SIMD_TARGET_SSE2 static void store(int32_t* p, reg const& v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	NYCO_SIMD_TARGET_SSE2 static reg broadcast(int32_t x) { return _mm_set1_epi32(x); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Add, reg a, reg b) { return _mm_add_epi32(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Subtract, reg a, reg b) { return _mm_sub_epi32(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::BitwiseAnd, reg a, reg b) { return _mm_and_si128(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::BitwiseOr, reg a, reg b) { return _mm_or_si128(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::BitwiseXor, reg a, reg b) { return _mm_xor_si128(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static void load(reg& out, int32_t const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_SSE2 static void broadcast(reg& out, int32_t x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_SSE2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+};
+
+template <>
+struct Vec<int16_t> {
+	using reg = __m128i;
+	static constexpr size_t width = 8;
+	NYCO_SIMD_TARGET_SSE2 static reg load(int16_t const* p) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+	NYCO_SIMD_TARGET_SSE2 static void store(int16_t* p, reg const& v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	NYCO_SIMD_TARGET_SSE2 static reg broadcast(int16_t x) { return _mm_set1_epi16(x); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Add, reg a, reg b) { return _mm_add_epi16(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Subtract, reg a, reg b) { return _mm_sub_epi16(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::Multiply, reg a, reg b) { return _mm_mullo_epi16(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::BitwiseAnd, reg a, reg b) { return _mm_and_si128(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::BitwiseOr, reg a, reg b) { return _mm_or_si128(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static reg apply(operations::BitwiseXor, reg a, reg b) { return _mm_xor_si128(a, b); }
+	NYCO_SIMD_TARGET_SSE2 static void load(reg& out, int16_t const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_SSE2 static void broadcast(reg& out, int16_t x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_SSE2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+};
+
+template <typename Op, typename T>
+constexpr bool supports = requires (typename Vec<T>::reg r) { Vec<T>::apply(Op{}, r, r); };
+
+template <typename Op, typename T, bool BroadcastA, bool BroadcastB>
+NYCO_SIMD_TARGET_SSE2 void run(T* dst, T const* a, T const* b, size_t length)
+{
+	using V = Vec<T>;
+	Op op{};
+	typename V::reg const va = V::broadcast(*a);
+	typename V::reg const vb = V::broadcast(*b);
+	size_t i = 0;
+	for (; i + V::width <= length; i += V::width) {
+		typename V::reg const x = BroadcastA ? va : V::load(a + i);
+		typename V::reg const y = BroadcastB ? vb : V::load(b + i);
+		V::store(dst + i, V::apply(op, x, y));
+	}
+	T const sa = *a;
+	T const sb = *b;
+	for (; i < length; ++i) {
+		dst[i] = op(BroadcastA ? sa : a[i], BroadcastB ? sb : b[i]);
+	}
+}
+}
+
+#pragma endregion
+
+#pragma region AVX2 Kernels
+
+namespace avx2 {
+template <typename T>
+struct Vec {};
+
+template <>
+struct Vec<float> {
+	using reg = __m256;
+	static constexpr size_t width = 8;
+	NYCO_SIMD_TARGET_AVX2 static reg load(float const* p) { return _mm256_loadu_ps(p); }
+	NYCO_SIMD_TARGET_AVX2 static void store(float* p, reg const& v) { _mm256_storeu_ps(p, v); }
+	NYCO_SIMD_TARGET_AVX2 static reg broadcast(float x) { return _mm256_set1_ps(x); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Add, reg a, reg b) { return _mm256_add_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Subtract, reg a, reg b) { return _mm256_sub_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Multiply, reg a, reg b) { return _mm256_mul_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Divide, reg a, reg b) { return _mm256_div_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Minimum, reg a, reg b) { return _mm256_min_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Maximum, reg a, reg b) { return _mm256_max_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Greater, reg a, reg b) { return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ), _mm256_set1_ps(1.0f)); }
+	NYCO_SIMD_TARGET_AVX2 static reg multiplyAdd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+	NYCO_SIMD_TARGET_AVX2 static void load(reg& out, float const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX2 static void broadcast(reg& out, float x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+	NYCO_SIMD_TARGET_AVX2 static void multiplyAdd(reg& out, reg const& a, reg const& b, reg const& c) { out = multiplyAdd(a, b, c); }
+};
+
+template <>
+struct Vec<double> {
+	using reg = __m256d;
+	static constexpr size_t width = 4;
+	NYCO_SIMD_TARGET_AVX2 static reg load(double const* p) { return _mm256_loadu_pd(p); }
+	NYCO_SIMD_TARGET_AVX2 static void store(double* p, reg const& v) { _mm256_storeu_pd(p, v); }
+	NYCO_SIMD_TARGET_AVX2 static reg broadcast(double x) { return _mm256_set1_pd(x); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Add, reg a, reg b) { return _mm256_add_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Subtract, reg a, reg b) { return _mm256_sub_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Multiply, reg a, reg b) { return _mm256_mul_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Divide, reg a, reg b) { return _mm256_div_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Minimum, reg a, reg b) { return _mm256_min_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Maximum, reg a, reg b) { return _mm256_max_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Greater, reg a, reg b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), _mm256_set1_pd(1.0)); }
+	NYCO_SIMD_TARGET_AVX2 static reg multiplyAdd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+	NYCO_SIMD_TARGET_AVX2 static void load(reg& out, double const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX2 static void broadcast(reg& out, double x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+	NYCO_SIMD_TARGET_AVX2 static void multiplyAdd(reg& out, reg const& a, reg const& b, reg const& c) { out = multiplyAdd(a, b, c); }
+};
+
+template <>
+struct Vec<int32_t> {
+	using reg = __m256i;
+	static constexpr size_t width = 8;
+	NYCO_SIMD_TARGET_AVX2 static reg load(int32_t const* p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+	NYCO_SIMD_TARGET_AVX2 static void store(int32_t* p, reg const& v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+	NYCO_SIMD_TARGET_AVX2 static reg broadcast(int32_t x) { return _mm256_set1_epi32(x); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Add, reg a, reg b) { return _mm256_add_epi32(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Subtract, reg a, reg b) { return _mm256_sub_epi32(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Multiply, reg a, reg b) { return _mm256_mullo_epi32(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::BitwiseAnd, reg a, reg b) { return _mm256_and_si256(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::BitwiseOr, reg a, reg b) { return _mm256_or_si256(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::BitwiseXor, reg a, reg b) { return _mm256_xor_si256(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static void load(reg& out, int32_t const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX2 static void broadcast(reg& out, int32_t x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+};
+
+template <>
+struct Vec<int16_t> {
+	using reg = __m256i;
+	static constexpr size_t width = 16;
+	NYCO_SIMD_TARGET_AVX2 static reg load(int16_t const* p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+	NYCO_SIMD_TARGET_AVX2 static void store(int16_t* p, reg const& v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+	NYCO_SIMD_TARGET_AVX2 static reg broadcast(int16_t x) { return _mm256_set1_epi16(x); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Add, reg a, reg b) { return _mm256_add_epi16(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Subtract, reg a, reg b) { return _mm256_sub_epi16(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::Multiply, reg a, reg b) { return _mm256_mullo_epi16(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::BitwiseAnd, reg a, reg b) { return _mm256_and_si256(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::BitwiseOr, reg a, reg b) { return _mm256_or_si256(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static reg apply(operations::BitwiseXor, reg a, reg b) { return _mm256_xor_si256(a, b); }
+	NYCO_SIMD_TARGET_AVX2 static void load(reg& out, int16_t const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX2 static void broadcast(reg& out, int16_t x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX2 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+};
+
+template <typename Op, typename T>
+constexpr bool supports = requires (typename Vec<T>::reg r) { Vec<T>::apply(Op{}, r, r); };
+
+template <typename Op, typename T, bool BroadcastA, bool BroadcastB>
+NYCO_SIMD_TARGET_AVX2 void run(T* dst, T const* a, T const* b, size_t length)
+{
+	using V = Vec<T>;
+	Op op{};
+	typename V::reg const va = V::broadcast(*a);
+	typename V::reg const vb = V::broadcast(*b);
+	size_t i = 0;
+	// two registers per iteration to hide the latency of the loads
+	for (; i + 2 * V::width <= length; i += 2 * V::width) {
+		typename V::reg const x0 = BroadcastA ? va : V::load(a + i);
+		typename V::reg const y0 = BroadcastB ? vb : V::load(b + i);
+		typename V::reg const x1 = BroadcastA ? va : V::load(a + i + V::width);
+		typename V::reg const y1 = BroadcastB ? vb : V::load(b + i + V::width);
+		V::store(dst + i, V::apply(op, x0, y0));
+		V::store(dst + i + V::width, V::apply(op, x1, y1));
+	}
+	for (; i + V::width <= length; i += V::width) {
+		typename V::reg const x = BroadcastA ? va : V::load(a + i);
+		typename V::reg const y = BroadcastB ? vb : V::load(b + i);
+		V::store(dst + i, V::apply(op, x, y));
+	}
+	T const sa = *a;
+	T const sb = *b;
+	for (; i < length; ++i) {
+		dst[i] = op(BroadcastA ? sa : a[i], BroadcastB ? sb : b[i]);
+	}
+}
+}
+
+#pragma endregion
+
+#pragma region AVX-512 Kernels
+
+namespace avx512 {
+template <typename T>
+struct Vec {};
+
+template <>
+struct Vec<float> {
+	using reg = __m512;
+	static constexpr size_t width = 16;
+	NYCO_SIMD_TARGET_AVX512 static reg load(float const* p) { return _mm512_loadu_ps(p); }
+	NYCO_SIMD_TARGET_AVX512 static void store(float* p, reg const& v) { _mm512_storeu_ps(p, v); }
+	NYCO_SIMD_TARGET_AVX512 static reg broadcast(float x) { return _mm512_set1_ps(x); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Add, reg a, reg b) { return _mm512_add_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Subtract, reg a, reg b) { return _mm512_sub_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Multiply, reg a, reg b) { return _mm512_mul_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Divide, reg a, reg b) { return _mm512_div_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Minimum, reg a, reg b) { return _mm512_min_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Maximum, reg a, reg b) { return _mm512_max_ps(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Greater, reg a, reg b) { return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), _mm512_set1_ps(1.0f)); }
+	NYCO_SIMD_TARGET_AVX512 static reg multiplyAdd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+	NYCO_SIMD_TARGET_AVX512 static void load(reg& out, float const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX512 static void broadcast(reg& out, float x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX512 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+	NYCO_SIMD_TARGET_AVX512 static void multiplyAdd(reg& out, reg const& a, reg const& b, reg const& c) { out = multiplyAdd(a, b, c); }
+};
+
+template <>
+struct Vec<double> {
+	using reg = __m512d;
+	static constexpr size_t width = 8;
+	NYCO_SIMD_TARGET_AVX512 static reg load(double const* p) { return _mm512_loadu_pd(p); }
+	NYCO_SIMD_TARGET_AVX512 static void store(double* p, reg const& v) { _mm512_storeu_pd(p, v); }
+	NYCO_SIMD_TARGET_AVX512 static reg broadcast(double x) { return _mm512_set1_pd(x); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Add, reg a, reg b) { return _mm512_add_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Subtract, reg a, reg b) { return _mm512_sub_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Multiply, reg a, reg b) { return _mm512_mul_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Divide, reg a, reg b) { return _mm512_div_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Minimum, reg a, reg b) { return _mm512_min_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Maximum, reg a, reg b) { return _mm512_max_pd(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Greater, reg a, reg b) { return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), _mm512_set1_pd(1.0)); }
+	NYCO_SIMD_TARGET_AVX512 static reg multiplyAdd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+	NYCO_SIMD_TARGET_AVX512 static void load(reg& out, double const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX512 static void broadcast(reg& out, double x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX512 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+	NYCO_SIMD_TARGET_AVX512 static void multiplyAdd(reg& out, reg const& a, reg const& b, reg const& c) { out = multiplyAdd(a, b, c); }
+};
+
+template <>
+struct Vec<int32_t> {
+	using reg = __m512i;
+	static constexpr size_t width = 16;
+	NYCO_SIMD_TARGET_AVX512 static reg load(int32_t const* p) { return _mm512_loadu_si512(p); }
+	NYCO_SIMD_TARGET_AVX512 static void store(int32_t* p, reg const& v) { _mm512_storeu_si512(p, v); }
+	NYCO_SIMD_TARGET_AVX512 static reg broadcast(int32_t x) { return _mm512_set1_epi32(x); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Add, reg a, reg b) { return _mm512_add_epi32(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Subtract, reg a, reg b) { return _mm512_sub_epi32(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Multiply, reg a, reg b) { return _mm512_mullo_epi32(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::BitwiseAnd, reg a, reg b) { return _mm512_and_si512(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::BitwiseOr, reg a, reg b) { return _mm512_or_si512(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::BitwiseXor, reg a, reg b) { return _mm512_xor_si512(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static void load(reg& out, int32_t const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX512 static void broadcast(reg& out, int32_t x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX512 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+};
+
+template <>
+struct Vec<int16_t> {
+	using reg = __m512i;
+	static constexpr size_t width = 32;
+	NYCO_SIMD_TARGET_AVX512 static reg load(int16_t const* p) { return _mm512_loadu_si512(p); }
+	NYCO_SIMD_TARGET_AVX512 static void store(int16_t* p, reg const& v) { _mm512_storeu_si512(p, v); }
+	NYCO_SIMD_TARGET_AVX512 static reg broadcast(int16_t x) { return _mm512_set1_epi16(x); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Add, reg a, reg b) { return _mm512_add_epi16(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Subtract, reg a, reg b) { return _mm512_sub_epi16(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::Multiply, reg a, reg b) { return _mm512_mullo_epi16(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::BitwiseAnd, reg a, reg b) { return _mm512_and_si512(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::BitwiseOr, reg a, reg b) { return _mm512_or_si512(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static reg apply(operations::BitwiseXor, reg a, reg b) { return _mm512_xor_si512(a, b); }
+	NYCO_SIMD_TARGET_AVX512 static void load(reg& out, int16_t const* p) { out = load(p); }
+	NYCO_SIMD_TARGET_AVX512 static void broadcast(reg& out, int16_t x) { out = broadcast(x); }
+	template <typename Op>
+	NYCO_SIMD_TARGET_AVX512 static void apply(Op op, reg& out, reg const& a, reg const& b) { out = apply(op, a, b); }
+};
+
+template <typename Op, typename T>
+constexpr bool supports = requires (typename Vec<T>::reg r) { Vec<T>::apply(Op{}, r, r); };
+
+template <typename Op, typename T, bool BroadcastA, bool BroadcastB>
+NYCO_SIMD_TARGET_AVX512 void run(T* dst, T const* a, T const* b, size_t length)
+{
+	using V = Vec<T>;
+	Op op{};
+	typename V::reg const va = V::broadcast(*a);
+	typename V::reg const vb = V::broadcast(*b);
+	size_t i = 0;
+	// two registers per iteration to hide the latency of the loads
+	for (; i + 2 * V::width <= length; i += 2 * V::width) {
+		typename V::reg const x0 = BroadcastA ? va : V::load(a + i);
+		typename V::reg const y0 = BroadcastB ? vb : V::load(b + i);
+		typename V::reg const x1 = BroadcastA ? va : V::load(a + i + V::width);
+		typename V::reg const y1 = BroadcastB ? vb : V::load(b + i + V::width);
+		V::store(dst + i, V::apply(op, x0, y0));
+		V::store(dst + i + V::width, V::apply(op, x1, y1));
+	}
+	for (; i + V::width <= length; i += V::width) {
+		typename V::reg const x = BroadcastA ? va : V::load(a + i);
+		typename V::reg const y = BroadcastB ? vb : V::load(b + i);
+		V::store(dst + i, V::apply(op, x, y));
+	}
+	T const sa = *a;
+	T const sb = *b;
+	for (; i < length; ++i) {
+		dst[i] = op(BroadcastA ? sa : a[i], BroadcastB ? sb : b[i]);
+	}
+}
+}
+
+#pragma endregion
+
+#endif
+
+#pragma region Dispatch
+
+namespace detail {
+template <typename Op, typename T, bool BroadcastA, bool BroadcastB>
+void dispatch(T* dst, T const* a, T const* b, size_t length)
+{
+	if (length == 0) {
+		return;
+	}
+#if NYCO_SIMD_X86
+	switch (instructionSet()) {
+	case InstructionSet::AVX512:
+		if constexpr (avx512::supports<Op, T>) {
+			avx512::run<Op, T, BroadcastA, BroadcastB>(dst, a, b, length);
+			return;
+		}
+		[[fallthrough]];
+	case InstructionSet::AVX2:
+		if constexpr (avx2::supports<Op, T>) {
+			avx2::run<Op, T, BroadcastA, BroadcastB>(dst, a, b, length);
+			return;
+		}
+		[[fallthrough]];
+	case InstructionSet::SSE2:
+		if constexpr (sse2::supports<Op, T>) {
+			sse2::run<Op, T, BroadcastA, BroadcastB>(dst, a, b, length);
+			return;
+		}
+		break;
+	default:
+		break;
+	}
+#endif
+	scalar::run<Op, T, BroadcastA, BroadcastB>(dst, a, b, length);
+}
+}
+
+template <typename Op, typename T>
+constexpr bool hasKernel()
+{
+#if NYCO_SIMD_X86
+	return avx512::supports<Op, T> || avx2::supports<Op, T> || sse2::supports<Op, T>;
+#else
+	return false;
+#endif
+}
+
+template <typename Op, typename T>
+void apply(T* dst, T const* a, T const* b, size_t length)
+{
+	detail::dispatch<Op, T, false, false>(dst, a, b, length);
+}
+
+template <typename Op, typename T>
+void applyScalarRight(T* dst, T const* a, T b, size_t length)
+{
+	detail::dispatch<Op, T, false, true>(dst, a, &b, length);
+}
+
+template <typename Op, typename T>
+void applyScalarLeft(T* dst, T a, T const* b, size_t length)
+{
+	detail::dispatch<Op, T, true, false>(dst, &a, b, length);
+}
+
+#pragma endregion
+
+}
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_SIMD_KERNELS_H
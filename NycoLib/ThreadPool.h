@@ -0,0 +1,355 @@
+#ifndef NYCOLIB_THREAD_POOL_H
+#define NYCOLIB_THREAD_POOL_H
+
+/*
+	Module: ThreadPool (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		ThreadPool contains the work-stealing ThreadPool the library runs parallel
+		operations on. every worker owns a fixed ring of tasks; it takes work from the back of
+		its own ring and, when that is empty, steals from the front of the others.
+		a task is a worker's whole share of one loop and hands out one index at a time,
+		so a loop takes a single slot per ring and starting one never allocates.
+		the thread that starts a parallel loop works on it too, then yields until the
+		indices still running on the workers return. an exception thrown by the loop body
+		is caught where it was thrown, the rest of the loop is drained without running it,
+		and the first exception is rethrown on the thread that started the loop.
+
+		the library owns a single pool (threadPool()) with one worker less than the number
+		of hardware threads, created the first time a parallel operation runs.
+
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <assert.h>
+
+
+#pragma region nyco - ThreadPool - Declarations
+
+namespace nyco {
+
+class ThreadPool {
+
+#pragma region Constructors
+public:
+
+	/*
+	* constructs a new ThreadPool with the given number of worker threads
+	* a pool with no workers runs every loop on the calling thread
+	*/
+	explicit ThreadPool(size_t threads);
+
+	ThreadPool(ThreadPool const&) = delete;
+
+	~ThreadPool();
+
+#pragma endregion
+
+#pragma region Methods
+public:
+
+	/*
+	* calls func(i) for every i in [0, count) on the workers and the calling thread,
+	* and returns once every call returned. does not allocate. a share that finds its ring
+	* full (more than TASKS loops nested or running at once) is run on the calling thread.
+	* if a call throws, the indices that did not start are skipped and the first exception
+	* is rethrown here, once no worker runs the loop anymore
+	*/
+	template <typename Function>
+	void parallelFor(size_t count, Function&& func);
+
+	/*
+	* returns the number of worker threads
+	*/
+	size_t threads() const;
+
+#pragma endregion
+
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	// the number of loops a worker can hold a share of at once, nested or started by different threads
+	static constexpr size_t TASKS = 64;
+
+#pragma region Private Members
+private:
+
+	// a single parallelFor, the function is called through run so the job lives on the caller's stack
+	struct Job {
+		void (*run)(void* context, size_t index);
+
+		void* context;
+
+		std::atomic<size_t> remaining;
+
+		// set by the first call that throws, which then stores its exception in error
+		std::atomic<bool> failed;
+
+		std::exception_ptr error;
+	};
+
+	// the indices next, next + stride, ... below end of one job
+	struct Task {
+		Job* job;
+
+		size_t next;
+
+		size_t end;
+
+		size_t stride;
+	};
+
+	// a ring of TASKS tasks, starting at first
+	struct Worker {
+		std::mutex lock;
+
+		std::array<Task, TASKS> tasks;
+
+		size_t first = 0;
+
+		size_t count = 0;
+	};
+
+	/*
+	* calls the function of job with index, unless a call already threw. an exception is kept in job
+	*/
+	static void call(Job& job, size_t index);
+
+	/*
+	* runs one index, taken from the task at the back of the ring of self or stolen from the front of another
+	* returns false if there was no task to run
+	*/
+	bool runOne(size_t self);
+
+	/*
+	* the loop of the worker thread self
+	*/
+	void work(size_t self);
+
+	/*
+	* returns the index of the ring the calling thread owns, the last one for threads outside the pool
+	*/
+	size_t self() const;
+
+	// one ring per worker thread, and a last one shared by the threads outside the pool
+	std::vector<std::unique_ptr<Worker>> m_workers;
+
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_wakeLock;
+
+	std::condition_variable m_wake;
+
+	std::atomic<size_t> m_nQueued;
+
+	bool m_bStop;
+
+#pragma endregion
+
+};
+
+/*
+* returns the ThreadPool owned by the library
+*/
+ThreadPool& threadPool();
+
+}
+
+#pragma endregion
+
+#pragma region nyco - ThreadPool - Definitions
+
+namespace nyco {
+
+namespace detail {
+struct ThreadPoolWorkerIndex {
+	ThreadPool const* pool = nullptr;
+
+	size_t index = 0;
+};
+
+inline ThreadPoolWorkerIndex& currentWorker()
+{
+	static thread_local ThreadPoolWorkerIndex worker;
+	return worker;
+}
+}
+
+inline ThreadPool::ThreadPool(size_t threads)
+	: m_workers{}
+	, m_threads{}
+	, m_wakeLock{}
+	, m_wake{}
+	, m_nQueued{ 0 }
+	, m_bStop{ false }
+{
+	for (size_t i = 0; i <= threads; ++i) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+	for (size_t i = 0; i < threads; ++i) {
+		m_threads.emplace_back([this, i]() { work(i); });
+	}
+}
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_wakeLock);
+		m_bStop = true;
+	}
+	m_wake.notify_all();
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+}
+
+template <typename Function>
+void ThreadPool::parallelFor(size_t count, Function&& func)
+{
+	if (count == 0) {
+		return;
+	}
+	if (m_threads.empty() || count == 1) {
+		for (size_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+	using F = std::remove_reference_t<Function>;
+	Job job{ [](void* context, size_t index) { (*static_cast<F*>(context))(index); }, const_cast<void*>(static_cast<void const*>(&func)), count, false, nullptr };
+	// the indices are dealt round robin, so every worker starts with work of its own
+	size_t const stride = m_workers.size();
+	size_t const rings = std::min(stride, count);
+	for (size_t d = 0; d < rings; ++d) {
+		size_t const share = (count - d + stride - 1) / stride;
+		Worker& worker = *m_workers[d];
+		{
+			std::lock_guard<std::mutex> guard(worker.lock);
+			if (worker.count < TASKS) {
+				// counted before the task is published, so a thief never takes more than was queued
+				m_nQueued.fetch_add(share, std::memory_order_release);
+				worker.tasks[(worker.first + worker.count) % TASKS] = Task{ &job, d, count, stride };
+				++worker.count;
+				continue;
+			}
+		}
+		// the ring is full, the share runs here instead of waiting for a slot
+		for (size_t i = d; i < count; i += stride) {
+			call(job, i);
+		}
+		job.remaining.fetch_sub(share, std::memory_order_acq_rel);
+	}
+	{
+		std::lock_guard<std::mutex> guard(m_wakeLock);
+	}
+	m_wake.notify_all();
+	size_t const me = self();
+	while (job.remaining.load(std::memory_order_acquire) != 0) {
+		if (!runOne(me)) {
+			std::this_thread::yield();
+		}
+	}
+	// every index returned, so no worker holds the job and the exception it stored is visible
+	if (job.error) {
+		std::rethrow_exception(job.error);
+	}
+}
+
+inline size_t ThreadPool::threads() const
+{
+	return m_threads.size();
+}
+
+inline void ThreadPool::call(Job& job, size_t index)
+{
+	if (job.failed.load(std::memory_order_relaxed)) {
+		return;
+	}
+	try {
+		job.run(job.context, index);
+	}
+	catch (...) {
+		if (!job.failed.exchange(true, std::memory_order_relaxed)) {
+			job.error = std::current_exception();
+		}
+	}
+}
+
+inline bool ThreadPool::runOne(size_t self)
+{
+	size_t const rings = m_workers.size();
+	for (size_t n = 0; n < rings; ++n) {
+		size_t const d = (self + n) % rings;
+		Worker& worker = *m_workers[d];
+		Job* job;
+		size_t index;
+		{
+			std::lock_guard<std::mutex> guard(worker.lock);
+			if (worker.count == 0) {
+				continue;
+			}
+			size_t const slot = d == self ? (worker.first + worker.count - 1) % TASKS : worker.first;
+			Task& task = worker.tasks[slot];
+			job = task.job;
+			index = task.next;
+			task.next += task.stride;
+			if (task.next >= task.end) {
+				// the task is spent, the owner frees the slot at the back and a thief the one at the front
+				if (d != self) {
+					worker.first = (worker.first + 1) % TASKS;
+				}
+				--worker.count;
+			}
+		}
+		m_nQueued.fetch_sub(1, std::memory_order_relaxed);
+		call(*job, index);
+		job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+	return false;
+}
+
+inline void ThreadPool::work(size_t self)
+{
+	detail::currentWorker() = detail::ThreadPoolWorkerIndex{ this, self };
+	while (true) {
+		if (runOne(self)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_wakeLock);
+		m_wake.wait(lock, [this]() { return m_bStop || m_nQueued.load(std::memory_order_acquire) != 0; });
+		if (m_bStop) {
+			return;
+		}
+	}
+}
+
+inline size_t ThreadPool::self() const
+{
+	detail::ThreadPoolWorkerIndex const& worker = detail::currentWorker();
+	return worker.pool == this ? worker.index : m_workers.size() - 1;
+}
+
+inline ThreadPool& threadPool()
+{
+	static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+	return pool;
+}
+
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_THREAD_POOL_H
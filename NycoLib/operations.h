@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cmath>
+
+
+namespace nyco {
+	namespace operations {
+		struct Add {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a + b; }
+		};
+
+		struct Subtract {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a - b; }
+		};
+
+		struct Multiply {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a * b; }
+		};
+
+		struct Divide {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a / b; }
+		};
+
+		struct Modulo {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return std::fmod(a, b); }
+		};
+
+		struct Minimum {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return b < a ? b : a; }
+		};
+
+		struct Maximum {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a < b ? b : a; }
+		};
+
+		// 1 where a > b and 0 elsewhere, so comparisons can be counted by summing
+		struct Greater {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return T(a > b); }
+		};
+
+		struct BitwiseXor {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a ^ b; }
+		};
+
+		struct BitwiseAnd {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a & b; }
+		};
+
+		struct BitwiseOr {
+			template <typename T>
+			constexpr T operator()(T a, T b) const { return a | b; }
+		};
+
+		struct Negate {
+			template <typename T>
+			constexpr T operator()(T a) const { return -a; }
+		};
+
+		struct BitwiseNot {
+			template <typename T>
+			constexpr T operator()(T a) const { return ~a; }
+		};
+	}
+}
@@ -44,6 +44,43 @@ namespace nyco {
 		template <>
 		struct is_ownership_struct<copy> : std::true_type {};
 
+		/*
+		* ownership policies, the second template parameter of AudioStream.
+		* they decide what the stream keeps its buffer in (see AudioBuffer.h):
+		* shared - a reference counted buffer that can be shared between streams, the default
+		* unique - a bare pointer owned by this stream alone, freed to its allocator with the stream
+		* borrowed - a bare pointer to samples that belong to someone else, never freed
+		* copy_on_write - a reference counted buffer that clone shares, copied by the first write to a shared stream
+		*/
+		struct shared {};
+
+		struct unique {};
+
+		struct borrowed {};
+
+		struct copy_on_write {};
+
+		template <typename T>
+		struct is_ownership_policy : std::false_type {};
+
+		template <>
+		struct is_ownership_policy<shared> : std::true_type {};
+
+		template <>
+		struct is_ownership_policy<unique> : std::true_type {};
+
+		template <>
+		struct is_ownership_policy<borrowed> : std::true_type {};
+
+		template <>
+		struct is_ownership_policy<copy_on_write> : std::true_type {};
+
+		/*
+		* a policy whose streams own their buffer, and so can allocate one
+		*/
+		template <typename T>
+		concept Owning = is_ownership_policy<T>::value && !std::is_same_v<T, borrowed>;
+
 		static constexpr auto COPY = copy{};
 		static constexpr auto TAKE = take_ownership{};
 		static constexpr auto NO_OWNERSHIP = no_ownership{};
@@ -0,0 +1,506 @@
+#ifndef NYCOLIB_BENCHMARK_H
+#define NYCOLIB_BENCHMARK_H
+
+/*
+	Module: Benchmark (.h)
+
+	Author: Binyamin Cohen @ NycoAudio
+
+	Description:
+		Benchmark contains the harness of the NycoLib benchmark: timing a case into a
+		latency distribution, the Result of a case, and saving, loading and comparing
+		results as JSON.
+
+		a case is timed in samples. every sample runs the case in a batch long enough
+		for the clock to be accurate, and records the time of a single call, so the
+		distribution (median, p90, p99) is of calls and not of batches.
+
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+#pragma region nyco - Benchmark - Declarations
+
+namespace nyco {
+namespace benchmark {
+
+/*
+* how long a case is timed for
+*/
+struct Options {
+	// the shortest time a batch of calls is timed for, in nanoseconds
+	double minBatchNs = 200000.0;
+
+	// the time spent on every case, in nanoseconds, the number of samples is derived from it
+	double budgetNs = 250000000.0;
+
+	size_t minSamples = 5;
+
+	size_t maxSamples = 31;
+};
+
+/*
+* the latency distribution of a single call, in nanoseconds
+*/
+struct Statistics {
+	double min = 0;
+
+	double median = 0;
+
+	double mean = 0;
+
+	double p90 = 0;
+
+	double p99 = 0;
+
+	double max = 0;
+};
+
+/*
+* the result of timing a single case
+*/
+struct Result {
+	std::string name;
+
+	std::string type;
+
+	// the number of samples every call processes
+	size_t size = 0;
+
+	bool aligned = true;
+
+	// the bytes every call reads and writes, 0 for operations that do not touch the samples
+	size_t bytes = 0;
+
+	Statistics ns;
+
+	/*
+	* returns the name, type, size and alignment as a single key, the key results are compared by
+	*/
+	std::string key() const;
+
+	/*
+	* returns the number of samples processed per second, by the median call
+	*/
+	double samplesPerSecond() const;
+
+	/*
+	* returns the number of gigabytes read and written per second, by the median call
+	*/
+	double gigabytesPerSecond() const;
+};
+
+/*
+* keeps value alive so the compiler can not remove the work that computed it
+*/
+template <typename T>
+void doNotOptimize(T const& value);
+
+/*
+* times func, called with no arguments, and returns the distribution of a single call
+*/
+template <typename Function>
+Statistics measure(Function&& func, Options const& options);
+
+/*
+* writes results to path as JSON, returns false if the file could not be written
+*/
+bool save(std::string const& path, std::vector<Result> const& results);
+
+/*
+* reads the results saved by save from path into results, returns false if the file could not be read
+*/
+bool load(std::string const& path, std::vector<Result>& results);
+
+/*
+* prints every result of current next to the baseline result with the same key,
+* flagging the ones whose median got slower (or faster) by more than threshold (0.05 is 5%)
+* returns the number of regressions
+*/
+size_t compare(std::vector<Result> const& baseline, std::vector<Result> const& current, double threshold);
+
+}
+}
+
+#pragma endregion
+
+#pragma region nyco - Benchmark - Definitions
+
+namespace nyco {
+namespace benchmark {
+
+#pragma region Result
+
+inline std::string Result::key() const
+{
+	return name + "/" + type + "/" + std::to_string(size) + (aligned ? "/aligned" : "/unaligned");
+}
+
+inline double Result::samplesPerSecond() const
+{
+	return ns.median > 0 ? static_cast<double>(size) * 1e9 / ns.median : 0;
+}
+
+inline double Result::gigabytesPerSecond() const
+{
+	return ns.median > 0 ? static_cast<double>(bytes) / ns.median : 0;
+}
+
+#pragma endregion
+
+#pragma region Measuring
+
+namespace detail {
+inline void const* volatile g_pSink = nullptr;
+
+inline double percentile(std::vector<double> const& sorted, double p)
+{
+	double const position = p * static_cast<double>(sorted.size() - 1);
+	size_t const low = static_cast<size_t>(position);
+	size_t const high = std::min(low + 1, sorted.size() - 1);
+	return sorted[low] + (sorted[high] - sorted[low]) * (position - static_cast<double>(low));
+}
+
+template <typename Function>
+double timeBatch(Function& func, size_t calls)
+{
+	auto const start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < calls; ++i) {
+		func();
+	}
+	auto const end = std::chrono::steady_clock::now();
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+}
+
+template <typename T>
+void doNotOptimize(T const& value)
+{
+	detail::g_pSink = &value;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+template <typename Function>
+Statistics measure(Function&& func, Options const& options)
+{
+	// the first call warms the caches and the allocator, and sizes the batch
+	double elapsed = detail::timeBatch(func, 1);
+	size_t batch = 1;
+	while (elapsed < options.minBatchNs) {
+		batch *= 2;
+		elapsed = detail::timeBatch(func, batch);
+	}
+
+	double const perSample = std::max(elapsed, 1.0);
+	size_t const samples = std::clamp(static_cast<size_t>(options.budgetNs / perSample), options.minSamples, options.maxSamples);
+	std::vector<double> calls;
+	calls.reserve(samples);
+	for (size_t i = 0; i < samples; ++i) {
+		calls.push_back(detail::timeBatch(func, batch) / static_cast<double>(batch));
+	}
+	std::sort(calls.begin(), calls.end());
+
+	Statistics stats;
+	stats.min = calls.front();
+	stats.max = calls.back();
+	stats.median = detail::percentile(calls, 0.5);
+	stats.p90 = detail::percentile(calls, 0.9);
+	stats.p99 = detail::percentile(calls, 0.99);
+	double sum = 0;
+	for (double call : calls) {
+		sum += call;
+	}
+	stats.mean = sum / static_cast<double>(calls.size());
+	return stats;
+}
+
+#pragma endregion
+
+#pragma region JSON
+
+namespace detail {
+/*
+* a JSON value, only as much of JSON as the results file needs
+*/
+struct Json {
+	enum Kind { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+	Kind kind = NUL;
+
+	bool boolean = false;
+
+	double number = 0;
+
+	std::string string;
+
+	std::vector<Json> array;
+
+	std::vector<std::pair<std::string, Json>> object;
+
+	Json const* find(std::string const& name) const
+	{
+		for (auto const& member : object) {
+			if (member.first == name) {
+				return &member.second;
+			}
+		}
+		return nullptr;
+	}
+};
+
+class JsonParser {
+public:
+	explicit JsonParser(std::string const& text)
+		: m_text{ text }
+		, m_nPosition{ 0 }
+	{
+	}
+
+	bool parse(Json& value)
+	{
+		return parseValue(value) && (skipSpace(), m_nPosition == m_text.size());
+	}
+
+private:
+	void skipSpace()
+	{
+		while (m_nPosition < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_nPosition]))) {
+			++m_nPosition;
+		}
+	}
+
+	bool consume(char c)
+	{
+		skipSpace();
+		if (m_nPosition < m_text.size() && m_text[m_nPosition] == c) {
+			++m_nPosition;
+			return true;
+		}
+		return false;
+	}
+
+	bool consumeWord(char const* word)
+	{
+		size_t const length = std::char_traits<char>::length(word);
+		if (m_text.compare(m_nPosition, length, word) != 0) {
+			return false;
+		}
+		m_nPosition += length;
+		return true;
+	}
+
+	bool parseString(std::string& s)
+	{
+		if (!consume('"')) {
+			return false;
+		}
+		while (m_nPosition < m_text.size() && m_text[m_nPosition] != '"') {
+			char c = m_text[m_nPosition++];
+			if (c == '\\' && m_nPosition < m_text.size()) {
+				c = m_text[m_nPosition++];
+				c = c == 'n' ? '\n' : c == 't' ? '\t' : c;
+			}
+			s.push_back(c);
+		}
+		return m_nPosition++ < m_text.size();
+	}
+
+	bool parseValue(Json& value)
+	{
+		skipSpace();
+		if (m_nPosition >= m_text.size()) {
+			return false;
+		}
+		char const c = m_text[m_nPosition];
+		if (c == '{') {
+			value.kind = Json::OBJECT;
+			++m_nPosition;
+			if (consume('}')) {
+				return true;
+			}
+			do {
+				std::pair<std::string, Json> member;
+				if (!parseString(member.first) || !consume(':') || !parseValue(member.second)) {
+					return false;
+				}
+				value.object.push_back(std::move(member));
+			} while (consume(','));
+			return consume('}');
+		}
+		if (c == '[') {
+			value.kind = Json::ARRAY;
+			++m_nPosition;
+			if (consume(']')) {
+				return true;
+			}
+			do {
+				value.array.emplace_back();
+				if (!parseValue(value.array.back())) {
+					return false;
+				}
+			} while (consume(','));
+			return consume(']');
+		}
+		if (c == '"') {
+			value.kind = Json::STRING;
+			return parseString(value.string);
+		}
+		if (consumeWord("true") || consumeWord("false")) {
+			value.kind = Json::BOOLEAN;
+			value.boolean = c == 't';
+			return true;
+		}
+		if (consumeWord("null")) {
+			value.kind = Json::NUL;
+			return true;
+		}
+		char const* const first = m_text.c_str() + m_nPosition;
+		char* last = nullptr;
+		value.kind = Json::NUMBER;
+		value.number = std::strtod(first, &last);
+		m_nPosition += static_cast<size_t>(last - first);
+		return last != first;
+	}
+
+	std::string const& m_text;
+
+	size_t m_nPosition;
+};
+
+inline std::string compilerName()
+{
+#if defined(__clang__)
+	return "clang " __clang_version__;
+#elif defined(__GNUC__)
+	return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+	return "msvc " + std::to_string(_MSC_VER);
+#else
+	return "unknown";
+#endif
+}
+}
+
+inline bool save(std::string const& path, std::vector<Result> const& results)
+{
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+	file.precision(6);
+	file << std::fixed;
+	file << "{\n";
+	file << "\t\"version\": 1,\n";
+	file << "\t\"compiler\": \"" << detail::compilerName() << "\",\n";
+	file << "\t\"results\": [";
+	for (size_t i = 0; i < results.size(); ++i) {
+		Result const& r = results[i];
+		file << (i == 0 ? "\n" : ",\n");
+		file << "\t\t{ \"name\": \"" << r.name << "\", \"type\": \"" << r.type << "\", \"size\": " << r.size
+			<< ", \"aligned\": " << (r.aligned ? "true" : "false") << ", \"bytes\": " << r.bytes
+			<< ", \"min_ns\": " << r.ns.min << ", \"median_ns\": " << r.ns.median << ", \"mean_ns\": " << r.ns.mean
+			<< ", \"p90_ns\": " << r.ns.p90 << ", \"p99_ns\": " << r.ns.p99 << ", \"max_ns\": " << r.ns.max
+			<< ", \"samples_per_s\": " << r.samplesPerSecond() << ", \"gb_per_s\": " << r.gigabytesPerSecond() << " }";
+	}
+	file << "\n\t]\n}\n";
+	return static_cast<bool>(file);
+}
+
+inline bool load(std::string const& path, std::vector<Result>& results)
+{
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+	std::string const text{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	detail::Json root;
+	if (!detail::JsonParser(text).parse(root)) {
+		return false;
+	}
+	detail::Json const* list = root.find("results");
+	if (list == nullptr || list->kind != detail::Json::ARRAY) {
+		return false;
+	}
+	auto number = [](detail::Json const& object, char const* name) {
+		detail::Json const* member = object.find(name);
+		return member != nullptr ? member->number : 0.0;
+	};
+	for (detail::Json const& item : list->array) {
+		detail::Json const* name = item.find("name");
+		detail::Json const* type = item.find("type");
+		detail::Json const* aligned = item.find("aligned");
+		if (name == nullptr || type == nullptr) {
+			return false;
+		}
+		Result r;
+		r.name = name->string;
+		r.type = type->string;
+		r.size = static_cast<size_t>(number(item, "size"));
+		r.aligned = aligned == nullptr || aligned->boolean;
+		r.bytes = static_cast<size_t>(number(item, "bytes"));
+		r.ns.min = number(item, "min_ns");
+		r.ns.median = number(item, "median_ns");
+		r.ns.mean = number(item, "mean_ns");
+		r.ns.p90 = number(item, "p90_ns");
+		r.ns.p99 = number(item, "p99_ns");
+		r.ns.max = number(item, "max_ns");
+		results.push_back(std::move(r));
+	}
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Comparing
+
+inline size_t compare(std::vector<Result> const& baseline, std::vector<Result> const& current, double threshold)
+{
+	size_t regressions = 0;
+	size_t improvements = 0;
+	size_t matched = 0;
+	std::printf("%-44s %14s %14s %9s\n", "case", "baseline (ns)", "current (ns)", "change");
+	for (Result const& now : current) {
+		std::string const key = now.key();
+		auto const before = std::find_if(baseline.begin(), baseline.end(), [&](Result const& r) { return r.key() == key; });
+		if (before == baseline.end() || before->ns.median <= 0) {
+			continue;
+		}
+		++matched;
+		double const change = now.ns.median / before->ns.median - 1.0;
+		char const* flag = "";
+		if (change > threshold) {
+			flag = "  REGRESSION";
+			++regressions;
+		}
+		else if (change < -threshold) {
+			flag = "  improved";
+			++improvements;
+		}
+		std::printf("%-44s %14.1f %14.1f %+8.1f%%%s\n", key.c_str(), before->ns.median, now.ns.median, change * 100.0, flag);
+	}
+	std::printf("\n%zu cases compared, %zu regressions and %zu improvements beyond %.1f%%\n", matched, regressions, improvements, threshold * 100.0);
+	return regressions;
+}
+
+#pragma endregion
+
+}
+}
+
+#pragma endregion
+
+#endif // !NYCOLIB_BENCHMARK_H
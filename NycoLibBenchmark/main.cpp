@@ -0,0 +1,344 @@
+/*
+	NycoLibBenchmark
+
+	measures the throughput (samples/s, GB/s) and the latency distribution of a call
+	for the AudioStream operations, over buffer sizes from 32 to 100M samples, the
+	sample types float, double, int16 and int32, and aligned and unaligned buffers.
+
+	building on Linux, from the root of the repository:
+		g++ -std=c++20 -O3 -DNDEBUG -pthread -INycoLib NycoLibBenchmark/main.cpp -o nycobench
+
+	usage:
+		nycobench [options]
+			--out <file>          saves the results as JSON (default: benchmark.json)
+			--compare <file>      compares the results with a saved baseline, the exit code is 1 if any case regressed
+			--in <file>           with --compare, compares a saved run instead of running the benchmark
+			--threshold <pct>     the change in the median that counts as a regression (default: 5)
+			--filter <text>       only runs the cases whose name contains text
+			--types <list>        only runs these types, e.g. float,int16
+			--min-size <n>        the smallest buffer size to run
+			--max-size <n>        the largest buffer size to run (default: 100000000)
+			--quick               runs up to 1M samples with a shorter time per case
+
+*/
+
+#include "AudioStream.h"
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace nyco;
+
+
+namespace {
+
+struct Config {
+	benchmark::Options options;
+
+	std::string out = "benchmark.json";
+
+	std::string baseline;
+
+	std::string in;
+
+	double threshold = 0.05;
+
+	std::string filter;
+
+	std::vector<std::string> types;
+
+	size_t minSize = 0;
+
+	size_t maxSize = 100000000;
+};
+
+size_t const SIZES[] = { 32, 128, 512, 2048, 8192, 32768, 131072, 524288, 2097152, 8388608, 33554432, 100000000 };
+
+/*
+* times the cases and collects their results
+*/
+class Runner {
+public:
+	explicit Runner(Config const& config)
+		: m_config{ config }
+	{
+	}
+
+	template <typename Function>
+	void run(char const* name, char const* type, size_t size, bool aligned, size_t bytes, Function&& func)
+	{
+		if (!m_config.filter.empty() && std::strstr(name, m_config.filter.c_str()) == nullptr) {
+			return;
+		}
+		benchmark::Result result;
+		result.name = name;
+		result.type = type;
+		result.size = size;
+		result.aligned = aligned;
+		result.bytes = bytes;
+		result.ns = benchmark::measure(func, m_config.options);
+		std::printf("%-18s %-7s %10zu %-10s %14.1f %14.1f %12.2f %9.2f\n", name, type, size, aligned ? "aligned" : "unaligned",
+			result.ns.median, result.ns.p99, result.samplesPerSecond() / 1e6, result.gigabytesPerSecond());
+		std::fflush(stdout);
+		m_results.push_back(std::move(result));
+	}
+
+	std::vector<benchmark::Result> const& results() const
+	{
+		return m_results;
+	}
+
+private:
+	Config const& m_config;
+
+	std::vector<benchmark::Result> m_results;
+};
+
+/*
+* returns a stream of size samples over storage, which holds size + 1 samples
+* storage comes from the library allocator and is 64 byte aligned, an unaligned stream starts one sample into it
+*/
+template <typename T>
+AudioStream<T> placed(AudioStream<T>& storage, size_t size, bool aligned)
+{
+	return AudioStream<T>(storage.begin() + (aligned ? 0 : 1), size, ownership::NO_OWNERSHIP);
+}
+
+template <typename T>
+void runCases(Runner& runner, char const* type, size_t size, bool aligned)
+{
+	AudioStream<T> storage[5] = { AudioStream<T>(size + 1), AudioStream<T>(size + 1), AudioStream<T>(size + 1), AudioStream<T>(size + 1), AudioStream<T>(size + 1) };
+	AudioStream<T> a = placed(storage[0], size, aligned);
+	AudioStream<T> b = placed(storage[1], size, aligned);
+	AudioStream<T> dst = placed(storage[2], size, aligned);
+	// the compound operators apply an identity operand, so the samples stay the same however many times they run
+	AudioStream<T> zeros = placed(storage[3], size, aligned);
+	AudioStream<T> ones = placed(storage[4], size, aligned);
+	for (size_t i = 0; i < size; ++i) {
+		a[i] = static_cast<T>(i % 100 + 1);
+		b[i] = static_cast<T>(i % 7 + 1);
+		dst[i] = a[i];
+		ones[i] = static_cast<T>(1);
+	}
+	T const scalar = static_cast<T>(3);
+	T const one = static_cast<T>(1);
+	T const zero = static_cast<T>(0);
+	T const large = static_cast<T>(1000);
+	size_t const bytes = size * sizeof(T);
+
+	auto run = [&](char const* name, size_t touched, auto&& func) {
+		runner.run(name, type, size, aligned, touched, func);
+	};
+
+	// AudioStream OP AudioStream, evaluated into an existing stream
+	run("add", 3 * bytes, [&]() { dst = a + b; });
+	run("sub", 3 * bytes, [&]() { dst = a - b; });
+	run("mul", 3 * bytes, [&]() { dst = a * b; });
+	run("div", 3 * bytes, [&]() { dst = a / b; });
+	run("mod", 3 * bytes, [&]() { dst = a % b; });
+	if constexpr (std::is_integral_v<T>) {
+		run("xor", 3 * bytes, [&]() { dst = a ^ b; });
+		run("and", 3 * bytes, [&]() { dst = a & b; });
+		run("or", 3 * bytes, [&]() { dst = a | b; });
+	}
+
+	// AudioStream OP scalar
+	run("add.scalar", 2 * bytes, [&]() { dst = a + scalar; });
+	run("sub.scalar", 2 * bytes, [&]() { dst = a - scalar; });
+	run("mul.scalar", 2 * bytes, [&]() { dst = a * scalar; });
+	run("div.scalar", 2 * bytes, [&]() { dst = a / scalar; });
+	run("mod.scalar", 2 * bytes, [&]() { dst = a % scalar; });
+	if constexpr (std::is_integral_v<T>) {
+		run("xor.scalar", 2 * bytes, [&]() { dst = a ^ scalar; });
+		run("and.scalar", 2 * bytes, [&]() { dst = a & scalar; });
+		run("or.scalar", 2 * bytes, [&]() { dst = a | scalar; });
+	}
+
+	// compound operators
+	for (size_t i = 0; i < size; ++i) {
+		dst[i] = a[i];
+	}
+	run("add.assign", 3 * bytes, [&]() { dst += zeros; });
+	run("sub.assign", 3 * bytes, [&]() { dst -= zeros; });
+	run("mul.assign", 3 * bytes, [&]() { dst *= ones; });
+	run("div.assign", 3 * bytes, [&]() { dst /= ones; });
+	run("add.assign.scalar", 2 * bytes, [&]() { dst += zero; });
+	run("mul.assign.scalar", 2 * bytes, [&]() { dst *= one; });
+	run("mod.assign.scalar", 2 * bytes, [&]() { dst %= large; });
+	if constexpr (std::is_integral_v<T>) {
+		run("xor.assign", 3 * bytes, [&]() { dst ^= zeros; });
+		run("or.assign.scalar", 2 * bytes, [&]() { dst |= zero; });
+	}
+
+	// unary operators and expressions
+	run("negate", 2 * bytes, [&]() { dst = -a; });
+	if constexpr (std::is_integral_v<T>) {
+		run("not", 2 * bytes, [&]() { dst = ~a; });
+	}
+	run("expr.muladd", 3 * bytes, [&]() { dst = a * b + a; });
+	run("expr.alloc", 3 * bytes, [&]() {
+		AudioStreamBase<T> result = a * b + a;
+		benchmark::doNotOptimize(result);
+	});
+
+	// transform and zipWith, with functions that keep the samples bounded however many times they run
+	run("transform", 2 * bytes, [&]() { dst.transform([](T x) { return static_cast<T>(T(1) - x); }); });
+	run("transform.binary", 3 * bytes, [&]() { dst.transform([](T x, T y) { return static_cast<T>(y - x); }, b); });
+	run("zipWith", 3 * bytes, [&]() { dst = AudioStreamBase<T>::zipWith(a, b, [](T x, T y) { return x > y ? x : y; }); });
+
+	// copies
+	run("clone", 2 * bytes, [&]() {
+		AudioStreamBase<T> copy = a.clone();
+		benchmark::doNotOptimize(copy);
+	});
+	run("concat", 4 * bytes, [&]() {
+		AudioStreamBase<T> joined = a >> b;
+		benchmark::doNotOptimize(joined);
+	});
+	run("shift.copy", 2 * bytes, [&]() {
+		AudioStreamBase<T> shifted = a << 1;
+		benchmark::doNotOptimize(shifted);
+	});
+
+	// shifts and rotations only move the start of the stream, they do not touch the samples
+	run("shift.left", 0, [&]() { dst <<= 1; });
+	run("shift.right", 0, [&]() { dst >>= 1; });
+	run("rotate", 0, [&]() { dst.rotateLeft(1); });
+	run("rotate.normalize", 2 * bytes, [&]() {
+		dst.rotateLeft(size / 3 + 1);
+		dst.normalize();
+	});
+}
+
+template <typename T>
+void runType(Runner& runner, Config const& config, char const* type)
+{
+	if (!config.types.empty() && std::find(config.types.begin(), config.types.end(), type) == config.types.end()) {
+		return;
+	}
+	for (size_t size : SIZES) {
+		if (size < config.minSize || size > config.maxSize) {
+			continue;
+		}
+		for (bool aligned : { true, false }) {
+			try {
+				runCases<T>(runner, type, size, aligned);
+			}
+			catch (std::bad_alloc const&) {
+				std::printf("%-18s %-7s %10zu %-10s skipped, out of memory\n", "*", type, size, aligned ? "aligned" : "unaligned");
+			}
+		}
+	}
+}
+
+std::vector<std::string> split(std::string const& list)
+{
+	std::vector<std::string> items;
+	size_t start = 0;
+	while (start <= list.size()) {
+		size_t const end = std::min(list.find(',', start), list.size());
+		if (end > start) {
+			items.push_back(list.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+	return items;
+}
+
+bool parse(int argc, char** argv, Config& config)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string const arg = argv[i];
+		bool const hasValue = i + 1 < argc;
+		if (arg == "--quick") {
+			config.maxSize = 1 << 20;
+			config.options.budgetNs = 50000000.0;
+			config.options.maxSamples = 15;
+		}
+		else if (!hasValue) {
+			return false;
+		}
+		else if (arg == "--out") {
+			config.out = argv[++i];
+		}
+		else if (arg == "--compare") {
+			config.baseline = argv[++i];
+		}
+		else if (arg == "--in") {
+			config.in = argv[++i];
+		}
+		else if (arg == "--threshold") {
+			config.threshold = std::atof(argv[++i]) / 100.0;
+		}
+		else if (arg == "--filter") {
+			config.filter = argv[++i];
+		}
+		else if (arg == "--types") {
+			config.types = split(argv[++i]);
+		}
+		else if (arg == "--min-size") {
+			config.minSize = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--max-size") {
+			config.maxSize = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else {
+			return false;
+		}
+	}
+	return config.in.empty() || !config.baseline.empty();
+}
+
+}
+
+
+int main(int argc, char** argv) {
+
+	Config config;
+	if (!parse(argc, argv, config)) {
+		std::fprintf(stderr, "usage: %s [--out file] [--compare baseline] [--in file] [--threshold pct] [--filter text] [--types list] [--min-size n] [--max-size n] [--quick]\n", argv[0]);
+		return 2;
+	}
+
+	std::vector<benchmark::Result> results;
+	if (!config.in.empty()) {
+		if (!benchmark::load(config.in, results)) {
+			std::fprintf(stderr, "could not read %s\n", config.in.c_str());
+			return 2;
+		}
+	}
+	else {
+		std::printf("%-18s %-7s %10s %-10s %14s %14s %12s %9s\n", "case", "type", "size", "alignment", "median (ns)", "p99 (ns)", "Msamples/s", "GB/s");
+		Runner runner(config);
+		runType<float>(runner, config, "float");
+		runType<double>(runner, config, "double");
+		runType<int16_t>(runner, config, "int16");
+		runType<int32_t>(runner, config, "int32");
+		results = runner.results();
+		if (!benchmark::save(config.out, results)) {
+			std::fprintf(stderr, "could not write %s\n", config.out.c_str());
+			return 2;
+		}
+		std::printf("\n%zu results saved to %s\n", results.size(), config.out.c_str());
+	}
+
+	if (!config.baseline.empty()) {
+		std::vector<benchmark::Result> baseline;
+		if (!benchmark::load(config.baseline, baseline)) {
+			std::fprintf(stderr, "could not read %s\n", config.baseline.c_str());
+			return 2;
+		}
+		std::printf("\n");
+		return benchmark::compare(baseline, results, config.threshold) == 0 ? 0 : 1;
+	}
+
+	return 0;
+}
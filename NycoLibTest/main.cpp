@@ -1,6 +1,17 @@
 #include "AudioStream.h"
+#include "FFT.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "../NycoLib.AudioFile/AudioFile.h"
@@ -8,6 +19,412 @@
 using namespace nyco;
 
 
+/*
+* compares FFT<BufferType> against a direct DFT for sizes covering every radix, on every instruction set
+* the butterflies must give the same result in a debug build as in a release one
+*/
+template <typename BufferType>
+bool checkFFT(double tolerance) {
+
+	double const pi = 3.14159265358979323846;
+	bool ok = true;
+
+	for (simd::InstructionSet set : { simd::InstructionSet::Scalar, simd::InstructionSet::SSE2, simd::InstructionSet::AVX2, simd::InstructionSet::AVX512 }) {
+		simd::setInstructionSet(set);
+		for (size_t n : { 2, 3, 4, 5, 7, 8, 12, 15, 16, 60, 64, 100, 128, 1000 }) {
+			std::vector<BufferType> re(n), im(n), outRe(n), outIm(n);
+			for (size_t i = 0; i < n; ++i) {
+				re[i] = static_cast<BufferType>(std::sin(0.37 * i) + 0.25);
+				im[i] = static_cast<BufferType>(std::cos(1.13 * i));
+			}
+
+			FFT<BufferType> fft(n);
+			fft.forward(AudioStreamView<BufferType const>(re.data(), n), AudioStreamView<BufferType const>(im.data(), n), AudioStreamView<BufferType>(outRe.data(), n), AudioStreamView<BufferType>(outIm.data(), n));
+
+			double error = 0;
+			for (size_t k = 0; k < n; ++k) {
+				std::complex<double> expected = 0;
+				for (size_t j = 0; j < n; ++j) {
+					expected += std::complex<double>(re[j], im[j]) * std::polar(1.0, -2 * pi * static_cast<double>((j * k) % n) / n);
+				}
+				error = std::max(error, std::abs(expected - std::complex<double>(outRe[k], outIm[k])) / n);
+			}
+			if (error > tolerance) {
+				std::cout << "FFT<" << sizeof(BufferType) * 8 << " bit> of " << n << " points on instruction set " << static_cast<int>(set) << " is off by " << error << std::endl;
+				ok = false;
+			}
+		}
+	}
+
+	simd::setInstructionSet(simd::detectInstructionSet());
+	return ok;
+}
+
+/*
+* returns true if stream holds expected in logical order, printing both otherwise
+*/
+template <typename BufferType, typename Ownership>
+bool holds(char const* name, AudioStreamBase<BufferType, Ownership> const& stream, std::vector<BufferType> const& expected) {
+
+	bool ok = stream.size() == expected.size();
+	for (size_t i = 0; ok && i < expected.size(); ++i) {
+		ok = stream[i] == expected[i];
+	}
+	if (!ok) {
+		std::cout << name << ": expected";
+		for (BufferType x : expected) {
+			std::cout << " " << x;
+		}
+		std::cout << ", got";
+		for (size_t i = 0; i < stream.size(); ++i) {
+			std::cout << " " << stream[i];
+		}
+		std::cout << std::endl;
+	}
+	return ok;
+}
+
+/*
+* compound operators on rotated and shifted streams, whose operands read the destination through its offset
+*/
+bool checkRotatedCompound() {
+
+	bool ok = true;
+
+	AudioStream<float> a(8);
+	for (size_t i = 0; i < 8; ++i) {
+		a[i] = 100.0f + i;
+	}
+	a.rotateLeft(3);
+	AudioStream<float> b(8);
+	b[5] = b[6] = b[7] = 100.0f;
+	a += b;
+	ok &= holds("rotate then +=", a, { 103, 104, 105, 106, 107, 200, 201, 202 });
+
+	AudioStream<float> c(8);
+	for (size_t i = 0; i < 8; ++i) {
+		c[i] = float(i);
+	}
+	c >>= 2;
+	c *= 2.0f;
+	ok &= holds("shift then *=", c, { 0, 0, 0, 2, 4, 6, 8, 10 });
+
+	AudioStream<float> d(8);
+	for (size_t i = 0; i < 8; ++i) {
+		d[i] = float(i);
+	}
+	d.rotateRight(3);
+	d.assign(execution::PARALLEL, d * 2.0f + d);
+	ok &= holds("rotate then assign with a policy", d, { 15, 18, 21, 0, 3, 6, 9, 12 });
+
+	AudioStream<float, ownership::copy_on_write> e(8);
+	for (size_t i = 0; i < 8; ++i) {
+		e[i] = float(i);
+	}
+	e.rotateLeft(2);
+	auto f = e.clone();
+	f -= e;
+	f += e * 10.0f;
+	ok &= holds("compound on a rotated clone", f, { 20, 30, 40, 50, 60, 70, 0, 10 });
+	ok &= holds("the rotated original", e, { 2, 3, 4, 5, 6, 7, 0, 1 });
+
+	return ok;
+}
+
+/*
+* a const stream is read in logical order through its iterators and segments, without being normalized
+*/
+bool checkConstIteration() {
+
+	static_assert(std::random_access_iterator<AudioStream<float>::const_iterator>);
+
+	AudioStream<float> stream(8);
+	for (size_t i = 0; i < 8; ++i) {
+		stream[i] = float(i);
+	}
+	stream.rotateLeft(3);
+	AudioStream<float> const& rotated = stream;
+
+	std::vector<float> read;
+	for (float x : rotated) {
+		read.push_back(x);
+	}
+	bool ok = read == std::vector<float>{ 3, 4, 5, 6, 7, 0, 1, 2 };
+	ok &= std::vector<float>(std::make_reverse_iterator(rotated.end()), std::make_reverse_iterator(rotated.begin())) == std::vector<float>{ 2, 1, 0, 7, 6, 5, 4, 3 };
+	ok &= rotated.end() - rotated.begin() == 8 && rotated.begin()[5] == 0.0f && *std::max_element(rotated.begin(), rotated.end()) == 7.0f;
+
+	auto const segments = rotated.segments();
+	ok &= segments[0].size() == 5 && segments[0][0] == 3.0f && segments[1].size() == 3 && segments[1][0] == 0.0f;
+
+	if (!ok) {
+		std::cout << "a rotated const stream is not read in logical order" << std::endl;
+	}
+	return ok;
+}
+
+/*
+* constant streams fold through expressions, and the flag is dropped whenever the samples may change behind it
+*/
+bool checkConstantFolding() {
+
+	bool ok = true;
+
+	// propagation
+	AudioStream<float> two(8);
+	two.fill(2.0f);
+	AudioStream<float> three(8);
+	three.fill(3.0f);
+	AudioStream<float> folded = two + three * 2.0f;
+	ok &= holds("constant + constant * gain", folded, std::vector<float>(8, 8.0f)) && folded.constantValue() == 8.0f;
+
+	AudioStream<float> silence(8);
+	silence *= 0.5f;
+	ok &= silence.isSilent();
+
+	AudioStream<int> zeros(8);
+	AudioStream<int> ramp(8);
+	for (size_t i = 0; i < 8; ++i) {
+		ramp[i] = int(i);
+	}
+	AudioStream<int> product = zeros * ramp;
+	ok &= product.isSilent();
+
+	// a float product is not folded through a varying side, an infinity times 0 is NaN
+	AudioStream<float> infinite(8);
+	infinite.fill(std::numeric_limits<float>::infinity());
+	infinite[3] = 1.0f;
+	AudioStream<float> nan = infinite * silence;
+	ok &= !nan.constantValue() && std::isnan(nan[0]) && nan[3] == 0.0f;
+
+	// invalidation
+	AudioStream<float> c(8);
+	c.fill(0.0f);
+	c.view()[2] = 4.0f;
+	c *= 3.0f;
+	ok &= holds("write through a view after fill", c, { 0, 0, 12, 0, 0, 0, 0, 0 });
+
+	c.fill(1.0f);
+	c[5] = 2.0f;
+	c += 1.0f;
+	ok &= holds("write through [] after fill", c, { 2, 2, 2, 2, 2, 3, 2, 2 });
+
+	std::shared_ptr<float> shared(new float[8], std::default_delete<float[]>());
+	AudioStream<float> a(shared, 8, ownership::NO_OWNERSHIP);
+	AudioStream<float> b(shared, 8, ownership::NO_OWNERSHIP);
+	a.fill(0.0f);
+	b[3] = 5.0f;
+	a += 1.0f;
+	ok &= holds("write through a stream sharing the buffer", a, { 1, 1, 1, 6, 1, 1, 1, 1 }) && !a.constantValue();
+
+	float samples[8] = {};
+	AudioStream<float, ownership::borrowed> borrowed(samples, 8, ownership::NO_OWNERSHIP);
+	ok &= borrowed.detectConstant() == 0.0f;
+	samples[6] = 7.0f;
+	ok &= !borrowed.constantValue() && !borrowed.detectConstant();
+
+	AudioStream<float, ownership::copy_on_write> original(8);
+	auto clone = original.clone();
+	clone[1] = 1.0f;
+	ok &= original.isSilent() && !clone.constantValue() && clone[1] == 1.0f;
+
+	if (!ok) {
+		std::cout << "constant folding or its invalidation failed" << std::endl;
+	}
+	return ok;
+}
+
+/*
+* an allocator that counts the buffers it has handed out and not yet taken back
+*/
+class CountingAllocator : public AudioAllocator {
+public:
+
+	void* allocate(size_t bytes) override {
+		++live;
+		return alignedAllocator().allocate(bytes);
+	}
+
+	void deallocate(void* p, size_t bytes) override {
+		--live;
+		alignedAllocator().deallocate(p, bytes);
+	}
+
+	int live = 0;
+};
+
+/*
+* a unique stream frees its buffer exactly once, wherever it was moved to, and a borrowed stream never frees it
+*/
+bool checkOwnership() {
+
+	static_assert(sizeof(AudioStream<float, ownership::borrowed>) < sizeof(AudioStream<float, ownership::unique>));
+	static_assert(sizeof(AudioStream<float, ownership::unique>) <= sizeof(AudioStream<float>));
+	static_assert(std::is_trivially_destructible_v<AudioStream<float, ownership::borrowed>>);
+	static_assert(std::is_same_v<decltype(std::declval<AudioStream<float, ownership::borrowed>&>().clone()), AudioStreamBase<float, ownership::unique>>);
+
+	bool ok = true;
+	CountingAllocator allocator;
+
+	{
+		AudioStream<float, ownership::unique> u(8, allocator);
+		for (size_t i = 0; i < 8; ++i) {
+			u[i] = float(i);
+		}
+		ok &= allocator.live == 1 && u.unique() && &u.allocator() == &allocator;
+
+		AudioStream<float, ownership::unique> moved = std::move(u);
+		ok &= allocator.live == 1 && holds("a moved unique stream", moved, { 0, 1, 2, 3, 4, 5, 6, 7 });
+
+		auto clone = moved.clone();
+		clone[0] = 10.0f;
+		ok &= allocator.live == 2 && moved[0] == 0.0f;
+
+		// an rvalue unique stream lends its buffer to the result
+		AudioStream<float, ownership::unique> tripled = std::move(clone) * 3.0f;
+		ok &= allocator.live == 2 && holds("a unique stream reused by an expression", tripled, { 30, 3, 6, 9, 12, 15, 18, 21 });
+
+		{
+			std::vector<AudioStream<float, ownership::unique>> streams;
+			for (int i = 0; i < 4; ++i) {
+				streams.emplace_back(8, allocator);
+			}
+			ok &= allocator.live == 6;
+		}
+		ok &= allocator.live == 2;
+	}
+	ok &= allocator.live == 0;
+
+	std::vector<float> host(8, 1.0f);
+	{
+		AudioStream<float, ownership::borrowed> borrowed(host.data(), host.size(), ownership::NO_OWNERSHIP);
+		ok &= !borrowed.unique();
+		borrowed *= 3.0f;
+		ok &= host[4] == 3.0f;
+
+		auto clone = borrowed.clone();
+		clone[0] = 9.0f;
+		ok &= host[0] == 3.0f;
+
+		AudioStream<float, ownership::borrowed> moved = std::move(borrowed);
+		moved[1] = 5.0f;
+		ok &= host[1] == 5.0f;
+	}
+	ok &= host == std::vector<float>{ 3, 5, 3, 3, 3, 3, 3, 3 };
+
+	if (!ok) {
+		std::cout << "a unique or borrowed stream did not keep its ownership" << std::endl;
+	}
+	return ok;
+}
+
+/*
+* a copy-on-write clone shares its buffer until the first write, through any mutable path, copies it
+*/
+bool checkCopyOnWrite() {
+
+	using Cow = AudioStream<float, ownership::copy_on_write>;
+
+	Cow original(8);
+	for (size_t i = 0; i < 8; ++i) {
+		original[i] = float(i);
+	}
+	std::vector<float> const ramp{ 0, 1, 2, 3, 4, 5, 6, 7 };
+
+	bool ok = true;
+
+	{
+		auto clone = original.clone();
+		ok &= !original.unique() && std::as_const(original).segments()[0].data() == std::as_const(clone).segments()[0].data();
+		clone[1] = -1.0f;
+		ok &= original.unique() && clone.unique();
+		ok &= holds("write through []", clone, { 0, -1, 2, 3, 4, 5, 6, 7 }) && holds("the original of []", original, ramp);
+	}
+	{
+		auto clone = original.clone();
+		*clone.begin() = -1.0f;
+		ok &= holds("write through begin", clone, { -1, 1, 2, 3, 4, 5, 6, 7 }) && holds("the original of begin", original, ramp);
+	}
+	{
+		auto clone = original.clone();
+		clone.transform([](float x) { return x * 2.0f; });
+		ok &= holds("transform", clone, { 0, 2, 4, 6, 8, 10, 12, 14 }) && holds("the original of transform", original, ramp);
+	}
+	{
+		auto clone = original.clone();
+		clone *= 3.0f;
+		clone += original;
+		ok &= holds("compound operators", clone, { 0, 4, 8, 12, 16, 20, 24, 28 }) && holds("the original of compound operators", original, ramp);
+	}
+	{
+		// the original is written while the clone reads it
+		auto clone = original.clone();
+		original += clone;
+		ok &= holds("compound operator on the original", original, { 0, 2, 4, 6, 8, 10, 12, 14 }) && holds("the clone of a compound operator", clone, ramp);
+		original -= clone;
+	}
+	{
+		auto clone = original.clone();
+		clone.rotateLeft(3);
+		ok &= !original.unique() && holds("a rotated clone", clone, { 3, 4, 5, 6, 7, 0, 1, 2 });
+		clone[6] = -1.0f;
+		ok &= holds("write to a rotated clone", clone, { 3, 4, 5, 6, 7, 0, -1, 2 }) && holds("the original of a rotated clone", original, ramp);
+	}
+	ok &= original.unique();
+
+	if (!ok) {
+		std::cout << "a copy-on-write clone was not copied by its first write" << std::endl;
+	}
+	return ok;
+}
+
+/*
+* an exception thrown by a parallel loop, on a worker or on the calling thread, reaches the caller once the loop drained
+*/
+bool checkParallelForException() {
+
+	ThreadPool pool(3);
+	bool ok = true;
+
+	for (size_t thrower : { size_t(0), size_t(1), size_t(63) }) {
+		try {
+			pool.parallelFor(64, [thrower](size_t i) {
+				if (i == thrower) {
+					throw std::runtime_error("thrown by the loop");
+				}
+			});
+			ok = false;
+		}
+		catch (std::runtime_error const&) {
+		}
+	}
+
+	try {
+		pool.parallelFor(4, [&pool](size_t i) {
+			pool.parallelFor(4, [i](size_t j) {
+				if (i == 2 && j == 3) {
+					throw 7;
+				}
+			});
+		});
+		ok = false;
+	}
+	catch (int x) {
+		ok &= x == 7;
+	}
+
+	// the pool still runs loops afterwards
+	std::atomic<size_t> sum{ 0 };
+	pool.parallelFor(64, [&sum](size_t i) { sum += i; });
+	ok &= sum == 2016;
+
+	if (!ok) {
+		std::cout << "an exception thrown by a parallel loop did not reach its caller" << std::endl;
+	}
+	return ok;
+}
+
+
+
 int main() {
 
 	double dBuffer[] = { 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0 };
@@ -33,5 +450,40 @@ int main() {
 		std::cout << a << std::endl;
 	}
 
+	if (!checkFFT<float>(1e-5) || !checkFFT<double>(1e-12)) {
+		return 1;
+	}
+	std::cout << "FFT matches the reference DFT" << std::endl;
+
+	if (!checkRotatedCompound()) {
+		return 1;
+	}
+	std::cout << "compound operators on rotated streams hold their samples in logical order" << std::endl;
+
+	if (!checkConstIteration()) {
+		return 1;
+	}
+	std::cout << "rotated const streams iterate in logical order" << std::endl;
+
+	if (!checkConstantFolding()) {
+		return 1;
+	}
+	std::cout << "constant streams fold and are invalidated by writes" << std::endl;
+
+	if (!checkOwnership()) {
+		return 1;
+	}
+	std::cout << "unique streams free their buffer once and borrowed streams never do" << std::endl;
+
+	if (!checkCopyOnWrite()) {
+		return 1;
+	}
+	std::cout << "copy-on-write clones are copied by their first write" << std::endl;
+
+	if (!checkParallelForException()) {
+		return 1;
+	}
+	std::cout << "exceptions thrown by parallel loops reach their caller" << std::endl;
+
 	return 0;
 }